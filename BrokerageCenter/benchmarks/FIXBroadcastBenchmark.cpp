@@ -0,0 +1,201 @@
+/*
+** Measures the per-target cost of broadcasting one FIX message (as FIXBroadcaster's writers do),
+** comparing a copy of the message for each target (previous behavior) with one copy per writer,
+** reused for all the targets that writer serves.
+**
+** There is no session to send through: each send does what Session::sendRaw does to the message,
+** i.e. it sets the session fields of the header and encodes the whole message into a string.
+** Time and heap allocations are reported per target. Allocations are counted by replacing the global operator new.
+**
+** Usage: FIXBroadcastBenchmark [numMessages = 2000] [numTargets = 100] [numOrderBookEntries = 20]
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <quickfix/FieldTypes.h>
+#include <quickfix/Message.h>
+#include <quickfix/fix50sp2/MarketDataIncrementalRefresh.h>
+#include <quickfix/fix50sp2/MarketDataSnapshotFullRefresh.h>
+
+#include <shift/miscutils/fix/HelperFunctions.h>
+
+static std::atomic<std::size_t> s_numAllocations { 0 };
+
+auto operator new(std::size_t size) -> void*
+{
+    s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc {};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+static const FIX::UtcTimeStamp s_timestamp { std::time(nullptr), 123456, 6 };
+
+/*
+ * The messages are built like FIXAcceptor::s_sendOrderBook and FIXAcceptor::s_sendOrderBookUpdate,
+ * then encoded once, as FIXBroadcaster::broadcast does.
+ */
+
+static void s_setHeader(FIX::Message& message, const char* msgType)
+{
+    FIX::Header& header = message.getHeader();
+    header.setField(FIX::BeginString(FIX::BeginString_FIXT11));
+    header.setField(FIX::SenderCompID("BROKERAGECENTER"));
+    header.setField(FIX::MsgType(msgType));
+}
+
+static auto s_createOrderBook(int numEntries) -> FIX::Message
+{
+    FIX::Message message;
+    s_setHeader(message, FIX::MsgType_MarketDataSnapshotFullRefresh);
+
+    message.setField(FIX::Symbol("AAPL"));
+    message.setField(FIX::RptSeq(42));
+
+    for (int i = 0; i < numEntries; ++i) {
+        shift::fix::addFIXGroup<FIX50SP2::MarketDataSnapshotFullRefresh::NoMDEntries>(message,
+            FIX::MDEntryType('B'),
+            FIX::MDEntryPx(150.01 - i * 0.01),
+            FIX::MDEntrySize(i + 1),
+            FIX::MDEntryDate(FIX::UtcDateOnly(s_timestamp.getDate(), s_timestamp.getMonth(), s_timestamp.getYear())),
+            FIX::MDEntryTime(FIX::UtcTimeOnly(s_timestamp.getTimeT(), s_timestamp.getFraction(6), 6)),
+            FIX::MDMkt("NAS"));
+    }
+
+    message.toString();
+    return message;
+}
+
+static auto s_createOrderBookUpdate() -> FIX::Message
+{
+    FIX::Message message;
+    s_setHeader(message, FIX::MsgType_MarketDataIncrementalRefresh);
+
+    shift::fix::addFIXGroup<FIX50SP2::MarketDataIncrementalRefresh::NoMDEntries>(message,
+        FIX::MDUpdateAction(FIX::MDUpdateAction_CHANGE),
+        FIX::MDEntryType('B'),
+        FIX::Symbol("AAPL"),
+        FIX::MDEntryPx(150.01),
+        FIX::MDEntrySize(3),
+        FIX::MDEntryDate(FIX::UtcDateOnly(s_timestamp.getDate(), s_timestamp.getMonth(), s_timestamp.getYear())),
+        FIX::MDEntryTime(FIX::UtcTimeOnly(s_timestamp.getTimeT(), s_timestamp.getFraction(6), 6)),
+        FIX::MDMkt("NAS"),
+        FIX::RptSeq(42));
+
+    message.toString();
+    return message;
+}
+
+/*
+ * What Session::sendRaw does to the message before writing it to the socket; returns the encoded size.
+ */
+static auto s_send(FIX::Message& message, int seqNum, std::string& messageString) -> std::size_t
+{
+    FIX::Header& header = message.getHeader();
+    header.setField(FIX::MsgSeqNum(seqNum));
+    header.setField(FIX::SendingTime(s_timestamp, 6));
+
+    message.toString(messageString);
+    return messageString.size();
+}
+
+// previous behavior: each target gets its own copy of the message
+static auto s_copyPerTarget(const FIX::Message& shared, const std::vector<std::string>& targetIDs, std::string& messageString) -> std::size_t
+{
+    std::size_t checksum = 0;
+    int seqNum = 0;
+
+    for (const auto& targetID : targetIDs) {
+        FIX::Message message(shared);
+        message.getHeader().setField(FIX::TargetCompID(targetID));
+        checksum += s_send(message, ++seqNum, messageString);
+    }
+
+    return checksum;
+}
+
+// each writer copies the message once, and each send overwrites the session fields of the previous one
+static auto s_copyPerWriter(const FIX::Message& shared, const std::vector<std::string>& targetIDs, std::string& messageString) -> std::size_t
+{
+    std::size_t checksum = 0;
+    int seqNum = 0;
+
+    FIX::Message message(shared);
+    for (const auto& targetID : targetIDs) {
+        message.getHeader().setField(FIX::TargetCompID(targetID));
+        checksum += s_send(message, ++seqNum, messageString);
+    }
+
+    return checksum;
+}
+
+template <typename _SendFunc>
+static void run(const char* name, const FIX::Message& shared, const std::vector<std::string>& targetIDs, std::size_t numMessages, _SendFunc send)
+{
+    std::string messageString;
+    std::size_t checksum = send(shared, targetIDs, messageString); // warm up: grows the string reused by the sends
+
+    const auto startAllocations = s_numAllocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < numMessages; ++i) {
+        checksum += send(shared, targetIDs, messageString);
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    const auto numAllocations = s_numAllocations.load() - startAllocations;
+
+    const double totalTargets = static_cast<double>(numMessages) * targetIDs.size();
+
+    std::cout << "  " << std::left << std::setw(16) << name
+              << " | per target: " << std::setw(10) << (elapsed / totalTargets) << " ns"
+              << " | allocations per target: " << std::setw(10) << (numAllocations / totalTargets)
+              << " | checksum: " << checksum
+              << std::endl;
+}
+
+static void runAll(const char* messageType, const FIX::Message& shared, const std::vector<std::string>& targetIDs, std::size_t numMessages)
+{
+    std::cout << messageType << " (" << shared.toString().size() << " bytes)" << std::endl;
+    run("copy per target", shared, targetIDs, numMessages, s_copyPerTarget);
+    run("copy per writer", shared, targetIDs, numMessages, s_copyPerWriter);
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t numMessages = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    const int numTargets = std::max((argc > 2) ? std::atoi(argv[2]) : 100, 1);
+    const int numOrderBookEntries = std::max((argc > 3) ? std::atoi(argv[3]) : 20, 1);
+
+    std::cout << "Messages: " << numMessages
+              << " | targets per writer: " << numTargets
+              << " | order book entries: " << numOrderBookEntries << std::endl;
+
+    std::vector<std::string> targetIDs;
+    for (int i = 0; i < numTargets; ++i) {
+        targetIDs.push_back("client" + std::to_string(i));
+    }
+
+    runAll("MarketDataSnapshotFullRefresh", s_createOrderBook(numOrderBookEntries), targetIDs, numMessages);
+    runAll("MarketDataIncrementalRefresh", s_createOrderBookUpdate(), targetIDs, numMessages);
+
+    return 0;
+}
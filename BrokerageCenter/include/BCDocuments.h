@@ -7,6 +7,7 @@
 #include "OrderBookEntry.h"
 #include "Parameters.h"
 #include "RiskManagement.h"
+#include "RiskManagementScheduler.h"
 #include "Transaction.h"
 
 #include <mutex>
@@ -45,6 +46,7 @@ public:
     void unregisterTargetFromCandles(const std::string& targetID);
 
     auto manageSubscriptionInOrderBook(bool isSubscribe, const std::string& symbol, const std::string& targetID) -> bool;
+    auto sendOrderBookSnapshot(const std::string& symbol, const std::string& targetID) -> bool;
     auto manageSubscriptionInCandlestickData(bool isSubscribe, const std::string& symbol, const std::string& targetID) -> bool;
 
     auto sendHistoryToUser(const std::string& userID) -> int;
@@ -56,8 +58,6 @@ public:
     void onNewOrderForUserRiskManagement(const std::string& userID, Order&& order);
     void onNewExecutionReportForUserRiskManagement(const std::string& userID, ExecutionReport&& report);
 
-    void broadcastOrderBooks() const;
-
 private:
     BCDocuments() = default; // singleton pattern
     BCDocuments(const BCDocuments&) = delete; // forbid copying
@@ -72,6 +72,7 @@ private:
     mutable std::mutex m_mtxUserID2TargetID;
     std::unordered_map<std::string, std::string> m_userID2TargetID;
 
+    RiskManagementScheduler m_riskManagementScheduler { ::RISK_MANAGEMENT_NUM_WORKERS }; // declared before the risk managements it runs, so that it outlives them
     mutable std::mutex m_mtxRiskManagementByUserID;
     std::unordered_map<std::string, std::unique_ptr<RiskManagement>> m_riskManagementByUserID; // userID, RiskManagement
 
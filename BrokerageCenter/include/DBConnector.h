@@ -2,8 +2,14 @@
 
 #include "TradingRecord.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -11,8 +17,31 @@
 
 class DBConnector {
 public:
+    /**
+     * @brief How trading records reach the database: they are always written by the trading records writer thread, in batches,
+     *        but BATCHED flushes at most every s_tradingRecordsFlushInterval, IMMEDIATE flushes as soon as records are queued,
+     *        and SYNCHRONOUS in addition makes enqueueTradingRecord() wait until its record was committed.
+     */
+    enum class RECORDS_DURABILITY : int {
+        BATCHED,
+        IMMEDIATE,
+        SYNCHRONOUS,
+    };
+
+    struct TradingRecordsStats {
+        std::uint64_t numQueued; // since the writer started
+        std::uint64_t numWritten;
+        std::uint64_t numFailed;
+        std::size_t queueSize; // records waiting to be written
+        double recordsPerSecond; // records written per second since the writer started
+        std::chrono::microseconds lastFlushLag; // time between queuing the oldest record of the last flush and its commit
+        std::chrono::microseconds lastFlushDuration;
+    };
+
     static bool s_isPortfolioDBReadOnly; // e.g. useful for research purpose when true
     static const std::string s_sessionID;
+    static RECORDS_DURABILITY s_tradingRecordsDurability;
+    static std::chrono::milliseconds s_tradingRecordsFlushInterval;
 
     ~DBConnector();
 
@@ -27,8 +56,14 @@ public:
 
     auto doQuery(std::string query, std::string msgIfStatMismatch, ExecStatusType statToMatch = PGRES_COMMAND_OK, PGresult** ppRes = nullptr) -> bool;
 
-    /*@ brief Inserts trade history into the table used to save the trading records. */
-    auto insertTradingRecord(const TradingRecord& trade) -> bool;
+    /*@ brief Starts/stops the thread writing the trading records; stopping writes all records still queued. */
+    auto startTradingRecordsWriter() -> bool;
+    void stopTradingRecordsWriter();
+
+    /*@ brief Queues trade history for the table used to save the trading records (blocks only when the queue is full, or in SYNCHRONOUS mode). */
+    void enqueueTradingRecord(TradingRecord record);
+
+    auto getTradingRecordsStats() const -> TradingRecordsStats;
 
 protected:
     PGconn* m_pConn;
@@ -39,5 +74,32 @@ private:
     DBConnector(const DBConnector&) = delete; // forbid copying
     auto operator=(const DBConnector&) -> DBConnector& = delete; // forbid assigning
 
+    auto createConnection() const -> PGconn*;
+
+    struct QueuedTradingRecord {
+        TradingRecord record;
+        std::chrono::steady_clock::time_point queuedTime;
+    };
+
+    void processTradingRecords();
+    auto writeTradingRecords(const std::vector<QueuedTradingRecord>& records) -> std::uint64_t;
+    auto prepareTradingRecordsConn() -> bool;
+
     std::unordered_map<std::string, std::string> m_loginInfo;
+
+    // trading records writer; it has its own connection, so that writing neither holds m_mtxPSQL nor waits for it
+    PGconn* m_pRecordsConn;
+    std::thread m_recordsWriter;
+    std::promise<void> m_quitRecordsWriter;
+    mutable std::mutex m_mtxRecordsQueue;
+    std::condition_variable m_cvRecordsQueue; // records were queued
+    std::condition_variable m_cvRecordsProcessed; // records were written (or failed), i.e. there is room in the queue
+    std::deque<QueuedTradingRecord> m_recordsQueue;
+    bool m_isRecordsWriterRunning;
+    std::uint64_t m_numRecordsQueued;
+    std::uint64_t m_numRecordsProcessed;
+    std::uint64_t m_numRecordsFailed;
+    std::chrono::steady_clock::time_point m_recordsWriterStartTime;
+    std::chrono::microseconds m_lastFlushLag;
+    std::chrono::microseconds m_lastFlushDuration;
 };
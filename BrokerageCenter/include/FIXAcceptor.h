@@ -2,8 +2,10 @@
 
 #include "CandlestickDataPoint.h"
 #include "ExecutionReport.h"
+#include "FIXBroadcaster.h"
 #include "Order.h"
 #include "OrderBookEntry.h"
+#include "Parameters.h"
 #include "PortfolioItem.h"
 #include "PortfolioSummary.h"
 #include "Transaction.h"
@@ -56,8 +58,8 @@ public:
     void disconnectClients();
 
     static void s_sendLastPrice2All(const Transaction& transac);
-    static void s_sendOrderBook(const std::vector<std::string>& targetList, const std::map<double, std::map<std::string, OrderBookEntry>>& orderBook);
-    static void s_sendOrderBookUpdate(const std::vector<std::string>& targetList, const OrderBookEntry& update);
+    static void s_sendOrderBook(const std::vector<std::string>& targetList, const std::string& symbol, OrderBookEntry::Type type, const std::map<double, std::map<std::string, OrderBookEntry>>& orderBook, unsigned int seqNum);
+    static void s_sendOrderBookUpdate(const std::vector<std::string>& targetList, const OrderBookEntry& update, unsigned int seqNum);
     static void s_sendCandlestickData(const std::vector<std::string>& targetList, const CandlestickDataPoint& cdPoint);
 
     static void s_sendConfirmationReport(const ExecutionReport& report);
@@ -90,4 +92,6 @@ private:
     std::unique_ptr<FIX::LogFactory> m_logFactoryPtr;
     std::unique_ptr<FIX::MessageStoreFactory> m_messageStoreFactoryPtr;
     std::unique_ptr<FIX::Acceptor> m_acceptorPtr;
+
+    FIXBroadcaster m_broadcaster { ::FIX_BROADCAST_NUM_WRITERS }; // destroyed first: its writers send through the acceptor's sessions
 };
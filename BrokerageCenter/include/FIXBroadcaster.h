@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <quickfix/Message.h>
+
+/**
+ * @brief Sends the same FIX message to many targets (e.g. order book and candlestick data subscribers) on a fixed pool of writer threads.
+ *        The message is shared by all its targets, and each writer copies it once for the targets it serves.
+ *        QuickFIX sessions own the sequence numbers and the message store, so that bytes cannot be shared between sessions:
+ *        every send still sets the header fields of its session, and concatenates the (already encoded) fields of the message.
+ *        Targets are sharded onto the writers by target ID, therefore the messages of a target are sent in the order they were broadcast.
+ */
+class FIXBroadcaster {
+public:
+    explicit FIXBroadcaster(unsigned int numWriters); // 0 means one writer per CPU core
+    ~FIXBroadcaster();
+
+    FIXBroadcaster(const FIXBroadcaster&) = delete; // forbid copying
+    auto operator=(const FIXBroadcaster&) -> FIXBroadcaster& = delete; // forbid assigning
+
+    void broadcast(const std::vector<std::string>& targetList, FIX::Message&& message);
+
+private:
+    struct Job {
+        std::shared_ptr<const FIX::Message> message;
+        std::vector<std::string> targetIDs; // the targets served by this writer
+    };
+
+    struct Writer {
+        std::mutex mtxJobs;
+        std::condition_variable cvJobs;
+        std::vector<Job> jobs;
+        std::promise<void> quitFlag;
+        std::thread thread;
+    };
+
+    auto getWriterIndex(const std::string& targetID) const -> unsigned int;
+    void processJobs(Writer* writer);
+
+    std::vector<std::unique_ptr<Writer>> m_writers;
+};
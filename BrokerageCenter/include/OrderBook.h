@@ -8,9 +8,9 @@
 #include <map>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <string>
 #include <thread>
+#include <vector>
 
 /**
 *  @brief Class that asynchronosly receives and/or broadcasts order books for a specific stock.
@@ -29,15 +29,14 @@ public:
     void onUnsubscribeOrderBook(const std::string& targetID);
 
     void broadcastWholeOrderBookToOne(const std::string& targetID);
-    void broadcastWholeOrderBookToAll();
-    void broadcastSingleUpdateToAll(const OrderBookEntry& update);
+    void broadcastSingleUpdateToAll(const OrderBookEntry& update, unsigned int seqNum);
 
-    void saveGlobalBidOrderBookUpdate(const OrderBookEntry& update);
-    void saveGlobalAskOrderBookUpdate(const OrderBookEntry& update);
+    void saveGlobalBidOrderBookUpdateNoLock(const OrderBookEntry& update);
+    void saveGlobalAskOrderBookUpdateNoLock(const OrderBookEntry& update);
 
-    static void s_saveLocalOrderBookUpdate(const OrderBookEntry& update, std::mutex& mtxLocalOrderBookk, std::map<double, std::map<std::string, OrderBookEntry>>& localOrderBook);
-    void saveLocalBidOrderBookUpdate(const OrderBookEntry& update);
-    void saveLocalAskOrderBookUpdate(const OrderBookEntry& update);
+    static void s_saveLocalOrderBookUpdateNoLock(const OrderBookEntry& update, std::map<double, std::map<std::string, OrderBookEntry>>& localOrderBook);
+    void saveLocalBidOrderBookUpdateNoLock(const OrderBookEntry& update);
+    void saveLocalAskOrderBookUpdateNoLock(const OrderBookEntry& update);
 
     auto getGlobalBidOrderBookFirstPrice() const -> double;
     auto getGlobalAskOrderBookFirstPrice() const -> double;
@@ -45,6 +44,10 @@ public:
     auto getLocalAskOrderBookFirstPrice() const -> double;
 
 private:
+    auto lockOrderBook(OrderBookEntry::Type type) const -> std::unique_lock<std::mutex>;
+    auto saveOrderBookUpdateNoLock(const OrderBookEntry& update) -> unsigned int;
+    void sendWholeOrderBookNoLock(const std::vector<std::string>& targetList) const;
+
     std::string m_symbol; ///> The stock name of this OrderBook instance.
 
     mutable std::mutex m_mtxOBEBuff; ///> Mutex for m_obeBuff.
@@ -62,5 +65,11 @@ private:
     std::map<double, std::map<std::string, OrderBookEntry>> m_localBidOrderBook;
     std::map<double, std::map<std::string, OrderBookEntry>> m_localAskOrderBook;
 
-    std::queue<OrderBookEntry> m_obeBuff;
+    // sequence number of the last update of each order book, sent with the updates and the snapshots so that clients can detect gaps
+    unsigned int m_globalBidSeqNum;
+    unsigned int m_globalAskSeqNum;
+    unsigned int m_localBidSeqNum;
+    unsigned int m_localAskSeqNum;
+
+    std::vector<OrderBookEntry> m_obeBuff; // pending updates, taken all at once by process()
 };
@@ -1,13 +1,21 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
 
 using namespace std::chrono_literals;
 
-static constexpr auto BROADCAST_ORDERBOOK_PERIOD = 1min;
-
 static constexpr auto DEFAULT_BUYING_POWER = 1.e6; // 1,000,000.00
 
+static constexpr auto DEFAULT_TRADING_RECORDS_FLUSH_INTERVAL = 100ms; // trading records are committed at most this long after being queued (in BATCHED durability mode)
+
+static constexpr unsigned int FIX_BROADCAST_NUM_WRITERS = 0; // threads sending order book and candlestick data to clients; 0 means one per CPU core
+
 static constexpr auto FIX_SESSION_DURATION = 12 * 60 * 60; // 12 hours
 
 static constexpr unsigned int NUM_SECONDS_PER_CANDLESTICK = 5;
+
+static constexpr unsigned int RISK_MANAGEMENT_NUM_WORKERS = 0; // threads running the risk management of all users; 0 means one per CPU core
+static constexpr int RISK_MANAGEMENT_BATCH_SIZE = 16; // messages of one user processed before its worker moves on to the next user
+
+static constexpr std::size_t TRADING_RECORDS_QUEUE_CAPACITY = 1 << 16; // trading records waiting to be written; when full, queuing blocks
@@ -4,14 +4,12 @@
 #include "Order.h"
 #include "PortfolioItem.h"
 #include "PortfolioSummary.h"
+#include "RiskManagementScheduler.h"
 
-#include <condition_variable>
-#include <future>
-#include <memory>
+#include <atomic>
 #include <mutex>
 #include <queue>
 #include <string>
-#include <thread>
 #include <unordered_map>
 #include <utility>
 
@@ -25,7 +23,8 @@ public:
     RiskManagement(const std::string& userID, double buyingPower, double holdingBalance, double borrowedBalance, double totalPL, int totalShares); //> For parametric use, i.e. to explicitly configurate the initial portfolio summary.
     ~RiskManagement();
 
-    void spawn();
+    /* @brief Start processing orders and execution reports on a worker of the scheduler, which must outlive this object. */
+    void attachToScheduler(RiskManagementScheduler& scheduler);
 
     static auto s_getMarketBuyPrice(const std::string& symbol) -> double;
     static auto s_getMarketSellPrice(const std::string& symbol) -> double;
@@ -36,23 +35,27 @@ public:
     void sendWaitingList() const;
 
     void enqueueOrder(Order&& order);
-    void processOrder();
+    auto processNextOrder() -> bool; // false if there was no order to process
     void enqueueExecRpt(ExecutionReport&& report);
-    void processExecRpt();
+    auto processNextExecRpt() -> bool; // false if there was no execution report to process
+    auto hasPendingMessages() const -> bool;
 
     auto verifyAndSendOrder(const Order& order) -> bool;
 
 private:
+    friend class RiskManagementScheduler;
+
+    void scheduleIfIdle();
+    void releaseRejectedOrder(const ExecutionReport& report);
+
     std::string m_userID;
 
     mutable std::mutex m_mtxOrder;
     mutable std::mutex m_mtxExecRpt;
 
-    std::unique_ptr<std::thread> m_orderThread;
-    std::unique_ptr<std::thread> m_execRptThread;
-    std::condition_variable m_cvOrder, m_cvExecRpt;
-    std::promise<void> m_quitFlagOrder;
-    std::promise<void> m_quitFlagExec;
+    RiskManagementScheduler* m_scheduler;
+    unsigned int m_workerIndex;
+    std::atomic<bool> m_isScheduled; // in the run-queue of its worker, or being processed
 
     std::queue<Order> m_orderBuffer;
     std::queue<ExecutionReport> m_execRptBuffer;
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class RiskManagement;
+
+/**
+ * @brief Runs the risk management of all users on a fixed pool of worker threads, instead of two threads per user.
+ *        Users are sharded onto the workers by user ID. Each worker owns a run-queue of the users having pending orders or
+ *        execution reports (their "mailboxes"), and a user is in at most one run-queue at a time, therefore all orders and
+ *        execution reports of a user are serialized: they are never processed concurrently.
+ *        Orders are processed in the order they arrived, and so are execution reports, but there is no ordering between the two queues:
+ *        each step of a turn processes the next execution report (if any), then the next order (if any).
+ */
+class RiskManagementScheduler {
+public:
+    explicit RiskManagementScheduler(unsigned int numWorkers); // 0 means one worker per CPU core
+    ~RiskManagementScheduler();
+
+    RiskManagementScheduler(const RiskManagementScheduler&) = delete; // forbid copying
+    auto operator=(const RiskManagementScheduler&) -> RiskManagementScheduler& = delete; // forbid assigning
+
+    auto getNumWorkers() const -> unsigned int;
+    auto getWorkerIndex(const std::string& userID) const -> unsigned int;
+
+    /* @brief Put a user in the run-queue of its worker; the caller must have flagged the user as scheduled. */
+    void schedule(RiskManagement* riskManagement);
+
+    /* @brief Take a user out of the run-queue of its worker, waiting until the worker is done with it if it is being processed. */
+    void unschedule(RiskManagement* riskManagement);
+
+private:
+    struct Worker {
+        std::mutex mtxRunQueue;
+        std::condition_variable cvRunQueue;
+        std::condition_variable cvDone; // a user was processed
+        std::deque<RiskManagement*> runQueue;
+        RiskManagement* running = nullptr; // user being processed
+        std::promise<void> quitFlag;
+        std::thread thread;
+    };
+
+    void processRunQueue(Worker* worker);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+};
@@ -142,6 +142,22 @@ auto BCDocuments::manageSubscriptionInOrderBook(bool isSubscribe, const std::str
     return true;
 }
 
+/**
+ * @brief Send again the order book snapshots of a symbol to a subscriber, e.g. after it detected a gap in the updates.
+ */
+auto BCDocuments::sendOrderBookSnapshot(const std::string& symbol, const std::string& targetID) -> bool
+{
+    assert(s_isSecurityListReady);
+
+    auto pos = m_orderBookBySymbol.find(symbol);
+    if (m_orderBookBySymbol.end() == pos) {
+        return false; // unknown RIC
+    }
+
+    pos->second->broadcastWholeOrderBookToOne(targetID);
+    return true;
+}
+
 auto BCDocuments::manageSubscriptionInCandlestickData(bool isSubscribe, const std::string& symbol, const std::string& targetID) -> bool
 {
     assert(s_isSecurityListReady);
@@ -244,13 +260,6 @@ void BCDocuments::onNewExecutionReportForUserRiskManagement(const std::string& u
     m_riskManagementByUserID[userID]->enqueueExecRpt(std::move(report));
 }
 
-void BCDocuments::broadcastOrderBooks() const
-{
-    for (const auto& kv : m_orderBookBySymbol) {
-        kv.second->broadcastWholeOrderBookToAll();
-    }
-}
-
 auto BCDocuments::addRiskManagementToUserNoLock(const std::string& userID) -> std::unordered_map<std::string, std::unique_ptr<RiskManagement>>::iterator
 {
     auto res = m_riskManagementByUserID.emplace(userID, nullptr);
@@ -292,7 +301,7 @@ auto BCDocuments::addRiskManagementToUserNoLock(const std::string& userID) -> st
         rmPtr->insertPortfolioItem(item[0], { item[0], std::stod(item[1]), std::stod(item[2]), std::stod(item[3]), std::stod(item[4]), std::stoi(item[5]), std::stoi(item[6]) });
     }
 
-    rmPtr->spawn();
+    rmPtr->attachToScheduler(m_riskManagementScheduler);
 
     return res.first;
 }
@@ -2,8 +2,12 @@
 
 #include "BCDocuments.h"
 
-#include <sstream>
+#include <array>
+#include <cstdio>
+#include <ctime>
+#include <iterator>
 
+#include <shift/miscutils/concurrency/Consumer.h>
 #include <shift/miscutils/crossguid/Guid.h>
 #include <shift/miscutils/crypto/Decryptor.h>
 #include <shift/miscutils/database/Common.h>
@@ -13,9 +17,21 @@
 
 /* static */ bool DBConnector::s_isPortfolioDBReadOnly = false;
 /* static */ const std::string DBConnector::s_sessionID = shift::crossguid::newGuid().str();
+/* static */ DBConnector::RECORDS_DURABILITY DBConnector::s_tradingRecordsDurability = DBConnector::RECORDS_DURABILITY::BATCHED;
+/* static */ std::chrono::milliseconds DBConnector::s_tradingRecordsFlushInterval = ::DEFAULT_TRADING_RECORDS_FLUSH_INTERVAL;
+
+static constexpr char s_insertTradingRecordStmt[] = "insert_trading_record";
+static constexpr int s_numTradingRecordCols = 16;
 
 DBConnector::DBConnector()
     : m_pConn(nullptr)
+    , m_pRecordsConn(nullptr)
+    , m_isRecordsWriterRunning(false)
+    , m_numRecordsQueued(0)
+    , m_numRecordsProcessed(0)
+    , m_numRecordsFailed(0)
+    , m_lastFlushLag(0)
+    , m_lastFlushDuration(0)
 {
     cout << "\nSession ID: " << s_sessionID << '\n'
          << endl;
@@ -23,6 +39,7 @@ DBConnector::DBConnector()
 
 DBConnector::~DBConnector()
 {
+    stopTradingRecordsWriter();
     disconnectDB();
 }
 
@@ -55,11 +72,8 @@ auto DBConnector::connectDB() -> bool
 {
     disconnectDB();
 
-    std::string info = "hostaddr=" + m_loginInfo["DBHost"] + " port=" + m_loginInfo["DBPort"] + " dbname=" + m_loginInfo["DBName"] + " user=" + m_loginInfo["DBUser"] + " password=" + m_loginInfo["DBPassword"];
-    m_pConn = PQconnectdb(info.c_str());
-    if (PQstatus(m_pConn) != CONNECTION_OK) {
-        disconnectDB();
-        cout << COLOR_ERROR "ERROR: Connection to database failed.\n" NO_COLOR;
+    m_pConn = createConnection();
+    if (nullptr == m_pConn) {
         return false;
     }
 
@@ -82,6 +96,28 @@ void DBConnector::disconnectDB()
     m_pConn = nullptr;
 }
 
+/**
+ * @brief Open a new connection to database, with the login information given to init().
+ * @return The connection, or nullptr if it failed.
+ */
+auto DBConnector::createConnection() const -> PGconn*
+{
+    const auto getInfo = [this](const char* key) -> std::string {
+        const auto it = m_loginInfo.find(key);
+        return (it == m_loginInfo.end()) ? "" : it->second;
+    };
+
+    std::string info = "hostaddr=" + getInfo("DBHost") + " port=" + getInfo("DBPort") + " dbname=" + getInfo("DBName") + " user=" + getInfo("DBUser") + " password=" + getInfo("DBPassword");
+    PGconn* pConn = PQconnectdb(info.c_str());
+    if (PQstatus(pConn) != CONNECTION_OK) {
+        PQfinish(pConn);
+        cout << COLOR_ERROR "ERROR: Connection to database failed.\n" NO_COLOR;
+        return nullptr;
+    }
+
+    return pConn;
+}
+
 auto DBConnector::doQuery(std::string query, std::string msgIfStatMismatch, ExecStatusType statToMatch /* = PGRES_COMMAND_OK */, PGresult** ppRes /* = nullptr */) -> bool
 {
     return shift::database::doQuery(m_pConn, std::move(query), std::move(msgIfStatMismatch), statToMatch, ppRes);
@@ -92,49 +128,283 @@ auto DBConnector::doQuery(std::string query, std::string msgIfStatMismatch, Exec
  */
 static auto s_utcToString(const FIX::UtcTimeStamp& ts, bool localTime) -> std::string
 {
-    std::ostringstream os;
-
-    time_t t = ts.getTimeT();
+    const time_t t = ts.getTimeT();
+    std::tm tm {};
     if (localTime) {
-        os << std::put_time(std::localtime(&t), "%Y-%m-%d %H:%M:%S");
+        localtime_r(&t, &tm);
     } else {
-        os << std::put_time(std::gmtime(&t), "%Y-%m-%d %H:%M:%S");
-    }
-
-    os << '.';
-
-    std::string fraction = std::to_string(ts.getFraction(6));
-    os << std::string(6 - fraction.length(), '0') + fraction; // microseconds with "0" padding
-
-    return os.str();
-}
-
-auto DBConnector::insertTradingRecord(const TradingRecord& trade) -> bool
-{
-    std::ostringstream queryStrm;
-    queryStrm << "INSERT INTO " << shift::database::PSQLTable<shift::database::TradingRecords>::name << " VALUES ('"
-              << s_sessionID << "','"
-              << s_utcToString(trade.realTime, true) << "','"
-              << s_utcToString(trade.executionTime, true) << "','"
-              << trade.symbol << "','"
-              << trade.price << "','"
-              << trade.size << "','"
-              << trade.traderID1 << "','"
-              << trade.traderID2 << "','"
-              << trade.orderID1 << "','"
-              << trade.orderID2 << "','"
-              << static_cast<char>(trade.orderType1) << "','"
-              << static_cast<char>(trade.orderType2) << "','"
-              << s_utcToString(trade.simulationTime1, true) << "','"
-              << s_utcToString(trade.simulationTime2, true) << "','"
-              << trade.decision << "','"
-              << trade.destination << "');";
-
-    auto lock { lockPSQL() };
-    if (!doQuery(queryStrm.str(), COLOR_ERROR "ERROR: Insert into [" + std::string(shift::database::PSQLTable<shift::database::TradingRecords>::name) + "] failed with query:\n" NO_COLOR)) {
-        cout << COLOR_WARNING << queryStrm.str() << NO_COLOR << '\n'
-             << endl;
+        gmtime_r(&t, &tm);
+    }
+
+    char buffer[32];
+    const auto len = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+    std::snprintf(buffer + len, sizeof(buffer) - len, ".%06d", ts.getFraction(6)); // microseconds with "0" padding
+
+    return buffer;
+}
+
+/**
+ * @brief Column values of one trading record, in the order of the columns of PSQLTable<TradingRecords>.
+ */
+static auto s_tradingRecordValues(const TradingRecord& trade) -> std::array<std::string, s_numTradingRecordCols>
+{
+    char price[32];
+    std::snprintf(price, sizeof(price), "%g", trade.price);
+
+    return {
+        DBConnector::s_sessionID,
+        s_utcToString(trade.realTime, true),
+        s_utcToString(trade.executionTime, true),
+        trade.symbol,
+        price,
+        std::to_string(trade.size),
+        trade.traderID1,
+        trade.traderID2,
+        trade.orderID1,
+        trade.orderID2,
+        std::string(1, static_cast<char>(trade.orderType1)),
+        std::string(1, static_cast<char>(trade.orderType2)),
+        s_utcToString(trade.simulationTime1, true),
+        s_utcToString(trade.simulationTime2, true),
+        std::string(1, trade.decision),
+        trade.destination,
+    };
+}
+
+/**
+ * @brief Append one row of values in PostgreSQL's COPY text format.
+ */
+static void s_appendCopyRow(std::string* pCopyData, const std::array<std::string, s_numTradingRecordCols>& values)
+{
+    for (const auto& value : values) {
+        for (const auto c : value) {
+            switch (c) {
+            case '\\':
+                *pCopyData += "\\\\";
+                break;
+            case '\t':
+                *pCopyData += "\\t";
+                break;
+            case '\n':
+                *pCopyData += "\\n";
+                break;
+            case '\r':
+                *pCopyData += "\\r";
+                break;
+            default:
+                *pCopyData += c;
+                break;
+            }
+        }
+        *pCopyData += '\t';
+    }
+
+    pCopyData->back() = '\n';
+}
+
+/**
+ * @brief Start the thread writing the trading records, on its own connection to database.
+ */
+auto DBConnector::startTradingRecordsWriter() -> bool
+{
+    if (m_recordsWriter.joinable()) {
+        return true;
+    }
+
+    m_pRecordsConn = createConnection();
+    if (nullptr == m_pRecordsConn || !prepareTradingRecordsConn()) {
+        cout << COLOR_ERROR "ERROR: The trading records writer could not be started.\n" NO_COLOR;
+        PQfinish(m_pRecordsConn);
+        m_pRecordsConn = nullptr;
         return false;
     }
+
+    {
+        std::lock_guard<std::mutex> guard(m_mtxRecordsQueue);
+        m_isRecordsWriterRunning = true;
+        m_numRecordsQueued = m_recordsQueue.size(); // records queued before the writer started
+        m_numRecordsProcessed = 0;
+        m_numRecordsFailed = 0;
+        m_recordsWriterStartTime = std::chrono::steady_clock::now();
+    }
+
+    m_quitRecordsWriter = std::promise<void>();
+    m_recordsWriter = std::thread(&DBConnector::processTradingRecords, this);
     return true;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Stop the thread writing the trading records, after it wrote all the records still queued.
+ */
+void DBConnector::stopTradingRecordsWriter()
+{
+    if (!m_recordsWriter.joinable()) {
+        return;
+    }
+
+    shift::concurrency::notifyConsumerThreadToQuit(m_quitRecordsWriter, m_cvRecordsQueue, m_recordsWriter);
+
+    {
+        std::lock_guard<std::mutex> guard(m_mtxRecordsQueue);
+        m_isRecordsWriterRunning = false;
+    }
+    m_cvRecordsProcessed.notify_all(); // nobody shall keep waiting for the writer
+
+    PQfinish(m_pRecordsConn);
+    m_pRecordsConn = nullptr;
+}
+
+/**
+ * @brief Prepare the statement used to write trading records one by one, when writing them all at once failed.
+ */
+auto DBConnector::prepareTradingRecordsConn() -> bool
+{
+    std::string query = "INSERT INTO " + std::string(shift::database::PSQLTable<shift::database::TradingRecords>::name) + " VALUES (";
+    for (int i = 1; i <= s_numTradingRecordCols; ++i) {
+        query += '$' + std::to_string(i) + (i < s_numTradingRecordCols ? ", " : ");");
+    }
+
+    PGresult* pRes = PQprepare(m_pRecordsConn, s_insertTradingRecordStmt, query.c_str(), s_numTradingRecordCols, nullptr);
+    const bool isPrepared = (PQresultStatus(pRes) == PGRES_COMMAND_OK);
+    PQclear(pRes);
+
+    return isPrepared;
+}
+
+void DBConnector::enqueueTradingRecord(TradingRecord record)
+{
+    std::unique_lock<std::mutex> lock(m_mtxRecordsQueue);
+    m_cvRecordsProcessed.wait(lock, [this] { return m_recordsQueue.size() < ::TRADING_RECORDS_QUEUE_CAPACITY || !m_isRecordsWriterRunning; });
+
+    m_recordsQueue.push_back({ std::move(record), std::chrono::steady_clock::now() });
+    const auto recordNum = ++m_numRecordsQueued;
+
+    // the writer only needs to know about the first record of a batch, and about an almost full queue
+    if (1 == m_recordsQueue.size() || ::TRADING_RECORDS_QUEUE_CAPACITY / 2 == m_recordsQueue.size()) {
+        m_cvRecordsQueue.notify_one();
+    }
+
+    if (RECORDS_DURABILITY::SYNCHRONOUS == s_tradingRecordsDurability) {
+        m_cvRecordsProcessed.wait(lock, [this, recordNum] { return m_numRecordsProcessed >= recordNum || !m_isRecordsWriterRunning; });
+    }
+}
+
+auto DBConnector::getTradingRecordsStats() const -> TradingRecordsStats
+{
+    std::lock_guard<std::mutex> guard(m_mtxRecordsQueue);
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_recordsWriterStartTime;
+    const auto numWritten = m_numRecordsProcessed - m_numRecordsFailed;
+
+    return {
+        m_numRecordsQueued,
+        numWritten,
+        m_numRecordsFailed,
+        m_recordsQueue.size(),
+        (m_isRecordsWriterRunning && elapsed.count() > 0) ? numWritten / elapsed.count() : 0.0,
+        m_lastFlushLag,
+        m_lastFlushDuration,
+    };
+}
+
+/**
+ * @brief Function to write the queued trading records in batches, for trading records writer thread.
+ *        When quitting, it first writes all the records still queued.
+ */
+void DBConnector::processTradingRecords()
+{
+    auto quitFut = m_quitRecordsWriter.get_future();
+    std::vector<QueuedTradingRecord> batch;
+
+    while (true) {
+        std::unique_lock<std::mutex> lock(m_mtxRecordsQueue);
+        const bool isQuitting = shift::concurrency::quitOrContinueConsumerThread(quitFut, m_cvRecordsQueue, lock, [this] { return !m_recordsQueue.empty(); });
+        if (isQuitting && m_recordsQueue.empty()) {
+            return;
+        }
+
+        if (!isQuitting && RECORDS_DURABILITY::BATCHED == s_tradingRecordsDurability) {
+            // let the batch grow, but do not keep its oldest record waiting longer than the flush interval
+            m_cvRecordsQueue.wait_until(lock, m_recordsQueue.front().queuedTime + s_tradingRecordsFlushInterval, [this, &quitFut] {
+                return m_recordsQueue.size() >= ::TRADING_RECORDS_QUEUE_CAPACITY / 2 || quitFut.wait_for(0ms) == std::future_status::ready;
+            });
+        }
+
+        batch.assign(std::make_move_iterator(m_recordsQueue.begin()), std::make_move_iterator(m_recordsQueue.end()));
+        m_recordsQueue.clear();
+        lock.unlock();
+
+        const auto flushBegin = std::chrono::steady_clock::now();
+        const auto numFailed = writeTradingRecords(batch);
+        const auto flushEnd = std::chrono::steady_clock::now();
+
+        lock.lock();
+        m_numRecordsProcessed += batch.size();
+        m_numRecordsFailed += numFailed;
+        m_lastFlushLag = std::chrono::duration_cast<std::chrono::microseconds>(flushEnd - batch.front().queuedTime);
+        m_lastFlushDuration = std::chrono::duration_cast<std::chrono::microseconds>(flushEnd - flushBegin);
+        lock.unlock();
+        m_cvRecordsProcessed.notify_all();
+
+        batch.clear();
+    }
+}
+
+/**
+ * @brief Insert a batch of trade history into the table used to save the trading records, through COPY.
+ *        A failed COPY inserts nothing (e.g. because of one duplicate record), therefore the records are then inserted one by one,
+ *        so that only the faulty ones are lost.
+ * @return The number of records that could not be inserted.
+ */
+auto DBConnector::writeTradingRecords(const std::vector<QueuedTradingRecord>& records) -> std::uint64_t
+{
+    const std::string tableName = shift::database::PSQLTable<shift::database::TradingRecords>::name;
+
+    std::vector<std::array<std::string, s_numTradingRecordCols>> rows;
+    rows.reserve(records.size());
+    std::string copyData;
+    for (const auto& queued : records) {
+        rows.push_back(s_tradingRecordValues(queued.record));
+        s_appendCopyRow(&copyData, rows.back());
+    }
+
+    if (shift::database::doQuery(m_pRecordsConn, "COPY " + tableName + " FROM STDIN", COLOR_ERROR "ERROR: COPY into [" + tableName + "] failed.\n" NO_COLOR, PGRES_COPY_IN)) {
+        bool isSuccess = (PQputCopyData(m_pRecordsConn, copyData.data(), static_cast<int>(copyData.size())) == 1);
+        isSuccess &= (PQputCopyEnd(m_pRecordsConn, isSuccess ? nullptr : "sending COPY data failed") == 1);
+        while (PGresult* pRes = PQgetResult(m_pRecordsConn)) {
+            isSuccess &= (PQresultStatus(pRes) == PGRES_COMMAND_OK);
+            PQclear(pRes);
+        }
+
+        if (isSuccess) {
+            return 0;
+        }
+    }
+
+    if (PQstatus(m_pRecordsConn) != CONNECTION_OK) {
+        PQreset(m_pRecordsConn);
+        if (PQstatus(m_pRecordsConn) != CONNECTION_OK || !prepareTradingRecordsConn()) {
+            cout << COLOR_ERROR "ERROR: Connection to database lost: " << records.size() << " trading records were not saved.\n" NO_COLOR;
+            return records.size();
+        }
+    }
+
+    std::uint64_t numFailed = 0;
+    for (const auto& values : rows) {
+        std::array<const char*, s_numTradingRecordCols> params;
+        for (int i = 0; i < s_numTradingRecordCols; ++i) {
+            params[i] = values[i].c_str();
+        }
+
+        PGresult* pRes = PQexecPrepared(m_pRecordsConn, s_insertTradingRecordStmt, s_numTradingRecordCols, params.data(), nullptr, nullptr, 0);
+        if (PQresultStatus(pRes) != PGRES_COMMAND_OK) {
+            ++numFailed;
+            cout << COLOR_ERROR "ERROR: Insert into [" << tableName << "] failed: " << PQresultErrorMessage(pRes) << NO_COLOR
+                 << COLOR_WARNING "(order IDs: " << values[8] << ", " << values[9] << ")" NO_COLOR << '\n'
+                 << endl;
+        }
+        PQclear(pRes);
+    }
+
+    return numFailed;
+}
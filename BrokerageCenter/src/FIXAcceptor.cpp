@@ -4,8 +4,6 @@
 #include "DBConnector.h"
 #include "Parameters.h"
 
-#include <atomic>
-#include <cassert>
 
 #include <quickfix/FieldConvertors.h>
 #include <quickfix/FieldTypes.h>
@@ -15,6 +13,7 @@
 #include <shift/miscutils/crypto/Decryptor.h>
 #include <shift/miscutils/database/Common.h>
 #include <shift/miscutils/fix/HelperFunctions.h>
+#include <shift/miscutils/fix/ThreadLocalFields.h>
 #include <shift/miscutils/terminal/Common.h>
 
 /* static */ std::string FIXAcceptor::s_senderID;
@@ -175,10 +174,7 @@ void FIXAcceptor::disconnectClients()
     message.setField(FIX::TransactTime(transac.simulationTime, 6)); // TODO: use simulationTime (execTime) and realTime (serverTime) everywhere
     message.setField(FIX::LastMkt(transac.destination));
 
-    for (const auto& targetID : BCDocuments::getInstance().getTargetList()) {
-        header.setField(FIX::TargetCompID(targetID));
-        FIX::Session::sendToTarget(message);
-    }
+    getInstance().m_broadcaster.broadcast(BCDocuments::getInstance().getTargetList(), std::move(message));
 }
 
 static inline void s_addGroupToOrderBookMsg(FIX::Message& message, const OrderBookEntry& entry)
@@ -193,9 +189,10 @@ static inline void s_addGroupToOrderBookMsg(FIX::Message& message, const OrderBo
 }
 
 /**
- * @brief Send complete order book by type
+ * @brief Send complete order book by type, with the sequence number of its last update.
+ *        An empty order book is sent as a single entry with price 0.0, as in the updates clearing an order book.
  */
-/* static */ void FIXAcceptor::s_sendOrderBook(const std::vector<std::string>& targetList, const std::map<double, std::map<std::string, OrderBookEntry>>& orderBook)
+/* static */ void FIXAcceptor::s_sendOrderBook(const std::vector<std::string>& targetList, const std::string& symbol, OrderBookEntry::Type type, const std::map<double, std::map<std::string, OrderBookEntry>>& orderBook, unsigned int seqNum)
 {
     FIX::Message message;
 
@@ -204,11 +201,12 @@ static inline void s_addGroupToOrderBookMsg(FIX::Message& message, const OrderBo
     header.setField(FIX::SenderCompID(s_senderID));
     header.setField(FIX::MsgType(FIX::MsgType_MarketDataSnapshotFullRefresh));
 
-    message.setField(FIX::Symbol(orderBook.begin()->second.begin()->second.getSymbol()));
-
-    const auto obt = orderBook.begin()->second.begin()->second.getType();
+    message.setField(FIX::Symbol(symbol));
+    message.setField(FIX::RptSeq(seqNum));
 
-    if (obt == OrderBookEntry::Type::GLB_BID || obt == OrderBookEntry::Type::LOC_BID) { // reverse the global/local bid order book order
+    if (orderBook.empty()) {
+        ::s_addGroupToOrderBookMsg(message, { type, symbol, 0.0, 0, "", FIX::UtcDateOnly(), FIX::UtcTimeOnly() });
+    } else if (type == OrderBookEntry::Type::GLB_BID || type == OrderBookEntry::Type::LOC_BID) { // reverse the global/local bid order book order
         for (auto ri = orderBook.crbegin(); ri != orderBook.crend(); ++ri) {
             for (const auto& j : ri->second) {
                 ::s_addGroupToOrderBookMsg(message, j.second);
@@ -222,16 +220,13 @@ static inline void s_addGroupToOrderBookMsg(FIX::Message& message, const OrderBo
         }
     }
 
-    for (const auto& targetID : targetList) {
-        header.setField(FIX::TargetCompID(targetID));
-        FIX::Session::sendToTarget(message);
-    }
+    getInstance().m_broadcaster.broadcast(targetList, std::move(message));
 }
 
 /**
- * @brief   Send order book update to one client
+ * @brief   Send order book update to one client, with its sequence number in its order book
  */
-/* static */ void FIXAcceptor::s_sendOrderBookUpdate(const std::vector<std::string>& targetList, const OrderBookEntry& update)
+/* static */ void FIXAcceptor::s_sendOrderBookUpdate(const std::vector<std::string>& targetList, const OrderBookEntry& update, unsigned int seqNum)
 {
     FIX::Message message;
 
@@ -248,12 +243,10 @@ static inline void s_addGroupToOrderBookMsg(FIX::Message& message, const OrderBo
         FIX::MDEntrySize(update.getSize()),
         FIX::MDEntryDate(update.getDate()),
         FIX::MDEntryTime(update.getTime()),
-        FIX::MDMkt(update.getDestination()));
+        FIX::MDMkt(update.getDestination()),
+        FIX::RptSeq(seqNum));
 
-    for (const auto& targetID : targetList) {
-        header.setField(FIX::TargetCompID(targetID));
-        FIX::Session::sendToTarget(message);
-    }
+    getInstance().m_broadcaster.broadcast(targetList, std::move(message));
 }
 
 /* static */ void FIXAcceptor::s_sendCandlestickData(const std::vector<std::string>& targetList, const CandlestickDataPoint& cdPoint)
@@ -272,10 +265,7 @@ static inline void s_addGroupToOrderBookMsg(FIX::Message& message, const OrderBo
     message.setField(FIX::TransactTime(FIX::UtcTimeStamp(cdPoint.getTimeFrom()), 6)); // no need for timestamp
     message.setField(FIX::FirstPx(cdPoint.getOpenPrice())); // Open price
 
-    for (const auto& targetID : targetList) {
-        header.setField(FIX::TargetCompID(targetID));
-        FIX::Session::sendToTarget(message);
-    }
+    getInstance().m_broadcaster.broadcast(targetList, std::move(message));
 }
 
 /**
@@ -608,51 +598,19 @@ void FIXAcceptor::onMessage(const FIX50SP2::MarketDataRequest& message, const FI
         return;
     }
 
-    static FIX::SubscriptionRequestType isSubscribed;
-
-    static FIX50SP2::MarketDataRequest::NoRelatedSym relatedSymGroup;
-    static FIX::Symbol symbol;
-
-    // #pragma GCC diagnostic ignored ....
-
-    FIX::SubscriptionRequestType* pIsSubscribed = nullptr;
-
-    FIX50SP2::MarketDataRequest::NoRelatedSym* pRelatedSymGroup = nullptr;
-    FIX::Symbol* pSymbol = nullptr;
-
-    static std::atomic<unsigned int> s_cntAtom { 0 };
-    unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-    while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-    }
-
-    assert(s_cntAtom > 0);
-
-    if (0 == prevCnt) { // sequential case; optimized:
-        pIsSubscribed = &isSubscribed;
-        pRelatedSymGroup = &relatedSymGroup;
-        pSymbol = &symbol;
-    } else { // > 1 threads; always safe way:
-        pIsSubscribed = new decltype(isSubscribed);
-        pRelatedSymGroup = new decltype(relatedSymGroup);
-        pSymbol = new decltype(symbol);
-    }
-
-    message.getField(*pIsSubscribed);
+    auto& [requestType, relatedSymGroup, symbol] = shift::fix::getThreadLocalFields<FIX50SP2::MarketDataRequest, FIX::SubscriptionRequestType, FIX50SP2::MarketDataRequest::NoRelatedSym, FIX::Symbol>();
 
-    message.getGroup(1, *pRelatedSymGroup);
-    pRelatedSymGroup->getField(*pSymbol);
+    message.getField(requestType);
 
-    BCDocuments::getInstance().manageSubscriptionInOrderBook('1' == pIsSubscribed->getValue(), pSymbol->getValue(), sessionID.getTargetCompID().getValue());
+    message.getGroup(1, relatedSymGroup);
+    relatedSymGroup.getField(symbol);
 
-    if (0 != prevCnt) { // > 1 threads
-        delete pIsSubscribed;
-        delete pRelatedSymGroup;
-        delete pSymbol;
+    if (FIX::SubscriptionRequestType_SNAPSHOT == requestType.getValue()) { // a subscriber detected a gap in the updates
+        BCDocuments::getInstance().sendOrderBookSnapshot(symbol.getValue(), sessionID.getTargetCompID().getValue());
+        return;
     }
 
-    s_cntAtom--;
-    assert(s_cntAtom >= 0);
+    BCDocuments::getInstance().manageSubscriptionInOrderBook(FIX::SubscriptionRequestType_SNAPSHOT_PLUS_UPDATES == requestType.getValue(), symbol.getValue(), sessionID.getTargetCompID().getValue());
 }
 
 /*
@@ -667,51 +625,14 @@ void FIXAcceptor::onMessage(const FIX50SP2::RFQRequest& message, const FIX::Sess
         return;
     }
 
-    static FIX::SubscriptionRequestType isSubscribed;
-
-    static FIX50SP2::MarketDataRequest::NoRelatedSym relatedSymGroup;
-    static FIX::Symbol symbol;
-
-    // #pragma GCC diagnostic ignored ....
-
-    FIX::SubscriptionRequestType* pIsSubscribed = nullptr;
+    auto& [isSubscribed, relatedSymGroup, symbol] = shift::fix::getThreadLocalFields<FIX50SP2::RFQRequest, FIX::SubscriptionRequestType, FIX50SP2::MarketDataRequest::NoRelatedSym, FIX::Symbol>();
 
-    FIX50SP2::MarketDataRequest::NoRelatedSym* pRelatedSymGroup = nullptr;
-    FIX::Symbol* pSymbol = nullptr;
+    message.getField(isSubscribed);
 
-    static std::atomic<unsigned int> s_cntAtom { 0 };
-    unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
+    message.getGroup(1, relatedSymGroup);
+    relatedSymGroup.getField(symbol);
 
-    while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-    }
-
-    assert(s_cntAtom > 0);
-
-    if (0 == prevCnt) { // sequential case; optimized:
-        pIsSubscribed = &isSubscribed;
-        pRelatedSymGroup = &relatedSymGroup;
-        pSymbol = &symbol;
-    } else { // > 1 threads; always safe way:
-        pIsSubscribed = new decltype(isSubscribed);
-        pRelatedSymGroup = new decltype(relatedSymGroup);
-        pSymbol = new decltype(symbol);
-    }
-
-    message.getField(*pIsSubscribed);
-
-    message.getGroup(1, *pRelatedSymGroup);
-    pRelatedSymGroup->getField(*pSymbol);
-
-    BCDocuments::getInstance().manageSubscriptionInCandlestickData('1' == pIsSubscribed->getValue(), pSymbol->getValue(), sessionID.getTargetCompID().getValue());
-
-    if (0 != prevCnt) { // > 1 threads
-        delete pIsSubscribed;
-        delete pRelatedSymGroup;
-        delete pSymbol;
-    }
-
-    s_cntAtom--;
-    assert(s_cntAtom >= 0);
+    BCDocuments::getInstance().manageSubscriptionInCandlestickData('1' == isSubscribed.getValue(), symbol.getValue(), sessionID.getTargetCompID().getValue());
 }
 
 /**
@@ -726,80 +647,23 @@ void FIXAcceptor::onMessage(const FIX50SP2::NewOrderSingle& message, const FIX::
         return;
     }
 
-    static FIX::ClOrdID orderID;
-    static FIX::Symbol orderSymbol;
-    static FIX::OrderQty orderSize;
-    static FIX::OrdType orderType;
-    static FIX::Price orderPrice;
+    auto& [orderID, orderSymbol, orderSize, orderType, orderPrice, orderIDGroup, orderUserID] = shift::fix::getThreadLocalFields<FIX50SP2::NewOrderSingle, FIX::ClOrdID, FIX::Symbol, FIX::OrderQty, FIX::OrdType, FIX::Price, FIX50SP2::NewOrderSingle::NoPartyIDs, FIX::PartyID>();
 
-    static FIX50SP2::NewOrderSingle::NoPartyIDs orderIDGroup;
-    static FIX::PartyID orderUserID;
+    message.getField(orderID);
+    message.getField(orderSymbol);
+    message.getField(orderSize);
+    message.getField(orderType);
+    message.getField(orderPrice);
 
-    // #pragma GCC diagnostic ignored ....
-
-    FIX::ClOrdID* pOrderID = nullptr;
-    FIX::Symbol* pOrderSymbol = nullptr;
-    FIX::OrderQty* pOrderSize = nullptr;
-    FIX::OrdType* pOrderType = nullptr;
-    FIX::Price* pOrderPrice = nullptr;
-
-    FIX50SP2::NewOrderSingle::NoPartyIDs* pOrderIDGroup = nullptr;
-    FIX::PartyID* pOrderUserID = nullptr;
-
-    static std::atomic<unsigned int> s_cntAtom { 0 };
-    unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-    while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-    }
-
-    assert(s_cntAtom > 0);
-
-    if (0 == prevCnt) { // sequential case; optimized:
-        pOrderID = &orderID;
-        pOrderSymbol = &orderSymbol;
-        pOrderSize = &orderSize;
-        pOrderType = &orderType;
-        pOrderPrice = &orderPrice;
-        pOrderIDGroup = &orderIDGroup;
-        pOrderUserID = &orderUserID;
-    } else { // > 1 threads; always safe way:
-        pOrderID = new decltype(orderID);
-        pOrderSymbol = new decltype(orderSymbol);
-        pOrderSize = new decltype(orderSize);
-        pOrderType = new decltype(orderType);
-        pOrderPrice = new decltype(orderPrice);
-        pOrderIDGroup = new decltype(orderIDGroup);
-        pOrderUserID = new decltype(orderUserID);
-    }
-
-    message.getField(*pOrderID);
-    message.getField(*pOrderSymbol);
-    message.getField(*pOrderSize);
-    message.getField(*pOrderType);
-    message.getField(*pOrderPrice);
-
-    message.getGroup(1, *pOrderIDGroup);
-    pOrderIDGroup->getField(*pOrderUserID);
-
-    std::string id = pOrderID->getValue();
-    std::string symbol = pOrderSymbol->getValue();
-    int size = static_cast<int>(pOrderSize->getValue());
-    auto type = static_cast<Order::Type>(pOrderType->getValue());
-    double price = pOrderPrice->getValue();
-    std::string userID = pOrderUserID->getValue();
-
-    if (0 != prevCnt) { // > 1 threads
-        delete pOrderID;
-        delete pOrderSymbol;
-        delete pOrderSize;
-        delete pOrderType;
-        delete pOrderPrice;
-        delete pOrderIDGroup;
-        delete pOrderUserID;
-    }
+    message.getGroup(1, orderIDGroup);
+    orderIDGroup.getField(orderUserID);
 
-    s_cntAtom--;
-    assert(s_cntAtom >= 0);
+    std::string id = orderID.getValue();
+    std::string symbol = orderSymbol.getValue();
+    int size = static_cast<int>(orderSize.getValue());
+    auto type = static_cast<Order::Type>(orderType.getValue());
+    double price = orderPrice.getValue();
+    std::string userID = orderUserID.getValue();
 
     bool success = true;
 
@@ -0,0 +1,112 @@
+#include "FIXBroadcaster.h"
+
+#include <algorithm>
+#include <functional>
+
+#include <quickfix/Session.h>
+
+#include <shift/miscutils/concurrency/Consumer.h>
+
+FIXBroadcaster::FIXBroadcaster(unsigned int numWriters)
+{
+    if (0 == numWriters) {
+        numWriters = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned int i = 0; i < numWriters; ++i) {
+        m_writers.push_back(std::make_unique<Writer>());
+    }
+    for (auto& writer : m_writers) {
+        writer->thread = std::thread(&FIXBroadcaster::processJobs, this, writer.get());
+    }
+}
+
+FIXBroadcaster::~FIXBroadcaster()
+{
+    for (auto& writer : m_writers) {
+        shift::concurrency::notifyConsumerThreadToQuit(writer->quitFlag, writer->cvJobs, writer->thread);
+    }
+}
+
+auto FIXBroadcaster::getWriterIndex(const std::string& targetID) const -> unsigned int
+{
+    return std::hash<std::string> {}(targetID) % m_writers.size();
+}
+
+/**
+ * @brief Queue a message for every target of the list; the message must have every field set, except the TargetCompID.
+ *        Each writer gets one job, with all the targets it serves.
+ */
+void FIXBroadcaster::broadcast(const std::vector<std::string>& targetList, FIX::Message&& message)
+{
+    if (targetList.empty()) {
+        return;
+    }
+
+    // QuickFIX caches the length and checksum of each field once it was encoded, and the copies made by the writers keep them:
+    // encoding the message here leaves each send only the header fields that Session sets
+    message.toString();
+    const std::shared_ptr<const FIX::Message> sharedMessage = std::make_shared<FIX::Message>(std::move(message));
+
+    std::vector<std::vector<std::string>> targetIDsPerWriter(m_writers.size());
+    for (const auto& targetID : targetList) {
+        targetIDsPerWriter[getWriterIndex(targetID)].push_back(targetID);
+    }
+
+    for (unsigned int i = 0; i < m_writers.size(); ++i) {
+        if (targetIDsPerWriter[i].empty()) {
+            continue;
+        }
+
+        auto& writer = *m_writers[i];
+
+        bool wasEmpty = false;
+        {
+            std::lock_guard<std::mutex> guard(writer.mtxJobs);
+            wasEmpty = writer.jobs.empty();
+            writer.jobs.push_back({ sharedMessage, std::move(targetIDsPerWriter[i]) });
+        }
+
+        // otherwise, the writer is busy and will take this job with the others
+        if (wasEmpty) {
+            writer.cvJobs.notify_one();
+        }
+    }
+}
+
+/**
+ * @brief Function to send the queued messages of one writer, for writer thread.
+ */
+void FIXBroadcaster::processJobs(Writer* writer)
+{
+    auto quitFut = writer->quitFlag.get_future();
+    std::vector<Job> jobs;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(writer->mtxJobs);
+            if (shift::concurrency::quitOrContinueConsumerThread(quitFut, writer->cvJobs, lock, [writer] { return !writer->jobs.empty(); })) {
+                return;
+            }
+
+            jobs.swap(writer->jobs);
+        }
+
+        for (auto& job : jobs) {
+            // sending sets the session fields of the header, and each send overwrites those of the previous one:
+            // one copy serves all targets of this writer
+            FIX::Message message(*job.message);
+
+            for (const auto& targetID : job.targetIDs) {
+                message.getHeader().setField(FIX::TargetCompID(targetID));
+
+                try {
+                    FIX::Session::sendToTarget(message);
+                } catch (const FIX::SessionNotFound&) { // the target disconnected in the meantime
+                }
+            }
+        }
+
+        jobs.clear(); // keeps its capacity for the next swap
+    }
+}
@@ -5,14 +5,13 @@
 #include "FIXAcceptor.h"
 #include "Parameters.h"
 
-#include <atomic>
-#include <cassert>
 
 #include <quickfix/FieldConvertors.h>
 #include <quickfix/FieldTypes.h>
 
 #include <shift/miscutils/crypto/Decryptor.h>
 #include <shift/miscutils/fix/HelperFunctions.h>
+#include <shift/miscutils/fix/ThreadLocalFields.h>
 #include <shift/miscutils/terminal/Common.h>
 
 using namespace std::chrono_literals;
@@ -226,98 +225,36 @@ void FIXInitiator::onMessage(const FIX50SP2::MarketDataSnapshotFullRefresh& mess
         return;
     }
 
-    static FIX::Symbol symbol;
+    auto& [symbol, entryGroup, bookType, price, size, simulationDate, simulationTime, destination] = shift::fix::getThreadLocalFields<FIX50SP2::MarketDataSnapshotFullRefresh, FIX::Symbol, FIX50SP2::MarketDataSnapshotFullRefresh::NoMDEntries, FIX::MDEntryType, FIX::MDEntryPx, FIX::MDEntrySize, FIX::MDEntryDate, FIX::MDEntryTime, FIX::MDMkt>();
 
-    static FIX50SP2::MarketDataSnapshotFullRefresh::NoMDEntries entryGroup;
-    static FIX::MDEntryType bookType;
-    static FIX::MDEntryPx price;
-    static FIX::MDEntrySize size;
-    static FIX::MDEntryDate simulationDate;
-    static FIX::MDEntryTime simulationTime;
-    static FIX::MDMkt destination;
-
-    // #pragma GCC diagnostic ignored ....
-
-    FIX::Symbol* pSymbol = nullptr;
-
-    FIX50SP2::MarketDataSnapshotFullRefresh::NoMDEntries* pEntryGroup = nullptr;
-    FIX::MDEntryType* pBookType = nullptr;
-    FIX::MDEntryPx* pPrice = nullptr;
-    FIX::MDEntrySize* pSize = nullptr;
-    FIX::MDEntryDate* pSimulationDate = nullptr;
-    FIX::MDEntryTime* pSimulationTime = nullptr;
-    FIX::MDMkt* pDestination = nullptr;
-
-    static std::atomic<unsigned int> s_cntAtom { 0 };
-    unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-    while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-    }
-
-    assert(s_cntAtom > 0);
-
-    if (0 == prevCnt) { // sequential case; optimized:
-        pSymbol = &symbol;
-        pEntryGroup = &entryGroup;
-        pBookType = &bookType;
-        pPrice = &price;
-        pSize = &size;
-        pSimulationDate = &simulationDate;
-        pSimulationTime = &simulationTime;
-        pDestination = &destination;
-    } else { // > 1 threads; always safe way:
-        pSymbol = new decltype(symbol);
-        pEntryGroup = new decltype(entryGroup);
-        pBookType = new decltype(bookType);
-        pPrice = new decltype(price);
-        pSize = new decltype(size);
-        pSimulationDate = new decltype(simulationDate);
-        pSimulationTime = new decltype(simulationTime);
-        pDestination = new decltype(destination);
-    }
-
-    message.getField(*pSymbol);
+    message.getField(symbol);
 
     for (int i = 1; i <= numOfEntries.getValue(); ++i) {
-        message.getGroup(static_cast<unsigned int>(i), *pEntryGroup);
+        message.getGroup(static_cast<unsigned int>(i), entryGroup);
 
-        pEntryGroup->getField(*pBookType);
-        pEntryGroup->getField(*pPrice);
-        pEntryGroup->getField(*pSize);
-        pEntryGroup->getField(*pSimulationDate);
-        pEntryGroup->getField(*pSimulationTime);
-        pEntryGroup->getField(*pDestination);
+        entryGroup.getField(bookType);
+        entryGroup.getField(price);
+        entryGroup.getField(size);
+        entryGroup.getField(simulationDate);
+        entryGroup.getField(simulationTime);
+        entryGroup.getField(destination);
 
         OrderBookEntry entry {
-            static_cast<OrderBookEntry::Type>(pBookType->getValue()),
-            pSymbol->getValue(),
-            pPrice->getValue(),
-            static_cast<int>(pSize->getValue()),
-            pDestination->getValue(),
-            pSimulationDate->getValue(),
-            pSimulationTime->getValue()
+            static_cast<OrderBookEntry::Type>(bookType.getValue()),
+            symbol.getValue(),
+            price.getValue(),
+            static_cast<int>(size.getValue()),
+            destination.getValue(),
+            simulationDate.getValue(),
+            simulationTime.getValue()
         };
 
         // - the first entry is guaranteed to have price <= 0.0: this will tell the
         // order book object that the targeted order book type must first be cleared.
         // - the following entries will be in such order so that the standard update
         // procedure for a given order book type may be used without information loss
-        BCDocuments::getInstance().onNewOBUpdateForOrderBook(pSymbol->getValue(), std::move(entry));
-    }
-
-    if (0 != prevCnt) { // > 1 threads
-        delete pSymbol;
-        delete pEntryGroup;
-        delete pBookType;
-        delete pPrice;
-        delete pSize;
-        delete pSimulationDate;
-        delete pSimulationTime;
-        delete pDestination;
+        BCDocuments::getInstance().onNewOBUpdateForOrderBook(symbol.getValue(), std::move(entry));
     }
-
-    s_cntAtom--;
-    assert(s_cntAtom >= 0);
 }
 
 /**
@@ -352,88 +289,31 @@ void FIXInitiator::onMessage(const FIX50SP2::MarketDataIncrementalRefresh& messa
         return;
     }
 
-    static FIX50SP2::MarketDataIncrementalRefresh::NoMDEntries entryGroup;
-    static FIX::MDEntryType bookType;
-    static FIX::Symbol symbol;
-    static FIX::MDEntryPx price;
-    static FIX::MDEntrySize size;
-    static FIX::MDEntryDate simulationDate;
-    static FIX::MDEntryTime simulationTime;
-    static FIX::MDMkt destination;
-
-    // #pragma GCC diagnostic ignored ....
-
-    FIX50SP2::MarketDataIncrementalRefresh::NoMDEntries* pEntryGroup = nullptr;
-    FIX::MDEntryType* pBookType = nullptr;
-    FIX::Symbol* pSymbol = nullptr;
-    FIX::MDEntryPx* pPrice = nullptr;
-    FIX::MDEntrySize* pSize = nullptr;
-    FIX::MDEntryDate* pSimulationDate = nullptr;
-    FIX::MDEntryTime* pSimulationTime = nullptr;
-    FIX::MDMkt* pDestination = nullptr;
-
-    static std::atomic<unsigned int> s_cntAtom { 0 };
-    unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-    while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-    }
+    auto& [entryGroup, bookType, symbol, price, size, simulationDate, simulationTime, destination] = shift::fix::getThreadLocalFields<FIX50SP2::MarketDataIncrementalRefresh, FIX50SP2::MarketDataIncrementalRefresh::NoMDEntries, FIX::MDEntryType, FIX::Symbol, FIX::MDEntryPx, FIX::MDEntrySize, FIX::MDEntryDate, FIX::MDEntryTime, FIX::MDMkt>();
 
-    assert(s_cntAtom > 0);
-
-    if (0 == prevCnt) { // sequential case; optimized:
-        pEntryGroup = &entryGroup;
-        pBookType = &bookType;
-        pSymbol = &symbol;
-        pPrice = &price;
-        pSize = &size;
-        pSimulationDate = &simulationDate;
-        pSimulationTime = &simulationTime;
-        pDestination = &destination;
-    } else { // > 1 threads; always safe way:
-        pEntryGroup = new decltype(entryGroup);
-        pBookType = new decltype(bookType);
-        pSymbol = new decltype(symbol);
-        pPrice = new decltype(price);
-        pSize = new decltype(size);
-        pSimulationDate = new decltype(simulationDate);
-        pSimulationTime = new decltype(simulationTime);
-        pDestination = new decltype(destination);
-    }
+    // the ME may pack several updates into one message (batching mode)
+    for (int i = 1; i <= numOfEntries.getValue(); ++i) {
+        message.getGroup(i, entryGroup);
+        entryGroup.getField(bookType);
+        entryGroup.getField(symbol);
+        entryGroup.getField(price);
+        entryGroup.getField(size);
+        entryGroup.getField(simulationDate);
+        entryGroup.getField(simulationTime);
+        entryGroup.getField(destination);
 
-    message.getGroup(1, *pEntryGroup);
-    pEntryGroup->getField(*pBookType);
-    pEntryGroup->getField(*pSymbol);
-    pEntryGroup->getField(*pPrice);
-    pEntryGroup->getField(*pSize);
-    pEntryGroup->getField(*pSimulationDate);
-    pEntryGroup->getField(*pSimulationTime);
-    pEntryGroup->getField(*pDestination);
-
-    OrderBookEntry entry {
-        static_cast<OrderBookEntry::Type>(pBookType->getValue()),
-        pSymbol->getValue(),
-        pPrice->getValue(),
-        static_cast<int>(pSize->getValue()),
-        pDestination->getValue(),
-        pSimulationDate->getValue(),
-        pSimulationTime->getValue()
-    };
-
-    BCDocuments::getInstance().onNewOBUpdateForOrderBook(pSymbol->getValue(), std::move(entry));
-
-    if (0 != prevCnt) { // > 1 threads
-        delete pEntryGroup;
-        delete pBookType;
-        delete pSymbol;
-        delete pPrice;
-        delete pSize;
-        delete pSimulationDate;
-        delete pSimulationTime;
-        delete pDestination;
-    }
+        OrderBookEntry entry {
+            static_cast<OrderBookEntry::Type>(bookType.getValue()),
+            symbol.getValue(),
+            price.getValue(),
+            static_cast<int>(size.getValue()),
+            destination.getValue(),
+            simulationDate.getValue(),
+            simulationTime.getValue()
+        };
 
-    s_cntAtom--;
-    assert(s_cntAtom >= 0);
+        BCDocuments::getInstance().onNewOBUpdateForOrderBook(symbol.getValue(), std::move(entry));
+    }
 }
 
 /**
@@ -444,7 +324,7 @@ void FIXInitiator::onMessage(const FIX50SP2::ExecutionReport& message, const FIX
     FIX::ExecType execType;
     message.getField(execType);
 
-    if (execType == FIX::ExecType_ORDER_STATUS) { // confirmation report
+    if (execType == FIX::ExecType_ORDER_STATUS || execType == FIX::ExecType_REJECTED) { // confirmation (or rejection) report
         FIX::NoPartyIDs numOfGroups;
         message.getField(numOfGroups);
         if (numOfGroups.getValue() < 1) {
@@ -452,125 +332,48 @@ void FIXInitiator::onMessage(const FIX50SP2::ExecutionReport& message, const FIX
             return;
         }
 
-        static FIX::OrderID orderID;
-        static FIX::OrdStatus status;
-        static FIX::Symbol symbol;
-        static FIX::Side orderType;
-        static FIX::Price price;
-        static FIX::EffectiveTime confirmTime;
-        static FIX::LastMkt destination;
-        static FIX::LeavesQty currentSize;
-        static FIX::TransactTime serverTime;
-
-        static FIX50SP2::ExecutionReport::NoPartyIDs idGroup;
-        static FIX::PartyID userID;
-
-        // #pragma GCC diagnostic ignored ....
-
-        FIX::OrderID* pOrderID = nullptr;
-        FIX::OrdStatus* pStatus = nullptr;
-        FIX::Symbol* pSymbol = nullptr;
-        FIX::Side* pOrderType = nullptr;
-        FIX::Price* pPrice = nullptr;
-        FIX::EffectiveTime* pConfirmTime = nullptr;
-        FIX::LastMkt* pDestination = nullptr;
-        FIX::LeavesQty* pCurrentSize = nullptr;
-        FIX::TransactTime* pServerTime = nullptr;
-
-        FIX50SP2::ExecutionReport::NoPartyIDs* pIDGroup = nullptr;
-        FIX::PartyID* pUserID = nullptr;
-
-        static std::atomic<unsigned int> s_cntAtom { 0 };
-        unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-        while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-        }
-
-        assert(s_cntAtom > 0);
-
-        if (0 == prevCnt) { // sequential case; optimized:
-            pOrderID = &orderID;
-            pStatus = &status;
-            pSymbol = &symbol;
-            pOrderType = &orderType;
-            pPrice = &price;
-            pConfirmTime = &confirmTime;
-            pDestination = &destination;
-            pCurrentSize = &currentSize;
-            pServerTime = &serverTime;
-            pIDGroup = &idGroup;
-            pUserID = &userID;
-        } else { // > 1 threads; always safe way:
-            pOrderID = new decltype(orderID);
-            pStatus = new decltype(status);
-            pSymbol = new decltype(symbol);
-            pOrderType = new decltype(orderType);
-            pPrice = new decltype(price);
-            pConfirmTime = new decltype(confirmTime);
-            pDestination = new decltype(destination);
-            pCurrentSize = new decltype(currentSize);
-            pServerTime = new decltype(serverTime);
-            pIDGroup = new decltype(idGroup);
-            pUserID = new decltype(userID);
-        }
+        auto& [orderID, status, symbol, orderType, price, confirmTime, destination, currentSize, serverTime, idGroup, userID] = shift::fix::getThreadLocalFields<FIX50SP2::ExecutionReport, FIX::OrderID, FIX::OrdStatus, FIX::Symbol, FIX::Side, FIX::Price, FIX::EffectiveTime, FIX::LastMkt, FIX::LeavesQty, FIX::TransactTime, FIX50SP2::ExecutionReport::NoPartyIDs, FIX::PartyID>();
 
-        message.getField(*pOrderID);
-        message.getField(*pStatus);
-        message.getField(*pSymbol);
-        message.getField(*pOrderType);
-        message.getField(*pPrice);
-        message.getField(*pConfirmTime);
-        message.getField(*pDestination);
-        message.getField(*pCurrentSize);
-        message.getField(*pServerTime);
+        message.getField(orderID);
+        message.getField(status);
+        message.getField(symbol);
+        message.getField(orderType);
+        message.getField(price);
+        message.getField(confirmTime);
+        message.getField(destination);
+        message.getField(currentSize);
+        message.getField(serverTime);
 
-        message.getGroup(1, *pIDGroup);
-        pIDGroup->getField(*pUserID);
+        message.getGroup(1, idGroup);
+        idGroup.getField(userID);
 
         cout << "Confirmation Report: "
-             << pUserID->getValue() << "\t"
-             << pOrderID->getValue() << "\t"
-             << pOrderType->getValue() << "\t"
-             << pSymbol->getValue() << "\t"
-             << pCurrentSize->getValue() << "\t"
-             << pPrice->getValue() << "\t"
-             << pStatus->getValue() << "\t"
-             << pDestination->getValue() << "\t"
-             << pConfirmTime->getString() << "\t"
-             << pServerTime->getString() << endl;
+             << userID.getValue() << "\t"
+             << orderID.getValue() << "\t"
+             << orderType.getValue() << "\t"
+             << symbol.getValue() << "\t"
+             << currentSize.getValue() << "\t"
+             << price.getValue() << "\t"
+             << status.getValue() << "\t"
+             << destination.getValue() << "\t"
+             << confirmTime.getString() << "\t"
+             << serverTime.getString() << endl;
 
         ExecutionReport report {
-            pUserID->getValue(),
-            pOrderID->getValue(),
-            static_cast<Order::Type>(pOrderType->getValue()),
-            pSymbol->getValue(),
-            static_cast<int>(pCurrentSize->getValue()),
+            userID.getValue(),
+            orderID.getValue(),
+            static_cast<Order::Type>(orderType.getValue()),
+            symbol.getValue(),
+            static_cast<int>(currentSize.getValue()),
             0, // executed size
-            pPrice->getValue(),
-            static_cast<Order::Status>(pStatus->getValue()),
-            pDestination->getValue(),
-            pConfirmTime->getValue(),
-            pServerTime->getValue()
+            price.getValue(),
+            static_cast<Order::Status>(status.getValue()),
+            destination.getValue(),
+            confirmTime.getValue(),
+            serverTime.getValue()
         };
 
-        BCDocuments::getInstance().onNewExecutionReportForUserRiskManagement(pUserID->getValue(), std::move(report));
-
-        if (0 != prevCnt) { // > 1 threads
-            delete pOrderID;
-            delete pStatus;
-            delete pSymbol;
-            delete pOrderType;
-            delete pPrice;
-            delete pConfirmTime;
-            delete pDestination;
-            delete pCurrentSize;
-            delete pServerTime;
-            delete pIDGroup;
-            delete pUserID;
-        }
-
-        s_cntAtom--;
-        assert(s_cntAtom >= 0);
+        BCDocuments::getInstance().onNewExecutionReportForUserRiskManagement(userID.getValue(), std::move(report));
 
     } else { // FIX::ExecType_TRADE: execution report
         FIX::NoPartyIDs numOfGroups;
@@ -580,115 +383,29 @@ void FIXInitiator::onMessage(const FIX50SP2::ExecutionReport& message, const FIX
             return;
         }
 
-        static FIX::OrderID orderID1;
-        static FIX::SecondaryOrderID orderID2;
-        static FIX::OrdStatus status;
-        static FIX::Symbol symbol;
-        static FIX::Side orderType1;
-        static FIX::OrdType orderType2;
-        static FIX::Price price;
-        static FIX::EffectiveTime execTime;
-        static FIX::LastMkt destination;
-        static FIX::CumQty executedSize;
-        static FIX::TransactTime serverTime;
-
-        static FIX50SP2::ExecutionReport::NoPartyIDs idGroup;
-        static FIX::PartyID userID1;
-        static FIX::PartyID userID2;
-
-        static FIX50SP2::ExecutionReport::NoTrdRegTimestamps timeGroup;
-        static FIX::TrdRegTimestamp utcTime1;
-        static FIX::TrdRegTimestamp utcTime2;
-
-        // #pragma GCC diagnostic ignored ....
-
-        FIX::OrderID* pOrderID1 = nullptr;
-        FIX::SecondaryOrderID* pOrderID2 = nullptr;
-        FIX::OrdStatus* pStatus = nullptr;
-        FIX::Symbol* pSymbol = nullptr;
-        FIX::Side* pOrderType1 = nullptr;
-        FIX::OrdType* pOrderType2 = nullptr;
-        FIX::Price* pPrice = nullptr;
-        FIX::EffectiveTime* pExecTime = nullptr;
-        FIX::LastMkt* pDestination = nullptr;
-        FIX::CumQty* pExecutedSize = nullptr;
-        FIX::TransactTime* pServerTime = nullptr;
-
-        FIX50SP2::ExecutionReport::NoPartyIDs* pIDGroup = nullptr;
-        FIX::PartyID* pUserID1 = nullptr;
-        FIX::PartyID* pUserID2 = nullptr;
-
-        FIX50SP2::ExecutionReport::NoTrdRegTimestamps* pTimeGroup = nullptr;
-        FIX::TrdRegTimestamp* pUTCTime1 = nullptr;
-        FIX::TrdRegTimestamp* pUTCTime2 = nullptr;
-
-        static std::atomic<unsigned int> s_cntAtom { 0 };
-        unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-        while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-        }
-
-        assert(s_cntAtom > 0);
-
-        if (0 == prevCnt) { // sequential case; optimized:
-            pOrderID1 = &orderID1;
-            pOrderID2 = &orderID2;
-            pStatus = &status;
-            pSymbol = &symbol;
-            pOrderType1 = &orderType1;
-            pOrderType2 = &orderType2;
-            pPrice = &price;
-            pExecTime = &execTime;
-            pDestination = &destination;
-            pExecutedSize = &executedSize;
-            pServerTime = &serverTime;
-            pIDGroup = &idGroup;
-            pUserID1 = &userID1;
-            pUserID2 = &userID2;
-            pTimeGroup = &timeGroup;
-            pUTCTime1 = &utcTime1;
-            pUTCTime2 = &utcTime2;
-        } else { // > 1 threads; always safe way:
-            pOrderID1 = new decltype(orderID1);
-            pOrderID2 = new decltype(orderID2);
-            pStatus = new decltype(status);
-            pSymbol = new decltype(symbol);
-            pOrderType1 = new decltype(orderType1);
-            pOrderType2 = new decltype(orderType2);
-            pPrice = new decltype(price);
-            pExecTime = new decltype(execTime);
-            pDestination = new decltype(destination);
-            pExecutedSize = new decltype(executedSize);
-            pServerTime = new decltype(serverTime);
-            pIDGroup = new decltype(idGroup);
-            pUserID1 = new decltype(userID1);
-            pUserID2 = new decltype(userID2);
-            pTimeGroup = new decltype(timeGroup);
-            pUTCTime1 = new decltype(utcTime1);
-            pUTCTime2 = new decltype(utcTime2);
-        }
-
-        message.getField(*pOrderID1);
-        message.getField(*pOrderID2);
-        message.getField(*pStatus);
-        message.getField(*pSymbol);
-        message.getField(*pOrderType1);
-        message.getField(*pOrderType2);
-        message.getField(*pPrice);
-        message.getField(*pExecTime);
-        message.getField(*pDestination);
-        message.getField(*pExecutedSize);
-        message.getField(*pServerTime);
-
-        message.getGroup(1, *pIDGroup);
-        pIDGroup->getField(*pUserID1);
-        message.getGroup(2, *pIDGroup);
-        pIDGroup->getField(*pUserID2);
-
-        message.getGroup(1, *pTimeGroup);
-        pTimeGroup->getField(*pUTCTime1);
-        message.getGroup(2, *pTimeGroup);
-        pTimeGroup->getField(*pUTCTime2);
+        auto& [orderID1, orderID2, status, symbol, orderType1, orderType2, price, execTime, destination, executedSize, serverTime, idGroup, userID1, userID2, timeGroup, utcTime1, utcTime2] = shift::fix::getThreadLocalFields<FIX50SP2::ExecutionReport, FIX::OrderID, FIX::SecondaryOrderID, FIX::OrdStatus, FIX::Symbol, FIX::Side, FIX::OrdType, FIX::Price, FIX::EffectiveTime, FIX::LastMkt, FIX::CumQty, FIX::TransactTime, FIX50SP2::ExecutionReport::NoPartyIDs, FIX::PartyID, FIX::PartyID, FIX50SP2::ExecutionReport::NoTrdRegTimestamps, FIX::TrdRegTimestamp, FIX::TrdRegTimestamp>();
+
+        message.getField(orderID1);
+        message.getField(orderID2);
+        message.getField(status);
+        message.getField(symbol);
+        message.getField(orderType1);
+        message.getField(orderType2);
+        message.getField(price);
+        message.getField(execTime);
+        message.getField(destination);
+        message.getField(executedSize);
+        message.getField(serverTime);
+
+        message.getGroup(1, idGroup);
+        idGroup.getField(userID1);
+        message.getGroup(2, idGroup);
+        idGroup.getField(userID2);
+
+        message.getGroup(1, timeGroup);
+        timeGroup.getField(utcTime1);
+        message.getGroup(2, timeGroup);
+        timeGroup.getField(utcTime2);
 
         auto printRpts = [](bool rpt1or2, auto userID, auto orderID, auto orderType, auto symbol, auto executedSize, auto price, auto status, auto destination, auto execTime, auto serverTime) {
             cout << (rpt1or2 ? "Report1: " : "Report2: ")
@@ -704,69 +421,69 @@ void FIXInitiator::onMessage(const FIX50SP2::ExecutionReport& message, const FIX
                  << serverTime->getString() << endl;
         };
 
-        if (pStatus->getValue() != FIX::OrdStatus_REPLACED) { // == '5', means this is a trade update from TRTH -> no need to store it
+        if (status.getValue() != FIX::OrdStatus_REPLACED) { // == '5', means this is a trade update from TRTH -> no need to store it
             TradingRecord record {
-                pServerTime->getValue(),
-                pExecTime->getValue(),
-                pSymbol->getValue(),
-                pPrice->getValue(),
-                static_cast<int>(pExecutedSize->getValue()),
-                pUserID1->getValue(),
-                pUserID2->getValue(),
-                pOrderID1->getValue(),
-                pOrderID2->getValue(),
-                static_cast<Order::Type>(pOrderType1->getValue()),
-                static_cast<Order::Type>(pOrderType2->getValue()),
-                pStatus->getValue(), // decision
-                pDestination->getValue(),
-                pUTCTime1->getValue(),
-                pUTCTime2->getValue()
+                serverTime.getValue(),
+                execTime.getValue(),
+                symbol.getValue(),
+                price.getValue(),
+                static_cast<int>(executedSize.getValue()),
+                userID1.getValue(),
+                userID2.getValue(),
+                orderID1.getValue(),
+                orderID2.getValue(),
+                static_cast<Order::Type>(orderType1.getValue()),
+                static_cast<Order::Type>(orderType2.getValue()),
+                status.getValue(), // decision
+                destination.getValue(),
+                utcTime1.getValue(),
+                utcTime2.getValue()
             };
 
-            DBConnector::getInstance().insertTradingRecord(record);
+            DBConnector::getInstance().enqueueTradingRecord(std::move(record));
         }
 
-        switch (pStatus->getValue()) {
+        switch (status.getValue()) {
         case FIX::OrdStatus_FILLED:
         case FIX::OrdStatus_REPLACED: {
             Transaction transac = {
-                pSymbol->getValue(),
-                static_cast<int>(pExecutedSize->getValue()),
-                pPrice->getValue(),
-                pDestination->getValue(),
-                pExecTime->getValue()
+                symbol.getValue(),
+                static_cast<int>(executedSize.getValue()),
+                price.getValue(),
+                destination.getValue(),
+                execTime.getValue()
             };
 
-            if (FIX::OrdStatus_FILLED == pStatus->getValue()) { // trade
-                printRpts(true, pUserID1, pOrderID1, pOrderType1, pSymbol, pExecutedSize, pPrice, pStatus, pDestination, pExecTime, pServerTime);
-                printRpts(false, pUserID2, pOrderID2, pOrderType2, pSymbol, pExecutedSize, pPrice, pStatus, pDestination, pExecTime, pServerTime);
+            if (FIX::OrdStatus_FILLED == status.getValue()) { // trade
+                printRpts(true, &userID1, &orderID1, &orderType1, &symbol, &executedSize, &price, &status, &destination, &execTime, &serverTime);
+                printRpts(false, &userID2, &orderID2, &orderType2, &symbol, &executedSize, &price, &status, &destination, &execTime, &serverTime);
 
                 ExecutionReport report1 {
-                    pUserID1->getValue(),
-                    pOrderID1->getValue(),
-                    static_cast<Order::Type>(pOrderType1->getValue()),
-                    pSymbol->getValue(),
+                    userID1.getValue(),
+                    orderID1.getValue(),
+                    static_cast<Order::Type>(orderType1.getValue()),
+                    symbol.getValue(),
                     0, // current size: will be added later
-                    static_cast<int>(pExecutedSize->getValue()),
-                    pPrice->getValue(),
-                    static_cast<Order::Status>(pStatus->getValue()),
-                    pDestination->getValue(),
-                    pExecTime->getValue(),
-                    pServerTime->getValue()
+                    static_cast<int>(executedSize.getValue()),
+                    price.getValue(),
+                    static_cast<Order::Status>(status.getValue()),
+                    destination.getValue(),
+                    execTime.getValue(),
+                    serverTime.getValue()
                 };
 
                 ExecutionReport report2 {
-                    pUserID2->getValue(),
-                    pOrderID2->getValue(),
-                    static_cast<Order::Type>(pOrderType2->getValue()),
-                    pSymbol->getValue(),
+                    userID2.getValue(),
+                    orderID2.getValue(),
+                    static_cast<Order::Type>(orderType2.getValue()),
+                    symbol.getValue(),
                     0, // current size: will be added later
-                    static_cast<int>(pExecutedSize->getValue()),
-                    pPrice->getValue(),
-                    static_cast<Order::Status>(pStatus->getValue()),
-                    pDestination->getValue(),
-                    pExecTime->getValue(),
-                    pServerTime->getValue()
+                    static_cast<int>(executedSize.getValue()),
+                    price.getValue(),
+                    static_cast<Order::Status>(status.getValue()),
+                    destination.getValue(),
+                    execTime.getValue(),
+                    serverTime.getValue()
                 };
 
                 if (!s_isFBA) {
@@ -774,57 +491,34 @@ void FIXInitiator::onMessage(const FIX50SP2::ExecutionReport& message, const FIX
                 }
 
                 auto& docs = BCDocuments::getInstance();
-                docs.onNewTransacForCandlestickData(pSymbol->getValue(), transac);
-                docs.onNewExecutionReportForUserRiskManagement(pUserID1->getValue(), std::move(report1));
-                docs.onNewExecutionReportForUserRiskManagement(pUserID2->getValue(), std::move(report2));
+                docs.onNewTransacForCandlestickData(symbol.getValue(), transac);
+                docs.onNewExecutionReportForUserRiskManagement(userID1.getValue(), std::move(report1));
+                docs.onNewExecutionReportForUserRiskManagement(userID2.getValue(), std::move(report2));
             } else { // FIX::OrdStatus_REPLACED: TRTH trade
                 FIXAcceptor::s_sendLastPrice2All(transac);
-                BCDocuments::getInstance().onNewTransacForCandlestickData(pSymbol->getValue(), transac);
+                BCDocuments::getInstance().onNewTransacForCandlestickData(symbol.getValue(), transac);
             }
         } break;
         case FIX::OrdStatus_CANCELED: { // cancellation
-            printRpts(true, pUserID1, pOrderID1, pOrderType1, pSymbol, pExecutedSize, pPrice, pStatus, pDestination, pExecTime, pServerTime);
-            printRpts(false, pUserID2, pOrderID2, pOrderType2, pSymbol, pExecutedSize, pPrice, pStatus, pDestination, pExecTime, pServerTime);
+            printRpts(true, &userID1, &orderID1, &orderType1, &symbol, &executedSize, &price, &status, &destination, &execTime, &serverTime);
+            printRpts(false, &userID2, &orderID2, &orderType2, &symbol, &executedSize, &price, &status, &destination, &execTime, &serverTime);
 
             ExecutionReport report2 {
-                pUserID2->getValue(),
-                pOrderID2->getValue(),
-                static_cast<Order::Type>(pOrderType2->getValue()),
-                pSymbol->getValue(),
+                userID2.getValue(),
+                orderID2.getValue(),
+                static_cast<Order::Type>(orderType2.getValue()),
+                symbol.getValue(),
                 0, // current size: will be added later
-                static_cast<int>(pExecutedSize->getValue()),
-                pPrice->getValue(),
-                static_cast<Order::Status>(pStatus->getValue()),
-                pDestination->getValue(),
-                pExecTime->getValue(),
-                pServerTime->getValue()
+                static_cast<int>(executedSize.getValue()),
+                price.getValue(),
+                static_cast<Order::Status>(status.getValue()),
+                destination.getValue(),
+                execTime.getValue(),
+                serverTime.getValue()
             };
 
-            BCDocuments::getInstance().onNewExecutionReportForUserRiskManagement(pUserID2->getValue(), std::move(report2));
+            BCDocuments::getInstance().onNewExecutionReportForUserRiskManagement(userID2.getValue(), std::move(report2));
         } break;
         } // switch
-
-        if (0 != prevCnt) { // > 1 threads
-            delete pOrderID1;
-            delete pOrderID2;
-            delete pStatus;
-            delete pSymbol;
-            delete pOrderType1;
-            delete pOrderType2;
-            delete pPrice;
-            delete pExecTime;
-            delete pDestination;
-            delete pExecutedSize;
-            delete pServerTime;
-            delete pIDGroup;
-            delete pUserID1;
-            delete pUserID2;
-            delete pUTCTime2;
-            delete pUTCTime1;
-            delete pTimeGroup;
-        }
-
-        s_cntAtom--;
-        assert(s_cntAtom >= 0);
     }
 }
@@ -4,6 +4,9 @@
 #include "FIXAcceptor.h"
 
 #include <algorithm>
+#include <set>
+#include <string_view>
+#include <tuple>
 
 #include <shift/miscutils/concurrency/Consumer.h>
 
@@ -13,6 +16,10 @@
  */
 OrderBook::OrderBook(std::string symbol)
     : m_symbol { std::move(symbol) }
+    , m_globalBidSeqNum(0)
+    , m_globalAskSeqNum(0)
+    , m_localBidSeqNum(0)
+    , m_localAskSeqNum(0)
 {
 }
 
@@ -28,45 +35,82 @@ OrderBook::~OrderBook() // override
 */
 void OrderBook::enqueueOrderBookUpdate(OrderBookEntry&& update)
 {
+    bool wasEmpty = false;
     {
         std::lock_guard<std::mutex> guard(m_mtxOBEBuff);
-        m_obeBuff.push(std::move(update));
+        wasEmpty = m_obeBuff.empty();
+        m_obeBuff.push_back(std::move(update));
+    }
+
+    // otherwise, the process thread is busy and will take this update with the others
+    if (wasEmpty) {
+        m_cvOBEBuff.notify_one();
     }
-    m_cvOBEBuff.notify_one();
 }
 
 /**
- * @brief Thread-safely save the OrderBookEntry items correspondingly with respect to their order book type.
+ * @brief Finds the updates that a later update of the same batch makes useless:
+ *        the ones to the same price level and destination of the same order book, and the clearings of an order book followed by another one.
+ *        Skipping them does not change the resulting order books, since each update overwrites (or erases) its own price level and destination,
+ *        and the global order books discard the same price levels whether or not an earlier update to that price level was applied.
+ * @return For each update of the batch, whether it can be skipped.
+ */
+static auto s_findSupersededUpdates(const std::vector<OrderBookEntry>& batch) -> std::vector<bool>
+{
+    std::vector<bool> isSuperseded(batch.size(), false);
+    std::set<std::tuple<OrderBookEntry::Type, double, std::string_view>> laterLevels;
+
+    for (auto i = batch.size(); i-- > 0;) {
+        const auto& update = batch[i];
+        const auto level = (update.getPrice() <= 0.0) // price <= 0.0 means clear the order book
+            ? std::make_tuple(update.getType(), 0.0, std::string_view {})
+            : std::make_tuple(update.getType(), update.getPrice(), std::string_view { update.getDestination() });
+
+        isSuperseded[i] = !laterLevels.insert(level).second;
+    }
+
+    return isSuperseded;
+}
+
+/**
+ * @brief Thread-safely save, number, and broadcast the OrderBookEntry items correspondingly with respect to their order book type.
+ *        The pending updates are processed in batches, without holding m_mtxOBEBuff.
  */
 void OrderBook::process()
 {
     thread_local auto quitFut = m_quitFlag.get_future();
 
+    std::vector<OrderBookEntry> batch;
+
     while (true) {
-        std::unique_lock<std::mutex> buffLock(m_mtxOBEBuff);
-        if (shift::concurrency::quitOrContinueConsumerThread(quitFut, m_cvOBEBuff, buffLock, [this] { return !m_obeBuff.empty(); })) {
-            return;
+        {
+            std::unique_lock<std::mutex> buffLock(m_mtxOBEBuff);
+            if (shift::concurrency::quitOrContinueConsumerThread(quitFut, m_cvOBEBuff, buffLock, [this] { return !m_obeBuff.empty(); })) {
+                return;
+            }
+
+            // take all pending updates at once, so that enqueueOrderBookUpdate() never waits for the broadcasts below
+            batch.swap(m_obeBuff);
         }
 
-        switch (m_obeBuff.front().getType()) {
-        case OrderBookEntry::Type::GLB_BID:
-            saveGlobalBidOrderBookUpdate(m_obeBuff.front());
-            break;
-        case OrderBookEntry::Type::GLB_ASK:
-            saveGlobalAskOrderBookUpdate(m_obeBuff.front());
-            break;
-        case OrderBookEntry::Type::LOC_BID:
-            saveLocalBidOrderBookUpdate(m_obeBuff.front());
-            break;
-        case OrderBookEntry::Type::LOC_ASK:
-            saveLocalAskOrderBookUpdate(m_obeBuff.front());
-            break;
-        default:
-            break;
+        const auto isSuperseded = (batch.size() > 1) ? s_findSupersededUpdates(batch) : std::vector<bool>(batch.size(), false);
+
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            if (isSuperseded[i]) {
+                continue;
+            }
+
+            const auto& update = batch[i];
+
+            // saving, numbering, and broadcasting the update under the lock of its order book keeps it in order with the snapshots
+            auto bookLock = lockOrderBook(update.getType());
+            if (bookLock.owns_lock()) {
+                const auto seqNum = saveOrderBookUpdateNoLock(update);
+                broadcastSingleUpdateToAll(update, seqNum);
+            }
         }
 
-        broadcastSingleUpdateToAll(m_obeBuff.front());
-        m_obeBuff.pop();
+        batch.clear(); // keeps its capacity for the next swap
     } // while
 }
 
@@ -80,11 +124,17 @@ void OrderBook::spawn()
 
 /**
  * @brief Record the target ID that subscribes to this order book and send a copy of the order book to it.
+ *        Both happen under the order book locks, so that the target receives exactly the updates following its snapshots.
  */
 void OrderBook::onSubscribeOrderBook(const std::string& targetID)
 {
-    broadcastWholeOrderBookToOne(targetID);
+    std::lock_guard<std::mutex> guard_B(m_mtxGlobalBidOrderBook);
+    std::lock_guard<std::mutex> guard_A(m_mtxGlobalAskOrderBook);
+    std::lock_guard<std::mutex> guard_b(m_mtxLocalBidOrderBook);
+    std::lock_guard<std::mutex> guard_a(m_mtxLocalAskOrderBook);
+
     registerTarget(targetID);
+    sendWholeOrderBookNoLock({ targetID });
 }
 
 /**
@@ -96,105 +146,99 @@ void OrderBook::onUnsubscribeOrderBook(const std::string& targetID)
 }
 
 /**
- * @brief Thread-safely sends complete order books to one user user.
+ * @brief Thread-safely sends complete order books to one user, e.g. when it detected a gap in the updates.
  */
 void OrderBook::broadcastWholeOrderBookToOne(const std::string& targetID)
 {
-    const std::vector<std::string> targetList { targetID };
-
     std::lock_guard<std::mutex> guard_B(m_mtxGlobalBidOrderBook);
     std::lock_guard<std::mutex> guard_A(m_mtxGlobalAskOrderBook);
     std::lock_guard<std::mutex> guard_b(m_mtxLocalBidOrderBook);
     std::lock_guard<std::mutex> guard_a(m_mtxLocalAskOrderBook);
 
-    if (!m_globalBidOrderBook.empty()) {
-        FIXAcceptor::s_sendOrderBook(targetList, m_globalBidOrderBook);
-    }
-    if (!m_globalAskOrderBook.empty()) {
-        FIXAcceptor::s_sendOrderBook(targetList, m_globalAskOrderBook);
-    }
-    if (!m_localBidOrderBook.empty()) {
-        FIXAcceptor::s_sendOrderBook(targetList, m_localBidOrderBook);
-    }
-    if (!m_localAskOrderBook.empty()) {
-        FIXAcceptor::s_sendOrderBook(targetList, m_localAskOrderBook);
-    }
+    sendWholeOrderBookNoLock({ targetID });
 }
 
 /**
- * @brief Thread-safely sends complete order books to all targets.
+ * @brief Sends the snapshots of all 4 order books, even empty ones, with the sequence number of their last update.
+ *        The caller must hold the locks of all 4 order books.
  */
-void OrderBook::broadcastWholeOrderBookToAll()
+void OrderBook::sendWholeOrderBookNoLock(const std::vector<std::string>& targetList) const
 {
-    auto targetList = getTargetList();
-    if (targetList.empty()) {
-        return;
-    }
-
-    std::lock_guard<std::mutex> guard_B(m_mtxGlobalBidOrderBook);
-    std::lock_guard<std::mutex> guard_A(m_mtxGlobalAskOrderBook);
-    std::lock_guard<std::mutex> guard_b(m_mtxLocalBidOrderBook);
-    std::lock_guard<std::mutex> guard_a(m_mtxLocalAskOrderBook);
-
-    if (!m_globalBidOrderBook.empty()) {
-        FIXAcceptor::s_sendOrderBook(targetList, m_globalBidOrderBook);
-    }
-    if (!m_globalAskOrderBook.empty()) {
-        FIXAcceptor::s_sendOrderBook(targetList, m_globalAskOrderBook);
-    }
-    if (!m_localBidOrderBook.empty()) {
-        FIXAcceptor::s_sendOrderBook(targetList, m_localBidOrderBook);
-    }
-    if (!m_localAskOrderBook.empty()) {
-        FIXAcceptor::s_sendOrderBook(targetList, m_localAskOrderBook);
-    }
+    FIXAcceptor::s_sendOrderBook(targetList, m_symbol, OrderBookEntry::Type::GLB_BID, m_globalBidOrderBook, m_globalBidSeqNum);
+    FIXAcceptor::s_sendOrderBook(targetList, m_symbol, OrderBookEntry::Type::GLB_ASK, m_globalAskOrderBook, m_globalAskSeqNum);
+    FIXAcceptor::s_sendOrderBook(targetList, m_symbol, OrderBookEntry::Type::LOC_BID, m_localBidOrderBook, m_localBidSeqNum);
+    FIXAcceptor::s_sendOrderBook(targetList, m_symbol, OrderBookEntry::Type::LOC_ASK, m_localAskOrderBook, m_localAskSeqNum);
 }
 
 /**
- * @brief Thread-safely sends an order book's single update to all targets.
+ * @brief Sends an order book's single update to all targets.
+ *        The caller must hold the lock of the order book of the update.
  * @param update The order book update record to be sent.
+ * @param seqNum The sequence number of the update in its order book.
  */
-void OrderBook::broadcastSingleUpdateToAll(const OrderBookEntry& update)
+void OrderBook::broadcastSingleUpdateToAll(const OrderBookEntry& update, unsigned int seqNum)
 {
     auto targetList = getTargetList();
     if (targetList.empty()) {
         return;
     }
 
+    FIXAcceptor::s_sendOrderBookUpdate(targetList, update, seqNum);
+}
+
+/**
+ * @brief Locks the order book of the given type.
+ * @return The lock, which owns no mutex if the type is not an order book type.
+ */
+auto OrderBook::lockOrderBook(OrderBookEntry::Type type) const -> std::unique_lock<std::mutex>
+{
     using ulock_t = std::unique_lock<std::mutex>;
-    ulock_t lock;
 
-    switch (update.getType()) {
-    case OrderBookEntry::Type::GLB_BID: {
-        lock = ulock_t(m_mtxGlobalBidOrderBook);
-        break;
-    }
-    case OrderBookEntry::Type::GLB_ASK: {
-        lock = ulock_t(m_mtxGlobalAskOrderBook);
-        break;
-    }
-    case OrderBookEntry::Type::LOC_BID: {
-        lock = ulock_t(m_mtxLocalBidOrderBook);
-        break;
-    }
-    case OrderBookEntry::Type::LOC_ASK: {
-        lock = ulock_t(m_mtxLocalAskOrderBook);
-        break;
-    }
+    switch (type) {
+    case OrderBookEntry::Type::GLB_BID:
+        return ulock_t(m_mtxGlobalBidOrderBook);
+    case OrderBookEntry::Type::GLB_ASK:
+        return ulock_t(m_mtxGlobalAskOrderBook);
+    case OrderBookEntry::Type::LOC_BID:
+        return ulock_t(m_mtxLocalBidOrderBook);
+    case OrderBookEntry::Type::LOC_ASK:
+        return ulock_t(m_mtxLocalAskOrderBook);
     default:
-        return;
+        return ulock_t();
     }
+}
 
-    FIXAcceptor::s_sendOrderBookUpdate(targetList, update);
+/**
+ * @brief Saves the OrderBookEntry item correspondingly with respect to its order book type.
+ *        The caller must hold the lock of that order book.
+ * @return The sequence number of the update in its order book.
+ */
+auto OrderBook::saveOrderBookUpdateNoLock(const OrderBookEntry& update) -> unsigned int
+{
+    switch (update.getType()) {
+    case OrderBookEntry::Type::GLB_BID:
+        saveGlobalBidOrderBookUpdateNoLock(update);
+        return ++m_globalBidSeqNum;
+    case OrderBookEntry::Type::GLB_ASK:
+        saveGlobalAskOrderBookUpdateNoLock(update);
+        return ++m_globalAskSeqNum;
+    case OrderBookEntry::Type::LOC_BID:
+        saveLocalBidOrderBookUpdateNoLock(update);
+        return ++m_localBidSeqNum;
+    case OrderBookEntry::Type::LOC_ASK:
+        saveLocalAskOrderBookUpdateNoLock(update);
+        return ++m_localAskSeqNum;
+    default:
+        return 0;
+    }
 }
 
 /**
- * @brief Thread-safely saves the latest order book entry to global bid order book, as the ceiling of all hitherto bid prices.
+ * @brief Saves the latest order book entry to global bid order book, as the ceiling of all hitherto bid prices.
  */
-void OrderBook::saveGlobalBidOrderBookUpdate(const OrderBookEntry& update)
+void OrderBook::saveGlobalBidOrderBookUpdateNoLock(const OrderBookEntry& update)
 {
     double price = update.getPrice();
-    std::lock_guard<std::mutex> guard(m_mtxGlobalBidOrderBook);
 
     // price <= 0.0 means clear the order book
     if (price <= 0.0) {
@@ -209,12 +253,11 @@ void OrderBook::saveGlobalBidOrderBookUpdate(const OrderBookEntry& update)
 }
 
 /**
- * @brief Thread-safely saves the latest order book entry to global ask order book, as the bottom of all hitherto ask prices.
+ * @brief Saves the latest order book entry to global ask order book, as the bottom of all hitherto ask prices.
  */
-void OrderBook::saveGlobalAskOrderBookUpdate(const OrderBookEntry& update)
+void OrderBook::saveGlobalAskOrderBookUpdateNoLock(const OrderBookEntry& update)
 {
     double price = update.getPrice();
-    std::lock_guard<std::mutex> guard(m_mtxGlobalAskOrderBook);
 
     // price <= 0.0 means clear the order book
     if (price <= 0.0) {
@@ -228,10 +271,9 @@ void OrderBook::saveGlobalAskOrderBookUpdate(const OrderBookEntry& update)
     m_globalAskOrderBook.erase(m_globalAskOrderBook.begin(), m_globalAskOrderBook.lower_bound(price));
 }
 
-/* static */ void OrderBook::s_saveLocalOrderBookUpdate(const OrderBookEntry& update, std::mutex& mtxLocalOrderBookk, std::map<double, std::map<std::string, OrderBookEntry>>& localOrderBook)
+/* static */ void OrderBook::s_saveLocalOrderBookUpdateNoLock(const OrderBookEntry& update, std::map<double, std::map<std::string, OrderBookEntry>>& localOrderBook)
 {
     double price = update.getPrice();
-    std::lock_guard<std::mutex> guard(mtxLocalOrderBookk);
 
     // price <= 0.0 means clear the order book
     if (price <= 0.0) {
@@ -250,21 +292,21 @@ void OrderBook::saveGlobalAskOrderBookUpdate(const OrderBookEntry& update)
 }
 
 /**
- * @brief Thread-safely saves order book entry to local bid order book at specific price.
+ * @brief Saves order book entry to local bid order book at specific price.
  * @param update The order book entry to be saved.
  */
-inline void OrderBook::saveLocalBidOrderBookUpdate(const OrderBookEntry& update)
+inline void OrderBook::saveLocalBidOrderBookUpdateNoLock(const OrderBookEntry& update)
 {
-    s_saveLocalOrderBookUpdate(update, m_mtxLocalBidOrderBook, m_localBidOrderBook);
+    s_saveLocalOrderBookUpdateNoLock(update, m_localBidOrderBook);
 }
 
 /**
- * @brief Thread-safely saves order book entry to local ask order book at specific price.
+ * @brief Saves order book entry to local ask order book at specific price.
  * @param update The order book entry to be saved.
  */
-inline void OrderBook::saveLocalAskOrderBookUpdate(const OrderBookEntry& update)
+inline void OrderBook::saveLocalAskOrderBookUpdateNoLock(const OrderBookEntry& update)
 {
-    s_saveLocalOrderBookUpdate(update, m_mtxLocalAskOrderBook, m_localAskOrderBook);
+    s_saveLocalOrderBookUpdateNoLock(update, m_localAskOrderBook);
 }
 
 auto OrderBook::getGlobalBidOrderBookFirstPrice() const -> double
@@ -7,7 +7,6 @@
 
 #include <cmath>
 
-#include <shift/miscutils/concurrency/Consumer.h>
 #include <shift/miscutils/terminal/Common.h>
 
 /* static */ inline void RiskManagement::s_sendOrderToMatchingEngine(const Order& order)
@@ -27,6 +26,9 @@
 
 RiskManagement::RiskManagement(const std::string& userID, double buyingPower)
     : m_userID(userID)
+    , m_scheduler(nullptr)
+    , m_workerIndex(0)
+    , m_isScheduled(false)
     , m_porfolioSummary(buyingPower)
     , m_pendingShortCashAmount(0.0)
 {
@@ -38,6 +40,9 @@ RiskManagement::RiskManagement(const std::string& userID, double buyingPower)
 
 RiskManagement::RiskManagement(const std::string& userID, double buyingPower, double holdingBalance, double borrowedBalance, double totalPL, int totalShares)
     : m_userID(userID)
+    , m_scheduler(nullptr)
+    , m_workerIndex(0)
+    , m_isScheduled(false)
     , m_porfolioSummary(buyingPower, holdingBalance, borrowedBalance, totalPL, totalShares)
     , m_pendingShortCashAmount(0.0)
 {
@@ -49,16 +54,29 @@ RiskManagement::RiskManagement(const std::string& userID, double buyingPower, do
 
 RiskManagement::~RiskManagement()
 {
-    shift::concurrency::notifyConsumerThreadToQuit(m_quitFlagExec, m_cvExecRpt, *m_execRptThread);
-    m_execRptThread = nullptr;
-    shift::concurrency::notifyConsumerThreadToQuit(m_quitFlagOrder, m_cvOrder, *m_orderThread);
-    m_orderThread = nullptr;
+    if (m_scheduler) {
+        m_scheduler->unschedule(this);
+    }
+}
+
+void RiskManagement::attachToScheduler(RiskManagementScheduler& scheduler)
+{
+    m_workerIndex = scheduler.getWorkerIndex(m_userID);
+    m_scheduler = &scheduler;
+
+    if (hasPendingMessages()) {
+        scheduleIfIdle();
+    }
 }
 
-void RiskManagement::spawn()
+/**
+ * @brief Put this user in the run-queue of its worker, unless it is there already or being processed.
+ */
+void RiskManagement::scheduleIfIdle()
 {
-    m_orderThread = std::make_unique<std::thread>(&RiskManagement::processOrder, this);
-    m_execRptThread = std::make_unique<std::thread>(&RiskManagement::processExecRpt, this);
+    if (m_scheduler && !m_isScheduled.exchange(true)) {
+        m_scheduler->schedule(this);
+    }
 }
 
 /* static */ inline auto RiskManagement::s_getMarketBuyPrice(const std::string& symbol) -> double
@@ -100,7 +118,7 @@ void RiskManagement::updateWaitingList(const ExecutionReport& report)
 
     auto& order = it->second;
     order.setExecutedSize(order.getExecutedSize() + report.executedSize);
-    if (order.getExecutedSize() == order.getSize()) {
+    if (order.getExecutedSize() == order.getSize() || report.orderStatus == Order::Status::REJECTED) {
         m_waitingList.erase(it);
     } else {
         if (report.orderStatus == Order::Status::CANCELED) {
@@ -125,49 +143,45 @@ void RiskManagement::enqueueOrder(Order&& order)
         std::lock_guard<std::mutex> guard(m_mtxOrder);
         m_orderBuffer.push(std::move(order));
     }
-    m_cvOrder.notify_one();
+    scheduleIfIdle();
 }
 
-void RiskManagement::processOrder()
+auto RiskManagement::processNextOrder() -> bool
 {
-    thread_local auto quitFut = m_quitFlagOrder.get_future();
-
-    while (true) {
-        std::unique_lock<std::mutex> lock(m_mtxOrder);
-        if (shift::concurrency::quitOrContinueConsumerThread(quitFut, m_cvOrder, lock, [this] { return !m_orderBuffer.empty(); })) {
-            return;
-        }
-
-        auto* orderPtr = &m_orderBuffer.front();
+    std::unique_lock<std::mutex> lockBuffer(m_mtxOrder);
+    if (m_orderBuffer.empty()) {
+        return false;
+    }
+    Order order = std::move(m_orderBuffer.front());
+    m_orderBuffer.pop();
+    lockBuffer.unlock();
 
-        if (m_portfolioItems.find(orderPtr->getSymbol()) == m_portfolioItems.end()) { // add new portfolio item ?
-            insertPortfolioItem(orderPtr->getSymbol(), orderPtr->getSymbol());
+    if (m_portfolioItems.find(order.getSymbol()) == m_portfolioItems.end()) { // add new portfolio item ?
+        insertPortfolioItem(order.getSymbol(), order.getSymbol());
 
-            if (!DBConnector::s_isPortfolioDBReadOnly) {
-                auto lock { DBConnector::getInstance().lockPSQL() };
-                DBConnector::getInstance().doQuery("INSERT INTO portfolio_items (id, symbol) VALUES ('" + m_userID + "','" + orderPtr->getSymbol() + "');", "");
-            }
+        if (!DBConnector::s_isPortfolioDBReadOnly) {
+            auto lock { DBConnector::getInstance().lockPSQL() };
+            DBConnector::getInstance().doQuery("INSERT INTO portfolio_items (id, symbol) VALUES ('" + m_userID + "','" + order.getSymbol() + "');", "");
         }
+    }
 
-        if (verifyAndSendOrder(*orderPtr)) {
-            // buying power may have been updated after call to verifyAndSendOrder
-            {
-                std::lock_guard<std::mutex> psGuard(m_mtxPortfolioSummary);
-                s_sendPortfolioSummaryToUser(m_userID, m_porfolioSummary);
-            }
+    if (verifyAndSendOrder(order)) {
+        // buying power may have been updated after call to verifyAndSendOrder
+        {
+            std::lock_guard<std::mutex> psGuard(m_mtxPortfolioSummary);
+            s_sendPortfolioSummaryToUser(m_userID, m_porfolioSummary);
+        }
 
-            {
-                std::lock_guard<std::mutex> guard(m_mtxWaitingList);
-                if (orderPtr->getType() != Order::Type::CANCEL_BID && orderPtr->getType() != Order::Type::CANCEL_ASK) {
-                    m_waitingList[orderPtr->getID()] = *orderPtr;
-                }
+        {
+            std::lock_guard<std::mutex> guard(m_mtxWaitingList);
+            if (order.getType() != Order::Type::CANCEL_BID && order.getType() != Order::Type::CANCEL_ASK) {
+                m_waitingList[order.getID()] = order;
             }
-            sendWaitingList();
         }
-
-        orderPtr = nullptr;
-        m_orderBuffer.pop();
+        sendWaitingList();
     }
+
+    return true;
 }
 
 void RiskManagement::enqueueExecRpt(ExecutionReport&& report)
@@ -176,248 +190,287 @@ void RiskManagement::enqueueExecRpt(ExecutionReport&& report)
         std::lock_guard<std::mutex> guard(m_mtxExecRpt);
         m_execRptBuffer.push(std::move(report));
     }
-    m_cvExecRpt.notify_one();
+    scheduleIfIdle();
 }
 
-void RiskManagement::processExecRpt()
+auto RiskManagement::processNextExecRpt() -> bool
 {
-    thread_local auto quitFut = m_quitFlagExec.get_future();
+    std::unique_lock<std::mutex> lockBuffer(m_mtxExecRpt);
+    if (m_execRptBuffer.empty()) {
+        return false;
+    }
+    ExecutionReport report = std::move(m_execRptBuffer.front());
+    m_execRptBuffer.pop();
+    lockBuffer.unlock();
 
-    while (true) {
-        std::unique_lock<std::mutex> lock(m_mtxExecRpt);
-        if (shift::concurrency::quitOrContinueConsumerThread(quitFut, m_cvExecRpt, lock, [this] { return !m_execRptBuffer.empty(); })) {
-            return;
-        }
+    // if it is not a confirmation report
+    if (report.orderStatus != Order::Status::NEW && report.orderStatus != Order::Status::PENDING_CANCEL) {
+
+        if (report.orderStatus == Order::Status::REJECTED) { // order discarded by the matching engine
+            releaseRejectedOrder(report);
 
-        auto* reportPtr = &m_execRptBuffer.front();
+        } else if (report.orderStatus == Order::Status::FILLED) { // execution report
 
-        // if it is not a confirmation report
-        if (reportPtr->orderStatus != Order::Status::NEW && reportPtr->orderStatus != Order::Status::PENDING_CANCEL) {
+            if (report.orderType == Order::Type::MARKET_BUY || report.orderType == Order::Type::LIMIT_BUY) {
 
-            if (reportPtr->orderStatus == Order::Status::FILLED) { // execution report
+                std::lock_guard<std::mutex> psGuard(m_mtxPortfolioSummary);
+                std::lock_guard<std::mutex> piGuard(m_mtxPortfolioItems);
+                std::lock_guard<std::mutex> qpGuard(m_mtxOrderProcessing);
 
-                if (reportPtr->orderType == Order::Type::MARKET_BUY || reportPtr->orderType == Order::Type::LIMIT_BUY) {
+                auto& item = m_portfolioItems[report.orderSymbol];
 
-                    std::lock_guard<std::mutex> psGuard(m_mtxPortfolioSummary);
-                    std::lock_guard<std::mutex> piGuard(m_mtxPortfolioItems);
-                    std::lock_guard<std::mutex> qpGuard(m_mtxOrderProcessing);
+                const double price = report.orderPrice; // NP
+                const int buyShares = report.executedSize * 100; // NS
 
-                    auto& item = m_portfolioItems[reportPtr->orderSymbol];
+                double inc = 0.0;
 
-                    const double price = reportPtr->orderPrice; // NP
-                    const int buyShares = reportPtr->executedSize * 100; // NS
+                if (item.getShortShares() == 0) { // no current short positions
+                    item.addLongPrice(price, buyShares);
+                    item.addLongShares(buyShares);
+                } else {
+                    if (buyShares > item.getShortShares()) {
+                        inc = (item.getShortPrice() - price) * item.getShortShares(); // (OP - NP) * OS
 
-                    double inc = 0.0;
+                        // all short positions are "consumed" and withholded money is returned
+                        m_porfolioSummary.returnBalance(item.getBorrowedBalance());
+                        item.resetBorrowedBalance();
 
-                    if (item.getShortShares() == 0) { // no current short positions
-                        item.addLongPrice(price, buyShares);
-                        item.addLongShares(buyShares);
+                        int rem = buyShares - item.getShortShares();
+                        item.addLongPrice(price, rem);
+                        item.addLongShares(rem);
+                        item.resetShortShares();
+                        item.resetShortPrice();
                     } else {
-                        if (buyShares > item.getShortShares()) {
-                            inc = (item.getShortPrice() - price) * item.getShortShares(); // (OP - NP) * OS
+                        inc = (item.getShortPrice() - price) * buyShares; // (OP - NP) * NS
 
-                            // all short positions are "consumed" and withholded money is returned
-                            m_porfolioSummary.returnBalance(item.getBorrowedBalance());
-                            item.resetBorrowedBalance();
+                        // some short positions are "consumed" and part of withheld money is returned
+                        double ret = item.getBorrowedBalance() * (double(buyShares) / double(item.getShortShares()));
+                        ret = std::floor(ret * std::pow(10, 2)) / std::pow(10, 2);
+                        m_porfolioSummary.returnBalance(ret);
+                        item.addBorrowedBalance(-ret);
 
-                            int rem = buyShares - item.getShortShares();
-                            item.addLongPrice(price, rem);
-                            item.addLongShares(rem);
-                            item.resetShortShares();
+                        item.addShortShares(-buyShares);
+                        if (item.getShortShares() == 0) {
                             item.resetShortPrice();
-                        } else {
-                            inc = (item.getShortPrice() - price) * buyShares; // (OP - NP) * NS
-
-                            // some short positions are "consumed" and part of withheld money is returned
-                            double ret = item.getBorrowedBalance() * (double(buyShares) / double(item.getShortShares()));
-                            ret = std::floor(ret * std::pow(10, 2)) / std::pow(10, 2);
-                            m_porfolioSummary.returnBalance(ret);
-                            item.addBorrowedBalance(-ret);
-
-                            item.addShortShares(-buyShares);
-                            if (item.getShortShares() == 0) {
-                                item.resetShortPrice();
-                            }
                         }
                     }
+                }
 
-                    // the user must pay for the share that were bought
-                    m_porfolioSummary.addBuyingPower(-buyShares * price);
-                    // but pending transaction price is returned (also updating total holding balance)
-                    m_porfolioSummary.releaseBalance(m_pendingBidOrders[reportPtr->orderID].getPrice() * buyShares);
+                // the user must pay for the share that were bought
+                m_porfolioSummary.addBuyingPower(-buyShares * price);
+                // but pending transaction price is returned (also updating total holding balance)
+                m_porfolioSummary.releaseBalance(m_pendingBidOrders[report.orderID].getPrice() * buyShares);
 
-                    m_pendingBidOrders[reportPtr->orderID].setSize(m_pendingBidOrders[reportPtr->orderID].getSize() - (buyShares / 100));
-                    reportPtr->currentSize = m_pendingBidOrders[reportPtr->orderID].getSize();
+                m_pendingBidOrders[report.orderID].setSize(m_pendingBidOrders[report.orderID].getSize() - (buyShares / 100));
+                report.currentSize = m_pendingBidOrders[report.orderID].getSize();
 
-                    if (m_pendingBidOrders[reportPtr->orderID].getSize() == 0) { // if pending transaction is completely fulfilled
-                        m_pendingBidOrders.erase(reportPtr->orderID); // it can be deleted
-                    } else {
-                        reportPtr->orderStatus = Order::Status::PARTIALLY_FILLED;
-                    }
+                if (m_pendingBidOrders[report.orderID].getSize() == 0) { // if pending transaction is completely fulfilled
+                    m_pendingBidOrders.erase(report.orderID); // it can be deleted
+                } else {
+                    report.orderStatus = Order::Status::PARTIALLY_FILLED;
+                }
 
-                    item.addPL(inc); // update instrument P&L
-                    m_porfolioSummary.addTotalPL(inc); // update portfolio P&L
-                    m_porfolioSummary.addTotalShares(buyShares); // update total trade shares
+                item.addPL(inc); // update instrument P&L
+                m_porfolioSummary.addTotalPL(inc); // update portfolio P&L
+                m_porfolioSummary.addTotalShares(buyShares); // update total trade shares
 
-                } else if (reportPtr->orderType == Order::Type::MARKET_SELL || reportPtr->orderType == Order::Type::LIMIT_SELL) {
+            } else if (report.orderType == Order::Type::MARKET_SELL || report.orderType == Order::Type::LIMIT_SELL) {
 
-                    std::lock_guard<std::mutex> psGuard(m_mtxPortfolioSummary);
-                    std::lock_guard<std::mutex> piGuard(m_mtxPortfolioItems);
-                    std::lock_guard<std::mutex> qpGuard(m_mtxOrderProcessing);
+                std::lock_guard<std::mutex> psGuard(m_mtxPortfolioSummary);
+                std::lock_guard<std::mutex> piGuard(m_mtxPortfolioItems);
+                std::lock_guard<std::mutex> qpGuard(m_mtxOrderProcessing);
 
-                    auto& item = m_portfolioItems[reportPtr->orderSymbol];
+                auto& item = m_portfolioItems[report.orderSymbol];
 
-                    const double price = reportPtr->orderPrice; // NP
-                    const int sellShares = reportPtr->executedSize * 100; // NS
+                const double price = report.orderPrice; // NP
+                const int sellShares = report.executedSize * 100; // NS
 
-                    double inc = 0.0;
+                double inc = 0.0;
 
-                    if (m_pendingAskOrders[reportPtr->orderID].second == 0) { // no long shares were reserved for this order
-                        m_porfolioSummary.borrowBalance(price * sellShares); // all shares need to be borrowed
-                        item.addBorrowedBalance(price * sellShares);
-                        m_pendingShortCashAmount -= m_pendingAskOrders[reportPtr->orderID].first.getPrice() * sellShares;
+                if (m_pendingAskOrders[report.orderID].second == 0) { // no long shares were reserved for this order
+                    m_porfolioSummary.borrowBalance(price * sellShares); // all shares need to be borrowed
+                    item.addBorrowedBalance(price * sellShares);
+                    m_pendingShortCashAmount -= m_pendingAskOrders[report.orderID].first.getPrice() * sellShares;
 
-                        item.addShortPrice(price, sellShares);
-                        item.addShortShares(sellShares);
-                    } else {
-                        if (sellShares < m_pendingAskOrders[reportPtr->orderID].second) { // if enough shares were previously reserved
-                            inc = (price - item.getLongPrice()) * sellShares; // (NP - OP) * NS
-
-                            // update buying power for selling shares
-                            m_porfolioSummary.addBuyingPower(sellShares * price);
-
-                            item.addLongShares(-sellShares);
-                            if (item.getLongShares() == 0) {
-                                item.resetLongPrice();
-                            }
-
-                            m_pendingShortUnitAmount[reportPtr->orderSymbol] -= sellShares;
-                            m_pendingAskOrders[reportPtr->orderID].second -= sellShares; // update reservation of shares of this transaction
-                        } else {
-                            inc = (price - item.getLongPrice()) * m_pendingAskOrders[reportPtr->orderID].second; // (NP - OP) * OS
-
-                            // update buying power for selling long shares
-                            m_porfolioSummary.addBuyingPower(m_pendingAskOrders[reportPtr->orderID].second * price);
-
-                            int rem = sellShares - m_pendingAskOrders[reportPtr->orderID].second;
-                            m_porfolioSummary.borrowBalance(price * rem); // the remainder of the shares need to be borrowed
-                            item.addBorrowedBalance(price * rem);
-                            m_pendingShortCashAmount -= m_pendingAskOrders[reportPtr->orderID].first.getPrice() * rem;
-
-                            item.addShortPrice(price, rem);
-                            item.addShortShares(rem);
-                            item.addLongShares(-m_pendingAskOrders[reportPtr->orderID].second);
-                            if (item.getLongShares() == 0) {
-                                item.resetLongPrice();
-                            }
-
-                            m_pendingShortUnitAmount[reportPtr->orderSymbol] -= m_pendingAskOrders[reportPtr->orderID].second;
-                            m_pendingAskOrders[reportPtr->orderID].second = 0; // all reserved shares of this transactions were already used
-                        }
-                    }
+                    item.addShortPrice(price, sellShares);
+                    item.addShortShares(sellShares);
+                } else {
+                    if (sellShares < m_pendingAskOrders[report.orderID].second) { // if enough shares were previously reserved
+                        inc = (price - item.getLongPrice()) * sellShares; // (NP - OP) * NS
+
+                        // update buying power for selling shares
+                        m_porfolioSummary.addBuyingPower(sellShares * price);
 
-                    m_pendingAskOrders[reportPtr->orderID].first.setSize(m_pendingAskOrders[reportPtr->orderID].first.getSize() - (sellShares / 100));
-                    reportPtr->currentSize = m_pendingAskOrders[reportPtr->orderID].first.getSize();
+                        item.addLongShares(-sellShares);
+                        if (item.getLongShares() == 0) {
+                            item.resetLongPrice();
+                        }
 
-                    if (m_pendingAskOrders[reportPtr->orderID].first.getSize() == 0) { // if pending transaction is completely fulfilled
-                        m_pendingAskOrders.erase(reportPtr->orderID); // it can be deleted
+                        m_pendingShortUnitAmount[report.orderSymbol] -= sellShares;
+                        m_pendingAskOrders[report.orderID].second -= sellShares; // update reservation of shares of this transaction
                     } else {
-                        reportPtr->orderStatus = Order::Status::PARTIALLY_FILLED;
+                        inc = (price - item.getLongPrice()) * m_pendingAskOrders[report.orderID].second; // (NP - OP) * OS
+
+                        // update buying power for selling long shares
+                        m_porfolioSummary.addBuyingPower(m_pendingAskOrders[report.orderID].second * price);
+
+                        int rem = sellShares - m_pendingAskOrders[report.orderID].second;
+                        m_porfolioSummary.borrowBalance(price * rem); // the remainder of the shares need to be borrowed
+                        item.addBorrowedBalance(price * rem);
+                        m_pendingShortCashAmount -= m_pendingAskOrders[report.orderID].first.getPrice() * rem;
+
+                        item.addShortPrice(price, rem);
+                        item.addShortShares(rem);
+                        item.addLongShares(-m_pendingAskOrders[report.orderID].second);
+                        if (item.getLongShares() == 0) {
+                            item.resetLongPrice();
+                        }
+
+                        m_pendingShortUnitAmount[report.orderSymbol] -= m_pendingAskOrders[report.orderID].second;
+                        m_pendingAskOrders[report.orderID].second = 0; // all reserved shares of this transactions were already used
                     }
+                }
 
-                    item.addPL(inc); // update instrument P&L
-                    m_porfolioSummary.addTotalPL(inc); // update portfolio P&L
-                    m_porfolioSummary.addTotalShares(sellShares); // update total trade shares
+                m_pendingAskOrders[report.orderID].first.setSize(m_pendingAskOrders[report.orderID].first.getSize() - (sellShares / 100));
+                report.currentSize = m_pendingAskOrders[report.orderID].first.getSize();
+
+                if (m_pendingAskOrders[report.orderID].first.getSize() == 0) { // if pending transaction is completely fulfilled
+                    m_pendingAskOrders.erase(report.orderID); // it can be deleted
+                } else {
+                    report.orderStatus = Order::Status::PARTIALLY_FILLED;
                 }
 
-            } else if (reportPtr->orderStatus == Order::Status::CANCELED) { // cancellation report
+                item.addPL(inc); // update instrument P&L
+                m_porfolioSummary.addTotalPL(inc); // update portfolio P&L
+                m_porfolioSummary.addTotalShares(sellShares); // update total trade shares
+            }
 
-                std::lock_guard<std::mutex> psGuard(m_mtxPortfolioSummary);
-                std::lock_guard<std::mutex> qpGuard(m_mtxOrderProcessing);
+        } else if (report.orderStatus == Order::Status::CANCELED) { // cancellation report
 
-                const int cancelShares = reportPtr->executedSize * 100;
+            std::lock_guard<std::mutex> psGuard(m_mtxPortfolioSummary);
+            std::lock_guard<std::mutex> qpGuard(m_mtxOrderProcessing);
 
-                if (reportPtr->orderType == Order::Type::CANCEL_BID) {
-                    // pending transaction price is returned
-                    m_porfolioSummary.releaseBalance(m_pendingBidOrders[reportPtr->orderID].getPrice() * cancelShares);
+            const int cancelShares = report.executedSize * 100;
 
-                    m_pendingBidOrders[reportPtr->orderID].setSize(m_pendingBidOrders[reportPtr->orderID].getSize() - (cancelShares / 100));
+            if (report.orderType == Order::Type::CANCEL_BID) {
+                // pending transaction price is returned
+                m_porfolioSummary.releaseBalance(m_pendingBidOrders[report.orderID].getPrice() * cancelShares);
 
-                    if (m_pendingBidOrders[reportPtr->orderID].getSize() == 0) { // if pending transaction is completely cancelled
-                        m_pendingBidOrders.erase(reportPtr->orderID); // it can be deleted
-                    }
-                } else if (reportPtr->orderType == Order::Type::CANCEL_ASK) {
-                    const int shortShares = m_pendingAskOrders[reportPtr->orderID].first.getSize() * 100 - m_pendingAskOrders[reportPtr->orderID].second;
+                m_pendingBidOrders[report.orderID].setSize(m_pendingBidOrders[report.orderID].getSize() - (cancelShares / 100));
 
-                    if (cancelShares < shortShares) {
-                        m_pendingShortCashAmount -= m_pendingAskOrders[reportPtr->orderID].first.getPrice() * cancelShares;
-                    } else {
-                        m_pendingShortCashAmount -= m_pendingAskOrders[reportPtr->orderID].first.getPrice() * shortShares;
-                        m_pendingShortUnitAmount[reportPtr->orderSymbol] -= (cancelShares - shortShares);
-                        m_pendingAskOrders[reportPtr->orderID].second -= (cancelShares - shortShares);
-                    }
+                if (m_pendingBidOrders[report.orderID].getSize() == 0) { // if pending transaction is completely cancelled
+                    m_pendingBidOrders.erase(report.orderID); // it can be deleted
+                }
+            } else if (report.orderType == Order::Type::CANCEL_ASK) {
+                const int shortShares = m_pendingAskOrders[report.orderID].first.getSize() * 100 - m_pendingAskOrders[report.orderID].second;
+
+                if (cancelShares < shortShares) {
+                    m_pendingShortCashAmount -= m_pendingAskOrders[report.orderID].first.getPrice() * cancelShares;
+                } else {
+                    m_pendingShortCashAmount -= m_pendingAskOrders[report.orderID].first.getPrice() * shortShares;
+                    m_pendingShortUnitAmount[report.orderSymbol] -= (cancelShares - shortShares);
+                    m_pendingAskOrders[report.orderID].second -= (cancelShares - shortShares);
+                }
 
-                    m_pendingAskOrders[reportPtr->orderID].first.setSize(m_pendingAskOrders[reportPtr->orderID].first.getSize() - (cancelShares / 100));
+                m_pendingAskOrders[report.orderID].first.setSize(m_pendingAskOrders[report.orderID].first.getSize() - (cancelShares / 100));
 
-                    if (m_pendingAskOrders[reportPtr->orderID].first.getSize() == 0) { // if pending transaction is completely cancelled
-                        m_pendingAskOrders.erase(reportPtr->orderID); // it can be deleted
-                    }
+                if (m_pendingAskOrders[report.orderID].first.getSize() == 0) { // if pending transaction is completely cancelled
+                    m_pendingAskOrders.erase(report.orderID); // it can be deleted
                 }
             }
+        }
 
-            bool wasPortfolioSent = false; // to postpone DB writes until lock guards are released
-            {
-                std::lock_guard<std::mutex> psGuard(m_mtxPortfolioSummary);
-                std::lock_guard<std::mutex> piGuard(m_mtxPortfolioItems);
+        bool wasPortfolioSent = false; // to postpone DB writes until lock guards are released
+        {
+            std::lock_guard<std::mutex> psGuard(m_mtxPortfolioSummary);
+            std::lock_guard<std::mutex> piGuard(m_mtxPortfolioItems);
 
-                s_sendPortfolioSummaryToUser(m_userID, m_porfolioSummary);
-                s_sendPortfolioItemToUser(m_userID, m_portfolioItems[reportPtr->orderSymbol]);
+            s_sendPortfolioSummaryToUser(m_userID, m_porfolioSummary);
+            s_sendPortfolioItemToUser(m_userID, m_portfolioItems[report.orderSymbol]);
 
-                wasPortfolioSent = true;
-            }
-            if (!DBConnector::s_isPortfolioDBReadOnly && wasPortfolioSent) {
-                const auto& item = m_portfolioItems[reportPtr->orderSymbol];
-                auto lock { DBConnector::getInstance().lockPSQL() };
-
-                DBConnector::getInstance().doQuery(
-                    "UPDATE portfolio_items" // presume that we have got the user's uuid already in it
-                    "\n"
-                    "SET borrowed_balance = "
-                        + std::to_string(item.getBorrowedBalance())
-                        + ", pl = " + std::to_string(item.getPL())
-                        + ", long_price = " + std::to_string(item.getLongPrice())
-                        + ", short_price = " + std::to_string(item.getShortPrice())
-                        + ", long_shares = " + std::to_string(item.getLongShares())
-                        + ", short_shares = " + std::to_string(item.getShortShares())
-                        + "\n" // PK == (id, symbol):
-                          "WHERE symbol = '"
-                        + reportPtr->orderSymbol + "' AND id = '"
-                        + m_userID + "';",
-                    COLOR_WARNING "WARNING: UPDATE portfolio_items failed for user [" + m_userID + "]!\n" NO_COLOR);
-
-                DBConnector::getInstance().doQuery(
-                    "UPDATE portfolio_summary" // presume that we have got the user's uuid already in it
-                    "\n"
-                    "SET buying_power = "
-                        + std::to_string(m_porfolioSummary.getBuyingPower())
-                        + ", holding_balance = " + std::to_string(m_porfolioSummary.getHoldingBalance())
-                        + ", borrowed_balance = " + std::to_string(m_porfolioSummary.getBorrowedBalance())
-                        + ", total_pl = " + std::to_string(m_porfolioSummary.getTotalPL())
-                        + ", total_shares = " + std::to_string(m_porfolioSummary.getTotalShares())
-                        + "\n" // PK == id:
-                          "WHERE id = '"
-                        + m_userID + "';",
-                    COLOR_WARNING "WARNING: UPDATE portfolio_summary failed for user [" + m_userID + "]!\n" NO_COLOR);
-            }
+            wasPortfolioSent = true;
         }
+        if (!DBConnector::s_isPortfolioDBReadOnly && wasPortfolioSent) {
+            const auto& item = m_portfolioItems[report.orderSymbol];
+            auto lock { DBConnector::getInstance().lockPSQL() };
+
+            DBConnector::getInstance().doQuery(
+                "UPDATE portfolio_items" // presume that we have got the user's uuid already in it
+                "\n"
+                "SET borrowed_balance = "
+                    + std::to_string(item.getBorrowedBalance())
+                    + ", pl = " + std::to_string(item.getPL())
+                    + ", long_price = " + std::to_string(item.getLongPrice())
+                    + ", short_price = " + std::to_string(item.getShortPrice())
+                    + ", long_shares = " + std::to_string(item.getLongShares())
+                    + ", short_shares = " + std::to_string(item.getShortShares())
+                    + "\n" // PK == (id, symbol):
+                      "WHERE symbol = '"
+                    + report.orderSymbol + "' AND id = '"
+                    + m_userID + "';",
+                COLOR_WARNING "WARNING: UPDATE portfolio_items failed for user [" + m_userID + "]!\n" NO_COLOR);
+
+            DBConnector::getInstance().doQuery(
+                "UPDATE portfolio_summary" // presume that we have got the user's uuid already in it
+                "\n"
+                "SET buying_power = "
+                    + std::to_string(m_porfolioSummary.getBuyingPower())
+                    + ", holding_balance = " + std::to_string(m_porfolioSummary.getHoldingBalance())
+                    + ", borrowed_balance = " + std::to_string(m_porfolioSummary.getBorrowedBalance())
+                    + ", total_pl = " + std::to_string(m_porfolioSummary.getTotalPL())
+                    + ", total_shares = " + std::to_string(m_porfolioSummary.getTotalShares())
+                    + "\n" // PK == id:
+                      "WHERE id = '"
+                    + m_userID + "';",
+                COLOR_WARNING "WARNING: UPDATE portfolio_summary failed for user [" + m_userID + "]!\n" NO_COLOR);
+        }
+    }
 
-        updateWaitingList(*reportPtr);
-        sendWaitingList();
-        FIXAcceptor::s_sendConfirmationReport(*reportPtr);
+    updateWaitingList(report);
+    sendWaitingList();
+    FIXAcceptor::s_sendConfirmationReport(report);
+
+    return true;
+}
+
+/**
+ * @brief Give back everything verifyAndSendOrder() reserved for an order which never reached its market.
+ */
+void RiskManagement::releaseRejectedOrder(const ExecutionReport& report)
+{
+    std::lock_guard<std::mutex> psGuard(m_mtxPortfolioSummary);
+    std::lock_guard<std::mutex> qpGuard(m_mtxOrderProcessing);
+
+    if (report.orderType == Order::Type::LIMIT_BUY || report.orderType == Order::Type::MARKET_BUY) {
+        auto it = m_pendingBidOrders.find(report.orderID);
+        if (it != m_pendingBidOrders.end()) {
+            m_porfolioSummary.releaseBalance(it->second.getPrice() * it->second.getSize() * 100);
+            m_pendingBidOrders.erase(it);
+        }
+    } else if (report.orderType == Order::Type::LIMIT_SELL || report.orderType == Order::Type::MARKET_SELL) {
+        auto it = m_pendingAskOrders.find(report.orderID);
+        if (it != m_pendingAskOrders.end()) {
+            const auto& [order, reservedShares] = it->second;
+            const int shortShares = order.getSize() * 100 - reservedShares;
+
+            m_pendingShortCashAmount -= order.getPrice() * shortShares;
+            m_pendingShortUnitAmount[report.orderSymbol] -= reservedShares;
+            m_pendingAskOrders.erase(it);
+        }
+    }
+}
+
+auto RiskManagement::hasPendingMessages() const -> bool
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mtxExecRpt);
+        if (!m_execRptBuffer.empty()) {
+            return true;
+        }
+    }
 
-        reportPtr = nullptr;
-        m_execRptBuffer.pop();
-    } // while
+    std::lock_guard<std::mutex> guard(m_mtxOrder);
+    return !m_orderBuffer.empty();
 }
 
 auto RiskManagement::verifyAndSendOrder(const Order& order) -> bool
@@ -0,0 +1,100 @@
+#include "RiskManagementScheduler.h"
+
+#include "Parameters.h"
+#include "RiskManagement.h"
+
+#include <algorithm>
+#include <functional>
+
+#include <shift/miscutils/concurrency/Consumer.h>
+
+RiskManagementScheduler::RiskManagementScheduler(unsigned int numWorkers)
+{
+    if (0 == numWorkers) {
+        numWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned int i = 0; i < numWorkers; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (auto& worker : m_workers) {
+        worker->thread = std::thread(&RiskManagementScheduler::processRunQueue, this, worker.get());
+    }
+}
+
+RiskManagementScheduler::~RiskManagementScheduler()
+{
+    for (auto& worker : m_workers) {
+        shift::concurrency::notifyConsumerThreadToQuit(worker->quitFlag, worker->cvRunQueue, worker->thread);
+    }
+}
+
+auto RiskManagementScheduler::getNumWorkers() const -> unsigned int
+{
+    return m_workers.size();
+}
+
+auto RiskManagementScheduler::getWorkerIndex(const std::string& userID) const -> unsigned int
+{
+    return std::hash<std::string> {}(userID) % m_workers.size();
+}
+
+void RiskManagementScheduler::schedule(RiskManagement* riskManagement)
+{
+    auto& worker = *m_workers[riskManagement->m_workerIndex];
+    {
+        std::lock_guard<std::mutex> guard(worker.mtxRunQueue);
+        worker.runQueue.push_back(riskManagement);
+    }
+    worker.cvRunQueue.notify_one();
+}
+
+void RiskManagementScheduler::unschedule(RiskManagement* riskManagement)
+{
+    auto& worker = *m_workers[riskManagement->m_workerIndex];
+
+    std::unique_lock<std::mutex> lock(worker.mtxRunQueue);
+    worker.runQueue.erase(std::remove(worker.runQueue.begin(), worker.runQueue.end(), riskManagement), worker.runQueue.end());
+    worker.cvDone.wait(lock, [&worker, riskManagement] { return worker.running != riskManagement; });
+}
+
+/**
+ * @brief Function to start one worker, for worker thread.
+ */
+void RiskManagementScheduler::processRunQueue(Worker* worker)
+{
+    auto quitFut = worker->quitFlag.get_future();
+
+    while (true) {
+        std::unique_lock<std::mutex> lock(worker->mtxRunQueue);
+        if (shift::concurrency::quitOrContinueConsumerThread(quitFut, worker->cvRunQueue, lock, [worker] { return !worker->runQueue.empty(); })) {
+            return;
+        }
+
+        auto* riskManagement = worker->runQueue.front();
+        worker->runQueue.pop_front();
+        worker->running = riskManagement;
+        lock.unlock();
+
+        // a bounded number of messages per user and per turn, so that a busy user cannot starve the others of the same worker
+        for (int i = 0; i < ::RISK_MANAGEMENT_BATCH_SIZE; ++i) {
+            const bool hasProcessedExecRpt = riskManagement->processNextExecRpt();
+            const bool hasProcessedOrder = riskManagement->processNextOrder();
+            if (!hasProcessedExecRpt && !hasProcessedOrder) {
+                break;
+            }
+        }
+
+        // messages enqueued from now on schedule the user again: check for the ones that were enqueued in the meantime
+        riskManagement->m_isScheduled = false;
+        const bool isRescheduled = riskManagement->hasPendingMessages() && !riskManagement->m_isScheduled.exchange(true);
+
+        lock.lock();
+        worker->running = nullptr;
+        if (isRescheduled) {
+            worker->runQueue.push_back(riskManagement); // at the back: other users of this worker get their turn first
+        }
+        lock.unlock();
+        worker->cvDone.notify_all();
+    }
+}
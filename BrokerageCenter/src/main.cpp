@@ -4,7 +4,6 @@
 #include "FIXInitiator.h"
 
 #include <algorithm>
-#include <atomic>
 #if __has_include(<filesystem>)
 #include <filesystem>
 #else
@@ -37,6 +36,10 @@
     "reset"
 #define CSTR_PFDBREADONLY \
     "readonlyportfolio"
+#define CSTR_DURABILITY \
+    "durability"
+#define CSTR_FLUSH_INTERVAL \
+    "flushinterval"
 #define CSTR_TIMEOUT \
     "timeout"
 #define CSTR_VERBOSE \
@@ -57,18 +60,20 @@ namespace po = boost::program_options;
 /* 'using' is the same as 'typedef' */
 using voh_t = shift::terminal::VerboseOptHelper;
 
-static std::atomic<bool> s_isBroadcasting { true };
-
 /*
- * @brief Function to broadcast order books, for broadcast order book thread.
+ * @brief Print the throughput and lag of saving the trading records.
  */
-static void s_broadcastOrderBooks()
+static void s_printTradingRecordsStats()
 {
-    while (::s_isBroadcasting) {
-        // broadcast the full order book of every stock every BROADCAST_ORDERBOOK_PERIOD (forcing a refresh in the client side)
-        std::this_thread::sleep_for(::BROADCAST_ORDERBOOK_PERIOD);
-        BCDocuments::getInstance().broadcastOrderBooks();
-    }
+    const auto stats = DBConnector::getInstance().getTradingRecordsStats();
+    cout << "Trading records: "
+         << stats.numQueued << " queued, "
+         << stats.numWritten << " saved, "
+         << stats.numFailed << " failed, "
+         << stats.queueSize << " waiting; "
+         << stats.recordsPerSecond << " records/s; last flush: "
+         << stats.lastFlushLag.count() << " us lag, "
+         << stats.lastFlushDuration.count() << " us duration" << endl;
 }
 
 auto main(int argc, char** argv) -> int
@@ -137,6 +142,8 @@ auto main(int argc, char** argv) -> int
         (CSTR_FBA ",f", "Matching Engine is using frequent batch auctions") //
         (CSTR_RESET ",r", "reset client portfolios and trading records") //
         (CSTR_PFDBREADONLY ",o", "is portfolio data in DB read-only") //
+        (CSTR_DURABILITY ",d", po::value<std::string>(), "when trading records are saved: \"batched\" (default), \"immediate\", or \"synchronous\" (waits for each record to be saved)") //
+        (CSTR_FLUSH_INTERVAL, po::value<std::chrono::milliseconds::rep>(), "maximum time, in milliseconds, before batched trading records are saved") //
         (CSTR_TIMEOUT ",t", po::value<decltype(params.timer)::min_t>(), "timeout duration counted in minutes. If not provided, user should terminate server with the terminal.") //
         (CSTR_VERBOSE ",v", "verbose mode that dumps detailed server information") //
         (CSTR_USERNAME ",u", po::value<std::string>(), "name of the new user") //
@@ -230,6 +237,25 @@ auto main(int argc, char** argv) -> int
 
     DBConnector::s_isPortfolioDBReadOnly = vm.count(CSTR_PFDBREADONLY) > 0;
 
+    if (vm.count(CSTR_DURABILITY) > 0) {
+        const auto durability = vm[CSTR_DURABILITY].as<std::string>();
+        if ("batched" == durability) {
+            DBConnector::s_tradingRecordsDurability = DBConnector::RECORDS_DURABILITY::BATCHED;
+        } else if ("immediate" == durability) {
+            DBConnector::s_tradingRecordsDurability = DBConnector::RECORDS_DURABILITY::IMMEDIATE;
+        } else if ("synchronous" == durability) {
+            DBConnector::s_tradingRecordsDurability = DBConnector::RECORDS_DURABILITY::SYNCHRONOUS;
+        } else {
+            cout << COLOR_ERROR "ERROR: Unknown trading records durability mode: " << durability << NO_COLOR << '\n'
+                 << endl;
+            return 9;
+        }
+    }
+
+    if (vm.count(CSTR_FLUSH_INTERVAL) > 0) {
+        DBConnector::s_tradingRecordsFlushInterval = std::chrono::milliseconds(std::max<std::chrono::milliseconds::rep>(0, vm[CSTR_FLUSH_INTERVAL].as<std::chrono::milliseconds::rep>()));
+    }
+
     DBConnector::getInstance().init(params.cryptoKey, params.configDir + CSTR_DBLOGIN_TXT);
 
     while (true) {
@@ -309,6 +335,11 @@ auto main(int argc, char** argv) -> int
         }
     }
 
+    // trading records are saved in background, before anything can trade
+    if (!DBConnector::getInstance().startTradingRecordsWriter()) {
+        return 10;
+    }
+
     // try to connect to Matching Engine
     FIXInitiator::getInstance().s_isFBA = params.isFBA;
     FIXInitiator::getInstance().connectMatchingEngine(params.configDir + "initiator.cfg", params.isVerbose, params.cryptoKey, params.configDir + CSTR_DBLOGIN_TXT);
@@ -321,12 +352,6 @@ auto main(int argc, char** argv) -> int
     // try to connect to clients
     FIXAcceptor::getInstance().connectClients(params.configDir + "acceptor.cfg", params.isVerbose, params.cryptoKey, params.configDir + CSTR_DBLOGIN_TXT);
 
-    // create a broadcaster to broadcast all order books
-    std::thread broadcaster;
-    if (!params.isFBA) {
-        broadcaster = std::thread(&::s_broadcastOrderBooks);
-    }
-
     // create 'done' file in ~/.shift/BrokerageCenter to signalize shell that service is done loading
     // (directory is also created if it does not exist)
     const char* homeDir = nullptr;
@@ -359,7 +384,7 @@ auto main(int argc, char** argv) -> int
                 while (true) {
                     cout.clear();
                     cout << '\n'
-                         << COLOR_PROMPT "The BrokerageCenter is running. (Enter 'T' to stop)" NO_COLOR << '\n'
+                         << COLOR_PROMPT "The BrokerageCenter is running. (Enter 'T' to stop, 'S' for trading records statistics)" NO_COLOR << '\n'
                          << endl;
                     voh_t { cout, params.isVerbose, true };
 
@@ -368,22 +393,26 @@ auto main(int argc, char** argv) -> int
                     if ('T' == cmd || 't' == cmd) {
                         return;
                     }
+                    if ('S' == cmd || 's' == cmd) {
+                        cout.clear();
+                        ::s_printTradingRecordsStats();
+                    }
                 }
             })
             .get(); // this_thread will wait for user terminating acceptor.
     }
 
     // close program
-    if (!params.isFBA) {
-        ::s_isBroadcasting = false; // to terminate broadcaster
-        if (broadcaster.joinable()) {
-            broadcaster.join(); // wait for termination
-        }
-    }
-
     FIXAcceptor::getInstance().disconnectClients();
     FIXInitiator::getInstance().disconnectMatchingEngine();
 
+    // save the trading records still queued
+    DBConnector::getInstance().stopTradingRecordsWriter();
+    if (params.isVerbose) {
+        cout.clear();
+        ::s_printTradingRecordsStats();
+    }
+
     if (params.isVerbose) {
         cout.clear();
         cout << "\nExecution finished. \nPlease press enter to close window: " << flush;
@@ -30,6 +30,7 @@
 #include <quickfix/fix50sp2/News.h>
 #include <quickfix/fix50sp2/Quote.h>
 
+class RawDataTimeConverter;
 class RequestsProcessorPerTarget;
 struct RawData;
 
@@ -59,6 +60,8 @@ private:
     FIXAcceptor(const FIXAcceptor&) = delete; // forbid copying
     auto operator=(const FIXAcceptor&) -> FIXAcceptor& = delete; // forbid assigning
 
+    static void sendRawDataBatches(const std::string& targetID, const std::vector<RawData>& rawData, RawDataTimeConverter* pTimeConverter);
+
     // QuickFIX methods
     void onCreate(const FIX::SessionID&) override;
     void onLogon(const FIX::SessionID&) override;
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include <libpq-fe.h>
 
@@ -15,6 +18,7 @@
 
 void cvtRICToDEInternalRepresentation(std::string* pCvtThis, bool reverse = false /*otherwise, from internal to RIC*/);
 
+struct RawData;
 struct TradingRecord;
 
 /**
@@ -22,7 +26,28 @@ struct TradingRecord;
  */
 class PSQL {
 public:
-    static auto s_getUpdateReutersTimeOrder(const std::string& currReutersTime, std::string* pLastRTime, int* pLastRTimeOrder) -> std::string;
+    /**
+     * @brief A connection checked out of the connection pool, for the exclusive use of the current thread.
+     *        It is returned to the pool when destroyed.
+     */
+    class PooledConnection {
+    public:
+        PooledConnection(PSQL* pPSQL = nullptr, PGconn* pConn = nullptr);
+        PooledConnection(PooledConnection&& other) noexcept;
+        ~PooledConnection();
+
+        PooledConnection(const PooledConnection&) = delete; // forbid copying
+        auto operator=(const PooledConnection&) -> PooledConnection& = delete; // forbid assigning
+
+        auto get() const -> PGconn*;
+        explicit operator bool() const;
+
+    private:
+        PSQL* m_pPSQL;
+        PGconn* m_pConn;
+    };
+
+    static auto s_getUpdateReutersTimeOrder(std::string_view currReutersTime, std::string* pLastRTime, int* pLastRTimeOrder) -> std::string;
 
     static auto s_createTableName(const std::string& symbol, const std::string& yyyymmdd) -> std::string;
 
@@ -40,6 +65,12 @@ public:
     /* @brief Test connection to database. */
     auto isConnected() const -> bool;
 
+    /* @brief Check out a connection from the pool, waiting if all of them are in use (evaluates to false if connecting failed). */
+    auto checkoutConnection() -> PooledConnection;
+
+    /* @brief Maximum number of pooled connections. */
+    auto getConnectionPoolSize() const -> int;
+
     /* @brief Close connection to database. */
     void disconnectDB();
 
@@ -55,23 +86,44 @@ public:
     /* @brief Create new table of Trade & Quote data for one kind of RIC. */
     auto createTableOfTradeAndQuoteRecords(std::string tableName) -> bool;
 
-    /* @brief Read .csv records data file and insert them into table created by createTableOfTradeAndQuoteRecords(). */
+    /* @brief Stream .csv records data file into table created by createTableOfTradeAndQuoteRecords(), using COPY on a dedicated connection. */
     auto insertTradeAndQuoteRecords(std::string csvName, std::string tableName) -> bool;
 
-    /* @brief Fetch chunk of Trade & Quote records from database and sends them to matching engine via FIXAcceptor. */
+    /* @brief Fetch chunk of Trade & Quote records from the tick cache or database and sends them to matching engine via FIXAcceptor. */
     auto readSendRawData(std::string targetID, std::string symbol, boost::posix_time::ptime startTime, boost::posix_time::ptime endTime) -> bool;
 
     /* @brief Convertor from CSV data to database records. */
     auto saveCSVIntoDB(std::string csvName, std::string symbol, std::string date) -> bool;
 
 protected:
-    PSQL(std::unordered_map<std::string, std::string>&& loginInfo);
+    PSQL(std::unordered_map<std::string, std::string>&& loginInfo, int connectionPoolSize);
     virtual ~PSQL() = 0; // PSQL becomes an abstract class, hence forces users to access it via PSQLManager
 
 private:
+    /* @brief Test connection to database (m_mtxPSQL must be held). */
+    auto isConnectedNoLock() const -> bool;
+
+    /* @brief Open a new connection to database (nullptr if it failed). */
+    auto createConnection() -> PGconn*;
+
+    /* @brief Return a checked out connection to the pool. */
+    void checkinConnection(PGconn* pConn);
+
+    /* @brief Decode Trade & Quote records of a time range of a table from a binary query. */
+    auto queryRawData(PGconn* pConn, const std::string& tableName, const char* stime, const char* etime, std::vector<RawData>* pRawData) -> bool;
+
+    /* @brief Stream all Trade & Quote records of a table into its tick cache file, through a cursor. */
+    auto cacheRawData(PGconn* pConn, const std::string& tableName) -> bool;
+
     mutable std::mutex m_mtxPSQL; // to mutual-exclusively access db
     PGconn* m_pConn;
     std::unordered_map<std::string, std::string> m_loginInfo;
+
+    const int m_connectionPoolSize;
+    std::mutex m_mtxPool; // guards the pool below
+    std::condition_variable m_cvPool; // for connections returned to the pool
+    std::vector<PGconn*> m_idleConnections;
+    int m_numConnections; // idle + checked out
 };
 
 /**
@@ -79,11 +131,11 @@ private:
  */
 class PSQLManager final : public PSQL {
 public:
-    static auto createInstance(std::unordered_map<std::string, std::string>&& loginInfo) -> PSQLManager&;
+    static auto createInstance(std::unordered_map<std::string, std::string>&& loginInfo, int connectionPoolSize) -> PSQLManager&;
     static auto getInstance() -> PSQLManager&;
 
 private:
-    PSQLManager(std::unordered_map<std::string, std::string>&& loginInfo); // singleton pattern
+    PSQLManager(std::unordered_map<std::string, std::string>&& loginInfo, int connectionPoolSize); // singleton pattern
     PSQLManager(const PSQLManager&) = delete; // forbid copying
     auto operator=(const PSQLManager&) -> PSQLManager& = delete; // forbid assigning
 
@@ -1,3 +1,15 @@
 #pragma once
 
 static constexpr auto FIX_SESSION_DURATION = 12 * 60 * 60; // 12 hours
+
+static constexpr auto DB_CONNECTION_POOL_SIZE = 8; // default maximum number of pooled database connections
+
+static constexpr auto TRTH_NUM_DOWNLOAD_WORKERS = 4; // TRTH requests processed (downloaded) in parallel
+static constexpr auto TRTH_MAX_PARALLEL_SAVES = 2; // downloads saved into database in parallel (each uses a pooled connection)
+
+static constexpr auto CSV_READ_BLOCK_SIZE = 1 << 20; // bytes read from a TRTH CSV file at once
+static constexpr auto PSQL_COPY_BUFFER_SIZE = 1 << 20; // bytes of COPY data sent to the database at once
+
+static constexpr auto TICK_CACHE_FETCH_SIZE = 1 << 16; // records fetched at once when a table is materialized into the tick cache
+
+static constexpr auto RAW_DATA_BATCH_SIZE = 1024; // ticks sent to the matching engine in one message (0: one Quote message per tick)
@@ -1,30 +1,23 @@
 #pragma once
 
-#include <string>
-
-#include <quickfix/FieldTypes.h>
+#include <cstdint>
 
 /**
  * @brief Data structure for carrying Trade or Quote data between database and FIX components.
- *        Shall always use C++ standard types.
+ *        It is a compact POD record (no heap allocation per tick), decoded straight from binary query results.
  */
 struct RawData {
-    std::string symbol; // or RIC
-    std::string reutersDate;
-    std::string reutersTime;
-    std::string toq; // trade or quote
-    std::string exchangeID;
+    char symbol[16]; // or RIC, VARCHAR(15)
+    char toq; // trade or quote
+    char exchangeID[11]; // VARCHAR(10)
+    char buyerID[11]; // VARCHAR(10)
+    char sellerID[11]; // VARCHAR(10)
     double price;
     int volume;
-    std::string buyerID;
     double bidPrice;
     int bidSize;
-    std::string sellerID;
     double askPrice;
     int askSize;
-    std::string exchangeTime;
-    std::string quoteTime;
-    std::string recordID;
-    int secs; // seconds since 1970/01/01
-    double microsecs; // microseconds of the day
+    std::int64_t secs; // seconds since 1970/01/01 (of the reuters date)
+    std::int64_t microsecs; // microseconds of the day (of the reuters time)
 };
@@ -3,16 +3,14 @@
 #include "TRTHRequest.h"
 
 #include <condition_variable>
+#include <deque>
 #include <future>
-#include <memory>
 #include <mutex>
-#include <queue>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
 
-#define GZ_BUF_LEN (1024 * 10)
-
 /**
  * @brief TRTH 3rd-party SOAP API wrapper and utilities. It is a singleton.
  */
@@ -28,6 +26,9 @@ public:
     void start();
     void stop();
 
+    /* @brief Serve downloads from <directory>/<symbol><YYYY-MM-DD>.csv[.gz] files instead of TRTH (e.g. for testing). */
+    void setLocalDataDirectory(std::string directory);
+
     void enqueueRequest(TRTHRequest req); // date format: YYYY-MM-DD
 
     void addUnavailableRequest(const TRTHRequest& req);
@@ -39,22 +40,35 @@ private:
     auto operator=(const TRTHAPI&) -> TRTHAPI& = delete; // forbid assigning
 
     void processRequests();
+    void processRequest(TRTHRequest& req);
+
+    auto downloadAsCSV(const std::string& symbol, const std::string& requestDate, std::string* pFileName, bool* pIsTemporary) -> int; // date format: YYYY-MM-DD
+    auto findLocalData(const std::string& symbol, const std::string& requestDate, std::string* pFileName) const -> int;
 
-    auto downloadAsCSV(const std::string& symbol, const std::string& requestDate) -> int; // date format: YYYY-MM-DD
+    void beginSaving();
+    void endSaving();
 
     static TRTHAPI* s_pInst;
 
     const std::string m_key;
     const std::string m_cfgDir;
 
-    std::queue<TRTHRequest> m_requests; ///> Queue for storing received TRTH downloading requests.
+    std::string m_localDataDir; ///> If not empty, the local stand-in for TRTH downloads.
+
+    std::deque<TRTHRequest> m_requests; ///> Queue for storing received TRTH downloading requests.
+    std::set<std::string> m_requestsInProgress; ///> Symbols and dates being processed, so that duplicated requests wait for them.
     std::vector<TRTHRequest> m_requestsUnavailable; ///> Memorizes unavailable/unrecognizable symbols/RICs.
 
-    std::unique_ptr<std::thread> m_reqProcessorPtr; ///> Pointer to the unique Requests Processor.
-    std::promise<void> m_reqProcQuitFlag; ///> To terminate the Requests Processor.
+    std::vector<std::thread> m_reqProcessors; ///> The Requests Processors (download workers).
+    std::promise<void> m_reqProcQuitFlag; ///> To terminate the Requests Processors.
+    std::shared_future<void> m_reqProcQuitFut;
 
     mutable std::mutex m_mtxReqs; ///> One per target; for guarding requests queue.
     std::condition_variable m_cvReqs; ///> For events of requests queue.
 
+    std::mutex m_mtxSaving; ///> For limiting the number of files saved into database at the same time.
+    std::condition_variable m_cvSaving;
+    int m_numSaving = 0;
+
     mutable std::mutex m_mtxReqsUnavail; ///> One per target; for guarding list of unavailable/unrecognizable requests.
 };
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "RawData.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief On-disk columnar copy of Trade & Quote tables, one file per table, so that replaying a date again bypasses the database.
+ *        Each column is a separate fixed-width array (IDs are dictionary-encoded), and files are memory-mapped when read.
+ */
+class TickCache {
+public:
+    /**
+     * @brief A read-only memory mapping of one cache file.
+     */
+    class MappedFile {
+    public:
+        MappedFile(const void* pData, std::size_t size);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete; // forbid copying
+        auto operator=(const MappedFile&) -> MappedFile& = delete; // forbid assigning
+
+        auto getNumRecords() const -> std::size_t;
+
+        /* @brief Decode records with (fromMicrosecs, toMicrosecs] microseconds of the day, found by binary search of the time column. */
+        void read(std::int64_t fromMicrosecs, std::int64_t toMicrosecs, std::vector<RawData>* pRecords) const;
+
+    private:
+        friend class TickCache;
+
+        auto isValid() const -> bool;
+
+        const void* m_pData;
+        std::size_t m_size;
+
+        std::size_t m_numRecords;
+        std::int64_t m_secs;
+        const std::int64_t* m_pMicrosecs;
+        const double* m_pPrice;
+        const double* m_pBidPrice;
+        const double* m_pAskPrice;
+        const std::int32_t* m_pVolume;
+        const std::int32_t* m_pBidSize;
+        const std::int32_t* m_pAskSize;
+        const std::uint16_t* m_pSymbol;
+        const std::uint16_t* m_pExchangeID;
+        const std::uint16_t* m_pBuyerID;
+        const std::uint16_t* m_pSellerID;
+        const char* m_pToq;
+        const char (*m_pStrings)[sizeof(RawData::symbol)];
+        std::size_t m_numStrings;
+        bool m_isValid;
+    };
+
+    /**
+     * @brief Writes the cache file of a table record by record, straight into a memory mapping of a temporary file,
+     *        so that the records of a whole table never have to be held in memory. The file replaces the cache file when finished.
+     */
+    class Writer {
+    public:
+        ~Writer(); // discards the temporary file, unless finish() succeeded
+
+        Writer(const Writer&) = delete; // forbid copying
+        auto operator=(const Writer&) -> Writer& = delete; // forbid assigning
+
+        /* @brief Add the next record, in (reuters_time, reuters_time_order) order (false if the table cannot be cached, e.g. it spans several dates). */
+        auto append(const RawData& record) -> bool;
+
+        /* @brief Complete the cache file, once the announced number of records was appended. */
+        auto finish() -> bool;
+
+    private:
+        friend class TickCache;
+
+        Writer(std::string filePath, std::size_t numRecords);
+
+        auto isValid() const -> bool;
+        auto encode(const char* id) -> std::uint16_t;
+        void discard();
+
+        const std::string m_filePath;
+        std::string m_tempPath;
+        int m_fd;
+        void* m_pData;
+        std::size_t m_mappedSize;
+
+        const std::size_t m_numRecords;
+        std::size_t m_numAppended;
+        std::int64_t m_secs;
+        std::int64_t* m_pMicrosecs;
+        double* m_pPrice;
+        double* m_pBidPrice;
+        double* m_pAskPrice;
+        std::int32_t* m_pVolume;
+        std::int32_t* m_pBidSize;
+        std::int32_t* m_pAskSize;
+        std::uint16_t* m_pSymbol;
+        std::uint16_t* m_pExchangeID;
+        std::uint16_t* m_pBuyerID;
+        std::uint16_t* m_pSellerID;
+        char* m_pToq;
+
+        // IDs repeat a lot (a handful of venues and brokers), hence each distinct string is stored once
+        std::vector<std::string> m_strings;
+        std::unordered_map<std::string, std::uint16_t> m_stringIndices;
+        bool m_isValid;
+    };
+
+    static auto getInstance() -> TickCache&;
+
+    /* @brief Set the directory of cache files; the cache is disabled while it is empty. */
+    void setDirectory(std::string directory);
+    auto isEnabled() const -> bool;
+
+    /* @brief Mapping of a table's cache file (nullptr if the table was not cached yet). */
+    auto open(const std::string& tableName) -> std::shared_ptr<const MappedFile>;
+
+    /* @brief Start writing the cache file of a table with the given number of records (nullptr if the cache is disabled or the file cannot be created). */
+    auto createWriter(const std::string& tableName, std::size_t numRecords) -> std::unique_ptr<Writer>;
+
+    /* @brief Remember that a table could not be cached, so that its chunks are read from the database without trying again. */
+    void setUncacheable(const std::string& tableName);
+    auto isUncacheable(const std::string& tableName) const -> bool;
+
+    /* @brief Remove a table's cache file, e.g. because the table is going to be (re)built. */
+    void invalidate(const std::string& tableName);
+
+private:
+    TickCache() = default; // singleton pattern
+    TickCache(const TickCache&) = delete; // forbid copying
+    auto operator=(const TickCache&) -> TickCache& = delete; // forbid assigning
+
+    auto getFilePath(const std::string& tableName) const -> std::string;
+
+    mutable std::mutex m_mtxFiles; // guards the members below
+    std::string m_directory;
+    std::unordered_map<std::string, std::shared_ptr<const MappedFile>> m_files; // table name -> mapping
+    std::unordered_set<std::string> m_uncacheableTables;
+};
@@ -6,16 +6,18 @@
 #include "RequestsProcessorPerTarget.h"
 
 #include <atomic>
-#include <cassert>
+#include <cstdint>
+#include <ctime>
 #include <iomanip>
 #include <sstream>
 
 #include <quickfix/FieldConvertors.h>
 #include <quickfix/FieldTypes.h>
 
-#include <shift/miscutils/crossguid/Guid.h>
 #include <shift/miscutils/crypto/Decryptor.h>
 #include <shift/miscutils/fix/HelperFunctions.h>
+#include <shift/miscutils/fix/ThreadLocalFields.h>
+#include <shift/miscutils/fix/TickBatch.h>
 #include <shift/miscutils/terminal/Common.h>
 
 // predefined constant FIX message fields (to avoid recalculations):
@@ -171,12 +173,54 @@ void FIXAcceptor::disconnectMatchingEngine()
 }
 
 /**
- * @brief Sends trade or quote data to ME.
+ * @brief Converts raw data time (New York time, stored as if it were UTC) into microseconds since epoch in UTC.
+ *        The UTC offset only changes on whole hours (DST transitions), so it is looked up once per hour of data.
+ */
+class RawDataTimeConverter {
+public:
+    auto toUtcMicrosecs(const RawData& rd) -> std::int64_t
+    {
+        const std::time_t secs = rd.secs + rd.microsecs / 1'000'000;
+        const std::time_t hour = secs / 3600;
+
+        if (hour != m_hour) {
+            // tm is always in local time and gmtime_r transforms time_t in tm disregarding timezone,
+            // since it assumes time_t is always in UTC (ours is in New York time)
+            const std::time_t hourSecs = hour * 3600;
+            std::tm secs_tm {};
+            ::gmtime_r(&hourSecs, &secs_tm);
+
+            // a negative value of time->tm_isdst causes mktime to attempt to determine if DST was in effect --
+            // more information is available at: https://en.cppreference.com/w/cpp/chrono/c/mktime
+            secs_tm.tm_isdst = -1;
+            m_offsetSecs = std::mktime(&secs_tm) - hourSecs;
+            m_hour = hour;
+        }
+
+        return (secs + m_offsetSecs) * 1'000'000LL + rd.microsecs % 1'000'000;
+    }
+
+private:
+    std::time_t m_hour = -1;
+    std::time_t m_offsetSecs = 0;
+};
+
+/**
+ * @brief Sends trade or quote data to ME: packed into tick batches of RAW_DATA_BATCH_SIZE ticks, or one Quote message per tick.
  */
 /* static */ void FIXAcceptor::sendRawData(const std::string& targetID, const std::vector<RawData>& rawData)
 {
+    RawDataTimeConverter timeConverter;
+
+    if (::RAW_DATA_BATCH_SIZE > 0) {
+        sendRawDataBatches(targetID, rawData, &timeConverter);
+        return;
+    }
+
+    static std::atomic<std::uint64_t> s_nextQuoteID { 1 };
+
     for (const auto& rd : rawData) {
-        if (('T' == rd.toq.front()) && (rd.volume < 100)) {
+        if (('T' == rd.toq) && (rd.volume < 100)) {
             continue;
         }
 
@@ -188,28 +232,20 @@ void FIXAcceptor::disconnectMatchingEngine()
         header.setField(FIX::TargetCompID(targetID));
         header.setField(FIX::MsgType(FIX::MsgType_Quote));
 
-        // tm is always in local time and std::gmtime transforms time_t in tm disregarding timezone,
-        // since it assumes time_t is always in UTC (ours is in New York time)
-        std::time_t secs = rd.secs + static_cast<int>(rd.microsecs);
-        std::tm* secs_tm = std::gmtime(&secs);
-
-        // a negative value of time->tm_isdst causes mktime to attempt to determine if DST was in effect --
-        // more information is available at: https://en.cppreference.com/w/cpp/chrono/c/mktime
-        secs_tm->tm_isdst = -1;
-        std::time_t utcSecs = std::mktime(secs_tm);
-
-        int millisec = static_cast<int>((rd.microsecs - static_cast<int>(rd.microsecs)) * 1000000);
+        const auto utcMicrosecs = timeConverter.toUtcMicrosecs(rd);
+        const std::time_t utcSecs = utcMicrosecs / 1'000'000;
+        const int microsec = static_cast<int>(utcMicrosecs % 1'000'000);
 
-        message.setField(FIX::QuoteID(shift::crossguid::newGuid().str()));
-        message.setField(FIX::QuoteType(rd.toq.front() == 'Q' ? 0 : 1));
+        message.setField(FIX::QuoteID(std::to_string(s_nextQuoteID++)));
+        message.setField(FIX::QuoteType(rd.toq == 'Q' ? 0 : 1));
         message.setField(FIX::Symbol(rd.symbol));
-        message.setField(FIX::TransactTime(FIX::UtcTimeStamp(utcSecs, millisec, 6), 6));
+        message.setField(FIX::TransactTime(FIX::UtcTimeStamp(utcSecs, microsec, 6), 6));
 
         shift::fix::addFIXGroup<FIX50SP2::Quote::NoPartyIDs>(message,
             FIXFIELD_PARTYROLE_EXECUTION_VENUE,
-            'Q' == rd.toq.front() ? FIX::PartyID(rd.buyerID) : FIX::PartyID(rd.exchangeID));
+            'Q' == rd.toq ? FIX::PartyID(rd.buyerID) : FIX::PartyID(rd.exchangeID));
 
-        if ('Q' == rd.toq.front()) {
+        if ('Q' == rd.toq) {
             shift::fix::addFIXGroup<FIX50SP2::Quote::NoPartyIDs>(message,
                 FIXFIELD_PARTYROLE_EXECUTION_VENUE,
                 FIX::PartyID(rd.sellerID));
@@ -218,7 +254,7 @@ void FIXAcceptor::disconnectMatchingEngine()
             message.setField(FIX::OfferPx(rd.askPrice));
             message.setField(FIX::BidSize(rd.bidSize));
             message.setField(FIX::OfferSize(rd.askSize));
-        } else { // if ('T' == rd.toq.front())
+        } else { // if ('T' == rd.toq)
             message.setField(FIX::BidPx(FIXAcceptor::s_roundNearest(rd.price, 0.01)));
             message.setField(FIX::BidSize(rd.volume / 100)); // this is and *should be* an int division
         }
@@ -227,6 +263,74 @@ void FIXAcceptor::disconnectMatchingEngine()
     }
 }
 
+/**
+ * @brief Sends trade or quote data to ME as News messages carrying many ticks each, encoded by shift::fix::TickBatchWriter in the RawData field.
+ *        The ticks are the same as those of the Quote messages (small trades skipped, trade prices rounded to cents and sizes to round lots).
+ */
+/* static */ void FIXAcceptor::sendRawDataBatches(const std::string& targetID, const std::vector<RawData>& rawData, RawDataTimeConverter* pTimeConverter)
+{
+    static std::atomic<std::uint64_t> s_nextBatchID { 1 };
+    thread_local shift::fix::TickBatchWriter s_writer; // keeps its buffers across chunks
+
+    auto sendBatch = [&targetID]() {
+        FIX::Message message;
+
+        FIX::Header& header = message.getHeader();
+        header.setField(::FIXFIELD_BEGINSTRING_FIXT11);
+        header.setField(FIX::SenderCompID(FIXAcceptor::s_senderID));
+        header.setField(FIX::TargetCompID(targetID));
+        header.setField(FIX::MsgType(FIX::MsgType_News));
+
+        message.setField(FIX::Headline(std::to_string(s_nextBatchID++)));
+        shift::fix::addFIXGroup<FIX50SP2::News::NoLinesOfText>(message,
+            FIX::Text("TICKS"));
+        message.setField(FIX::RawDataLength(static_cast<int>(s_writer.getPayload().size())));
+        message.setField(FIX::RawData(s_writer.getPayload()));
+
+        FIX::Session::sendToTarget(message);
+    };
+
+    std::string_view batchSymbol;
+
+    for (const auto& rd : rawData) {
+        if (('T' == rd.toq) && (rd.volume < 100)) {
+            continue;
+        }
+
+        if (s_writer.getNumEntries() > 0 && (batchSymbol != rd.symbol || s_writer.getNumEntries() >= static_cast<std::size_t>(::RAW_DATA_BATCH_SIZE))) {
+            sendBatch();
+        }
+
+        if (0 == s_writer.getNumEntries()) {
+            batchSymbol = rd.symbol;
+            s_writer.reset(batchSymbol);
+        }
+
+        shift::fix::TickBatchEntry entry;
+        entry.toq = rd.toq;
+        entry.utcMicrosecs = pTimeConverter->toUtcMicrosecs(rd);
+
+        if ('Q' == rd.toq) {
+            entry.bidPrice = rd.bidPrice;
+            entry.bidSize = rd.bidSize;
+            entry.buyerID = rd.buyerID;
+            entry.askPrice = rd.askPrice;
+            entry.askSize = rd.askSize;
+            entry.sellerID = rd.sellerID;
+        } else { // if ('T' == rd.toq)
+            entry.bidPrice = FIXAcceptor::s_roundNearest(rd.price, 0.01);
+            entry.bidSize = rd.volume / 100; // this is and *should be* an int division
+            entry.buyerID = rd.exchangeID;
+        }
+
+        s_writer.add(entry);
+    }
+
+    if (s_writer.getNumEntries() > 0) {
+        sendBatch();
+    }
+}
+
 void FIXAcceptor::onCreate(const FIX::SessionID& sessionID) // override
 {
     cout << "FIX:Create - " << sessionID << endl;
@@ -271,65 +375,25 @@ void FIXAcceptor::onMessage(const FIX50SP2::SecurityList& message, const FIX::Se
     }
     lockRP.unlock();
 
-    static FIX::SecurityResponseID requestID;
-    static FIX::SecurityListID startTimeString;
-    static FIX::SecurityListRefID endTimeString;
-    static FIX::SecurityListDesc dataChunkPeriod;
-
-    static FIX50SP2::SecurityList::NoRelatedSym relatedSymGroup;
-    static FIX::Symbol symbol;
-
-    // #pragma GCC diagnostic ignored ....
-
-    FIX::SecurityResponseID* pRequestID = nullptr;
-    FIX::SecurityListID* pStartTimeString = nullptr;
-    FIX::SecurityListRefID* pEndTimeString = nullptr;
-    FIX::SecurityListDesc* pDataChunkPeriod = nullptr;
-
-    FIX50SP2::SecurityList::NoRelatedSym* pRelatedSymGroup = nullptr;
-    FIX::Symbol* pSymbol = nullptr;
-
-    static std::atomic<unsigned int> s_cntAtom { 0 };
-    unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
+    auto& [requestID, startTimeString, endTimeString, dataChunkPeriod, relatedSymGroup, relatedSymbol] = shift::fix::getThreadLocalFields<FIX50SP2::SecurityList, FIX::SecurityResponseID, FIX::SecurityListID, FIX::SecurityListRefID, FIX::SecurityListDesc, FIX50SP2::SecurityList::NoRelatedSym, FIX::Symbol>();
 
-    while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-    }
-
-    assert(s_cntAtom > 0);
-
-    if (0 == prevCnt) { // sequential case; optimized:
-        pRequestID = &requestID;
-        pStartTimeString = &startTimeString;
-        pEndTimeString = &endTimeString;
-        pDataChunkPeriod = &dataChunkPeriod;
-        pRelatedSymGroup = &relatedSymGroup;
-        pSymbol = &symbol;
-    } else { // > 1 threads; always safe way:
-        pRequestID = new decltype(requestID);
-        pStartTimeString = new decltype(startTimeString);
-        pEndTimeString = new decltype(endTimeString);
-        pDataChunkPeriod = new decltype(dataChunkPeriod);
-        pRelatedSymGroup = new decltype(relatedSymGroup);
-        pSymbol = new decltype(symbol);
-    }
-
-    message.getField(*pRequestID);
-    message.getField(*pStartTimeString);
-    message.getField(*pEndTimeString);
-    message.getField(*pDataChunkPeriod);
+    message.getField(requestID);
+    message.getField(startTimeString);
+    message.getField(endTimeString);
+    message.getField(dataChunkPeriod);
 
     cout << "Request info:" << '\n'
-         << pRequestID->getValue() << '\n'
-         << pStartTimeString->getValue() << '\n'
-         << pEndTimeString->getValue() << endl;
+         << requestID.getValue() << '\n'
+         << startTimeString.getValue() << '\n'
+         << endTimeString.getValue() << endl;
 
     std::vector<std::string> symbols;
 
     for (int i = 1; i <= numOfGroups.getValue(); ++i) {
-        message.getGroup(static_cast<unsigned int>(i), *pRelatedSymGroup);
-        pRelatedSymGroup->getField(*pSymbol);
+        message.getGroup(static_cast<unsigned int>(i), relatedSymGroup);
+        relatedSymGroup.getField(relatedSymbol);
 
-        std::string symbol = pSymbol->getValue();
+        std::string symbol = relatedSymbol.getValue();
         ::cvtRICToDEInternalRepresentation(&symbol);
 
         cout << i << ":\t" << symbol << endl;
@@ -337,26 +401,14 @@ void FIXAcceptor::onMessage(const FIX50SP2::SecurityList& message, const FIX::Se
     }
     cout << endl;
 
-    boost::posix_time::ptime startTime = boost::posix_time::from_iso_string(*pStartTimeString);
-    boost::posix_time::ptime endTime = boost::posix_time::from_iso_string(*pEndTimeString);
+    boost::posix_time::ptime startTime = boost::posix_time::from_iso_string(startTimeString);
+    boost::posix_time::ptime endTime = boost::posix_time::from_iso_string(endTimeString);
 
-    const int numSecondsPerDataChunk = std::stoi(pDataChunkPeriod->getValue());
+    const int numSecondsPerDataChunk = std::stoi(dataChunkPeriod.getValue());
 
     lockRP.lock();
-    m_requestsProcessorByTarget[targetID]->enqueueMarketDataRequest(std::move(*pRequestID), std::move(symbols), std::move(startTime), std::move(endTime), numSecondsPerDataChunk);
+    m_requestsProcessorByTarget[targetID]->enqueueMarketDataRequest(std::move(requestID), std::move(symbols), std::move(startTime), std::move(endTime), numSecondsPerDataChunk);
     lockRP.unlock();
-
-    if (0 != prevCnt) { // > 1 threads
-        delete pRequestID;
-        delete pStartTimeString;
-        delete pEndTimeString;
-        delete pDataChunkPeriod;
-        delete pRelatedSymGroup;
-        delete pSymbol;
-    }
-
-    s_cntAtom--;
-    assert(s_cntAtom >= 0);
 }
 
 /**
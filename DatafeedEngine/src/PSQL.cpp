@@ -1,14 +1,24 @@
 #include "PSQL.h"
 
 #include "FIXAcceptor.h"
+#include "Parameters.h"
 #include "RawData.h"
+#include "TickCache.h"
 
 #include <algorithm>
+#include <cfloat>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <iomanip>
+#include <type_traits>
 #include <vector>
 
+#include <zlib.h>
+
 #include <shift/miscutils/Common.h>
 #include <shift/miscutils/terminal/Common.h>
 
@@ -27,7 +37,7 @@ void cvtRICToDEInternalRepresentation(std::string* pCvtThis, bool reverse /* = f
  *          SELECT reuters_time, reuters_time_order
  *          FROM public.<a table name here>;
  */
-/* static */ auto PSQL::s_getUpdateReutersTimeOrder(const std::string& currReutersTime, std::string* pLastRTime, int* pLastRTimeOrder) -> std::string
+/* static */ auto PSQL::s_getUpdateReutersTimeOrder(std::string_view currReutersTime, std::string* pLastRTime, int* pLastRTimeOrder) -> std::string
 {
     if (currReutersTime.length() != pLastRTime->length() // Different size must implies different strings!
         /* Reuters time data are always in increasing order, usually with strides of some microseconds(10^-6s) to some milliseconds.
@@ -69,9 +79,11 @@ void cvtRICToDEInternalRepresentation(std::string* pCvtThis, bool reverse /* = f
  *       It shall always use data types in DBFIXDataCarrier.h to transit data from/to FIX-related parts.
  */
 
-PSQL::PSQL(std::unordered_map<std::string, std::string>&& loginInfo)
+PSQL::PSQL(std::unordered_map<std::string, std::string>&& loginInfo, int connectionPoolSize)
     : m_pConn { nullptr }
     , m_loginInfo { std::move(loginInfo) }
+    , m_connectionPoolSize { std::max(connectionPoolSize, 1) }
+    , m_numConnections { 0 }
 {
 }
 
@@ -98,31 +110,55 @@ auto PSQL::getLoginInfo() const -> const std::unordered_map<std::string, std::st
 }
 
 /**
- * @brief Establish connection to database.
+ * @brief Establish connection to database, unless it is established already.
+ *        Several threads may try at the same time (e.g. the TRTH request processors, while the database is down):
+ *        only the first of them reconnects, and a broken connection is closed before.
  */
 auto PSQL::connectDB() -> bool
+{
+    auto lock { lockPSQL() };
+
+    if (isConnectedNoLock()) {
+        return true;
+    }
+
+    if (nullptr != m_pConn) {
+        PQfinish(m_pConn);
+    }
+
+    m_pConn = createConnection();
+    return nullptr != m_pConn;
+}
+
+/**
+ * @brief Open a new connection to database, with the same login information (nullptr if it failed).
+ */
+auto PSQL::createConnection() -> PGconn*
 {
     std::string info = "hostaddr=" + m_loginInfo["DBHost"] + " port=" + m_loginInfo["DBPort"] + " dbname=" + m_loginInfo["DBName"] + " user=" + m_loginInfo["DBUser"] + " password=" + m_loginInfo["DBPassword"];
     const char* c = info.c_str();
-    auto lock { lockPSQL() };
 
-    m_pConn = PQconnectdb(c);
-    if (PQstatus(m_pConn) != CONNECTION_OK) {
+    PGconn* pConn = PQconnectdb(c);
+    if (PQstatus(pConn) != CONNECTION_OK) {
         cout << COLOR_ERROR "ERROR: Connection to database failed.\n" NO_COLOR;
 
-        PQfinish(m_pConn); // https://www.postgresql.org/docs/8.1/libpq.html \> PQfinish
-        m_pConn = nullptr;
-
-        return false;
+        PQfinish(pConn); // https://www.postgresql.org/docs/8.1/libpq.html \> PQfinish
+        return nullptr;
     }
 
-    return true;
+    return pConn;
 }
 
 /**
  * @brief Test connection to database.
  */
 auto PSQL::isConnected() const -> bool
+{
+    std::lock_guard<std::mutex> guard(m_mtxPSQL);
+    return isConnectedNoLock();
+}
+
+auto PSQL::isConnectedNoLock() const -> bool
 {
     return (nullptr != m_pConn) && (PQstatus(m_pConn) == CONNECTION_OK);
 }
@@ -132,6 +168,15 @@ auto PSQL::isConnected() const -> bool
  */
 void PSQL::disconnectDB()
 {
+    {
+        std::lock_guard<std::mutex> guard(m_mtxPool);
+        for (auto* pConn : m_idleConnections) {
+            PQfinish(pConn);
+        }
+        m_numConnections -= static_cast<int>(m_idleConnections.size()); // checked out connections are closed when returned
+        m_idleConnections.clear();
+    }
+
     auto lock { lockPSQL() };
     if (nullptr == m_pConn) {
         return;
@@ -141,6 +186,103 @@ void PSQL::disconnectDB()
     m_pConn = nullptr;
 }
 
+/**
+ * @brief Check out a connection from the pool: an idle one if any, or else a new one if the pool is not full yet,
+ *        or else wait until another thread returns its connection.
+ */
+auto PSQL::checkoutConnection() -> PSQL::PooledConnection
+{
+    std::unique_lock<std::mutex> poolLock(m_mtxPool);
+    m_cvPool.wait(poolLock, [this] { return !m_idleConnections.empty() || m_numConnections < m_connectionPoolSize; });
+
+    if (!m_idleConnections.empty()) {
+        auto* pConn = m_idleConnections.back();
+        m_idleConnections.pop_back();
+        return { this, pConn };
+    }
+
+    ++m_numConnections;
+    poolLock.unlock(); // connecting takes a while
+
+    auto* pConn = createConnection();
+    if (nullptr == pConn) {
+        poolLock.lock();
+        --m_numConnections;
+        poolLock.unlock();
+        m_cvPool.notify_one();
+    }
+
+    return { this, pConn };
+}
+
+/**
+ * @brief Return a checked out connection to the pool. Broken connections are closed instead (and will be reopened on demand).
+ */
+void PSQL::checkinConnection(PGconn* pConn)
+{
+    if (PQstatus(pConn) == CONNECTION_OK && PQtransactionStatus(pConn) != PQTRANS_IDLE) {
+        PQclear(PQexec(pConn, "ROLLBACK")); // never hand over a connection in the middle of a (failed) transaction
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(m_mtxPool);
+        if (PQstatus(pConn) == CONNECTION_OK) {
+            m_idleConnections.push_back(pConn);
+            pConn = nullptr;
+        } else {
+            --m_numConnections;
+        }
+    }
+    m_cvPool.notify_one();
+
+    if (nullptr != pConn) {
+        PQfinish(pConn);
+    }
+}
+
+auto PSQL::getConnectionPoolSize() const -> int
+{
+    return m_connectionPoolSize;
+}
+
+//-----------------------------------------------------------------------------------------------
+
+/**
+ *
+ * class PSQL::PooledConnection
+ *
+ */
+
+PSQL::PooledConnection::PooledConnection(PSQL* pPSQL /* = nullptr */, PGconn* pConn /* = nullptr */)
+    : m_pPSQL { pPSQL }
+    , m_pConn { pConn }
+{
+}
+
+PSQL::PooledConnection::PooledConnection(PooledConnection&& other) noexcept
+    : m_pPSQL { other.m_pPSQL }
+    , m_pConn { other.m_pConn }
+{
+    other.m_pConn = nullptr;
+}
+
+PSQL::PooledConnection::~PooledConnection()
+{
+    if (nullptr != m_pConn) {
+        m_pPSQL->checkinConnection(m_pConn);
+    }
+}
+
+auto PSQL::PooledConnection::get() const -> PGconn*
+{
+    return m_pConn;
+}
+
+PSQL::PooledConnection::operator bool() const
+{
+    return nullptr != m_pConn;
+}
+
 void PSQL::init()
 {
     if (!connectDB()) {
@@ -150,7 +292,7 @@ void PSQL::init()
         return;
     }
 
-    cout << "Connection to database is good." << endl;
+    cout << "Connection to database is good. (pool of up to " << m_connectionPoolSize << " connections)" << endl;
 }
 
 auto PSQL::doQuery(std::string query, std::string msgIfStatMismatch, ExecStatusType statToMatch /* = PGRES_COMMAND_OK */, PGresult** ppRes /* = nullptr */) -> bool
@@ -164,13 +306,17 @@ auto PSQL::doQuery(std::string query, std::string msgIfStatMismatch, ExecStatusT
  */
 auto PSQL::checkTableOfTradeAndQuoteRecordsExist(std::string ric, std::string reutersDate, std::string* pTableName) -> shift::database::TABLE_STATUS
 {
-    auto lock { lockPSQL() };
     using TABLE_STATUS = shift::database::TABLE_STATUS;
 
+    auto conn = checkoutConnection();
+    if (!conn) {
+        return TABLE_STATUS::DB_ERROR;
+    }
+
     auto tableName = PSQL::s_createTableName(ric, s_reutersDateToYYYYMMDD(reutersDate));
 
     PGresult* pRes = nullptr;
-    if (!doQuery("SELECT EXISTS ("
+    if (!shift::database::doQuery(conn.get(), "SELECT EXISTS ("
                  "SELECT 1 "
                  "FROM pg_tables "
                  "WHERE schemaname = 'public' AND tablename = '"
@@ -204,298 +350,501 @@ auto PSQL::checkTableOfTradeAndQuoteRecordsExist(std::string ric, std::string re
  */
 auto PSQL::createTableOfTradeAndQuoteRecords(std::string tableName) -> bool
 {
-    auto lock { lockPSQL() };
-    return doQuery("CREATE TABLE " + tableName + shift::database::PSQLTable<shift::database::TradeAndQuoteRecords>::sc_colsDefinition, COLOR_ERROR "\tERROR: Create " + tableName + " table failed. (Please make sure that the old TAQ table was dropped.)\t" NO_COLOR);
+    auto conn = checkoutConnection();
+    return conn && shift::database::doQuery(conn.get(), "CREATE TABLE " + tableName + shift::database::PSQLTable<shift::database::TradeAndQuoteRecords>::sc_colsDefinition, COLOR_ERROR "\tERROR: Create " + tableName + " table failed. (Please make sure that the old TAQ table was dropped.)\t" NO_COLOR);
 }
 
 /**
- * @brief Read csv file, Append statement and insert record into table.
+ * @brief Cut the next comma-separated field off the front of a CSV line, without copying it (a missing field reads as empty).
  */
-auto PSQL::insertTradeAndQuoteRecords(std::string csvName, std::string tableName) -> bool
+static auto s_nextCSVField(std::string_view* pLine) -> std::string_view
 {
-    std::ifstream file(csvName); //define input stream
-    std::string line;
-    std::string cell;
-
-    // to keep track ordering of reuters time so as to enable us create primary key (PK=(reuters_time, reuters_time_order))
-    std::string lastRTime("N/A"); // **NOTE** : we assume that reuters time are always in increasing order in the CSV, otherwise the ordering algorithm here does NOT work!
-    int lastRTimeOrder { 1 }; // initial value is always 1
-    bool hasAnyData = false;
+    const auto commaPos = pLine->find(',');
+    const auto field = pLine->substr(0, commaPos);
+    pLine->remove_prefix((commaPos == std::string_view::npos) ? pLine->size() : commaPos + 1);
+    return field;
+}
 
-    // skip csv's headline
-    std::getline(file, line);
+/**
+ * @brief Append one column value in PostgreSQL's COPY text format (an empty value is written as NULL).
+ */
+static void s_appendCopyValue(std::string* pCopyData, std::string_view value, char delim = '\t')
+{
+    if (value.empty()) {
+        *pCopyData += "\\N";
+    } else {
+        for (const auto c : value) {
+            switch (c) {
+            case '\\':
+                *pCopyData += "\\\\";
+                break;
+            case '\t':
+                *pCopyData += "\\t";
+                break;
+            case '\n':
+                *pCopyData += "\\n";
+                break;
+            case '\r':
+                *pCopyData += "\\r";
+                break;
+            default:
+                *pCopyData += c;
+                break;
+            }
+        }
+    }
 
-    while (true) {
-        std::string pqQuery = "INSERT INTO " + tableName + " (" + shift::database::PSQLTable<shift::database::TradeAndQuoteRecords>::sc_recordFormat + ") VALUES ";
-        size_t nVals = 0;
+    *pCopyData += delim;
+}
 
-        while (nVals < 1e4 && std::getline(file, line)) { // reached one-time insertion limit?
-            hasAnyData = true;
-            // begin assembling a value:
-            pqQuery += '(';
-
-            std::stringstream lineStream(line);
-            static auto readAppendField = [](auto& lineStream, auto& cell, auto& pqQuery, bool isNumeric) {
-                std::getline(lineStream, cell, ',');
-                if (cell.empty()) {
-                    pqQuery += "NULL,";
-                } else {
-                    if (!isNumeric) {
-                        pqQuery += '\'';
-                    }
-                    pqQuery += cell;
-                    if (!isNumeric) {
-                        pqQuery += '\'';
-                    }
-                    pqQuery += ',';
-                }
-            };
-
-            // RIC
-            readAppendField(lineStream, cell, pqQuery, false);
-
-            // skip domain(?)
-            std::getline(lineStream, cell, ',');
-
-            // [PK] date-time & order
-            std::getline(lineStream, cell, ','); // YYYY-MM-DDTHH:MM:SS.SSSSSSSSS(Z|-XX|+XX), where 'T' and 'Z' are required character literals
-            {
-                const auto dateTimeDelimPos = cell.find('T');
-                const bool bGMTUTC = (cell.rfind('Z') != std::string::npos);
-                const auto timeTailPos = bGMTUTC
-                    ? cell.rfind('Z')
-                    : (cell.substr(cell.rfind(':') + 1).rfind('-') != std::string::npos) // ensure there is '-' in the non-date parts for rfind('-')
-                    ? cell.rfind('-') // expect "-XX"
-                    : cell.rfind('+'); // expect "+XX"
-
-                // reuters date
-                pqQuery += '\'';
-                pqQuery += cell.substr(0, dateTimeDelimPos);
-                pqQuery += "','";
-
-                // reuters time
-                const auto& rtNanoSec = cell.substr(dateTimeDelimPos + 1, timeTailPos - dateTimeDelimPos - 1);
-                const auto& rtMicroSec = rtNanoSec.substr({}, rtNanoSec.find('.') + 1 + 6); // truncated
-                pqQuery += rtMicroSec;
-                pqQuery += "',";
-
-                // reuters time order (for primary key purpose)
-                pqQuery += s_getUpdateReutersTimeOrder(rtMicroSec, &lastRTime, &lastRTimeOrder);
-                pqQuery += ',';
-
-                // reuters time offset
-                if (bGMTUTC) {
-                    pqQuery += "0,";
-                } else if (std::string::npos == timeTailPos) { // no offset info
-                    pqQuery += "NULL,";
-                } else { // local exchange time
-                    pqQuery += cell.substr(timeTailPos);
-                    pqQuery += ',';
-                }
-            }
+/**
+ * @brief Convert one line of a TRTH CSV file into one row of COPY data (same columns as PSQLTable<TradeAndQuoteRecords>::sc_recordFormat).
+ *        Returns false if the line is not a Trade nor a Quote.
+ */
+static auto s_appendTradeAndQuoteCopyRow(std::string_view line, std::string* pCopyData, std::string* pLastRTime, int* pLastRTimeOrder) -> bool
+{
+    // RIC
+    s_appendCopyValue(pCopyData, s_nextCSVField(&line));
+
+    // skip domain(?)
+    s_nextCSVField(&line);
+
+    // [PK] date-time & order
+    {
+        const auto cell = s_nextCSVField(&line); // YYYY-MM-DDTHH:MM:SS.SSSSSSSSS(Z|-XX|+XX), where 'T' and 'Z' are required character literals
+        const auto dateTimeDelimPos = cell.find('T');
+        const bool bGMTUTC = (cell.rfind('Z') != std::string_view::npos);
+        const auto timeTailPos = bGMTUTC
+            ? cell.rfind('Z')
+            : (cell.substr(cell.rfind(':') + 1).rfind('-') != std::string_view::npos) // ensure there is '-' in the non-date parts for rfind('-')
+            ? cell.rfind('-') // expect "-XX"
+            : cell.rfind('+'); // expect "+XX"
+
+        // reuters date
+        s_appendCopyValue(pCopyData, cell.substr(0, dateTimeDelimPos));
+
+        // reuters time
+        const auto rtNanoSec = cell.substr(dateTimeDelimPos + 1, timeTailPos - dateTimeDelimPos - 1);
+        const auto rtMicroSec = rtNanoSec.substr(0, rtNanoSec.find('.') + 1 + 6); // truncated
+        s_appendCopyValue(pCopyData, rtMicroSec);
+
+        // reuters time order (for primary key purpose)
+        s_appendCopyValue(pCopyData, PSQL::s_getUpdateReutersTimeOrder(rtMicroSec, pLastRTime, pLastRTimeOrder));
+
+        // reuters time offset
+        if (bGMTUTC) {
+            s_appendCopyValue(pCopyData, "0");
+        } else if (std::string_view::npos == timeTailPos) { // no offset info
+            s_appendCopyValue(pCopyData, {});
+        } else { // local exchange time
+            s_appendCopyValue(pCopyData, cell.substr(timeTailPos));
+        }
+    }
 
-            pqQuery += '\'';
-            // type: trade / quote
-            std::getline(lineStream, cell, ',');
-            bool isTrade = true;
-            if ("Quote" == cell) {
-                isTrade = false;
-                pqQuery += 'Q';
-            } else if ("Trade" == cell) {
-                pqQuery += 'T';
-            } else { // abnormal: missing/unknown type
-                cout << " - " << COLOR_ERROR "ERROR: At least one Trade/Quote type cannot be determined! Insertion failed.\n" NO_COLOR;
-                return false;
-            }
-            pqQuery += "',";
-
-            // exchange id
-            std::getline(lineStream, cell, ',');
-            if (cell.length() > 0) {
-                pqQuery += '\'';
-                pqQuery += cell;
-                pqQuery += "',";
-            } else if (isTrade) {
-                pqQuery += "'TRTH',"; // exchange_id: character varying(10)
-            } else {
-                pqQuery += "NULL,";
-            }
+    // type: trade / quote
+    const auto toq = s_nextCSVField(&line);
+    bool isTrade = true;
+    if ("Quote" == toq) {
+        isTrade = false;
+        s_appendCopyValue(pCopyData, "Q");
+    } else if ("Trade" == toq) {
+        s_appendCopyValue(pCopyData, "T");
+    } else { // abnormal: missing/unknown type
+        return false;
+    }
 
-            // price
-            readAppendField(lineStream, cell, pqQuery, true);
+    // exchange id
+    const auto exchangeID = s_nextCSVField(&line);
+    s_appendCopyValue(pCopyData, (exchangeID.empty() && isTrade) ? "TRTH" : exchangeID); // exchange_id: character varying(10)
 
-            // volume
-            readAppendField(lineStream, cell, pqQuery, true);
+    // price, volume, buyer id, bid price, bid size, seller id, ask price, ask size
+    for (int i = 0; i < 8; ++i) {
+        s_appendCopyValue(pCopyData, s_nextCSVField(&line));
+    }
 
-            // buyer id
-            readAppendField(lineStream, cell, pqQuery, false);
+    // exch & quote Time
+    const auto etNanoSec = s_nextCSVField(&line); // exch. time with praction in nano seconds
+    if (isTrade) {
+        // set SQL exch. time with blank quote time
+        s_appendCopyValue(pCopyData, etNanoSec);
+        s_appendCopyValue(pCopyData, {}, '\n');
+    } else {
+        // set SQL quote time with blank exch. time
+        s_appendCopyValue(pCopyData, {});
+        s_appendCopyValue(pCopyData, etNanoSec, '\n');
+    }
 
-            // bid price
-            readAppendField(lineStream, cell, pqQuery, true);
+    return true;
+}
 
-            // bid size
-            readAppendField(lineStream, cell, pqQuery, true);
+/**
+ * @brief Read csv file, and stream its records into the table through COPY.
+ *        The file may be gzip-compressed (e.g. a TRTH download): it is decompressed on the fly, never written back to disk.
+ *        The CSV is read in large blocks, and its fields are converted straight into the COPY buffer (no per-line strings);
+ *        COPY runs on a pooled connection, so that a long ingest neither holds m_mtxPSQL nor blocks other users of the database.
+ */
+auto PSQL::insertTradeAndQuoteRecords(std::string csvName, std::string tableName) -> bool
+{
+    // zlib reads uncompressed files as they are
+    std::unique_ptr<std::remove_pointer_t<gzFile>, decltype(&gzclose)> file { gzopen(csvName.c_str(), "rb"), &gzclose };
+    if (file) {
+        gzbuffer(file.get(), ::CSV_READ_BLOCK_SIZE);
+    }
 
-            // seller id
-            readAppendField(lineStream, cell, pqQuery, false);
+    auto conn = checkoutConnection();
+    PGconn* pConn = conn.get();
+    if (nullptr == pConn || !file) {
+        // DE should NOT keep any data of erroneous table, just discard them:
+        auto lock { lockPSQL() };
+        doQuery("DROP TABLE " + tableName + " CASCADE;", "");
+        return false;
+    }
 
-            // ask price
-            readAppendField(lineStream, cell, pqQuery, true);
+    if (!shift::database::doQuery(pConn, "COPY " + tableName + " (" + shift::database::PSQLTable<shift::database::TradeAndQuoteRecords>::sc_recordFormat + ") FROM STDIN", COLOR_ERROR "ERROR: COPY into [ " + tableName + " ] failed.\n" NO_COLOR, PGRES_COPY_IN)) {
+        shift::database::doQuery(pConn, "DROP TABLE " + tableName + " CASCADE;", "");
+        return false;
+    }
 
-            // ask size
-            readAppendField(lineStream, cell, pqQuery, true);
+    // to keep track ordering of reuters time so as to enable us create primary key (PK=(reuters_time, reuters_time_order))
+    std::string lastRTime("N/A"); // **NOTE** : we assume that reuters time are always in increasing order in the CSV, otherwise the ordering algorithm here does NOT work!
+    int lastRTimeOrder { 1 }; // initial value is always 1
+    bool hasAnyData = false;
+    bool isHeadline = true;
+    const char* copyError = nullptr; // reason to abort the COPY, if any
+
+    std::vector<char> block(::CSV_READ_BLOCK_SIZE);
+    std::size_t carrySize = 0; // incomplete last line of the previous block
+    std::string copyData;
+    copyData.reserve(::PSQL_COPY_BUFFER_SIZE + 1024);
+
+    while (nullptr == copyError) {
+        const int numRead = gzread(file.get(), block.data() + carrySize, static_cast<unsigned int>(block.size() - carrySize));
+        if (numRead < 0) {
+            int errnum = Z_OK;
+            cout << " - " << COLOR_ERROR "ERROR: Cannot read " << csvName << ": " << gzerror(file.get(), &errnum) << '\n' << NO_COLOR;
+            copyError = "reading data file failed";
+            break;
+        }
 
-            // exch & quote Time
-            std::getline(lineStream, cell, ',');
-            {
-                const auto& etNanoSec = cell; // exch. time with praction in nano seconds
-                // const auto fracPos = etNanoSec.find('.') + 1;
-                // const auto& etMicroSec = etNanoSec.substr({}, etNanoSec.find('.') + 1 + 3); // trancated
+        const bool isLastBlock = (static_cast<std::size_t>(numRead) < block.size() - carrySize);
+        const std::string_view data(block.data(), carrySize + numRead);
 
-                if (etNanoSec.empty()) { // Exch Time empty in CSV ?
-                    pqQuery += "NULL,NULL";
-                } else if (isTrade) {
-                    // set SQL exch. time with blank quote time
-                    pqQuery += '\'' + etNanoSec + "',NULL";
-                } else {
-                    // set SQL quote time with blank exch. time
-                    pqQuery += "NULL,'" + etNanoSec + '\'';
+        std::size_t lineBegin = 0;
+        while (nullptr == copyError && lineBegin < data.size()) {
+            auto lineEnd = data.find('\n', lineBegin);
+            if (std::string_view::npos == lineEnd) {
+                if (!isLastBlock) {
+                    break; // continue with the next block
                 }
+                lineEnd = data.size();
             }
 
-            // finish assembling one value
-            pqQuery += "),";
+            auto line = data.substr(lineBegin, lineEnd - lineBegin);
+            lineBegin = lineEnd + 1;
 
-            ++nVals;
-        } // while(getline)
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+
+            // skip csv's headline
+            if (isHeadline) {
+                isHeadline = false;
+                continue;
+            }
+
+            hasAnyData = true;
+            if (!s_appendTradeAndQuoteCopyRow(line, &copyData, &lastRTime, &lastRTimeOrder)) {
+                cout << " - " << COLOR_ERROR "ERROR: At least one Trade/Quote type cannot be determined! Insertion failed.\n" NO_COLOR;
+                copyError = "unknown Trade/Quote type";
+            }
+        }
 
-        if (!hasAnyData) {
-            cout << " - " << COLOR_WARNING "WARNING: " << csvName << " has no data to be inserted into database.\n" NO_COLOR;
-            return true;
+        if (nullptr == copyError && (copyData.size() >= ::PSQL_COPY_BUFFER_SIZE || isLastBlock) && !copyData.empty()) {
+            if (PQputCopyData(pConn, copyData.data(), static_cast<int>(copyData.size())) != 1) {
+                copyError = "sending COPY data failed";
+            }
+            copyData.clear();
         }
 
-        if (0 == nVals) { // finished processing all lines ?
+        if (isLastBlock) {
             break;
         }
 
-        pqQuery.back() = ';';
+        carrySize = data.size() - lineBegin;
+        std::memmove(block.data(), block.data() + lineBegin, carrySize);
+        if (carrySize == block.size()) { // a line longer than a whole block
+            block.resize(block.size() * 2);
+        }
+    }
 
-        auto lock { lockPSQL() };
-        if (!doQuery(pqQuery, COLOR_ERROR "ERROR: Insert into [ " + tableName + " ] failed.\n" NO_COLOR)) {
-            std::ofstream of("./PSQL_INSERT_ERROR_DUMP.txt");
-            if (of.good()) {
-                of.write(pqQuery.c_str(), pqQuery.length());
-            }
+    // finish (or abort) the COPY, and check its result
+    bool isSuccess = (PQputCopyEnd(pConn, copyError) == 1);
+    while (PGresult* pRes = PQgetResult(pConn)) {
+        isSuccess &= (PQresultStatus(pRes) == PGRES_COMMAND_OK);
+        PQclear(pRes);
+    }
+    isSuccess &= (nullptr == copyError);
 
-            cout << COLOR_WARNING "The failed SQL query was written into './PSQL_INSERT_ERROR_DUMP.txt'. Please check it by manually executing the query. The table [" << tableName << "] was not created." NO_COLOR << endl;
+    if (!isSuccess) {
+        cout << COLOR_ERROR "ERROR: Insert into [ " << tableName << " ] failed: " << PQerrorMessage(pConn) << NO_COLOR;
+        cout << COLOR_WARNING "The table [" << tableName << "] was not created." NO_COLOR << endl;
 
-            // DE should NOT keep any data of erroneous table, just discard them:
-            doQuery("DROP TABLE " + tableName + " CASCADE;", "");
+        // DE should NOT keep any data of erroneous table, just discard them:
+        shift::database::doQuery(pConn, "DROP TABLE " + tableName + " CASCADE;", "");
 
-            return false;
-        }
-    } // while(true)
+        return false;
+    }
+
+    if (!hasAnyData) {
+        cout << " - " << COLOR_WARNING "WARNING: " << csvName << " has no data to be inserted into database.\n" NO_COLOR;
+    }
 
     return true;
 }
 
 /**
- * @brief Fetch chunk of Quote and trading records, and send to matching engine.
+ * @brief Binary result decoding helpers (PostgreSQL sends binary values in network byte order).
  */
-auto PSQL::readSendRawData(std::string targetID, std::string symbol, boost::posix_time::ptime startTime, boost::posix_time::ptime endTime) -> bool
+static auto s_readBinaryInt32(const char* pValue) -> std::int32_t
 {
-    const std::string stime = boost::posix_time::to_iso_extended_string(startTime).substr(11, 8);
-    const std::string etime = boost::posix_time::to_iso_extended_string(endTime).substr(11, 8);
-    const std::string table_name = s_createTableName(symbol, boost::posix_time::to_iso_string(startTime).substr(0, 8)); /*YYYYMMDD*/
-    auto lock { lockPSQL() };
+    const auto* pBytes = reinterpret_cast<const unsigned char*>(pValue);
+    return static_cast<std::int32_t>((std::uint32_t { pBytes[0] } << 24) | (std::uint32_t { pBytes[1] } << 16) | (std::uint32_t { pBytes[2] } << 8) | std::uint32_t { pBytes[3] });
+}
 
-    if (!doQuery("BEGIN", COLOR_ERROR "ERROR: BEGIN command failed.\n" NO_COLOR)) {
-        return false;
+static auto s_readBinaryInt64(const char* pValue) -> std::int64_t
+{
+    const auto high = static_cast<std::uint32_t>(s_readBinaryInt32(pValue));
+    const auto low = static_cast<std::uint32_t>(s_readBinaryInt32(pValue + 4));
+    return static_cast<std::int64_t>((std::uint64_t { high } << 32) | low);
+}
+
+/**
+ * @brief REAL columns are converted through their shortest decimal representation,
+ *        which is the value the text result format used to give (e.g. 123.45 rather than 123.449997).
+ */
+static auto s_readBinaryFloat4(const char* pValue) -> double
+{
+    const auto bits = static_cast<std::uint32_t>(s_readBinaryInt32(pValue));
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+
+    char buf[32];
+    for (int precision = FLT_DIG; precision < FLT_DECIMAL_DIG; ++precision) {
+        std::snprintf(buf, sizeof(buf), "%.*g", precision, value);
+        if (std::strtof(buf, nullptr) == value) {
+            return std::strtod(buf, nullptr);
+        }
     }
+    std::snprintf(buf, sizeof(buf), "%.*g", FLT_DECIMAL_DIG, value);
+    return std::strtod(buf, nullptr);
+}
 
+template <std::size_t N>
+static void s_readBinaryText(const PGresult* pRes, int row, int col, char (&field)[N])
+{
+    const auto length = std::min<std::size_t>(PQgetlength(pRes, row, col), N - 1);
+    std::memcpy(field, PQgetvalue(pRes, row, col), length);
+    field[length] = '\0';
+}
+
+/**
+ * @brief The Trade & Quote records query, with reuters_time in ($1, $2] if isRange is set, otherwise all of them.
+ *        It returns the records together with their epoch time, so that they can be decoded straight into compact RawData records.
+ */
+static auto s_createRawDataQuery(const std::string& tableName, bool isRange) -> std::string
+{
     std::string pqQuery;
-    pqQuery += "DECLARE data CURSOR FOR SELECT " + std::string(shift::database::PSQLTable<shift::database::TradeAndQuoteRecords>::sc_recordFormat) + " FROM ";
-    pqQuery += table_name;
-    pqQuery += " WHERE reuters_time > '";
-    pqQuery += stime;
-    pqQuery += "' AND reuters_time <= '";
-    pqQuery += etime;
-    pqQuery += '\'';
-    pqQuery += " ORDER BY reuters_time";
+    pqQuery += "SELECT ric, toq, exchange_id, price, volume, buyer_id, bid_price, bid_size, seller_id, ask_price, ask_size";
+    pqQuery += ", extract(epoch from reuters_date)::bigint, (extract(epoch from reuters_time) * 1000000)::bigint FROM ";
+    pqQuery += tableName;
+    if (isRange) {
+        pqQuery += " WHERE reuters_time > $1::time AND reuters_time <= $2::time";
+    }
+    pqQuery += " ORDER BY reuters_time, reuters_time_order";
 
 #if __DBG_DUMP_PQCMD
-    cout << "DEBUG: pqQuery@readSendRawData ==\n\n"
+    cout << "DEBUG: pqQuery@s_createRawDataQuery ==\n\n"
          << pqQuery << '\n'
          << endl;
 #endif
 
-    if (!doQuery(pqQuery, COLOR_ERROR "ERROR: DECLARE CURSOR [ " + table_name + " ] failed. (send_raw_data)\n" NO_COLOR)) {
+    return pqQuery;
+}
+
+/**
+ * @brief Decode one row of a binary result of the s_createRawDataQuery() query.
+ */
+static void s_decodeRawData(const PGresult* pRes, int row, RawData* pRawData)
+{
+    enum COL_IDX : int {
+        RIC = 0,
+        TOQ,
+        EXCH_ID,
+        PRICE,
+        VOLUME,
+        BUYER_ID,
+        BID_PRICE,
+        BID_SIZE,
+        SELLER_ID,
+        ASK_PRICE,
+        ASK_SIZE,
+        SECS,
+        MICROSECS,
+    };
+
+    // NULL values read as zeros/empty strings, as they used to
+    auto int32At = [pRes, row](int col) { return PQgetisnull(pRes, row, col) ? 0 : s_readBinaryInt32(PQgetvalue(pRes, row, col)); };
+    auto int64At = [pRes, row](int col) { return PQgetisnull(pRes, row, col) ? 0 : s_readBinaryInt64(PQgetvalue(pRes, row, col)); };
+    auto float4At = [pRes, row](int col) { return PQgetisnull(pRes, row, col) ? 0.0 : s_readBinaryFloat4(PQgetvalue(pRes, row, col)); };
+
+    auto& rd = *pRawData;
+
+    s_readBinaryText(pRes, row, COL_IDX::RIC, rd.symbol);
+    rd.toq = PQgetisnull(pRes, row, COL_IDX::TOQ) ? '\0' : *PQgetvalue(pRes, row, COL_IDX::TOQ);
+    s_readBinaryText(pRes, row, COL_IDX::EXCH_ID, rd.exchangeID);
+    rd.price = float4At(COL_IDX::PRICE);
+    rd.volume = int32At(COL_IDX::VOLUME);
+    s_readBinaryText(pRes, row, COL_IDX::BUYER_ID, rd.buyerID);
+    rd.bidPrice = float4At(COL_IDX::BID_PRICE);
+    rd.bidSize = int32At(COL_IDX::BID_SIZE);
+    s_readBinaryText(pRes, row, COL_IDX::SELLER_ID, rd.sellerID);
+    rd.askPrice = float4At(COL_IDX::ASK_PRICE);
+    rd.askSize = int32At(COL_IDX::ASK_SIZE);
+    rd.secs = int64At(COL_IDX::SECS);
+    rd.microsecs = int64At(COL_IDX::MICROSECS);
+}
+
+/**
+ * @brief Query Trade & Quote records of a table, with reuters_time in (stime, etime].
+ *        A single query returns the records in binary format.
+ */
+auto PSQL::queryRawData(PGconn* pConn, const std::string& tableName, const char* stime, const char* etime, std::vector<RawData>* pRawData) -> bool
+{
+    const auto pqQuery = s_createRawDataQuery(tableName, true);
+
+    const char* const paramValues[] = { stime, etime };
+    PGresult* pRes = PQexecParams(pConn, pqQuery.c_str(), 2, nullptr, paramValues, nullptr, nullptr, 1 /* binary results */);
+    if (PQresultStatus(pRes) != PGRES_TUPLES_OK) {
+        cout << COLOR_ERROR "ERROR: SELECT [ " << tableName << " ] failed. (send_raw_data)\n" NO_COLOR;
+        PQclear(pRes);
+        return false;
+    }
+
+    pRawData->resize(PQntuples(pRes));
+
+    // save each record for each row into struct RawData
+    for (int i = 0, nt = PQntuples(pRes); i < nt; ++i) {
+        s_decodeRawData(pRes, i, &(*pRawData)[i]);
+    }
+
+    PQclear(pRes);
+    return true;
+}
+
+/**
+ * @brief Materialize all Trade & Quote records of a table into its tick cache file.
+ *        The records are fetched through a cursor, ::TICK_CACHE_FETCH_SIZE at a time, and written straight into the cache file,
+ *        so that neither the whole query result nor all the records of the table are held in memory.
+ */
+auto PSQL::cacheRawData(PGconn* pConn, const std::string& tableName) -> bool
+{
+    // the record count and the cursor must see the same table
+    if (!shift::database::doQuery(pConn, "BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY;", COLOR_ERROR "ERROR: BEGIN failed. (cache_raw_data)\n" NO_COLOR)) {
         return false;
     }
 
     PGresult* pRes = nullptr;
-    if (!doQuery("FETCH ALL FROM data", COLOR_ERROR "ERROR: FETCH ALL failed.\n" NO_COLOR, PGRES_TUPLES_OK, &pRes)) {
+    if (!shift::database::doQuery(pConn, "SELECT count(*) FROM " + tableName + ';', COLOR_ERROR "ERROR: SELECT count [ " + tableName + " ] failed. (cache_raw_data)\n" NO_COLOR, PGRES_TUPLES_OK, &pRes)) {
         PQclear(pRes);
-        return false;
+        return false; // the transaction is rolled back when the connection is checked in
     }
+    const auto numRecords = std::strtoull(PQgetvalue(pRes, 0, 0), nullptr, 10);
+    PQclear(pRes);
 
-    std::string queryTime;
-    queryTime += "SELECT extract(epoch from reuters_date)::bigint, extract(epoch from reuters_time) FROM ";
-    queryTime += table_name;
-    queryTime += " WHERE reuters_time > '";
-    queryTime += stime;
-    queryTime += "' AND reuters_time <= '";
-    queryTime += etime;
-    queryTime += '\'';
-    queryTime += " ORDER BY reuters_time";
+    auto pWriter = TickCache::getInstance().createWriter(tableName, numRecords);
+    if (!pWriter) {
+        return false;
+    }
 
-    PGresult* pResTime = nullptr;
-    if (!doQuery(queryTime, COLOR_ERROR "ERROR: EXTRACT TIME failed.\n" NO_COLOR, PGRES_TUPLES_OK, &pResTime)) {
-        PQclear(pResTime);
+    if (!shift::database::doQuery(pConn, "DECLARE raw_data_cursor NO SCROLL CURSOR FOR " + s_createRawDataQuery(tableName, false) + ';', COLOR_ERROR "ERROR: DECLARE CURSOR [ " + tableName + " ] failed. (cache_raw_data)\n" NO_COLOR)) {
         return false;
     }
 
-    double microsecs = 0.0;
-    std::vector<RawData> rawData(PQntuples(pRes));
-    std::setprecision(15);
+    const std::string fetchQuery = "FETCH " + std::to_string(::TICK_CACHE_FETCH_SIZE) + " FROM raw_data_cursor;";
+    RawData rd;
 
-    // next, save each record for each row into struct RawData and send to matching engine
-    for (int i = 0, nt = PQntuples(pRes); i < nt; ++i) {
-        char* pCh {};
-        using VAL_IDX = shift::database::PSQLTable<shift::database::TradeAndQuoteRecords>::VAL_IDX;
-
-        rawData[i].secs = std::atoi(PQgetvalue(pResTime, i, 0));
-        sscanf(PQgetvalue(pResTime, i, 1), "%lf", &microsecs);
-        rawData[i].microsecs = microsecs;
-
-        rawData[i].symbol = PQgetvalue(pRes, i, VAL_IDX::RIC);
-        rawData[i].reutersDate = PQgetvalue(pRes, i, VAL_IDX::REUT_DATE);
-        rawData[i].reutersTime = PQgetvalue(pRes, i, VAL_IDX::REUT_TIME);
-        rawData[i].toq = PQgetvalue(pRes, i, VAL_IDX::TOQ);
-        rawData[i].exchangeID = PQgetvalue(pRes, i, VAL_IDX::EXCH_ID);
-        rawData[i].price = std::strtod(PQgetvalue(pRes, i, VAL_IDX::PRICE), &pCh);
-        rawData[i].volume = std::atoi(PQgetvalue(pRes, i, VAL_IDX::VOLUMN));
-        rawData[i].buyerID = PQgetvalue(pRes, i, VAL_IDX::BUYER_ID);
-        rawData[i].bidPrice = std::strtod(PQgetvalue(pRes, i, VAL_IDX::BID_PRICE), &pCh);
-        rawData[i].bidSize = std::atoi(PQgetvalue(pRes, i, VAL_IDX::BID_SIZE));
-        rawData[i].sellerID = PQgetvalue(pRes, i, VAL_IDX::SELLER_ID);
-        rawData[i].askPrice = std::strtod(PQgetvalue(pRes, i, VAL_IDX::ASK_PRICE), &pCh);
-        rawData[i].askSize = std::atoi(PQgetvalue(pRes, i, VAL_IDX::ASK_SIZE));
-    }
-
-    PQclear(pResTime);
-    PQclear(pRes);
+    while (true) {
+        pRes = PQexecParams(pConn, fetchQuery.c_str(), 0, nullptr, nullptr, nullptr, nullptr, 1 /* binary results */);
+        if (PQresultStatus(pRes) != PGRES_TUPLES_OK) {
+            cout << COLOR_ERROR "ERROR: FETCH [ " << tableName << " ] failed. (cache_raw_data)\n" NO_COLOR;
+            PQclear(pRes);
+            return false;
+        }
 
-    pRes = PQexec(m_pConn, "CLOSE data");
-    PQclear(pRes);
-    pRes = PQexec(m_pConn, "END");
-    PQclear(pRes);
+        const int nt = PQntuples(pRes);
+        for (int i = 0; i < nt; ++i) {
+            s_decodeRawData(pRes, i, &rd);
+            if (!pWriter->append(rd)) {
+                PQclear(pRes);
+                return false;
+            }
+        }
+        PQclear(pRes);
 
-    if (!rawData.empty()) {
-        FIXAcceptor::sendRawData(targetID, rawData);
+        if (nt < ::TICK_CACHE_FETCH_SIZE) {
+            break;
+        }
     }
 
-    cout << std::setw(10 + 9) << table_name << std::setw(12) << std::right << " - Finished ";
+    // closes the cursor as well
+    return shift::database::doQuery(pConn, "COMMIT;", COLOR_ERROR "ERROR: COMMIT failed. (cache_raw_data)\n" NO_COLOR) && pWriter->finish();
+}
+
+/**
+ * @brief Serve the chunk from the table's tick cache file when possible.
+ *        The first read of a table materializes the whole table into the cache, so later chunks and replays skip the database;
+ *        tables which cannot be cached are remembered, and their chunks are read from the database right away.
+ */
+auto PSQL::readSendRawData(std::string targetID, std::string symbol, boost::posix_time::ptime startTime, boost::posix_time::ptime endTime) -> bool
+{
+    const std::string stime = boost::posix_time::to_iso_extended_string(startTime).substr(11, 8);
+    const std::string etime = boost::posix_time::to_iso_extended_string(endTime).substr(11, 8);
+    const std::string table_name = s_createTableName(symbol, boost::posix_time::to_iso_string(startTime).substr(0, 8)); /*YYYYMMDD*/
+
+    static thread_local std::vector<RawData> s_rawData; // reused by each sending thread, holds one chunk
+
+    auto& tickCache = TickCache::getInstance();
+    auto pCacheFile = tickCache.open(table_name);
+
+    if (!pCacheFile && tickCache.isEnabled() && !tickCache.isUncacheable(table_name)) {
+        auto conn = checkoutConnection();
+        if (conn) {
+            if (cacheRawData(conn.get(), table_name)) {
+                pCacheFile = tickCache.open(table_name);
+            }
+            if (!pCacheFile) {
+                cout << COLOR_WARNING "WARNING: [ " << table_name << " ] cannot be cached, it is read from the database." NO_COLOR << endl;
+                tickCache.setUncacheable(table_name);
+            }
+        }
+    }
+
+    if (pCacheFile) {
+        // same bounds as the query below: whole seconds of the day
+        const std::int64_t fromMicrosecs = startTime.time_of_day().total_seconds() * 1'000'000LL;
+        const std::int64_t toMicrosecs = endTime.time_of_day().total_seconds() * 1'000'000LL;
+        pCacheFile->read(fromMicrosecs, toMicrosecs, &s_rawData);
+    } else {
+        auto conn = checkoutConnection();
+        if (!conn || !queryRawData(conn.get(), table_name, stime.c_str(), etime.c_str(), &s_rawData)) {
+            return false;
+        }
+    }
+
+    // next, send records to matching engine
+    if (!s_rawData.empty()) {
+        FIXAcceptor::sendRawData(targetID, s_rawData);
+    }
 
     return true;
 }
@@ -522,6 +871,8 @@ auto PSQL::saveCSVIntoDB(std::string csvName, std::string symbol, std::string da
 {
     const std::string tableName = s_createTableName(symbol, s_reutersDateToYYYYMMDD(date));
 
+    TickCache::getInstance().invalidate(tableName); // the table is (re)built from scratch
+
     cout << "Create table of [ " << symbol << ' ' << date << " ]";
     if (createTableOfTradeAndQuoteRecords(tableName)) {
         cout << " - OK." << endl;
@@ -551,14 +902,14 @@ auto PSQL::saveCSVIntoDB(std::string csvName, std::string symbol, std::string da
 
 /* static */ PSQLManager* PSQLManager::s_pInst = nullptr;
 
-PSQLManager::PSQLManager(std::unordered_map<std::string, std::string>&& loginInfo)
-    : PSQL { std::move(loginInfo) }
+PSQLManager::PSQLManager(std::unordered_map<std::string, std::string>&& loginInfo, int connectionPoolSize)
+    : PSQL { std::move(loginInfo), connectionPoolSize }
 {
 }
 
-/* static */ auto PSQLManager::createInstance(std::unordered_map<std::string, std::string>&& loginInfo) -> PSQLManager&
+/* static */ auto PSQLManager::createInstance(std::unordered_map<std::string, std::string>&& loginInfo, int connectionPoolSize) -> PSQLManager&
 {
-    static PSQLManager s_inst(std::move(loginInfo));
+    static PSQLManager s_inst(std::move(loginInfo), connectionPoolSize);
     s_pInst = &s_inst;
     return s_inst;
 }
@@ -4,6 +4,12 @@
 #include "PSQL.h"
 #include "TRTHAPI.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <system_error>
+
 #include <shift/miscutils/concurrency/Consumer.h>
 #include <shift/miscutils/terminal/Common.h>
 
@@ -251,15 +257,55 @@ void RequestsProcessorPerTarget::processRequests()
     auto& db = PSQLManager::getInstance();
     if (!db.isConnected()) {
         cerr << "ERROR: s_processNextDataRequest connect to DB failed." << endl;
+
+        // the target does not request the next data chunk before this one is finished
+        FIXAcceptor::sendNotice(targetID, lastMarketRequestPtr->getRequestID(), "SENDFINISH");
+        lastMarketRequestPtr->updateStartTime(sendTo);
         return;
     }
 
-    size_t cnt = 0;
-    for (const auto& symbol : symbols) {
-        if (db.readSendRawData(targetID, symbol, sendFrom, sendTo)) {
-            cout << '(' << ++cnt << '/' << symbols.size() << ")\n";
+    // symbols are read and sent in parallel, one symbol at a time per worker,
+    // each worker using its own pooled database connection
+    // (so the quotes of each symbol are still sent in order)
+    const auto numWorkers = std::min<size_t>(db.getConnectionPoolSize(), symbols.size());
+    std::atomic<size_t> nextIdx { 0 };
+    std::atomic<size_t> cnt { 0 };
+    std::mutex mtxOutput;
+    const auto chunkBegin = std::chrono::steady_clock::now();
+
+    auto sendSymbols = [&] {
+        for (size_t idx = nextIdx++; idx < symbols.size(); idx = nextIdx++) {
+            const auto queryBegin = std::chrono::steady_clock::now();
+            try {
+                if (db.readSendRawData(targetID, symbols[idx], sendFrom, sendTo)) {
+                    const auto queryMillis = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - queryBegin).count();
+
+                    std::lock_guard<std::mutex> guard(mtxOutput);
+                    cout << std::setw(10 + 9) << std::right << symbols[idx] << " - Finished in " << std::setw(6) << queryMillis << " ms (" << ++cnt << '/' << symbols.size() << ")\n";
+                }
+            } catch (const std::exception& e) { // only this symbol is missing from the data chunk
+                std::lock_guard<std::mutex> guard(mtxOutput);
+                cerr << COLOR_ERROR "ERROR: Sending " << symbols[idx] << " failed: " << e.what() << NO_COLOR << endl;
+            }
+        }
+    };
+
+    std::vector<std::future<void>> workers;
+    for (size_t i = 1; i < numWorkers; ++i) {
+        try {
+            workers.push_back(std::async(std::launch::async, sendSymbols));
+        } catch (const std::system_error& e) { // the running workers share the remaining symbols
+            cerr << COLOR_WARNING "WARNING: Cannot start more data chunk workers: " << e.what() << NO_COLOR << endl;
+            break;
         }
     }
+    sendSymbols(); // this thread is a worker as well
+    for (auto& worker : workers) {
+        worker.get();
+    }
+
+    cout << "Data chunk sent in " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chunkBegin).count() << " ms, using " << workers.size() + 1 << " database connection(s).\n"
+         << endl;
 
     FIXAcceptor::sendNotice(targetID, lastMarketRequestPtr->getRequestID(), "SENDFINISH");
 
@@ -1,6 +1,11 @@
 #include "TRTHAPI.h"
 
 #include "PSQL.h"
+#include "Parameters.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 
 #include <zlib.h>
 
@@ -18,7 +23,6 @@
 #include <shift/miscutils/concurrency/Consumer.h>
 #include <shift/miscutils/crypto/Decryptor.h>
 #include <shift/miscutils/terminal/Common.h>
-#include <shift/miscutils/terminal/Functions.h>
 
 using namespace std::chrono_literals;
 
@@ -36,27 +40,18 @@ static inline auto s_createCSVName(const std::string& symbol, const std::string&
 }
 
 /**
- * @brief Unzips a .GZ file (source) as a new file (destination).
+ * @brief Check if a (possibly gzip-compressed) file has no data.
  */
-static auto unzip(const char* src, const char* dst, int* errn) -> bool
+static auto s_isEmptyFile(const std::string& fileName) -> bool
 {
-    unsigned char buf[GZ_BUF_LEN];
-    gzFile in = gzopen(src, "rb");
-    std::FILE* out = std::fopen(dst, "w");
-
-    while (true) {
-        int len = gzread(in, buf, GZ_BUF_LEN);
-        if (len <= 0) {
-            if (len < 0) {
-                gzerror(in, errn);
-            }
-            break;
-        }
-
-        std::fwrite(buf, sizeof(Bytef), (size_t)len, out);
+    gzFile in = gzopen(fileName.c_str(), "rb");
+    if (nullptr == in) {
+        return true;
     }
 
-    return !(std::fclose(out) != 0 || gzclose(in) != Z_OK || *errn < 0);
+    const bool isEmpty = (gzgetc(in) < 0);
+    gzclose(in);
+    return isEmpty;
 }
 
 template <typename _Sink>
@@ -97,21 +92,26 @@ TRTHAPI::~TRTHAPI()
 }
 
 /**
- * @brief Creates and runs a Requests Processor thread.
+ * @brief Creates and runs the Requests Processor threads.
  */
 void TRTHAPI::start()
 {
-    if (!m_reqProcessorPtr) {
-        m_reqProcessorPtr = std::make_unique<std::thread>(&TRTHAPI::processRequests, this);
+    if (!m_reqProcessors.empty()) {
+        return;
+    }
+
+    m_reqProcQuitFut = m_reqProcQuitFlag.get_future().share();
+    for (int i = 0; i < ::TRTH_NUM_DOWNLOAD_WORKERS; ++i) {
+        m_reqProcessors.emplace_back(&TRTHAPI::processRequests, this);
     }
 }
 
 /**
- * @brief Terminates the Requests Processor.
+ * @brief Terminates the Requests Processors.
  */
 void TRTHAPI::stop()
 {
-    if (!m_reqProcessorPtr) {
+    if (m_reqProcessors.empty()) {
         return;
     }
 
@@ -119,15 +119,29 @@ void TRTHAPI::stop()
          << COLOR "TRTH is stopping..." NO_COLOR << '\n'
          << flush;
 
-    shift::concurrency::notifyConsumerThreadToQuit(m_reqProcQuitFlag, m_cvReqs, *m_reqProcessorPtr);
-    m_reqProcessorPtr = nullptr;
+    m_reqProcQuitFlag.set_value(); // set the flag to prepare for terminating the threads
+    m_cvReqs.notify_all(); // notify so that the threads unblock and move forward
+    for (auto& th : m_reqProcessors) {
+        if (th.joinable()) {
+            th.join();
+        }
+    }
+    m_reqProcessors.clear();
+}
+
+void TRTHAPI::setLocalDataDirectory(std::string directory)
+{
+    if (!directory.empty() && directory.back() != '/') {
+        directory += '/';
+    }
+    m_localDataDir = std::move(directory);
 }
 
 void TRTHAPI::enqueueRequest(TRTHRequest req)
 {
     {
         std::lock_guard<std::mutex> guard(m_mtxReqs);
-        m_requests.push(req);
+        m_requests.push_back(req);
     }
     m_cvReqs.notify_one();
 }
@@ -175,104 +189,178 @@ auto TRTHAPI::removeUnavailableRICs(std::vector<std::string>& originalRICs) -> s
 }
 
 /**
- * @brief The unique Requests Processor thread for all requests.
+ * @brief Waits until fewer than TRTH_MAX_PARALLEL_SAVES files are being saved into database.
+ */
+void TRTHAPI::beginSaving()
+{
+    std::unique_lock<std::mutex> lock(m_mtxSaving);
+    m_cvSaving.wait(lock, [this] { return m_numSaving < ::TRTH_MAX_PARALLEL_SAVES; });
+    ++m_numSaving;
+}
+
+void TRTHAPI::endSaving()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mtxSaving);
+        --m_numSaving;
+    }
+    m_cvSaving.notify_one();
+}
+
+/**
+ * @brief One of the TRTH_NUM_DOWNLOAD_WORKERS Requests Processor threads sharing all requests.
+ *        Downloads run in parallel on all of them, while saving the downloads into database is limited to TRTH_MAX_PARALLEL_SAVES of them.
  */
 void TRTHAPI::processRequests()
 {
-    auto futQuit = m_reqProcQuitFlag.get_future();
-    auto& db = PSQLManager::getInstance();
-    std::string tableName;
-    int flag = -1;
+    auto futQuit = m_reqProcQuitFut;
+
+    // the first request whose symbol and date are not being processed by another worker
+    auto findNextRequest = [this] {
+        return std::find_if(m_requests.begin(), m_requests.end(), [this](const TRTHRequest& req) { return m_requestsInProgress.count(req.symbol + req.date) == 0; });
+    };
 
     while (true) {
         std::unique_lock<std::mutex> lock(m_mtxReqs);
-        if (shift::concurrency::quitOrContinueConsumerThread(futQuit, m_cvReqs, lock, [this] { return !m_requests.empty(); })) {
+        if (shift::concurrency::quitOrContinueConsumerThread(futQuit, m_cvReqs, lock, [this, &findNextRequest] { return findNextRequest() != m_requests.end(); })) {
             return; // stopping TRTH was requested, shall terminate current thread
         }
 
-        TRTHRequest req;
-        req = std::move(m_requests.front());
-        m_requests.pop();
+        auto reqIt = findNextRequest();
+        TRTHRequest req = std::move(*reqIt);
+        m_requests.erase(reqIt);
+        const std::string reqKey = req.symbol + req.date;
+        m_requestsInProgress.insert(reqKey);
         lock.unlock(); // so that request supplier threads can push queue in time
 
-        while (!db.isConnected()) {
-            cout << "Request processor is trying to connect DB..." << endl;
-            std::this_thread::sleep_for(5s);
-            db.connectDB();
-        }
+        processRequest(req);
 
-        // shall detect duplicated requests and skip them:
-        auto dbFlag = db.checkTableOfTradeAndQuoteRecordsExist(req.symbol, req.date, &tableName);
-        using PTS = shift::database::TABLE_STATUS;
+        lock.lock();
+        m_requestsInProgress.erase(reqKey);
+        lock.unlock();
+        m_cvReqs.notify_all(); // duplicated requests of the same symbol and date may proceed now
+    } // while
+}
 
-        bool isPerfect = true;
+/**
+ * @brief Processes one request: checks the database, downloads the data if needed, and saves them into database.
+ */
+void TRTHAPI::processRequest(TRTHRequest& req)
+{
+    auto& db = PSQLManager::getInstance();
+    std::string tableName;
+    int flag = -1;
 
-        switch (dbFlag) {
-        case PTS::NOT_EXIST:
-            if (s_bTRTHLoginJsonExists) {
-                break; // go to download it from TRTH
-            }
+    while (!db.isConnected()) {
+        cout << "Request processor is trying to connect DB..." << endl;
+        std::this_thread::sleep_for(5s);
+        db.connectDB();
+    }
 
-            // issue #32: DO NOT download if NO trthLogin.json exists on this computer
-            req.prom->set_value(true);
-            addUnavailableRequest(req);
-            continue; // while(true)
+    // shall detect duplicated requests and skip them:
+    auto dbFlag = db.checkTableOfTradeAndQuoteRecordsExist(req.symbol, req.date, &tableName);
+    using PTS = shift::database::TABLE_STATUS;
 
-        case PTS::DB_ERROR:
-        case PTS::OTHER_ERROR: {
-            isPerfect = false;
-            cout << COLOR_ERROR "ERROR: Database was abnormal @ TRTHAPI::processRequests when querying symbol [ " << req.symbol << " ]. The symbol will be ignored!" NO_COLOR << endl;
-            addUnavailableRequest(req);
-        }
-        case PTS::EXISTS: {
-            req.prom->set_value(isPerfect);
-            continue; // while(true)
+    bool isPerfect = true;
+
+    switch (dbFlag) {
+    case PTS::NOT_EXIST:
+        if (s_bTRTHLoginJsonExists) {
+            break; // go to download it from TRTH
         }
 
-        default:
-            cout << COLOR_WARNING "Unknown database status!" NO_COLOR << endl;
-            break;
-        } // switch
+        // issue #32: DO NOT download if NO trthLogin.json exists on this computer
+        req.prom->set_value(true);
+        addUnavailableRequest(req);
+        return;
+
+    case PTS::DB_ERROR:
+    case PTS::OTHER_ERROR: {
+        isPerfect = false;
+        cout << COLOR_ERROR "ERROR: Database was abnormal @ TRTHAPI::processRequests when querying symbol [ " << req.symbol << " ]. The symbol will be ignored!" NO_COLOR << endl;
+        addUnavailableRequest(req);
+    }
+    case PTS::EXISTS: {
+        req.prom->set_value(isPerfect);
+        return;
+    }
+
+    default:
+        cout << COLOR_WARNING "Unknown database status!" NO_COLOR << endl;
+        break;
+    } // switch
 
-        try {
-            flag = downloadAsCSV(req.symbol, req.date);
-        } catch (const web::http::http_exception& e) {
-            cout << e.what() << endl;
-            flag = 2;
+    std::string fileName;
+    bool isTemporary = false;
+
+    try {
+        flag = downloadAsCSV(req.symbol, req.date, &fileName, &isTemporary);
+    } catch (const web::http::http_exception& e) {
+        cout << e.what() << endl;
+        flag = 2;
+    }
+
+    if (flag == 0) {
+        beginSaving();
+        isPerfect &= db.isConnected() && db.saveCSVIntoDB(fileName, req.symbol, req.date);
+        endSaving();
+
+        if (isTemporary) {
+            std::remove(fileName.c_str());
         }
 
-        if (flag == 0) {
-            std::string csvName = ::s_createCSVName(req.symbol, req.date);
-            isPerfect &= db.isConnected() && db.saveCSVIntoDB(csvName, req.symbol, req.date);
+        if (isPerfect) {
+            // it's available in DB now, untrack it from unavailables
+            std::lock_guard<std::mutex> guard(m_mtxReqsUnavail);
+            auto newEnd = std::remove_if(m_requestsUnavailable.begin(), m_requestsUnavailable.end(), [&req](const TRTHRequest& elem) { return elem.symbol == req.symbol && elem.date == req.date; });
+            m_requestsUnavailable.erase(newEnd, m_requestsUnavailable.end());
+        }
+    } else if (flag == 1) { // not in TR
+        isPerfect = false;
+        addUnavailableRequest(req);
+    } else { // other RETRIEVE_STATUS
+        isPerfect = false;
+        cout << COLOR_ERROR "ERROR: TRTH cannot download [ " << req.symbol << " ]. The symbol will be skipped." << endl;
+        cout << NO_COLOR;
+        addUnavailableRequest(req);
+    }
 
-            if (isPerfect) {
-                std::remove(csvName.c_str());
-                // cout << csvName << " deleted." << endl;
+    req.prom->set_value(isPerfect);
+}
 
-                // it's available in DB now, untrack it from unavailables
-                std::lock_guard<std::mutex> guard(m_mtxReqsUnavail);
-                auto newEnd = std::remove_if(m_requestsUnavailable.begin(), m_requestsUnavailable.end(), [&req](const TRTHRequest& elem) { return elem.symbol == req.symbol && elem.date == req.date; });
-                m_requestsUnavailable.erase(newEnd, m_requestsUnavailable.end());
+/**
+ * @brief The local stand-in for TRTH downloads: finds <symbol><date>.csv.gz (or .csv) in the local data directory.
+ */
+auto TRTHAPI::findLocalData(const std::string& symbol, const std::string& requestDate, std::string* pFileName) const -> int
+{
+    const auto csvName = m_localDataDir + ::s_createCSVName(symbol, requestDate);
+
+    for (const auto& fileName : { csvName + ".gz", csvName }) {
+        if (std::ifstream { fileName }.good()) {
+            *pFileName = fileName;
+            if (s_isEmptyFile(fileName)) {
+                cout << COLOR_WARNING "WARNING: No data for " << symbol << '!' << NO_COLOR << endl;
+                return 1;
             }
-        } else if (flag == 1) { // not in TR
-            isPerfect = false;
-            addUnavailableRequest(req);
-        } else { // other RETRIEVE_STATUS
-            isPerfect = false;
-            cout << COLOR_ERROR "ERROR: TRTH cannot download [ " << req.symbol << " ]. The symbol will be skipped." << endl;
-            cout << NO_COLOR;
-            addUnavailableRequest(req);
+            return 0;
         }
+    }
 
-        req.prom->set_value(isPerfect);
-    } // while
+    cout << COLOR_WARNING "WARNING: No local data file for " << symbol << " (" << requestDate << ")!" << NO_COLOR << endl;
+    return 1; // e.g. RIC does not exist in TRTH
 }
 
 /**
  * @brief The main method to search, check, request and download data from TRTH. Gives processing status as feedback.
+ *        The data are kept gzip-compressed in the downloaded file (*pFileName), which is temporary (*pIsTemporary) unless it was found locally.
  */
-auto TRTHAPI::downloadAsCSV(const std::string& symbol, const std::string& requestDate) -> int // date format: YYYY-MM-DD
+auto TRTHAPI::downloadAsCSV(const std::string& symbol, const std::string& requestDate, std::string* pFileName, bool* pIsTemporary) -> int // date format: YYYY-MM-DD
 {
+    if (!m_localDataDir.empty()) {
+        *pIsTemporary = false;
+        return findLocalData(symbol, requestDate, pFileName);
+    }
+
     // prepare symbol format for TRTH request
     std::string ric = symbol;
     ::cvtRICToDEInternalRepresentation(&ric, true); // '_' => '.'
@@ -326,8 +414,7 @@ auto TRTHAPI::downloadAsCSV(const std::string& symbol, const std::string& reques
     // jExtr.serialize(cout);
     // cout << "\n########################################################" << endl;
 
-    cout << endl
-         << "Requesting " << COLOR << '[' << symbol << ']' << NO_COLOR << flush;
+    cout << "Requesting " << COLOR << '[' << symbol << ']' << NO_COLOR << endl;
 
     req.set_method(web::http::methods::POST);
     req.set_request_uri("/Extractions/ExtractRaw");
@@ -342,8 +429,7 @@ auto TRTHAPI::downloadAsCSV(const std::string& symbol, const std::string& reques
     auto extrJobID = utility::string_t {};
     try {
         web::http::http_response extrReqResp;
-        shift::terminal::dots_awaiter([&extrReqResp, &client, &req] { extrReqResp = client.request(req).get(); });
-        cout << endl;
+        extrReqResp = client.request(req).get();
         // cout << std::setw(20) << std::right << "Status:  " << extrReqResp.status_code() << endl;
         // cout << std::setw(20) << std::right << "Reason:  " << extrReqResp.reason_phrase() << endl;
         if (extrReqResp.status_code() >= 400) {
@@ -364,7 +450,7 @@ auto TRTHAPI::downloadAsCSV(const std::string& symbol, const std::string& reques
         throw web::http::http_exception(COLOR_ERROR "ERROR: Cannot get RawExtractionResults:JobId!" NO_COLOR);
     }
 
-    cout << "Downloading" << flush;
+    cout << "Downloading " << COLOR << '[' << symbol << ']' << NO_COLOR << endl;
 
     req.set_method(web::http::methods::GET);
     req.set_request_uri("/Extractions/RawExtractionResults('" + extrJobID + "')/$value");
@@ -383,30 +469,21 @@ auto TRTHAPI::downloadAsCSV(const std::string& symbol, const std::string& reques
     auto csvName = ::s_createCSVName(symbol, requestDate);
     auto gzipName = csvName + ".gz";
 
+    *pFileName = gzipName;
+    *pIsTemporary = true;
+
     Concurrency::streams::fstream::open_ostream(gzipName, std::ios::binary)
-        .then([&gzipStrm](Concurrency::streams::ostream os) {
-            size_t nread {};
-            shift::terminal::dots_awaiter([&nread, &gzipStrm, &os] { nread = gzipStrm.read_to_end(os.streambuf()).get(); });
-            cout << " - Size: " << nread << endl;
+        .then([&gzipStrm, &symbol](Concurrency::streams::ostream os) {
+            size_t nread = gzipStrm.read_to_end(os.streambuf()).get();
+            cout << '[' << symbol << "] - Size: " << nread << endl;
             os.flush();
         })
         .get();
 
-    // cout << "Unzipping..." << endl;
-
-    int errn = Z_OK;
-    bool bRes = ::unzip(gzipName.c_str(), csvName.c_str(), &errn);
-    (void)bRes; // no warning
-    // cout << std::setw(20) << std::right << "Status:  " << (bRes ? "OK" : "ERR=");
-    // if (!bRes)
-    //     cout << errn;
-    // cout << endl;
-
-    std::remove(gzipName.c_str());
-
-    if (std::ifstream { csvName }.peek() == std::ifstream::traits_type::eof()) { // empty CSV file ?
+    // the data are decompressed on the fly when saved into database
+    if (::s_isEmptyFile(gzipName)) { // empty CSV file ?
         cout << COLOR_WARNING "WARNING: No data for this RIC!" << NO_COLOR << endl;
-        std::remove(csvName.c_str());
+        std::remove(gzipName.c_str());
         return 1; // e.g. RIC does not exist in TRTH
     }
 
@@ -0,0 +1,477 @@
+#include "TickCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string_view>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr char CACHE_FILE_MAGIC[8] = { 'S', 'H', 'I', 'F', 'T', 'T', 'C', '1' };
+static constexpr auto CACHE_FILE_EXTENSION = ".ticks";
+
+/**
+ * @brief Cache file header. It is followed by the columns, each starting at a multiple of 8 bytes:
+ *        microsecs, price, bid_price, ask_price, volume, bid_size, ask_size, ric, exchange_id, buyer_id, seller_id, toq,
+ *        and then the dictionary of ID strings referred to by the ric, exchange_id, buyer_id and seller_id columns.
+ */
+struct FileHeader {
+    char magic[sizeof(CACHE_FILE_MAGIC)];
+    std::uint64_t numRecords;
+    std::uint64_t numStrings;
+    std::int64_t secs; // seconds since 1970/01/01 (of the reuters date, shared by all records)
+};
+
+using dict_string_t = char[sizeof(RawData::symbol)];
+
+/**
+ * @brief Byte offsets of the columns in a cache file.
+ */
+struct FileLayout {
+    std::size_t microsecs;
+    std::size_t price;
+    std::size_t bidPrice;
+    std::size_t askPrice;
+    std::size_t volume;
+    std::size_t bidSize;
+    std::size_t askSize;
+    std::size_t symbol;
+    std::size_t exchangeID;
+    std::size_t buyerID;
+    std::size_t sellerID;
+    std::size_t toq;
+    std::size_t strings;
+    std::size_t size; // of the whole file
+};
+
+static auto s_alignColumn(std::size_t offset) -> std::size_t
+{
+    return (offset + 7) / 8 * 8;
+}
+
+static auto s_getFileLayout(std::size_t numRecords, std::size_t numStrings) -> FileLayout
+{
+    FileLayout layout;
+    std::size_t offset = sizeof(FileHeader);
+    auto column = [&offset](std::size_t count, std::size_t elemSize) {
+        const auto begin = offset;
+        offset = s_alignColumn(offset + count * elemSize);
+        return begin;
+    };
+
+    layout.microsecs = column(numRecords, sizeof(std::int64_t));
+    layout.price = column(numRecords, sizeof(double));
+    layout.bidPrice = column(numRecords, sizeof(double));
+    layout.askPrice = column(numRecords, sizeof(double));
+    layout.volume = column(numRecords, sizeof(std::int32_t));
+    layout.bidSize = column(numRecords, sizeof(std::int32_t));
+    layout.askSize = column(numRecords, sizeof(std::int32_t));
+    layout.symbol = column(numRecords, sizeof(std::uint16_t));
+    layout.exchangeID = column(numRecords, sizeof(std::uint16_t));
+    layout.buyerID = column(numRecords, sizeof(std::uint16_t));
+    layout.sellerID = column(numRecords, sizeof(std::uint16_t));
+    layout.toq = column(numRecords, sizeof(char));
+    layout.strings = column(numStrings, sizeof(dict_string_t));
+    layout.size = offset;
+
+    return layout;
+}
+
+/**
+ * @brief Check the magic number and that the file is as long as its header says (e.g. it was not truncated).
+ */
+static auto s_hasValidHeader(const void* pData, std::size_t size) -> bool
+{
+    if (size < sizeof(FileHeader)) {
+        return false;
+    }
+
+    const auto* pHeader = static_cast<const FileHeader*>(pData);
+    if (std::memcmp(pHeader->magic, CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC)) != 0) {
+        return false;
+    }
+
+    if (pHeader->numRecords > size || pHeader->numStrings > size) { // also rules out overflows below
+        return false;
+    }
+
+    return s_getFileLayout(pHeader->numRecords, pHeader->numStrings).size == size;
+}
+
+//-----------------------------------------------------------------------------------------
+
+/**
+ *
+ * class TickCache::MappedFile
+ *
+ */
+
+TickCache::MappedFile::MappedFile(const void* pData, std::size_t size)
+    : m_pData { pData }
+    , m_size { size }
+    , m_numRecords { 0 }
+    , m_secs { 0 }
+    , m_numStrings { 0 }
+    , m_isValid { false }
+{
+    if (!s_hasValidHeader(m_pData, m_size)) {
+        return;
+    }
+
+    const auto* pBase = static_cast<const char*>(m_pData);
+    const auto* pHeader = reinterpret_cast<const FileHeader*>(pBase);
+    const auto layout = s_getFileLayout(pHeader->numRecords, pHeader->numStrings);
+
+    m_numRecords = pHeader->numRecords;
+    m_secs = pHeader->secs;
+    m_pMicrosecs = reinterpret_cast<const std::int64_t*>(pBase + layout.microsecs);
+    m_pPrice = reinterpret_cast<const double*>(pBase + layout.price);
+    m_pBidPrice = reinterpret_cast<const double*>(pBase + layout.bidPrice);
+    m_pAskPrice = reinterpret_cast<const double*>(pBase + layout.askPrice);
+    m_pVolume = reinterpret_cast<const std::int32_t*>(pBase + layout.volume);
+    m_pBidSize = reinterpret_cast<const std::int32_t*>(pBase + layout.bidSize);
+    m_pAskSize = reinterpret_cast<const std::int32_t*>(pBase + layout.askSize);
+    m_pSymbol = reinterpret_cast<const std::uint16_t*>(pBase + layout.symbol);
+    m_pExchangeID = reinterpret_cast<const std::uint16_t*>(pBase + layout.exchangeID);
+    m_pBuyerID = reinterpret_cast<const std::uint16_t*>(pBase + layout.buyerID);
+    m_pSellerID = reinterpret_cast<const std::uint16_t*>(pBase + layout.sellerID);
+    m_pToq = pBase + layout.toq;
+    m_pStrings = reinterpret_cast<const dict_string_t*>(pBase + layout.strings);
+    m_numStrings = pHeader->numStrings;
+
+    // dictionary indices are checked once here rather than for every record read
+    auto indicesInRange = [this](const std::uint16_t* pIndices) {
+        return std::all_of(pIndices, pIndices + m_numRecords, [this](std::uint16_t index) { return index < m_numStrings; });
+    };
+    m_isValid = indicesInRange(m_pSymbol) && indicesInRange(m_pExchangeID) && indicesInRange(m_pBuyerID) && indicesInRange(m_pSellerID)
+        && std::is_sorted(m_pMicrosecs, m_pMicrosecs + m_numRecords);
+}
+
+TickCache::MappedFile::~MappedFile()
+{
+    ::munmap(const_cast<void*>(m_pData), m_size);
+}
+
+auto TickCache::MappedFile::getNumRecords() const -> std::size_t
+{
+    return m_numRecords;
+}
+
+auto TickCache::MappedFile::isValid() const -> bool
+{
+    return m_isValid;
+}
+
+void TickCache::MappedFile::read(std::int64_t fromMicrosecs, std::int64_t toMicrosecs, std::vector<RawData>* pRecords) const
+{
+    const auto* pBegin = std::upper_bound(m_pMicrosecs, m_pMicrosecs + m_numRecords, fromMicrosecs);
+    const auto* pEnd = std::upper_bound(pBegin, m_pMicrosecs + m_numRecords, toMicrosecs);
+    const std::size_t first = pBegin - m_pMicrosecs;
+
+    pRecords->resize(pEnd - pBegin);
+
+    for (std::size_t i = 0; i < pRecords->size(); ++i) {
+        const auto j = first + i;
+        auto& rd = (*pRecords)[i];
+
+        std::memcpy(rd.symbol, m_pStrings[m_pSymbol[j]], sizeof(rd.symbol));
+        rd.toq = m_pToq[j];
+        std::memcpy(rd.exchangeID, m_pStrings[m_pExchangeID[j]], sizeof(rd.exchangeID));
+        rd.price = m_pPrice[j];
+        rd.volume = m_pVolume[j];
+        std::memcpy(rd.buyerID, m_pStrings[m_pBuyerID[j]], sizeof(rd.buyerID));
+        rd.bidPrice = m_pBidPrice[j];
+        rd.bidSize = m_pBidSize[j];
+        std::memcpy(rd.sellerID, m_pStrings[m_pSellerID[j]], sizeof(rd.sellerID));
+        rd.askPrice = m_pAskPrice[j];
+        rd.askSize = m_pAskSize[j];
+        rd.secs = m_secs;
+        rd.microsecs = m_pMicrosecs[j];
+    }
+}
+
+//-----------------------------------------------------------------------------------------
+
+/**
+ *
+ * class TickCache::Writer
+ *
+ */
+
+/**
+ * @brief Create a temporary file (so that readers never see a partially written cache file) as long as the file without its dictionary,
+ *        and map it: the dictionary is only known at the end, and is appended by finish().
+ */
+TickCache::Writer::Writer(std::string filePath, std::size_t numRecords)
+    : m_filePath { std::move(filePath) }
+    , m_fd { -1 }
+    , m_pData { MAP_FAILED }
+    , m_mappedSize { s_getFileLayout(numRecords, 0).size }
+    , m_numRecords { numRecords }
+    , m_numAppended { 0 }
+    , m_secs { 0 }
+    , m_isValid { false }
+{
+    std::ostringstream tempPath;
+    tempPath << m_filePath << ".tmp." << ::getpid() << '.' << std::this_thread::get_id();
+    m_tempPath = tempPath.str();
+
+    m_fd = ::open(m_tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0) {
+        return;
+    }
+
+    if (::ftruncate(m_fd, m_mappedSize) != 0) { // zero-filled, including the padding of the columns
+        return;
+    }
+
+    m_pData = ::mmap(nullptr, m_mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (MAP_FAILED == m_pData) {
+        return;
+    }
+
+    auto* pBase = static_cast<char*>(m_pData);
+    const auto layout = s_getFileLayout(m_numRecords, 0);
+
+    m_pMicrosecs = reinterpret_cast<std::int64_t*>(pBase + layout.microsecs);
+    m_pPrice = reinterpret_cast<double*>(pBase + layout.price);
+    m_pBidPrice = reinterpret_cast<double*>(pBase + layout.bidPrice);
+    m_pAskPrice = reinterpret_cast<double*>(pBase + layout.askPrice);
+    m_pVolume = reinterpret_cast<std::int32_t*>(pBase + layout.volume);
+    m_pBidSize = reinterpret_cast<std::int32_t*>(pBase + layout.bidSize);
+    m_pAskSize = reinterpret_cast<std::int32_t*>(pBase + layout.askSize);
+    m_pSymbol = reinterpret_cast<std::uint16_t*>(pBase + layout.symbol);
+    m_pExchangeID = reinterpret_cast<std::uint16_t*>(pBase + layout.exchangeID);
+    m_pBuyerID = reinterpret_cast<std::uint16_t*>(pBase + layout.buyerID);
+    m_pSellerID = reinterpret_cast<std::uint16_t*>(pBase + layout.sellerID);
+    m_pToq = pBase + layout.toq;
+
+    m_isValid = true;
+}
+
+TickCache::Writer::~Writer()
+{
+    discard();
+}
+
+auto TickCache::Writer::isValid() const -> bool
+{
+    return m_isValid;
+}
+
+void TickCache::Writer::discard()
+{
+    if (MAP_FAILED != m_pData) {
+        ::munmap(m_pData, m_mappedSize);
+        m_pData = MAP_FAILED;
+    }
+
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+        std::remove(m_tempPath.c_str());
+    }
+
+    m_isValid = false;
+}
+
+auto TickCache::Writer::encode(const char* id) -> std::uint16_t
+{
+    const auto res = m_stringIndices.emplace(id, static_cast<std::uint16_t>(m_strings.size()));
+    if (res.second) {
+        m_isValid = m_isValid && m_strings.size() <= UINT16_MAX;
+        m_strings.emplace_back(id);
+    }
+    return res.first->second;
+}
+
+auto TickCache::Writer::append(const RawData& record) -> bool
+{
+    if (!m_isValid || m_numAppended == m_numRecords) {
+        m_isValid = false;
+        return false;
+    }
+
+    if (0 == m_numAppended) {
+        m_secs = record.secs;
+    } else if (record.secs != m_secs) { // tables hold a single date; anything else is served from the database
+        m_isValid = false;
+        return false;
+    }
+
+    const auto i = m_numAppended++;
+    m_pMicrosecs[i] = record.microsecs;
+    m_pPrice[i] = record.price;
+    m_pBidPrice[i] = record.bidPrice;
+    m_pAskPrice[i] = record.askPrice;
+    m_pVolume[i] = record.volume;
+    m_pBidSize[i] = record.bidSize;
+    m_pAskSize[i] = record.askSize;
+    m_pSymbol[i] = encode(record.symbol);
+    m_pExchangeID[i] = encode(record.exchangeID);
+    m_pBuyerID[i] = encode(record.buyerID);
+    m_pSellerID[i] = encode(record.sellerID);
+    m_pToq[i] = record.toq;
+
+    return m_isValid;
+}
+
+auto TickCache::Writer::finish() -> bool
+{
+    if (!m_isValid || m_numAppended != m_numRecords) {
+        discard();
+        return false;
+    }
+
+    FileHeader header {};
+    std::memcpy(header.magic, CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
+    header.numRecords = m_numRecords;
+    header.numStrings = m_strings.size();
+    header.secs = m_secs;
+    std::memcpy(m_pData, &header, sizeof(header));
+
+    std::vector<dict_string_t> dictionary(m_strings.size());
+    for (std::size_t i = 0; i < m_strings.size(); ++i) {
+        std::memset(dictionary[i], 0, sizeof(dict_string_t));
+        std::memcpy(dictionary[i], m_strings[i].c_str(), std::min(m_strings[i].size(), sizeof(dict_string_t) - 1));
+    }
+
+    // the dictionary is the last column, right after the mapped part of the file
+    const auto layout = s_getFileLayout(m_numRecords, m_strings.size());
+    const auto dictionarySize = dictionary.size() * sizeof(dict_string_t);
+    bool isWritten = (::munmap(m_pData, m_mappedSize) == 0);
+    m_pData = MAP_FAILED;
+    isWritten = isWritten && (::pwrite(m_fd, dictionary.data(), dictionarySize, layout.strings) == static_cast<ssize_t>(dictionarySize));
+    isWritten = isWritten && (::ftruncate(m_fd, layout.size) == 0);
+    isWritten = (::close(m_fd) == 0) && isWritten;
+    m_fd = -1;
+
+    if (!isWritten || std::rename(m_tempPath.c_str(), m_filePath.c_str()) != 0) {
+        std::remove(m_tempPath.c_str());
+        m_isValid = false;
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------
+
+/**
+ *
+ * class TickCache
+ *
+ */
+
+/* static */ auto TickCache::getInstance() -> TickCache&
+{
+    static TickCache s_inst;
+    return s_inst;
+}
+
+void TickCache::setDirectory(std::string directory)
+{
+    std::lock_guard<std::mutex> guard(m_mtxFiles);
+
+    if (!directory.empty() && directory.back() != '/') {
+        directory += '/';
+    }
+
+    m_directory = std::move(directory);
+    m_files.clear();
+    m_uncacheableTables.clear();
+}
+
+auto TickCache::isEnabled() const -> bool
+{
+    std::lock_guard<std::mutex> guard(m_mtxFiles);
+    return !m_directory.empty();
+}
+
+auto TickCache::getFilePath(const std::string& tableName) const -> std::string
+{
+    return m_directory + tableName + CACHE_FILE_EXTENSION;
+}
+
+auto TickCache::open(const std::string& tableName) -> std::shared_ptr<const MappedFile>
+{
+    std::lock_guard<std::mutex> guard(m_mtxFiles);
+
+    if (m_directory.empty()) {
+        return nullptr;
+    }
+
+    auto it = m_files.find(tableName);
+    if (it != m_files.end()) {
+        return it->second;
+    }
+
+    const int fd = ::open(getFilePath(tableName).c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st;
+    void* pData = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        pData = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd); // the mapping stays valid
+
+    if (MAP_FAILED == pData) {
+        return nullptr;
+    }
+
+    auto pFile = std::make_shared<const MappedFile>(pData, st.st_size);
+    if (!pFile->isValid()) { // e.g. left over by an older version; it is rewritten by the caller
+        return nullptr;
+    }
+
+    m_files[tableName] = pFile;
+    return pFile;
+}
+
+auto TickCache::createWriter(const std::string& tableName, std::size_t numRecords) -> std::unique_ptr<Writer>
+{
+    std::string filePath;
+    {
+        std::lock_guard<std::mutex> guard(m_mtxFiles);
+        if (m_directory.empty()) {
+            return nullptr;
+        }
+        filePath = getFilePath(tableName);
+    }
+
+    std::unique_ptr<Writer> pWriter { new Writer { std::move(filePath), numRecords } };
+    return pWriter->isValid() ? std::move(pWriter) : nullptr;
+}
+
+void TickCache::setUncacheable(const std::string& tableName)
+{
+    std::lock_guard<std::mutex> guard(m_mtxFiles);
+    m_uncacheableTables.insert(tableName);
+}
+
+auto TickCache::isUncacheable(const std::string& tableName) const -> bool
+{
+    std::lock_guard<std::mutex> guard(m_mtxFiles);
+    return m_uncacheableTables.count(tableName) > 0;
+}
+
+void TickCache::invalidate(const std::string& tableName)
+{
+    std::lock_guard<std::mutex> guard(m_mtxFiles);
+
+    if (m_directory.empty()) {
+        return;
+    }
+
+    m_files.erase(tableName); // threads still reading it keep their mapping
+    m_uncacheableTables.erase(tableName);
+    std::remove(getFilePath(tableName).c_str());
+}
@@ -1,6 +1,8 @@
 #include "FIXAcceptor.h"
 #include "PSQL.h"
+#include "Parameters.h"
 #include "TRTHAPI.h"
+#include "TickCache.h"
 
 #if __has_include(<filesystem>)
 #include <filesystem>
@@ -30,6 +32,14 @@ using namespace std::chrono_literals;
     "trthLogin.json"
 #define CSTR_TIMEOUT \
     "timeout"
+#define CSTR_DBPOOL \
+    "dbpool"
+#define CSTR_CACHEDIR \
+    "cachedir"
+#define CSTR_NOCACHE \
+    "nocache"
+#define CSTR_TRTHDIR \
+    "trthdir"
 #define CSTR_VERBOSE \
     "verbose"
 
@@ -56,6 +66,9 @@ auto main(int argc, char** argv) -> int
             min_t minutes;
         } timer;
         bool isVerbose;
+        int dbPoolSize;
+        std::string cacheDir; // empty: ~/.shift/DatafeedEngine/cache
+        bool isCacheEnabled;
     } params = {
         "/usr/local/share/shift/DatafeedEngine/", // default installation folder for configuration
         "SHIFT123", // built-in initial crypto key used for encrypting dbLogin.txt
@@ -64,6 +77,9 @@ auto main(int argc, char** argv) -> int
             0,
         },
         false,
+        ::DB_CONNECTION_POOL_SIZE,
+        "",
+        true,
     };
 
     po::options_description desc("\nUSAGE: ./DatafeedEngine [options] <args>\n\n\tThis is the DatafeedEngine.\n\tThe server connects with TRTH and MatchingEngine instances and runs in background.\n\nOPTIONS");
@@ -72,6 +88,10 @@ auto main(int argc, char** argv) -> int
         (CSTR_CONFIG ",c", po::value<std::string>(), "set config directory") //
         (CSTR_KEY ",k", po::value<std::string>(), "shared key of " CSTR_DBLOGIN_TXT " and " CSTR_TRTHLOGIN_JSN " files") //
         (CSTR_TIMEOUT ",t", po::value<decltype(params.timer)::min_t>(), "timeout duration counted in minutes. If not provided, user should terminate server with the terminal.") //
+        (CSTR_DBPOOL ",p", po::value<int>(), "maximum number of parallel database connections (default: 8)") //
+        (CSTR_CACHEDIR ",d", po::value<std::string>(), "set directory of the tick cache (default: ~/.shift/DatafeedEngine/cache)") //
+        (CSTR_NOCACHE ",n", "disable the tick cache, i.e. always read Trade & Quote data from database") //
+        (CSTR_TRTHDIR, po::value<std::string>(), "read <symbol><YYYY-MM-DD>.csv[.gz] files of this directory instead of downloading from TRTH (e.g. for testing)") //
         (CSTR_VERBOSE ",v", "verbose mode that dumps detailed server information") //
         ; // add_options
 
@@ -125,28 +145,66 @@ auto main(int argc, char** argv) -> int
         }
     }
 
-    TRTHAPI::s_bTRTHLoginJsonExists = std::ifstream { params.configDir + CSTR_TRTHLOGIN_JSN }.good(); // file exists ?
+    if (vm.count(CSTR_DBPOOL) > 0) {
+        params.dbPoolSize = vm[CSTR_DBPOOL].as<int>();
+        if (params.dbPoolSize < 1) {
+            cout << COLOR "Note: The dbpool option is ignored because of the given value." NO_COLOR << '\n'
+                 << endl;
+            params.dbPoolSize = ::DB_CONNECTION_POOL_SIZE;
+        }
+    }
+
+    if (vm.count(CSTR_CACHEDIR) > 0) {
+        params.cacheDir = vm[CSTR_CACHEDIR].as<std::string>();
+    }
+
+    if (vm.count(CSTR_NOCACHE) > 0) {
+        params.isCacheEnabled = false;
+    }
+
+    const char* homeDir = nullptr;
+    if ((homeDir = getenv("HOME")) == nullptr) {
+        homeDir = getpwuid(getuid())->pw_dir;
+    }
+    std::string servicePath { homeDir };
+    servicePath += "/.shift/DatafeedEngine";
+
+    // tick cache init (directory is also created if it does not exist)
+    if (params.isCacheEnabled) {
+        if (params.cacheDir.empty()) {
+            params.cacheDir = servicePath + "/cache";
+        }
+#if __has_include(<filesystem>)
+        std::filesystem::create_directories(params.cacheDir);
+#else
+        std::experimental::filesystem::create_directories(params.cacheDir);
+#endif
+        TickCache::getInstance().setDirectory(params.cacheDir);
+        cout << COLOR "Tick cache directory: " << params.cacheDir << NO_COLOR << '\n'
+             << endl;
+    }
+
+    TRTHAPI::s_bTRTHLoginJsonExists = std::ifstream { params.configDir + CSTR_TRTHLOGIN_JSN }.good() // file exists ?
+        || vm.count(CSTR_TRTHDIR) > 0; // the local stand-in needs no login
 
     // database init
     auto loginPSQL = shift::crypto::readEncryptedConfigFile(params.cryptoKey, params.configDir + CSTR_DBLOGIN_TXT);
-    PSQLManager::createInstance(std::move(loginPSQL)); // already moved-in, don't use loginPSQL thereafter!
+    PSQLManager::createInstance(std::move(loginPSQL), params.dbPoolSize); // already moved-in, don't use loginPSQL thereafter!
     PSQLManager::getInstance().init();
 
     cout << '\n'
          << COLOR "TRTH is starting..." NO_COLOR << '\n'
          << endl;
-    TRTHAPI::createInstance(params.cryptoKey, params.configDir).start();
+    auto& trthAPI = TRTHAPI::createInstance(params.cryptoKey, params.configDir);
+    if (vm.count(CSTR_TRTHDIR) > 0) {
+        trthAPI.setLocalDataDirectory(vm[CSTR_TRTHDIR].as<std::string>());
+    }
+    trthAPI.start();
 
     FIXAcceptor::getInstance().connectMatchingEngine(params.configDir + "acceptor.cfg", params.isVerbose, params.cryptoKey, params.configDir + CSTR_DBLOGIN_TXT);
 
     // create 'done' file in ~/.shift/DatafeedEngine to signalize shell that service is done loading
     // (directory is also created if it does not exist)
-    const char* homeDir = nullptr;
-    if ((homeDir = getenv("HOME")) == nullptr) {
-        homeDir = getpwuid(getuid())->pw_dir;
-    }
-    std::string servicePath { homeDir };
-    servicePath += "/.shift/DatafeedEngine";
 #if __has_include(<filesystem>)
     std::filesystem::create_directories(servicePath);
 #else
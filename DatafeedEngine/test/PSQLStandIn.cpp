@@ -0,0 +1,178 @@
+#include "PSQLStandIn.h"
+
+#include "PSQL.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <zlib.h>
+
+static std::mutex s_mtxState;
+static std::chrono::milliseconds s_saveDuration { 0 };
+static std::map<std::string, std::vector<std::string>> s_savedTables; // symbol + date => CSV lines
+static std::map<std::string, int> s_numSaves;
+static std::set<std::string> s_tablesBeingSaved;
+static int s_numConcurrentAccesses = 0;
+static int s_numParallelSaves = 0;
+static int s_maxParallelSaves = 0;
+
+/**
+ * @brief Read all lines of a (possibly gzip-compressed) CSV file.
+ */
+static auto s_readLines(const std::string& fileName, std::vector<std::string>* pLines) -> bool
+{
+    gzFile in = gzopen(fileName.c_str(), "rb");
+    if (nullptr == in) {
+        return false;
+    }
+
+    std::string line;
+    char buffer[256];
+    while (nullptr != gzgets(in, buffer, sizeof(buffer))) {
+        line += buffer;
+        if (line.back() == '\n') {
+            line.pop_back();
+            pLines->push_back(std::move(line));
+            line.clear();
+        }
+    }
+    if (!line.empty()) {
+        pLines->push_back(std::move(line));
+    }
+
+    gzclose(in);
+    return true;
+}
+
+void standin::setSaveDuration(std::chrono::milliseconds duration)
+{
+    std::lock_guard<std::mutex> guard(s_mtxState);
+    s_saveDuration = duration;
+}
+
+auto standin::getSavedRecords(const std::string& symbol, const std::string& date) -> std::vector<std::string>
+{
+    std::lock_guard<std::mutex> guard(s_mtxState);
+    auto it = s_savedTables.find(symbol + date);
+    return (s_savedTables.end() == it) ? std::vector<std::string> {} : it->second;
+}
+
+auto standin::getNumSaves(const std::string& symbol, const std::string& date) -> int
+{
+    std::lock_guard<std::mutex> guard(s_mtxState);
+    auto it = s_numSaves.find(symbol + date);
+    return (s_numSaves.end() == it) ? 0 : it->second;
+}
+
+auto standin::getNumConcurrentAccesses() -> int
+{
+    std::lock_guard<std::mutex> guard(s_mtxState);
+    return s_numConcurrentAccesses;
+}
+
+auto standin::getMaxParallelSaves() -> int
+{
+    std::lock_guard<std::mutex> guard(s_mtxState);
+    return s_maxParallelSaves;
+}
+
+void standin::resetMaxParallelSaves()
+{
+    std::lock_guard<std::mutex> guard(s_mtxState);
+    s_maxParallelSaves = s_numParallelSaves;
+}
+
+//-----------------------------------------------------------------------------------------
+
+void cvtRICToDEInternalRepresentation(std::string* pCvtThis, bool reverse /* = false */)
+{
+    const char from = reverse ? '_' : '.';
+    const char to = reverse ? '.' : '_';
+    std::replace(pCvtThis->begin(), pCvtThis->end(), from, to);
+}
+
+PSQL::PSQL(std::unordered_map<std::string, std::string>&& loginInfo, int connectionPoolSize)
+    : m_pConn { nullptr }
+    , m_loginInfo { std::move(loginInfo) }
+    , m_connectionPoolSize { std::max(connectionPoolSize, 1) }
+    , m_numConnections { 0 }
+{
+}
+
+/*virtual*/ PSQL::~PSQL() /*= 0*/
+{
+}
+
+auto PSQL::connectDB() -> bool
+{
+    return true;
+}
+
+auto PSQL::isConnected() const -> bool
+{
+    return true;
+}
+
+auto PSQL::checkTableOfTradeAndQuoteRecordsExist(std::string ric, std::string reutersDate, std::string* pTableName) -> shift::database::TABLE_STATUS
+{
+    const std::string key = ric + reutersDate;
+    *pTableName = key;
+
+    std::lock_guard<std::mutex> guard(s_mtxState);
+    if (s_tablesBeingSaved.count(key) > 0) {
+        ++s_numConcurrentAccesses;
+    }
+    return (s_savedTables.count(key) > 0) ? shift::database::TABLE_STATUS::EXISTS : shift::database::TABLE_STATUS::NOT_EXIST;
+}
+
+auto PSQL::saveCSVIntoDB(std::string csvName, std::string symbol, std::string date) -> bool
+{
+    const std::string key = symbol + date;
+    std::chrono::milliseconds saveDuration;
+
+    {
+        std::lock_guard<std::mutex> guard(s_mtxState);
+        if (!s_tablesBeingSaved.insert(key).second) {
+            ++s_numConcurrentAccesses;
+        }
+        ++s_numSaves[key];
+        s_maxParallelSaves = std::max(s_maxParallelSaves, ++s_numParallelSaves);
+        saveDuration = s_saveDuration;
+    }
+
+    std::vector<std::string> lines;
+    const bool isRead = s_readLines(csvName, &lines);
+    std::this_thread::sleep_for(saveDuration);
+
+    std::lock_guard<std::mutex> guard(s_mtxState);
+    if (isRead) {
+        s_savedTables[key] = std::move(lines);
+    }
+    s_tablesBeingSaved.erase(key);
+    --s_numParallelSaves;
+    return isRead;
+}
+
+//-----------------------------------------------------------------------------------------
+
+/* static */ PSQLManager* PSQLManager::s_pInst = nullptr;
+
+PSQLManager::PSQLManager(std::unordered_map<std::string, std::string>&& loginInfo, int connectionPoolSize)
+    : PSQL { std::move(loginInfo), connectionPoolSize }
+{
+}
+
+/* static */ auto PSQLManager::createInstance(std::unordered_map<std::string, std::string>&& loginInfo, int connectionPoolSize) -> PSQLManager&
+{
+    static PSQLManager s_inst(std::move(loginInfo), connectionPoolSize);
+    s_pInst = &s_inst;
+    return s_inst;
+}
+
+/* static */ auto PSQLManager::getInstance() -> PSQLManager&
+{
+    return *s_pInst;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Observations of the in-memory stand-in for PSQL (PSQLStandIn.cpp), which the tests link instead of PSQL.cpp.
+ *        A "table" exists once a file was saved for its symbol and date; saving keeps the decompressed CSV lines of the file.
+ */
+namespace standin {
+
+/* @brief How long each save takes, so that parallel saves overlap. */
+void setSaveDuration(std::chrono::milliseconds duration);
+
+/* @brief The CSV lines saved for a symbol and date, in file order (empty if nothing was saved). */
+auto getSavedRecords(const std::string& symbol, const std::string& date) -> std::vector<std::string>;
+
+/* @brief Number of times a file was saved for a symbol and date. */
+auto getNumSaves(const std::string& symbol, const std::string& date) -> int;
+
+/* @brief Number of times the table of a symbol and date was checked or saved while it was being saved. */
+auto getNumConcurrentAccesses() -> int;
+
+/* @brief Maximum number of saves that were running at the same time, since the last reset. */
+auto getMaxParallelSaves() -> int;
+void resetMaxParallelSaves();
+
+} // standin
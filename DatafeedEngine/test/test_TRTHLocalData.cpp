@@ -0,0 +1,176 @@
+#define BOOST_TEST_MODULE test_TRTHLocalData
+#define BOOST_TEST_DYN_LINK
+
+#include "PSQLStandIn.h"
+
+#include "PSQL.h"
+#include "Parameters.h"
+#include "TRTHAPI.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if __has_include(<filesystem>)
+#include <filesystem>
+namespace fs = std::filesystem;
+#else
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+#include <zlib.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std::chrono_literals;
+
+static const std::string s_date = "2020-01-02";
+static std::string s_trthDir; // the local stand-in for TRTH downloads (i.e. --trthdir)
+
+/**
+ * @brief Runs the TRTH request processors on a temporary --trthdir, with PSQLStandIn.cpp in place of the database.
+ */
+struct TRTHFixture {
+    TRTHFixture()
+    {
+        char dirTemplate[] = "/tmp/shift_trthdir_XXXXXX";
+        if (nullptr == ::mkdtemp(dirTemplate)) {
+            throw std::runtime_error("Cannot create the temporary --trthdir.");
+        }
+        s_trthDir = dirTemplate;
+
+        PSQLManager::createInstance({}, ::DB_CONNECTION_POOL_SIZE);
+
+        TRTHAPI::s_bTRTHLoginJsonExists = true; // as with --trthdir, which needs no login
+        auto& trthAPI = TRTHAPI::createInstance("", "");
+        trthAPI.setLocalDataDirectory(s_trthDir); // without the trailing '/', as given in the command line
+        trthAPI.start();
+    }
+
+    ~TRTHFixture()
+    {
+        TRTHAPI::getInstance().stop();
+        fs::remove_all(s_trthDir);
+    }
+};
+
+BOOST_GLOBAL_FIXTURE(TRTHFixture);
+
+/**
+ * @brief Write <symbol><date>.csv.gz into the --trthdir, as TRTH would download it.
+ */
+static void s_writeCSVGz(const std::string& symbol, const std::vector<std::string>& lines)
+{
+    gzFile out = gzopen((s_trthDir + '/' + symbol + s_date + ".csv.gz").c_str(), "wb");
+    BOOST_REQUIRE(nullptr != out);
+    for (const auto& line : lines) {
+        gzputs(out, (line + '\n').c_str());
+    }
+    gzclose(out);
+}
+
+/**
+ * @brief Enqueue requests for the symbols and wait until all of them were processed.
+ * @return The results of the requests, in the same order.
+ */
+static auto s_requestAll(const std::vector<std::string>& symbols) -> std::vector<bool>
+{
+    std::deque<std::promise<bool>> proms(symbols.size()); // the promises must not move while being processed
+    std::vector<std::future<bool>> futs;
+
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        futs.push_back(proms[i].get_future());
+
+        TRTHRequest req;
+        req.symbol = symbols[i];
+        req.date = s_date;
+        req.prom = &proms[i];
+        TRTHAPI::getInstance().enqueueRequest(std::move(req));
+    }
+
+    std::vector<bool> results;
+    for (auto& fut : futs) {
+        BOOST_REQUIRE(fut.wait_for(30s) == std::future_status::ready);
+        results.push_back(fut.get());
+    }
+    return results;
+}
+
+static const std::vector<std::string> s_records = {
+    "#RIC,Domain,Date-Time,GMT Offset,Type,Price,Volume,Bid Price,Bid Size,Ask Price,Ask Size,Exch Time",
+    "TEST.A,Market Price,2020-01-02T14:30:00.000000000Z,-5,Quote,,,100.01,5,100.03,3,14:30:00.000000000",
+    "TEST.A,Market Price,2020-01-02T14:30:00.000000000Z,-5,Trade,100.02,200,,,,,14:30:00.000000000",
+    "TEST.A,Market Price,2020-01-02T14:30:00.000123000Z,-5,Quote,,,100.02,1,100.03,3,14:30:00.000123000",
+};
+
+BOOST_AUTO_TEST_CASE(IngestsLocalCSVGz)
+{
+    s_writeCSVGz("TEST.A", s_records);
+
+    const auto results = s_requestAll({ "TEST.A" });
+    BOOST_TEST(results.front());
+
+    BOOST_TEST(standin::getNumSaves("TEST.A", s_date) == 1);
+    BOOST_TEST(standin::getSavedRecords("TEST.A", s_date) == s_records, boost::test_tools::per_element());
+
+    // files of the local stand-in are not temporary downloads, and stay in place
+    BOOST_TEST(std::ifstream { s_trthDir + "/TEST.A" + s_date + ".csv.gz" }.good());
+}
+
+BOOST_AUTO_TEST_CASE(MissingLocalFileIsUnavailable)
+{
+    const auto results = s_requestAll({ "TEST.MISSING" });
+    BOOST_TEST(!results.front());
+    BOOST_TEST(standin::getNumSaves("TEST.MISSING", s_date) == 0);
+
+    std::vector<std::string> rics { "TEST.MISSING" };
+    BOOST_TEST(TRTHAPI::getInstance().removeUnavailableRICs(rics) == 1u);
+    BOOST_TEST(rics.empty());
+}
+
+BOOST_AUTO_TEST_CASE(DeduplicatesConcurrentRequests)
+{
+    standin::setSaveDuration(100ms); // so that all workers pick a request while the first one is still saving
+    s_writeCSVGz("TEST.B", s_records);
+
+    const auto results = s_requestAll(std::vector<std::string>(2 * ::TRTH_NUM_DOWNLOAD_WORKERS, "TEST.B"));
+    for (bool result : results) {
+        BOOST_TEST(result);
+    }
+
+    // the duplicates waited for the first request, then found its table
+    BOOST_TEST(standin::getNumSaves("TEST.B", s_date) == 1);
+    BOOST_TEST(standin::getNumConcurrentAccesses() == 0);
+
+    standin::setSaveDuration(0ms);
+}
+
+BOOST_AUTO_TEST_CASE(LimitsParallelSaves)
+{
+    standin::setSaveDuration(100ms); // so that all workers try to save at the same time
+    standin::resetMaxParallelSaves();
+
+    std::vector<std::string> symbols;
+    for (int i = 0; i < 2 * ::TRTH_NUM_DOWNLOAD_WORKERS; ++i) {
+        symbols.push_back("TEST.C" + std::to_string(i));
+        s_writeCSVGz(symbols.back(), s_records);
+    }
+
+    const auto results = s_requestAll(symbols);
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        BOOST_TEST(results[i]);
+        BOOST_TEST(standin::getNumSaves(symbols[i], s_date) == 1);
+    }
+
+    BOOST_TEST(standin::getMaxParallelSaves() <= ::TRTH_MAX_PARALLEL_SAVES);
+    BOOST_TEST(standin::getMaxParallelSaves() == std::min(::TRTH_MAX_PARALLEL_SAVES, ::TRTH_NUM_DOWNLOAD_WORKERS));
+
+    standin::setSaveDuration(0ms);
+}
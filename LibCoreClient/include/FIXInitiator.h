@@ -92,6 +92,7 @@ protected:
 
     // FIXInitiator - QuickFIX methods
     static void s_sendOrderBookRequest(const std::string& symbol, bool isSubscribed);
+    static void s_sendOrderBookSnapshotRequest(const std::string& symbol);
     static void s_sendCandlestickDataRequest(const std::string& symbol, bool isSubscribed);
 
     void submitOrder(const Order&, const std::string& userID = "");
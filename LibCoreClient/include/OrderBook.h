@@ -23,6 +23,15 @@ public:
         LOCAL_ASK = 'a'
     };
 
+    /**
+     * @brief What to do with an order book update, according to its sequence number.
+     */
+    enum class UpdateAction {
+        APPLY,
+        DISCARD, // already part of the last snapshot, or waiting for a snapshot
+        RESYNCHRONIZE, // updates were missed: a new snapshot is needed
+    };
+
     OrderBook(std::string symbol, Type type);
     virtual ~OrderBook() = default;
 
@@ -36,6 +45,8 @@ public:
     auto getOrderBookWithDestination() -> std::vector<shift::OrderBookEntry>;
 
     void setOrderBook(std::list<shift::OrderBookEntry>&& entries);
+    void setOrderBook(std::list<shift::OrderBookEntry>&& entries, unsigned int seqNum);
+    auto sequenceUpdate(unsigned int seqNum) -> UpdateAction;
     void resetOrderBook();
     void displayOrderBook();
 
@@ -49,6 +60,9 @@ protected:
 
     mutable std::mutex m_mutex;
     std::list<shift::OrderBookEntry> m_entries;
+
+    unsigned int m_seqNum; // sequence number of the last update included in m_entries
+    bool m_isSynchronized; // whether m_entries comes from a snapshot followed by all its updates
 };
 
 } // shift
@@ -8,8 +8,6 @@
 #include "OrderBookLocalBid.h"
 #include "Parameters.h"
 
-#include <atomic>
-#include <cassert>
 #include <cmath>
 #include <future>
 #include <list>
@@ -25,11 +23,13 @@
 #include <Common.h>
 #include <crypto/Encryptor.h>
 #include <fix/HelperFunctions.h>
+#include <fix/ThreadLocalFields.h>
 #include <terminal/Common.h>
 #else
 #include <shift/miscutils/Common.h>
 #include <shift/miscutils/crypto/Encryptor.h>
 #include <shift/miscutils/fix/HelperFunctions.h>
+#include <shift/miscutils/fix/ThreadLocalFields.h>
 #include <shift/miscutils/terminal/Common.h>
 #endif
 
@@ -45,6 +45,7 @@ static const auto& FIXFIELD_BEGINSTRING_FIXT11 = FIX::BeginString(FIX::BeginStri
 static const auto& FIXFIELD_USERREQUESTTYPE_LOG_ON_USER = FIX::UserRequestType(FIX::UserRequestType_LOG_ON_USER);
 static const auto& FIXFIELD_SUBSCRIPTIONREQUESTTYPE_SUBSCRIBE = FIX::SubscriptionRequestType(FIX::SubscriptionRequestType_SNAPSHOT_PLUS_UPDATES);
 static const auto& FIXFIELD_SUBSCRIPTIONREQUESTTYPE_UNSUBSCRIBE = FIX::SubscriptionRequestType(FIX::SubscriptionRequestType_DISABLE_PREVIOUS_SNAPSHOT_PLUS_UPDATE_REQUEST);
+static const auto& FIXFIELD_SUBSCRIPTIONREQUESTTYPE_SNAPSHOT = FIX::SubscriptionRequestType(FIX::SubscriptionRequestType_SNAPSHOT);
 static const auto& FIXFIELD_MDUPDATETYPE_INCREMENTAL_REFRESH = FIX::MDUpdateType(FIX::MDUpdateType_INCREMENTAL_REFRESH);
 static const auto& FIXFIELD_MARKETDEPTH_FULL_BOOK_DEPTH = FIX::MarketDepth(0);
 static const auto& FIXFIELD_MDENTRYTYPE_BID = FIX::MDEntryType(FIX::MDEntryType_BID);
@@ -432,6 +433,33 @@ inline void FIXInitiator::initializeOrderBooks()
     FIX::Session::sendToTarget(message);
 }
 
+/*
+ * @brief Request again the order book snapshots of a subscribed symbol, after a gap in its updates.
+ */
+/* static */ void FIXInitiator::s_sendOrderBookSnapshotRequest(const std::string& symbol)
+{
+    FIX::Message message;
+
+    FIX::Header& header = message.getHeader();
+    header.setField(::FIXFIELD_BEGINSTRING_FIXT11);
+    header.setField(FIX::SenderCompID(s_senderID));
+    header.setField(FIX::TargetCompID(s_targetID));
+    header.setField(FIX::MsgType(FIX::MsgType_MarketDataRequest));
+
+    message.setField(FIX::MDReqID(crossguid::newGuid().str()));
+    message.setField(::FIXFIELD_SUBSCRIPTIONREQUESTTYPE_SNAPSHOT);
+    message.setField(::FIXFIELD_MARKETDEPTH_FULL_BOOK_DEPTH); // required by FIX
+
+    fix::addFIXGroup<FIX50SP2::MarketDataRequest::NoMDEntryTypes>(message,
+        ::FIXFIELD_MDENTRYTYPE_BID);
+    fix::addFIXGroup<FIX50SP2::MarketDataRequest::NoMDEntryTypes>(message,
+        ::FIXFIELD_MDENTRYTYPE_OFFER);
+    fix::addFIXGroup<FIX50SP2::MarketDataRequest::NoRelatedSym>(message,
+        FIX::Symbol(symbol));
+
+    FIX::Session::sendToTarget(message);
+}
+
 /*
  * @brief Send candle data request to BC.
  */
@@ -617,69 +645,24 @@ void FIXInitiator::onMessage(const FIX50SP2::UserResponse& message, const FIX::S
 void FIXInitiator::onMessage(const FIX50SP2::Advertisement& message, const FIX::SessionID& sessionID) // override
 {
     if (m_connected) {
-        static FIX::Symbol originalName;
-        static FIX::Quantity size;
-        static FIX::Price price;
-        static FIX::TransactTime simulationTime;
-        static FIX::LastMkt destination;
-
-        // #pragma GCC diagnostic ignored ....
-
-        FIX::Symbol* pOriginalName = nullptr;
-        FIX::Quantity* pSize = nullptr;
-        FIX::Price* pPrice = nullptr;
-        FIX::TransactTime* pSimulationTime = nullptr;
-        FIX::LastMkt* pDestination = nullptr;
-
-        static std::atomic<unsigned int> s_cntAtom { 0 };
-        unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
+        auto& [originalName, size, price, simulationTime, destination] = shift::fix::getThreadLocalFields<FIX50SP2::Advertisement, FIX::Symbol, FIX::Quantity, FIX::Price, FIX::TransactTime, FIX::LastMkt>();
 
-        while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-        }
-
-        assert(s_cntAtom > 0);
-
-        if (0 == prevCnt) { // sequential case; optimized:
-            pOriginalName = &originalName;
-            pSize = &size;
-            pPrice = &price;
-            pSimulationTime = &simulationTime;
-            pDestination = &destination;
-        } else { // > 1 threads; always safe way:
-            pOriginalName = new decltype(originalName);
-            pSize = new decltype(size);
-            pPrice = new decltype(price);
-            pSimulationTime = new decltype(simulationTime);
-            pDestination = new decltype(destination);
-        }
+        message.getField(originalName);
+        message.getField(size);
+        message.getField(price);
+        message.getField(simulationTime);
+        message.getField(destination);
 
-        message.getField(*pOriginalName);
-        message.getField(*pSize);
-        message.getField(*pPrice);
-        message.getField(*pSimulationTime);
-        message.getField(*pDestination);
+        std::string symbol = m_originalName_symbol[originalName.getValue()];
 
-        std::string symbol = m_originalName_symbol[pOriginalName->getValue()];
-
-        m_lastTrades[symbol].first = pPrice->getValue();
-        m_lastTrades[symbol].second = static_cast<int>(pSize->getValue());
-        m_lastTradeTime = std::chrono::system_clock::from_time_t(pSimulationTime->getValue().getTimeT());
+        m_lastTrades[symbol].first = price.getValue();
+        m_lastTrades[symbol].second = static_cast<int>(size.getValue());
+        m_lastTradeTime = std::chrono::system_clock::from_time_t(simulationTime.getValue().getTimeT());
 
         try {
             getSuperUser()->receiveLastPrice(symbol);
         } catch (...) {
         }
-
-        if (0 != prevCnt) { // > 1 threads
-            delete pOriginalName;
-            delete pSize;
-            delete pPrice;
-            delete pSimulationTime;
-            delete pDestination;
-        }
-
-        s_cntAtom--;
-        assert(s_cntAtom >= 0);
     }
 }
 
@@ -696,92 +679,40 @@ void FIXInitiator::onMessage(const FIX50SP2::MarketDataSnapshotFullRefresh& mess
         return;
     }
 
-    static FIX::Symbol originalName;
-
-    static FIX50SP2::MarketDataSnapshotFullRefresh::NoMDEntries entryGroup;
-    static FIX::MDEntryType bookType;
-    static FIX::MDEntryPx price;
-    static FIX::MDEntrySize size;
-    static FIX::MDEntryDate simulationDate;
-    static FIX::MDEntryTime simulationTime;
-    static FIX::MDMkt destination;
-
-    // #pragma GCC diagnostic ignored ....
-
-    FIX::Symbol* pOriginalName = nullptr;
-
-    FIX50SP2::MarketDataSnapshotFullRefresh::NoMDEntries* pEntryGroup = nullptr;
-    FIX::MDEntryType* pBookType = nullptr;
-    FIX::MDEntryPx* pPrice = nullptr;
-    FIX::MDEntrySize* pSize = nullptr;
-    FIX::MDEntryDate* pSimulationDate = nullptr;
-    FIX::MDEntryTime* pSimulationTime = nullptr;
-    FIX::MDMkt* pDestination = nullptr;
+    auto& [originalName, seqNum, entryGroup, bookType, price, size, simulationDate, simulationTime, destination] = shift::fix::getThreadLocalFields<FIX50SP2::MarketDataSnapshotFullRefresh, FIX::Symbol, FIX::RptSeq, FIX50SP2::MarketDataSnapshotFullRefresh::NoMDEntries, FIX::MDEntryType, FIX::MDEntryPx, FIX::MDEntrySize, FIX::MDEntryDate, FIX::MDEntryTime, FIX::MDMkt>();
 
-    static std::atomic<unsigned int> s_cntAtom { 0 };
-    unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
+    message.getField(originalName);
 
-    while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-    }
+    std::string symbol = m_originalName_symbol[originalName.getValue()];
+    std::list<OrderBookEntry> orderBook;
 
-    assert(s_cntAtom > 0);
-
-    if (0 == prevCnt) { // sequential case; optimized:
-        pOriginalName = &originalName;
-        pEntryGroup = &entryGroup;
-        pBookType = &bookType;
-        pPrice = &price;
-        pSize = &size;
-        pSimulationDate = &simulationDate;
-        pSimulationTime = &simulationTime;
-        pDestination = &destination;
-    } else { // > 1 threads; always safe way:
-        pOriginalName = new decltype(originalName);
-        pEntryGroup = new decltype(entryGroup);
-        pBookType = new decltype(bookType);
-        pPrice = new decltype(price);
-        pSize = new decltype(size);
-        pSimulationDate = new decltype(simulationDate);
-        pSimulationTime = new decltype(simulationTime);
-        pDestination = new decltype(destination);
-    }
+    for (int i = 1; i <= numOfEntries.getValue(); ++i) {
+        message.getGroup(static_cast<unsigned int>(i), entryGroup);
 
-    message.getField(*pOriginalName);
+        entryGroup.getField(bookType);
+        entryGroup.getField(price);
+        entryGroup.getField(size);
+        entryGroup.getField(simulationDate);
+        entryGroup.getField(simulationTime);
+        entryGroup.getField(destination);
 
-    std::string symbol = m_originalName_symbol[pOriginalName->getValue()];
-    std::list<OrderBookEntry> orderBook;
+        if (price.getValue() <= 0.0) { // an empty order book is sent as a single entry with price 0.0
+            continue;
+        }
 
-    for (int i = 1; i <= numOfEntries.getValue(); ++i) {
-        message.getGroup(static_cast<unsigned int>(i), *pEntryGroup);
-
-        pEntryGroup->getField(*pBookType);
-        pEntryGroup->getField(*pPrice);
-        pEntryGroup->getField(*pSize);
-        pEntryGroup->getField(*pSimulationDate);
-        pEntryGroup->getField(*pSimulationTime);
-        pEntryGroup->getField(*pDestination);
-
-        orderBook.emplace_back(static_cast<double>(pPrice->getValue()),
-            static_cast<int>(pSize->getValue()),
-            pDestination->getValue(),
-            s_convertToTimePoint(pSimulationDate->getValue(), pSimulationTime->getValue()));
+        orderBook.emplace_back(static_cast<double>(price.getValue()),
+            static_cast<int>(size.getValue()),
+            destination.getValue(),
+            s_convertToTimePoint(simulationDate.getValue(), simulationTime.getValue()));
     }
 
-    m_orderBooks[symbol][static_cast<OrderBook::Type>(pBookType->getValue())]->setOrderBook(std::move(orderBook));
-
-    if (0 != prevCnt) { // > 1 threads
-        delete pOriginalName;
-        delete pEntryGroup;
-        delete pBookType;
-        delete pPrice;
-        delete pSize;
-        delete pSimulationDate;
-        delete pSimulationTime;
-        delete pDestination;
+    auto& book = m_orderBooks[symbol][static_cast<OrderBook::Type>(bookType.getValue())];
+    if (message.isSetField(FIX::FIELD::RptSeq)) {
+        message.getField(seqNum);
+        book->setOrderBook(std::move(orderBook), static_cast<unsigned int>(seqNum.getValue()));
+    } else {
+        book->setOrderBook(std::move(orderBook));
     }
-
-    s_cntAtom--;
-    assert(s_cntAtom >= 0);
 }
 
 /**
@@ -798,90 +729,46 @@ void FIXInitiator::onMessage(const FIX50SP2::MarketDataIncrementalRefresh& messa
         return;
     }
 
-    static FIX50SP2::MarketDataIncrementalRefresh::NoMDEntries entryGroup;
-    static FIX::MDEntryType bookType;
-    static FIX::Symbol originalName;
-    static FIX::MDEntryPx price;
-    static FIX::MDEntrySize size;
-    static FIX::MDEntryDate simulationDate;
-    static FIX::MDEntryTime simulationTime;
-    static FIX::MDMkt destination;
-
-    // #pragma GCC diagnostic ignored ....
-
-    FIX50SP2::MarketDataIncrementalRefresh::NoMDEntries* pEntryGroup = nullptr;
-    FIX::MDEntryType* pBookType = nullptr;
-    FIX::Symbol* pOriginalName = nullptr;
-    FIX::MDEntryPx* pPrice = nullptr;
-    FIX::MDEntrySize* pSize = nullptr;
-    FIX::MDEntryDate* pSimulationDate = nullptr;
-    FIX::MDEntryTime* pSimulationTime = nullptr;
-    FIX::MDMkt* pDestination = nullptr;
-
-    static std::atomic<unsigned int> s_cntAtom { 0 };
-    unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-    while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-    }
+    auto& [entryGroup, bookType, originalName, price, size, simulationDate, simulationTime, destination, seqNum] = shift::fix::getThreadLocalFields<FIX50SP2::MarketDataIncrementalRefresh, FIX50SP2::MarketDataIncrementalRefresh::NoMDEntries, FIX::MDEntryType, FIX::Symbol, FIX::MDEntryPx, FIX::MDEntrySize, FIX::MDEntryDate, FIX::MDEntryTime, FIX::MDMkt, FIX::RptSeq>();
 
-    assert(s_cntAtom > 0);
-
-    if (0 == prevCnt) { // sequential case; optimized:
-        pEntryGroup = &entryGroup;
-        pBookType = &bookType;
-        pOriginalName = &originalName;
-        pPrice = &price;
-        pSize = &size;
-        pSimulationDate = &simulationDate;
-        pSimulationTime = &simulationTime;
-        pDestination = &destination;
-    } else { // > 1 threads; always safe way:
-        pEntryGroup = new decltype(entryGroup);
-        pBookType = new decltype(bookType);
-        pOriginalName = new decltype(originalName);
-        pPrice = new decltype(price);
-        pSize = new decltype(size);
-        pSimulationDate = new decltype(simulationDate);
-        pSimulationTime = new decltype(simulationTime);
-        pDestination = new decltype(destination);
-    }
+    message.getGroup(1, entryGroup);
+    entryGroup.getField(bookType);
+    entryGroup.getField(originalName);
+    entryGroup.getField(price);
+    entryGroup.getField(size);
+    entryGroup.getField(simulationDate);
+    entryGroup.getField(simulationTime);
+    entryGroup.getField(destination);
 
-    message.getGroup(1, *pEntryGroup);
-    pEntryGroup->getField(*pBookType);
-    pEntryGroup->getField(*pOriginalName);
-    pEntryGroup->getField(*pPrice);
-    pEntryGroup->getField(*pSize);
-    pEntryGroup->getField(*pSimulationDate);
-    pEntryGroup->getField(*pSimulationTime);
-    pEntryGroup->getField(*pDestination);
+    std::string symbol = m_originalName_symbol[originalName.getValue()];
+    auto& book = m_orderBooks[symbol][static_cast<OrderBook::Type>(bookType.getValue())];
 
-    std::string symbol = m_originalName_symbol[pOriginalName->getValue()];
+    if (entryGroup.isSetField(FIX::FIELD::RptSeq)) {
+        entryGroup.getField(seqNum);
+
+        switch (book->sequenceUpdate(static_cast<unsigned int>(seqNum.getValue()))) {
+        case OrderBook::UpdateAction::APPLY:
+            break;
+        case OrderBook::UpdateAction::DISCARD:
+            return;
+        case OrderBook::UpdateAction::RESYNCHRONIZE:
+            debugDump("Gap in the order book updates of " + symbol + ": requesting a new snapshot.");
+            s_sendOrderBookSnapshotRequest(originalName.getValue());
+            return;
+        }
+    }
 
-    if (pPrice->getValue() > 0.0) {
+    if (price.getValue() > 0.0) {
         OrderBookEntry entry {
-            pPrice->getValue(),
-            static_cast<int>(pSize->getValue()),
-            pDestination->getValue(),
-            s_convertToTimePoint(pSimulationDate->getValue(), pSimulationTime->getValue())
+            price.getValue(),
+            static_cast<int>(size.getValue()),
+            destination.getValue(),
+            s_convertToTimePoint(simulationDate.getValue(), simulationTime.getValue())
         };
-        m_orderBooks[symbol][static_cast<OrderBook::Type>(pBookType->getValue())]->update(std::move(entry));
+        book->update(std::move(entry));
     } else {
-        m_orderBooks[symbol][static_cast<OrderBook::Type>(pBookType->getValue())]->resetOrderBook();
-    }
-
-    if (0 != prevCnt) { // > 1 threads
-        delete pEntryGroup;
-        delete pBookType;
-        delete pOriginalName;
-        delete pPrice;
-        delete pSize;
-        delete pSimulationDate;
-        delete pSimulationTime;
-        delete pDestination;
+        book->resetOrderBook();
     }
-
-    s_cntAtom--;
-    assert(s_cntAtom >= 0);
 }
 
 /**
@@ -890,61 +777,23 @@ void FIXInitiator::onMessage(const FIX50SP2::MarketDataIncrementalRefresh& messa
  */
 void FIXInitiator::onMessage(const FIX50SP2::SecurityStatus& message, const FIX::SessionID& sessionID) // override
 {
-    static FIX::Symbol originalName;
-    static FIX::HighPx highPrice;
-    static FIX::LowPx lowPrice;
-    static FIX::LastPx closePrice;
-    static FIX::FirstPx openPrice;
-    static FIX::TransactTime timestamp;
-
-    // #pragma GCC diagnostic ignored ....
-
-    FIX::Symbol* pOriginalName = nullptr;
-    FIX::HighPx* pHighPrice = nullptr;
-    FIX::LowPx* pLowPrice = nullptr;
-    FIX::LastPx* pClosePrice = nullptr;
-    FIX::FirstPx* pOpenPrice = nullptr;
-    FIX::TransactTime* pTimestamp = nullptr;
-
-    static std::atomic<unsigned int> s_cntAtom { 0 };
-    unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-    while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-    }
-
-    assert(s_cntAtom > 0);
-
-    if (0 == prevCnt) { // sequential case; optimized:
-        pOriginalName = &originalName;
-        pHighPrice = &highPrice;
-        pLowPrice = &lowPrice;
-        pClosePrice = &closePrice;
-        pOpenPrice = &openPrice;
-        pTimestamp = &timestamp;
-    } else { // > 1 threads; always safe way:
-        pOriginalName = new decltype(originalName);
-        pHighPrice = new decltype(highPrice);
-        pLowPrice = new decltype(lowPrice);
-        pClosePrice = new decltype(closePrice);
-        pOpenPrice = new decltype(openPrice);
-        pTimestamp = new decltype(timestamp);
-    }
+    auto& [originalName, highPrice, lowPrice, closePrice, openPrice, timestamp] = shift::fix::getThreadLocalFields<FIX50SP2::SecurityStatus, FIX::Symbol, FIX::HighPx, FIX::LowPx, FIX::LastPx, FIX::FirstPx, FIX::TransactTime>();
 
-    message.getField(*pOriginalName);
-    message.getField(*pHighPrice);
-    message.getField(*pLowPrice);
-    message.getField(*pClosePrice);
-    message.getField(*pOpenPrice);
-    message.getField(*pTimestamp);
+    message.getField(originalName);
+    message.getField(highPrice);
+    message.getField(lowPrice);
+    message.getField(closePrice);
+    message.getField(openPrice);
+    message.getField(timestamp);
 
-    std::string symbol = m_originalName_symbol[pOriginalName->getValue()];
+    std::string symbol = m_originalName_symbol[originalName.getValue()];
 
     // logic for storing open price and check if ready:
     // open price stores the very first candle data open price for each ticker
     if (!m_openPricesReady) {
         std::lock_guard<std::mutex> opGuard(m_mtxOpenPrices);
         if (m_openPrices.find(symbol) == m_openPrices.end()) {
-            m_openPrices[symbol] = pOpenPrice->getValue();
+            m_openPrices[symbol] = openPrice.getValue();
             if (m_openPrices.size() == getStockList().size()) {
                 m_openPricesReady = true;
             }
@@ -952,21 +801,9 @@ void FIXInitiator::onMessage(const FIX50SP2::SecurityStatus& message, const FIX:
     }
 
     try {
-        getSuperUser()->receiveCandlestickData(symbol, pOpenPrice->getValue(), pHighPrice->getValue(), pLowPrice->getValue(), pClosePrice->getValue(), std::to_string(pTimestamp->getValue().getTimeT()));
+        getSuperUser()->receiveCandlestickData(symbol, openPrice.getValue(), highPrice.getValue(), lowPrice.getValue(), closePrice.getValue(), std::to_string(timestamp.getValue().getTimeT()));
     } catch (...) {
     }
-
-    if (0 != prevCnt) { // > 1 threads
-        delete pOriginalName;
-        delete pHighPrice;
-        delete pLowPrice;
-        delete pClosePrice;
-        delete pOpenPrice;
-        delete pTimestamp;
-    }
-
-    s_cntAtom--;
-    assert(s_cntAtom >= 0);
 }
 
 /**
@@ -982,78 +819,22 @@ void FIXInitiator::onMessage(const FIX50SP2::ExecutionReport& message, const FIX
         return;
     }
 
-    static FIX::OrderID orderID;
-    static FIX::OrdStatus status;
-    static FIX::OrdType orderType;
-    static FIX::Price executedPrice;
-    static FIX::CumQty executedSize;
+    auto& [orderID, status, orderType, executedPrice, executedSize, idGroup, userID] = shift::fix::getThreadLocalFields<FIX50SP2::ExecutionReport, FIX::OrderID, FIX::OrdStatus, FIX::OrdType, FIX::Price, FIX::CumQty, FIX50SP2::ExecutionReport::NoPartyIDs, FIX::PartyID>();
 
-    static FIX50SP2::ExecutionReport::NoPartyIDs idGroup;
-    static FIX::PartyID userID;
+    message.getField(orderID);
+    message.getField(status);
+    message.getField(orderType);
+    message.getField(executedPrice);
+    message.getField(executedSize);
 
-    // #pragma GCC diagnostic ignored ....
-
-    FIX::OrderID* pOrderID = nullptr;
-    FIX::OrdStatus* pStatus = nullptr;
-    FIX::OrdType* pOrderType = nullptr;
-    FIX::Price* pExecutedPrice = nullptr;
-    FIX::CumQty* pExecutedSize = nullptr;
-
-    FIX50SP2::ExecutionReport::NoPartyIDs* pIDGroup = nullptr;
-    FIX::PartyID* pUserID = nullptr;
-
-    static std::atomic<unsigned int> s_cntAtom { 0 };
-    unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-    while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-    }
-
-    assert(s_cntAtom > 0);
-
-    if (0 == prevCnt) { // sequential case; optimized:
-        pOrderID = &orderID;
-        pStatus = &status;
-        pOrderType = &orderType;
-        pExecutedPrice = &executedPrice;
-        pExecutedSize = &executedSize;
-        pIDGroup = &idGroup;
-        pUserID = &userID;
-    } else { // > 1 threads; always safe way:
-        pOrderID = new decltype(orderID);
-        pStatus = new decltype(status);
-        pOrderType = new decltype(orderType);
-        pExecutedPrice = new decltype(executedPrice);
-        pExecutedSize = new decltype(executedSize);
-        pIDGroup = new decltype(idGroup);
-        pUserID = new decltype(userID);
-    }
-
-    message.getField(*pOrderID);
-    message.getField(*pStatus);
-    message.getField(*pOrderType);
-    message.getField(*pExecutedPrice);
-    message.getField(*pExecutedSize);
-
-    message.getGroup(1, *pIDGroup);
-    pIDGroup->getField(*pUserID);
+    message.getGroup(1, idGroup);
+    idGroup.getField(userID);
 
     try {
-        getClientByUserID(pUserID->getValue())->storeExecution(pOrderID->getValue(), static_cast<Order::Type>(pOrderType->getValue()), static_cast<int>(pExecutedSize->getValue()), pExecutedPrice->getValue(), static_cast<Order::Status>(pStatus->getValue()));
-        getClientByUserID(pUserID->getValue())->receiveExecution(pOrderID->getValue());
+        getClientByUserID(userID.getValue())->storeExecution(orderID.getValue(), static_cast<Order::Type>(orderType.getValue()), static_cast<int>(executedSize.getValue()), executedPrice.getValue(), static_cast<Order::Status>(status.getValue()));
+        getClientByUserID(userID.getValue())->receiveExecution(orderID.getValue());
     } catch (...) {
     }
-
-    if (0 != prevCnt) { // > 1 threads
-        delete pOrderID;
-        delete pStatus;
-        delete pExecutedPrice;
-        delete pExecutedSize;
-        delete pIDGroup;
-        delete pUserID;
-    }
-
-    s_cntAtom--;
-    assert(s_cntAtom >= 0);
 }
 
 /**
@@ -1070,184 +851,54 @@ void FIXInitiator::onMessage(const FIX50SP2::PositionReport& message, const FIX:
 
     if (type == FIX::SecurityType_COMMON_STOCK) { // item
 
-        static FIX::Symbol originalName;
-        static FIX::SettlPrice longPrice;
-        static FIX::PriorSettlPrice shortPrice;
-        static FIX::PriceDelta realizedPL;
-
-        static FIX50SP2::PositionReport::NoPartyIDs userIDGroup;
-        static FIX::PartyID userID;
-
-        static FIX50SP2::PositionReport::NoPositions sizeGroup;
-        static FIX::LongQty longSize;
-        static FIX::ShortQty shortSize;
-
-        // #pragma GCC diagnostic ignored ....
+        auto& [originalName, longPrice, shortPrice, realizedPL, userIDGroup, userID, sizeGroup, longSize, shortSize] = shift::fix::getThreadLocalFields<FIX50SP2::PositionReport, FIX::Symbol, FIX::SettlPrice, FIX::PriorSettlPrice, FIX::PriceDelta, FIX50SP2::PositionReport::NoPartyIDs, FIX::PartyID, FIX50SP2::PositionReport::NoPositions, FIX::LongQty, FIX::ShortQty>();
 
-        FIX::Symbol* pOriginalName = nullptr;
-        FIX::SettlPrice* pLongPrice = nullptr;
-        FIX::PriorSettlPrice* pShortPrice = nullptr;
-        FIX::PriceDelta* pRealizedPL = nullptr;
+        message.getField(originalName);
+        message.getField(longPrice);
+        message.getField(shortPrice);
+        message.getField(realizedPL);
 
-        FIX50SP2::PositionReport::NoPartyIDs* pUserIDGroup = nullptr;
-        FIX::PartyID* pUserID = nullptr;
+        message.getGroup(1, userIDGroup);
+        userIDGroup.getField(userID);
 
-        FIX50SP2::PositionReport::NoPositions* pSizeGroup = nullptr;
-        FIX::LongQty* pLongSize = nullptr;
-        FIX::ShortQty* pShortSize = nullptr;
-
-        static std::atomic<unsigned int> s_cntAtom { 0 };
-        unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-        while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-        }
-
-        assert(s_cntAtom > 0);
-
-        if (0 == prevCnt) { // sequential case; optimized:
-            pOriginalName = &originalName;
-            pLongPrice = &longPrice;
-            pShortPrice = &shortPrice;
-            pRealizedPL = &realizedPL;
-            pUserIDGroup = &userIDGroup;
-            pUserID = &userID;
-            pSizeGroup = &sizeGroup;
-            pLongSize = &longSize;
-            pShortSize = &shortSize;
-        } else { // > 1 threads; always safe way:
-            pOriginalName = new decltype(originalName);
-            pLongPrice = new decltype(longPrice);
-            pShortPrice = new decltype(shortPrice);
-            pRealizedPL = new decltype(realizedPL);
-            pUserIDGroup = new decltype(userIDGroup);
-            pUserID = new decltype(userID);
-            pSizeGroup = new decltype(sizeGroup);
-            pLongSize = new decltype(longSize);
-            pShortSize = new decltype(shortSize);
-        }
-
-        message.getField(*pOriginalName);
-        message.getField(*pLongPrice);
-        message.getField(*pShortPrice);
-        message.getField(*pRealizedPL);
-
-        message.getGroup(1, *pUserIDGroup);
-        pUserIDGroup->getField(*pUserID);
-
-        message.getGroup(1, *pSizeGroup);
-        pSizeGroup->getField(*pLongSize);
-        pSizeGroup->getField(*pShortSize);
+        message.getGroup(1, sizeGroup);
+        sizeGroup.getField(longSize);
+        sizeGroup.getField(shortSize);
 
         // m_originalName_symbol shall be always thread-safe-readonly once after being initialized, so we shall prevent it from accidental insertion here
-        if (m_originalName_symbol.find(pOriginalName->getValue()) == m_originalName_symbol.end()) {
-            cout << COLOR_WARNING "FIX50SP2::PositionReport received an unknown symbol [" << pOriginalName->getValue() << "], skipped." NO_COLOR << endl;
+        if (m_originalName_symbol.find(originalName.getValue()) == m_originalName_symbol.end()) {
+            cout << COLOR_WARNING "FIX50SP2::PositionReport received an unknown symbol [" << originalName.getValue() << "], skipped." NO_COLOR << endl;
             return;
         }
 
-        std::string symbol = m_originalName_symbol[pOriginalName->getValue()];
+        std::string symbol = m_originalName_symbol[originalName.getValue()];
 
         try {
-            getClientByUserID(pUserID->getValue())->storePortfolioItem(symbol, static_cast<int>(pLongSize->getValue()), static_cast<int>(pShortSize->getValue()), pLongPrice->getValue(), pShortPrice->getValue(), pRealizedPL->getValue());
-            getClientByUserID(pUserID->getValue())->receivePortfolioItem(symbol);
+            getClientByUserID(userID.getValue())->storePortfolioItem(symbol, static_cast<int>(longSize.getValue()), static_cast<int>(shortSize.getValue()), longPrice.getValue(), shortPrice.getValue(), realizedPL.getValue());
+            getClientByUserID(userID.getValue())->receivePortfolioItem(symbol);
         } catch (...) {
         }
 
-        if (0 != prevCnt) { // > 1 threads
-            delete pOriginalName;
-            delete pLongPrice;
-            delete pShortPrice;
-            delete pRealizedPL;
-            delete pUserIDGroup;
-            delete pUserID;
-            delete pSizeGroup;
-            delete pLongSize;
-            delete pShortSize;
-        }
-
-        s_cntAtom--;
-        assert(s_cntAtom >= 0);
-
     } else { // summary (FIX::SecurityType_CASH)
 
-        static FIX::PriceDelta totalRealizedPL;
+        auto& [totalRealizedPL, userIDGroup, userID, totalSharesGroup, totalShares, totalBuyingPowerGroup, totalBuyingPower] = shift::fix::getThreadLocalFields<FIX50SP2::PositionReport, FIX::PriceDelta, FIX50SP2::PositionReport::NoPartyIDs, FIX::PartyID, FIX50SP2::PositionReport::NoPositions, FIX::LongQty, FIX50SP2::PositionReport::NoPosAmt, FIX::PosAmt>();
 
-        static FIX50SP2::PositionReport::NoPartyIDs userIDGroup;
-        static FIX::PartyID userID;
+        message.getField(totalRealizedPL);
 
-        static FIX50SP2::PositionReport::NoPositions totalSharesGroup;
-        static FIX::LongQty totalShares;
+        message.getGroup(1, userIDGroup);
+        userIDGroup.getField(userID);
 
-        static FIX50SP2::PositionReport::NoPosAmt totalBuyingPowerGroup;
-        static FIX::PosAmt totalBuyingPower;
+        message.getGroup(1, totalSharesGroup);
+        totalSharesGroup.getField(totalShares);
 
-        // #pragma GCC diagnostic ignored ....
-
-        FIX::PriceDelta* pTotalRealizedPL = nullptr;
-
-        FIX50SP2::PositionReport::NoPartyIDs* pUserIDGroup = nullptr;
-        FIX::PartyID* pUserID = nullptr;
-
-        FIX50SP2::PositionReport::NoPositions* pTotalSharesGroup = nullptr;
-        FIX::LongQty* pTotalShares = nullptr;
-
-        FIX50SP2::PositionReport::NoPosAmt* pTotalBuyingPowerGroup = nullptr;
-        FIX::PosAmt* pTotalBuyingPower = nullptr;
-
-        static std::atomic<unsigned int> s_cntAtom { 0 };
-        unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-        while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-        }
-
-        assert(s_cntAtom > 0);
-
-        if (0 == prevCnt) { // sequential case; optimized:
-            pTotalRealizedPL = &totalRealizedPL;
-            pUserIDGroup = &userIDGroup;
-            pUserID = &userID;
-            pTotalSharesGroup = &totalSharesGroup;
-            pTotalShares = &totalShares;
-            pTotalBuyingPowerGroup = &totalBuyingPowerGroup;
-            pTotalBuyingPower = &totalBuyingPower;
-        } else { // > 1 threads; always safe way:
-            pTotalRealizedPL = new decltype(totalRealizedPL);
-            pUserIDGroup = new decltype(userIDGroup);
-            pUserID = new decltype(userID);
-            pTotalSharesGroup = new decltype(totalSharesGroup);
-            pTotalShares = new decltype(totalShares);
-            pTotalBuyingPowerGroup = new decltype(totalBuyingPowerGroup);
-            pTotalBuyingPower = new decltype(totalBuyingPower);
-        }
-
-        message.getField(*pTotalRealizedPL);
-
-        message.getGroup(1, *pUserIDGroup);
-        pUserIDGroup->getField(*pUserID);
-
-        message.getGroup(1, *pTotalSharesGroup);
-        pTotalSharesGroup->getField(*pTotalShares);
-
-        message.getGroup(1, *pTotalBuyingPowerGroup);
-        pTotalBuyingPowerGroup->getField(*pTotalBuyingPower);
+        message.getGroup(1, totalBuyingPowerGroup);
+        totalBuyingPowerGroup.getField(totalBuyingPower);
 
         try {
-            getClientByUserID(pUserID->getValue())->storePortfolioSummary(pTotalBuyingPower->getValue(), static_cast<int>(pTotalShares->getValue()), pTotalRealizedPL->getValue());
-            getClientByUserID(pUserID->getValue())->receivePortfolioSummary();
+            getClientByUserID(userID.getValue())->storePortfolioSummary(totalBuyingPower.getValue(), static_cast<int>(totalShares.getValue()), totalRealizedPL.getValue());
+            getClientByUserID(userID.getValue())->receivePortfolioSummary();
         } catch (...) {
         }
-
-        if (0 != prevCnt) { // > 1 threads
-            delete pTotalRealizedPL;
-            delete pUserIDGroup;
-            delete pUserID;
-            delete pTotalSharesGroup;
-            delete pTotalShares;
-            delete pTotalBuyingPowerGroup;
-            delete pTotalBuyingPower;
-        }
-
-        s_cntAtom--;
-        assert(s_cntAtom >= 0);
     }
 }
 
@@ -1261,127 +912,55 @@ void FIXInitiator::onMessage(const FIX50SP2::NewOrderList& message, const FIX::S
         std::this_thread::sleep_for(10ms);
     }
 
-    static FIX::ClientBidID userID;
-    static FIX::NoOrders n;
-
-    static FIX50SP2::NewOrderList::NoOrders quoteSetGroup;
-    static FIX::ClOrdID orderID;
-    static FIX::Symbol originalName;
-    static FIX::OrderQty size;
-    static FIX::OrdType orderType;
-    static FIX::Price price;
-    static FIX::OrderQty2 executedSize;
-    static FIX::PositionEffect status;
-
-    // #pragma GCC diagnostic ignored ....
-
-    FIX::ClientBidID* pUserID = nullptr;
-    FIX::NoOrders* pN = nullptr;
-
-    FIX50SP2::NewOrderList::NoOrders* pQuoteSetGroup = nullptr;
-    FIX::ClOrdID* pOrderID = nullptr;
-    FIX::Symbol* pOriginalName = nullptr;
-    FIX::OrderQty* pSize = nullptr;
-    FIX::OrdType* pOrderType = nullptr;
-    FIX::Price* pPrice = nullptr;
-    FIX::OrderQty2* pExecutedSize = nullptr;
-    FIX::PositionEffect* pStatus = nullptr;
-
-    static std::atomic<unsigned int> s_cntAtom { 0 };
-    unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-    while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-    }
-
-    assert(s_cntAtom > 0);
-
-    if (0 == prevCnt) { // sequential case; optimized:
-        pUserID = &userID;
-        pN = &n;
-        pQuoteSetGroup = &quoteSetGroup;
-        pOrderID = &orderID;
-        pOriginalName = &originalName;
-        pSize = &size;
-        pOrderType = &orderType;
-        pPrice = &price;
-        pExecutedSize = &executedSize;
-        pStatus = &status;
-    } else { // > 1 threads; always safe way:
-        pUserID = new decltype(userID);
-        pN = new decltype(n);
-        pQuoteSetGroup = new decltype(quoteSetGroup);
-        pOrderID = new decltype(orderID);
-        pOriginalName = new decltype(originalName);
-        pSize = new decltype(size);
-        pOrderType = new decltype(orderType);
-        pPrice = new decltype(price);
-        pExecutedSize = new decltype(executedSize);
-        pStatus = new decltype(status);
-    }
+    auto& [userID, n, quoteSetGroup, orderID, originalName, size, orderType, price, executedSize, status] = shift::fix::getThreadLocalFields<FIX50SP2::NewOrderList, FIX::ClientBidID, FIX::NoOrders, FIX50SP2::NewOrderList::NoOrders, FIX::ClOrdID, FIX::Symbol, FIX::OrderQty, FIX::OrdType, FIX::Price, FIX::OrderQty2, FIX::PositionEffect>();
 
-    message.getField(*pUserID);
-    message.getField(*pN);
+    message.getField(userID);
+    message.getField(n);
 
     std::vector<Order> waitingList;
 
-    for (int i = 1; i <= *pN; ++i) {
-        message.getGroup(static_cast<unsigned int>(i), *pQuoteSetGroup);
+    for (int i = 1; i <= n; ++i) {
+        message.getGroup(static_cast<unsigned int>(i), quoteSetGroup);
 
-        pQuoteSetGroup->getField(*pOrderID);
-        pQuoteSetGroup->getField(*pOriginalName);
-        pQuoteSetGroup->getField(*pSize);
-        pQuoteSetGroup->getField(*pOrderType);
-        pQuoteSetGroup->getField(*pPrice);
-        pQuoteSetGroup->getField(*pExecutedSize);
-        pQuoteSetGroup->getField(*pStatus);
+        quoteSetGroup.getField(orderID);
+        quoteSetGroup.getField(originalName);
+        quoteSetGroup.getField(size);
+        quoteSetGroup.getField(orderType);
+        quoteSetGroup.getField(price);
+        quoteSetGroup.getField(executedSize);
+        quoteSetGroup.getField(status);
 
-        int sizeInt = static_cast<int>(pSize->getValue());
+        int sizeInt = static_cast<int>(size.getValue());
 
         if (sizeInt > 0) {
 
             // m_originalName_symbol shall be always thread-safe-readonly once after being initialized, so we shall prevent it from accidental insertion here
-            if (m_originalName_symbol.find(pOriginalName->getValue()) == m_originalName_symbol.end()) {
-                cout << COLOR_WARNING "FIX50SP2::PositionReport received an unknown symbol [" << pOriginalName->getValue() << "], skipped." NO_COLOR << endl;
+            if (m_originalName_symbol.find(originalName.getValue()) == m_originalName_symbol.end()) {
+                cout << COLOR_WARNING "FIX50SP2::PositionReport received an unknown symbol [" << originalName.getValue() << "], skipped." NO_COLOR << endl;
                 continue;
             }
 
-            std::string symbol = m_originalName_symbol[pOriginalName->getValue()];
+            std::string symbol = m_originalName_symbol[originalName.getValue()];
 
             Order order {
-                static_cast<Order::Type>(pOrderType->getValue()),
+                static_cast<Order::Type>(orderType.getValue()),
                 symbol,
                 sizeInt,
-                pPrice->getValue(),
-                pOrderID->getValue()
+                price.getValue(),
+                orderID.getValue()
             };
-            order.setExecutedSize(static_cast<int>(pExecutedSize->getValue()));
-            order.setStatus(static_cast<Order::Status>(pStatus->getValue()));
+            order.setExecutedSize(static_cast<int>(executedSize.getValue()));
+            order.setStatus(static_cast<Order::Status>(status.getValue()));
 
             waitingList.push_back(std::move(order));
         }
     }
 
     try {
-        getClientByUserID(pUserID->getValue())->storeWaitingList(std::move(waitingList));
-        getClientByUserID(pUserID->getValue())->receiveWaitingList();
+        getClientByUserID(userID.getValue())->storeWaitingList(std::move(waitingList));
+        getClientByUserID(userID.getValue())->receiveWaitingList();
     } catch (...) {
     }
-
-    if (0 != prevCnt) { // > 1 threads
-        delete pUserID;
-        delete pN;
-        delete pQuoteSetGroup;
-        delete pOrderID;
-        delete pOriginalName;
-        delete pSize;
-        delete pOrderType;
-        delete pPrice;
-        delete pExecutedSize;
-        delete pStatus;
-    }
-
-    s_cntAtom--;
-    assert(s_cntAtom >= 0);
 }
 
 /**
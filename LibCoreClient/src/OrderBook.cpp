@@ -10,6 +10,8 @@ namespace shift {
 OrderBook::OrderBook(std::string symbol, OrderBook::Type type)
     : m_symbol { std::move(symbol) }
     , m_type { type }
+    , m_seqNum { 0 }
+    , m_isSynchronized { false }
 {
 }
 
@@ -141,6 +143,41 @@ void OrderBook::setOrderBook(std::list<OrderBookEntry>&& entries)
     m_entries = std::move(entries);
 }
 
+/**
+ * @brief Method to set the entries of a snapshot of the order book, which includes all updates up to seqNum.
+ * @param entries A list of OrderBookEntry including all entries to be inserted.
+ * @param seqNum The sequence number of the last update included in the snapshot.
+ */
+void OrderBook::setOrderBook(std::list<OrderBookEntry>&& entries, unsigned int seqNum)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_entries = std::move(entries);
+    m_seqNum = seqNum;
+    m_isSynchronized = true;
+}
+
+/**
+ * @brief Method to check the sequence number of an incoming update against the last one, and to advance it if the update follows.
+ * @param seqNum The sequence number of the incoming update.
+ * @return Whether to apply the update, to discard it, or to request a new snapshot (later updates are discarded until it arrives).
+ */
+auto OrderBook::sequenceUpdate(unsigned int seqNum) -> OrderBook::UpdateAction
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    if (!m_isSynchronized || seqNum <= m_seqNum) {
+        return UpdateAction::DISCARD;
+    }
+
+    if (seqNum != m_seqNum + 1) {
+        m_isSynchronized = false;
+        return UpdateAction::RESYNCHRONIZE;
+    }
+
+    m_seqNum = seqNum;
+    return UpdateAction::APPLY;
+}
+
 /**
  * @brief Method to reset the m_entries of current order book (clear it).
  */
@@ -0,0 +1,35 @@
+#define BOOST_TEST_MODULE test_OrderBookSequence
+#define BOOST_TEST_DYN_LINK
+
+#include "testUtils.h"
+
+#include "OrderBookGlobalBid.h"
+
+BOOST_AUTO_TEST_CASE(ORDERBOOKSEQUENCETEST_WAITSFORSNAPSHOT)
+{
+    OrderBookGlobalBid book { "AAPL" };
+
+    // updates received before the first snapshot are already part of it
+    BOOST_CHECK(book.sequenceUpdate(1) == OrderBook::UpdateAction::DISCARD);
+
+    book.setOrderBook({}, 5);
+    BOOST_CHECK(book.sequenceUpdate(5) == OrderBook::UpdateAction::DISCARD);
+    BOOST_CHECK(book.sequenceUpdate(6) == OrderBook::UpdateAction::APPLY);
+    BOOST_CHECK(book.sequenceUpdate(7) == OrderBook::UpdateAction::APPLY);
+}
+
+BOOST_AUTO_TEST_CASE(ORDERBOOKSEQUENCETEST_RESYNCHRONIZESONGAP)
+{
+    OrderBookGlobalBid book { "AAPL" };
+
+    book.setOrderBook({}, 0);
+    BOOST_CHECK(book.sequenceUpdate(1) == OrderBook::UpdateAction::APPLY);
+
+    // only the first update after the gap requests a new snapshot
+    BOOST_CHECK(book.sequenceUpdate(3) == OrderBook::UpdateAction::RESYNCHRONIZE);
+    BOOST_CHECK(book.sequenceUpdate(4) == OrderBook::UpdateAction::DISCARD);
+
+    book.setOrderBook({}, 4);
+    BOOST_CHECK(book.sequenceUpdate(4) == OrderBook::UpdateAction::DISCARD);
+    BOOST_CHECK(book.sequenceUpdate(5) == OrderBook::UpdateAction::APPLY);
+}
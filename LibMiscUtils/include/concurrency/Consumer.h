@@ -10,8 +10,8 @@ using namespace std::chrono_literals;
 
 namespace shift::concurrency {
 
-template <typename _FutRes, typename _PredFn>
-auto quitOrContinueConsumerThread(std::future<_FutRes>& quitFlagFut, std::condition_variable& cv, std::unique_lock<std::mutex>& lockForCV, _PredFn&& pred) -> bool
+template <typename _Future, typename _PredFn> // std::future or std::shared_future
+auto quitOrContinueConsumerThread(_Future& quitFlagFut, std::condition_variable& cv, std::unique_lock<std::mutex>& lockForCV, _PredFn&& pred) -> bool
 {
     cv.wait(lockForCV, [&quitFlagFut, &pred] {
         if (quitFlagFut.wait_for(0ms) == std::future_status::ready) {
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace shift::concurrency {
+
+// Bounded lock-free multi-producer/single-consumer ring buffer.
+// Each pre-allocated slot carries a sequence number telling whether it is free for
+// the producer claiming that position, or holds an element ready for the consumer:
+// producers only contend on the tail index, and never block each other while copying.
+// See: https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+template <typename T>
+class MPSCQueue {
+public:
+    explicit MPSCQueue(std::size_t capacity)
+        : m_capacity { roundUpToPowerOfTwo(capacity) }
+        , m_mask { m_capacity - 1 }
+        , m_slots { std::make_unique<Slot[]>(m_capacity) }
+    {
+        for (std::size_t i = 0; i < m_capacity; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MPSCQueue()
+    {
+        consume_all([](T&&) {});
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete; // forbid copying
+    auto operator=(const MPSCQueue&) -> MPSCQueue& = delete; // forbid assigning
+
+    // producer side (thread-safe): value is left untouched if the queue is full
+    auto try_push(T&& value) -> bool
+    {
+        Slot* slot = nullptr;
+        auto tail = m_tail.load(std::memory_order_relaxed);
+
+        while (true) {
+            slot = &m_slots[tail & m_mask];
+            auto diff = static_cast<std::intptr_t>(slot->sequence.load(std::memory_order_acquire)) - static_cast<std::intptr_t>(tail);
+
+            if (diff == 0) { // slot is free: try to claim it
+                if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) { // slot still holds an element from the previous lap: full
+                return false;
+            } else { // another producer claimed it first
+                tail = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (&slot->storage) T(std::move(value));
+        slot->sequence.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side
+    auto try_pop(T& value) -> bool
+    {
+        return consume_all([&value](T&& element) { value = std::move(element); }, 1) == 1;
+    }
+
+    // consumer side: the oldest element, left in the queue
+    // (nullptr if the queue is empty, or if the oldest slot has been claimed but not yet filled by its producer)
+    auto front() const -> const T*
+    {
+        const Slot& slot = m_slots[m_head & m_mask];
+        if (slot.sequence.load(std::memory_order_acquire) != m_head + 1) {
+            return nullptr;
+        }
+
+        return std::launder(reinterpret_cast<const T*>(&slot.storage));
+    }
+
+    // consumer side: hand (at most maxCount) queued elements to func in FIFO order;
+    // stops early at a slot which has been claimed but not yet filled by its producer
+    template <typename Func>
+    auto consume_all(Func&& func, std::size_t maxCount = static_cast<std::size_t>(-1)) -> std::size_t
+    {
+        std::size_t count = 0;
+
+        for (; count < maxCount; ++count, ++m_head) {
+            Slot& slot = m_slots[m_head & m_mask];
+            if (slot.sequence.load(std::memory_order_acquire) != m_head + 1) {
+                break;
+            }
+
+            T* element = std::launder(reinterpret_cast<T*>(&slot.storage));
+            func(std::move(*element));
+            element->~T();
+
+            slot.sequence.store(m_head + m_capacity, std::memory_order_release);
+        }
+
+        return count;
+    }
+
+    auto capacity() const -> std::size_t
+    {
+        return m_capacity;
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+    };
+
+    // keep the index written by producers away from the consumer's
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    static auto roundUpToPowerOfTwo(std::size_t n) -> std::size_t
+    {
+        std::size_t result = 1;
+        while (result < n) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const std::size_t m_capacity;
+    const std::size_t m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_tail { 0 }; // shared by the producers
+    alignas(CACHE_LINE_SIZE) std::size_t m_head { 0 }; // only used by the consumer
+};
+
+} // shift::concurrency
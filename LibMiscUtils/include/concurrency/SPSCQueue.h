@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace shift::concurrency {
+
+// Bounded lock-free single-producer/single-consumer ring buffer.
+// Elements are stored in pre-allocated slots, and each side caches the other side's
+// index, so that the shared indices are only re-read when the ring looks full/empty.
+// See: https://rigtorp.se/ringbuffer/
+template <typename T>
+class SPSCQueue {
+public:
+    explicit SPSCQueue(std::size_t capacity)
+        : m_capacity { roundUpToPowerOfTwo(capacity) }
+        , m_mask { m_capacity - 1 }
+        , m_slots { std::make_unique<Slot[]>(m_capacity) }
+    {
+    }
+
+    ~SPSCQueue()
+    {
+        for (auto head = m_head.load(std::memory_order_relaxed); head != m_tail.load(std::memory_order_relaxed); ++head) {
+            at(head)->~T();
+        }
+    }
+
+    SPSCQueue(const SPSCQueue&) = delete; // forbid copying
+    auto operator=(const SPSCQueue&) -> SPSCQueue& = delete; // forbid assigning
+
+    // producer side: value is left untouched if the queue is full
+    auto try_push(T&& value) -> bool
+    {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead == m_capacity) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead == m_capacity) {
+                return false;
+            }
+        }
+
+        new (&m_slots[tail & m_mask]) T(std::move(value));
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side
+    auto try_pop(T& value) -> bool
+    {
+        return consume_all([&value](T&& element) { value = std::move(element); }, 1) == 1;
+    }
+
+    // consumer side: the oldest element, left in the queue (nullptr if the queue is empty)
+    auto front() const -> const T*
+    {
+        auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail && head == m_tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        return std::launder(reinterpret_cast<const T*>(&m_slots[head & m_mask]));
+    }
+
+    // consumer side: hand (at most maxCount) queued elements to func in FIFO order,
+    // publishing the freed slots to the producer only once, at the end of the batch
+    template <typename Func>
+    auto consume_all(Func&& func, std::size_t maxCount = static_cast<std::size_t>(-1)) -> std::size_t
+    {
+        auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+        }
+
+        std::size_t count = 0;
+        for (; head != m_cachedTail && count < maxCount; ++head, ++count) {
+            T* element = at(head);
+            func(std::move(*element));
+            element->~T();
+        }
+
+        m_head.store(head, std::memory_order_release);
+        return count;
+    }
+
+    auto empty() const -> bool
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    // only approximate while either side is active (e.g. for monitoring)
+    auto size() const -> std::size_t
+    {
+        auto head = m_head.load(std::memory_order_acquire); // head never passes tail: load it first
+        return m_tail.load(std::memory_order_acquire) - head;
+    }
+
+    auto capacity() const -> std::size_t
+    {
+        return m_capacity;
+    }
+
+private:
+    using Slot = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+    // keep indices written by different threads on different cache lines
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    static auto roundUpToPowerOfTwo(std::size_t n) -> std::size_t
+    {
+        std::size_t result = 1;
+        while (result < n) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    inline auto at(std::size_t index) -> T*
+    {
+        return std::launder(reinterpret_cast<T*>(&m_slots[index & m_mask]));
+    }
+
+    const std::size_t m_capacity;
+    const std::size_t m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_head { 0 }; // written by the consumer
+    std::size_t m_cachedTail { 0 };
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_tail { 0 }; // written by the producer
+    std::size_t m_cachedHead { 0 };
+};
+
+} // shift::concurrency
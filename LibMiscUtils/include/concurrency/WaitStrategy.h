@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace shift::concurrency {
+
+// How a consumer thread waits for work signaled by its producers through notify():
+// - BLOCKING: park on a condition variable (no CPU usage while idle, but every wake-up costs a context switch)
+// - SPINNING: busy-wait with a pause instruction (lowest latency, but keeps one core busy per waiting thread)
+// - HYBRID: spin for a short while, then park
+// Producers only take the mutex when the consumer is actually parked.
+class WaitStrategy {
+public:
+    enum class Type : char {
+        BLOCKING,
+        SPINNING,
+        HYBRID,
+    };
+
+    explicit WaitStrategy(Type type = Type::HYBRID, std::chrono::nanoseconds spinDuration = std::chrono::microseconds(50))
+        : m_type { type }
+        , m_spinDuration { spinDuration }
+    {
+    }
+
+    WaitStrategy(const WaitStrategy&) = delete; // forbid copying
+    auto operator=(const WaitStrategy&) -> WaitStrategy& = delete; // forbid assigning
+
+    auto getType() const -> Type
+    {
+        return m_type.load(std::memory_order_relaxed);
+    }
+
+    void setType(Type type)
+    {
+        m_type.store(type, std::memory_order_relaxed);
+    }
+
+    // producer side
+    void notify()
+    {
+        m_signaled.store(true, std::memory_order_seq_cst);
+
+        if (m_isParked.load(std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> guard(m_mtx);
+            m_cv.notify_one();
+        }
+    }
+
+    // consumer side: returns true if notified, or false if the deadline was reached first
+    auto waitUntil(std::chrono::steady_clock::time_point deadline) -> bool
+    {
+        auto type = getType();
+
+        if (type != Type::BLOCKING) {
+            auto spinDeadline = (type == Type::SPINNING) ? deadline : std::min(deadline, std::chrono::steady_clock::now() + m_spinDuration);
+
+            do {
+                if (consumeSignal()) {
+                    return true;
+                }
+                pause();
+            } while (std::chrono::steady_clock::now() < spinDeadline);
+
+            if (type == Type::SPINNING) {
+                return consumeSignal();
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_isParked.store(true, std::memory_order_seq_cst);
+        bool signaled = m_cv.wait_until(lock, deadline, [this] { return m_signaled.load(std::memory_order_seq_cst); });
+        m_isParked.store(false, std::memory_order_relaxed);
+        if (signaled) {
+            m_signaled.store(false, std::memory_order_relaxed);
+        }
+
+        return signaled;
+    }
+
+private:
+    auto consumeSignal() -> bool
+    {
+        // only write the shared flag when it is set
+        return m_signaled.load(std::memory_order_relaxed) && m_signaled.exchange(false, std::memory_order_acquire);
+    }
+
+    static void pause()
+    {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#endif
+    }
+
+    std::atomic<Type> m_type;
+    const std::chrono::nanoseconds m_spinDuration;
+
+    std::atomic<bool> m_signaled { false };
+    std::atomic<bool> m_isParked { false };
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+};
+
+} // shift::concurrency
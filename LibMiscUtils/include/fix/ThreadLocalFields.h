@@ -0,0 +1,25 @@
+#pragma once
+
+#include <tuple>
+
+namespace shift::fix {
+
+/**
+ * @brief Per-thread set of reusable FIX field and group objects to decode messages into.
+ *        Fields keep their string buffers between messages, so once these have grown to fit,
+ *        decoding a message into them does not allocate, however many threads are decoding at the same time.
+ * @param _TagType Type identifying the set, usually the FIX message type being decoded: sets with the same tag and field types are the same objects.
+ * @param _FieldTypes The types of the FIX field and group objects.
+ * @return Reference to the calling thread's set, meant to be unpacked by a structured binding:
+ *           auto& [symbol, price] = getThreadLocalFields<FIX50SP2::Quote, FIX::Symbol, FIX::BidPx>();
+ *         Values are left over from the previous message decoded by the same thread; the set must not be used again
+ *         by a function it is passed to (e.g. a message handler cracking a nested message of the same type).
+ */
+template <typename _TagType, typename... _FieldTypes>
+auto getThreadLocalFields() -> std::tuple<_FieldTypes...>&
+{
+    thread_local std::tuple<_FieldTypes...> s_fields;
+    return s_fields;
+}
+
+} // shift::fix
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace shift::fix {
+
+/**
+ * @brief One Trade or Quote tick carried in a tick batch.
+ */
+struct TickBatchEntry {
+    char toq; // 'T' for trade, 'Q' for quote
+    std::int64_t utcMicrosecs; // transact time, microseconds since 1970/01/01 UTC
+    double bidPrice; // or trade price
+    int bidSize; // or trade size
+    double askPrice; // quotes only
+    int askSize; // quotes only
+    std::string_view buyerID; // bid venue, or execution venue of a trade
+    std::string_view sellerID; // ask venue, quotes only
+};
+
+/**
+ * @brief Compact binary encoding of many ticks of one symbol, to be carried in a single FIX message (RawData field):
+ *          version byte, symbol, then one entry per tick until the end of the payload.
+ *        Entries hold the transact time as a delta from the previous tick, prices as raw IEEE 754 doubles,
+ *        sizes as variable-length integers, and venues as indices of a dictionary built along the payload
+ *        (a new venue is written inline the first time it appears).
+ */
+class TickBatchWriter {
+public:
+    static constexpr std::uint8_t sc_version = 1;
+
+    void reset(std::string_view symbol)
+    {
+        m_payload.clear();
+        m_payload += static_cast<char>(sc_version);
+        s_putVarint(&m_payload, symbol.size());
+        m_payload += symbol;
+
+        m_numEntries = 0;
+        m_lastUtcMicrosecs = 0;
+        m_dictionary.clear();
+    }
+
+    void add(const TickBatchEntry& entry)
+    {
+        m_payload += entry.toq;
+        s_putVarint(&m_payload, s_zigzag(entry.utcMicrosecs - m_lastUtcMicrosecs));
+        m_lastUtcMicrosecs = entry.utcMicrosecs;
+
+        s_putDouble(&m_payload, entry.bidPrice);
+        s_putVarint(&m_payload, s_zigzag(entry.bidSize));
+        putString(entry.buyerID);
+
+        if ('Q' == entry.toq) {
+            s_putDouble(&m_payload, entry.askPrice);
+            s_putVarint(&m_payload, s_zigzag(entry.askSize));
+            putString(entry.sellerID);
+        }
+
+        ++m_numEntries;
+    }
+
+    auto getNumEntries() const -> std::size_t
+    {
+        return m_numEntries;
+    }
+
+    auto getPayload() const -> const std::string&
+    {
+        return m_payload;
+    }
+
+private:
+    static auto s_zigzag(std::int64_t value) -> std::uint64_t
+    {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    static void s_putVarint(std::string* pPayload, std::uint64_t value)
+    {
+        while (value >= 0x80) {
+            *pPayload += static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        *pPayload += static_cast<char>(value);
+    }
+
+    static void s_putDouble(std::string* pPayload, double value)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 8; ++i) { // little-endian, whatever the host is
+            *pPayload += static_cast<char>(bits >> (8 * i));
+        }
+    }
+
+    void putString(std::string_view str)
+    {
+        std::size_t index = 0;
+        while (index < m_dictionary.size() && m_dictionary[index] != str) { // venues are few: linear search is fastest
+            ++index;
+        }
+
+        s_putVarint(&m_payload, index);
+        if (index == m_dictionary.size()) {
+            m_dictionary.emplace_back(str);
+            s_putVarint(&m_payload, str.size());
+            m_payload += str;
+        }
+    }
+
+    std::string m_payload;
+    std::size_t m_numEntries = 0;
+    std::int64_t m_lastUtcMicrosecs = 0;
+    std::vector<std::string> m_dictionary;
+};
+
+/**
+ * @brief Decoder of TickBatchWriter payloads. Venue IDs of the entries read point into the payload, which must outlive them.
+ */
+class TickBatchReader {
+public:
+    explicit TickBatchReader(std::string_view payload)
+        : m_payload { payload }
+    {
+        std::uint64_t symbolLength = 0;
+        m_isValid = !m_payload.empty() && static_cast<std::uint8_t>(m_payload[0]) == TickBatchWriter::sc_version;
+        m_pos = 1;
+        m_isValid = m_isValid && getVarint(&symbolLength) && getBytes(symbolLength, &m_symbol);
+    }
+
+    /* @brief False if the payload is not a tick batch or is truncated. */
+    auto isValid() const -> bool
+    {
+        return m_isValid;
+    }
+
+    auto getSymbol() const -> std::string_view
+    {
+        return m_symbol;
+    }
+
+    /* @brief Decode the next entry; false at the end of the payload or if it is malformed. */
+    auto next(TickBatchEntry* pEntry) -> bool
+    {
+        if (!m_isValid || m_pos >= m_payload.size()) {
+            return false;
+        }
+
+        pEntry->toq = m_payload[m_pos++];
+
+        std::uint64_t delta = 0;
+        std::uint64_t bidSize = 0;
+        m_isValid = getVarint(&delta) && getDouble(&pEntry->bidPrice) && getVarint(&bidSize) && getString(&pEntry->buyerID);
+        m_lastUtcMicrosecs = static_cast<std::int64_t>(static_cast<std::uint64_t>(m_lastUtcMicrosecs) + static_cast<std::uint64_t>(s_unzigzag(delta))); // wraps instead of overflowing on corrupted data
+        pEntry->utcMicrosecs = m_lastUtcMicrosecs;
+        pEntry->bidSize = static_cast<int>(s_unzigzag(bidSize));
+
+        if ('Q' == pEntry->toq) {
+            std::uint64_t askSize = 0;
+            m_isValid = m_isValid && getDouble(&pEntry->askPrice) && getVarint(&askSize) && getString(&pEntry->sellerID);
+            pEntry->askSize = static_cast<int>(s_unzigzag(askSize));
+        } else {
+            pEntry->askPrice = 0.0;
+            pEntry->askSize = 0;
+            pEntry->sellerID = {};
+        }
+
+        return m_isValid;
+    }
+
+private:
+    static auto s_unzigzag(std::uint64_t value) -> std::int64_t
+    {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    auto getVarint(std::uint64_t* pValue) -> bool
+    {
+        *pValue = 0;
+        for (int shift = 0; shift < 64 && m_pos < m_payload.size(); shift += 7) {
+            const auto byte = static_cast<std::uint8_t>(m_payload[m_pos++]);
+            *pValue |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if (byte < 0x80) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto getDouble(double* pValue) -> bool
+    {
+        if (m_payload.size() - m_pos < 8) {
+            return false;
+        }
+
+        std::uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i) {
+            bits |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(m_payload[m_pos++])) << (8 * i);
+        }
+        std::memcpy(pValue, &bits, sizeof(bits));
+        return true;
+    }
+
+    auto getBytes(std::uint64_t length, std::string_view* pBytes) -> bool
+    {
+        if (m_payload.size() - m_pos < length) {
+            return false;
+        }
+
+        *pBytes = m_payload.substr(m_pos, length);
+        m_pos += length;
+        return true;
+    }
+
+    auto getString(std::string_view* pStr) -> bool
+    {
+        std::uint64_t index = 0;
+        if (!getVarint(&index) || index > m_dictionary.size()) {
+            return false;
+        }
+
+        if (index == m_dictionary.size()) {
+            std::uint64_t length = 0;
+            if (!getVarint(&length) || !getBytes(length, pStr)) {
+                return false;
+            }
+            m_dictionary.push_back(*pStr);
+        } else {
+            *pStr = m_dictionary[index];
+        }
+        return true;
+    }
+
+    std::string_view m_payload;
+    std::size_t m_pos = 0;
+    bool m_isValid = false;
+    std::string_view m_symbol;
+    std::int64_t m_lastUtcMicrosecs = 0;
+    std::vector<std::string_view> m_dictionary;
+};
+
+} // shift::fix
@@ -0,0 +1,159 @@
+/*
+** Replays a cancel-heavy order stream against one side of the local order book,
+** comparing the legacy cancel path (scan price levels for the cancel's price, then its orders for the order ID)
+** with the order-ID index path (BookSide::findOrder + binary search of the level).
+**
+** Usage: CancelBenchmark [numRestingOrders = 20000] [numOperations = 200000] [numPriceLevels = 200]
+*/
+
+#include "markets/BookSide.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace markets;
+
+struct Operation {
+    bool isCancel;
+    std::string orderID;
+    double price;
+};
+
+static auto makeOrder(const std::string& orderID, double price) -> Order
+{
+    return { "BENCH", "trader", orderID, price, 100, Order::Type::LIMIT_BUY, FIX::UtcTimeStamp {} };
+}
+
+static void insert(BookSide& bookSide, const std::string& orderID, double price)
+{
+    auto level = bookSide.lower_bound(price);
+    if (level == bookSide.end() || level->getPrice() != price) {
+        level = bookSide.insert(level, price);
+    }
+    level->setSize(level->getSize() + 100);
+    level->push_back(makeOrder(orderID, price));
+}
+
+static void remove(BookSide& bookSide, BookSide::iterator level, PriceLevel::iterator order)
+{
+    level->setSize(level->getSize() - order->getSize());
+    level->erase(order);
+    if (level->empty()) {
+        bookSide.erase(level);
+    }
+}
+
+// previous behavior: walk the book from the best price level to the cancel's price, then search that level for the order
+static auto cancelByScan(BookSide& bookSide, const std::string& orderID, double price) -> bool
+{
+    auto level = bookSide.begin();
+    while (level != bookSide.end() && level->getPrice() > price) {
+        ++level;
+    }
+    if (level == bookSide.end() || level->getPrice() != price) {
+        return false;
+    }
+
+    for (auto order = level->begin(); order != level->end(); ++order) {
+        if (order->getOrderID() == orderID) {
+            remove(bookSide, level, order);
+            return true;
+        }
+    }
+    return false;
+}
+
+static auto cancelByIndex(BookSide& bookSide, const std::string& orderID, double price) -> bool
+{
+    auto order = bookSide.findOrder(orderID, price);
+    if (order.getIndex() == OrderPool::NIL) {
+        return false;
+    }
+    remove(bookSide, bookSide.lower_bound(price), order);
+    return true;
+}
+
+template <typename CancelFunc>
+static void run(const char* name, const std::vector<Operation>& initial, const std::vector<Operation>& stream, CancelFunc cancel)
+{
+    BookSide bookSide { BookSide::Type::BID };
+    for (const auto& op : initial) {
+        insert(bookSide, op.orderID, op.price);
+    }
+
+    std::size_t numCancels = 0;
+    std::size_t numFound = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& op : stream) {
+        if (op.isCancel) {
+            ++numCancels;
+            numFound += cancel(bookSide, op.orderID, op.price);
+        } else {
+            insert(bookSide, op.orderID, op.price);
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::left << std::setw(8) << name
+              << " total: " << std::setw(12) << (elapsed / 1000000.0) << " ms"
+              << " | per operation: " << std::setw(10) << (static_cast<double>(elapsed) / stream.size()) << " ns"
+              << " | cancels: " << numCancels << " (" << numFound << " found)"
+              << " | resting orders left: " << bookSide.getOrderPool().size()
+              << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t numRestingOrders = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    const std::size_t numOperations = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 200000;
+    const int numPriceLevels = (argc > 3) ? std::atoi(argv[3]) : 200;
+
+    std::mt19937_64 rng { 42 };
+    std::uniform_int_distribution<int> levelDist { 0, numPriceLevels - 1 };
+    std::uniform_real_distribution<double> opDist { 0.0, 1.0 };
+
+    std::size_t nextOrderID = 0;
+    std::vector<Operation> live; // orders which may still be resting
+
+    auto newOrder = [&]() -> Operation {
+        Operation op { false, std::to_string(nextOrderID++), 100.0 - levelDist(rng) * 0.01 };
+        live.push_back(op);
+        return op;
+    };
+
+    std::vector<Operation> initial;
+    initial.reserve(numRestingOrders);
+    for (std::size_t i = 0; i < numRestingOrders; ++i) {
+        initial.push_back(newOrder());
+    }
+
+    // ~80% cancellations of random resting orders, ~20% new orders
+    std::vector<Operation> stream;
+    stream.reserve(numOperations);
+    for (std::size_t i = 0; i < numOperations; ++i) {
+        if (!live.empty() && opDist(rng) < 0.8) {
+            std::uniform_int_distribution<std::size_t> pick { 0, live.size() - 1 };
+            auto j = pick(rng);
+            stream.push_back({ true, live[j].orderID, live[j].price });
+            live[j] = std::move(live.back());
+            live.pop_back();
+        } else {
+            stream.push_back(newOrder());
+        }
+    }
+
+    std::cout << "Resting orders: " << numRestingOrders
+              << " | price levels: " << numPriceLevels
+              << " | operations: " << numOperations << std::endl;
+
+    run("scan", initial, stream, cancelByScan);
+    run("index", initial, stream, cancelByIndex);
+
+    return 0;
+}
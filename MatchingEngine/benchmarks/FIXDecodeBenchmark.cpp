@@ -0,0 +1,331 @@
+/*
+** Measures the cost of decoding the fields of the busiest FIX message types, as the onMessage handlers do,
+** comparing the legacy field objects (shared statics guarded by a counter, heap-allocated fields
+** whenever more than one thread is decoding) with shift::fix::getThreadLocalFields.
+**
+** Every thread decodes its own copy of the message numMessages times; time and heap allocations
+** are reported per decoded message. Allocations are counted by replacing the global operator new.
+**
+** Usage: FIXDecodeBenchmark [numMessages = 200000] [maxNumThreads = 4]
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <quickfix/FieldTypes.h>
+#include <quickfix/fix50sp2/ExecutionReport.h>
+#include <quickfix/fix50sp2/MarketDataIncrementalRefresh.h>
+#include <quickfix/fix50sp2/NewOrderSingle.h>
+#include <quickfix/fix50sp2/Quote.h>
+
+#include <shift/miscutils/fix/HelperFunctions.h>
+#include <shift/miscutils/fix/ThreadLocalFields.h>
+
+static std::atomic<std::size_t> s_numAllocations { 0 };
+
+auto operator new(std::size_t size) -> void*
+{
+    s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc {};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+static const FIX::UtcTimeStamp s_timestamp { std::time(nullptr), 123456, 6 };
+
+/*
+ * Each decoder builds a typical message and decodes it like the corresponding onMessage handler,
+ * returning a checksum of the decoded values so that the work cannot be optimized away.
+ */
+
+struct QuoteDecoder { // MatchingEngine: raw data from Datafeed Engine
+    using Message = FIX50SP2::Quote;
+    using Fields = std::tuple<FIX::Symbol, FIX::BidPx, FIX::OfferPx, FIX::BidSize, FIX::OfferSize, FIX::TransactTime, FIX50SP2::Quote::NoPartyIDs, FIX::PartyID, FIX::PartyID>;
+
+    static auto create() -> Message
+    {
+        Message message;
+        message.setField(FIX::QuoteID("1"));
+        message.setField(FIX::QuoteType(0));
+        message.setField(FIX::Symbol("AAPL.O"));
+        message.setField(FIX::TransactTime(s_timestamp, 6));
+        shift::fix::addFIXGroup<FIX50SP2::Quote::NoPartyIDs>(message, FIX::PartyRole(FIX::PartyRole_EXECUTION_VENUE), FIX::PartyID("NAS"));
+        shift::fix::addFIXGroup<FIX50SP2::Quote::NoPartyIDs>(message, FIX::PartyRole(FIX::PartyRole_EXECUTION_VENUE), FIX::PartyID("NYS"));
+        message.setField(FIX::BidPx(150.01));
+        message.setField(FIX::OfferPx(150.03));
+        message.setField(FIX::BidSize(3));
+        message.setField(FIX::OfferSize(5));
+        return message;
+    }
+
+    static auto decode(const Message& message, FIX::Symbol& symbol, FIX::BidPx& bidPrice, FIX::OfferPx& askPrice, FIX::BidSize& bidSize, FIX::OfferSize& askSize, FIX::TransactTime& transactTime, FIX50SP2::Quote::NoPartyIDs& idGroup, FIX::PartyID& buyerID, FIX::PartyID& sellerID) -> double
+    {
+        message.getField(symbol);
+        message.getField(bidPrice);
+        message.getField(bidSize);
+        message.getField(transactTime);
+        message.getGroup(1, idGroup);
+        idGroup.getField(buyerID);
+        message.getField(askPrice);
+        message.getField(askSize);
+        message.getGroup(2, idGroup);
+        idGroup.getField(sellerID);
+
+        return symbol.getString().size() + bidPrice.getValue() + askPrice.getValue() + bidSize.getValue() + askSize.getValue()
+            + transactTime.getValue().getFraction(6) + buyerID.getString().size() + sellerID.getString().size();
+    }
+};
+
+struct NewOrderSingleDecoder { // MatchingEngine and Brokerage Center: orders of clients
+    using Message = FIX50SP2::NewOrderSingle;
+    using Fields = std::tuple<FIX::ClOrdID, FIX::Symbol, FIX::OrderQty, FIX::OrdType, FIX::Price, FIX50SP2::NewOrderSingle::NoPartyIDs, FIX::PartyID>;
+
+    static auto create() -> Message
+    {
+        Message message;
+        message.setField(FIX::ClOrdID("5f3c7e1a-94b2-4d1e-8c55-0a6b2f9d7e31"));
+        message.setField(FIX::Symbol("AAPL"));
+        message.setField(FIX::OrderQty(10));
+        message.setField(FIX::OrdType('1'));
+        message.setField(FIX::Price(150.02));
+        shift::fix::addFIXGroup<FIX50SP2::NewOrderSingle::NoPartyIDs>(message, FIX::PartyRole(FIX::PartyRole_CLIENT_ID), FIX::PartyID("0c8a4f6e-2d71-4b3a-9e15-7f2b6c4d8a90"));
+        return message;
+    }
+
+    static auto decode(const Message& message, FIX::ClOrdID& orderID, FIX::Symbol& symbol, FIX::OrderQty& size, FIX::OrdType& orderType, FIX::Price& price, FIX50SP2::NewOrderSingle::NoPartyIDs& idGroup, FIX::PartyID& traderID) -> double
+    {
+        message.getField(orderID);
+        message.getField(symbol);
+        message.getField(size);
+        message.getField(orderType);
+        message.getField(price);
+        message.getGroup(1, idGroup);
+        idGroup.getField(traderID);
+
+        return orderID.getString().size() + symbol.getString().size() + size.getValue() + orderType.getValue() + price.getValue() + traderID.getString().size();
+    }
+};
+
+struct ExecutionReportDecoder { // Brokerage Center: trades from Matching Engine
+    using Message = FIX50SP2::ExecutionReport;
+    using Fields = std::tuple<FIX::OrderID, FIX::SecondaryOrderID, FIX::OrdStatus, FIX::Symbol, FIX::Side, FIX::OrdType, FIX::Price, FIX::EffectiveTime, FIX::LastMkt, FIX::CumQty, FIX::TransactTime, FIX50SP2::ExecutionReport::NoPartyIDs, FIX::PartyID, FIX::PartyID, FIX50SP2::ExecutionReport::NoTrdRegTimestamps, FIX::TrdRegTimestamp, FIX::TrdRegTimestamp>;
+
+    static auto create() -> Message
+    {
+        Message message;
+        message.setField(FIX::OrderID("5f3c7e1a-94b2-4d1e-8c55-0a6b2f9d7e31"));
+        message.setField(FIX::SecondaryOrderID("b7d1e0c2-3a4f-4e8b-a1c6-92f05d3e7b14"));
+        message.setField(FIX::ExecID("1700000000000000-42"));
+        message.setField(FIX::ExecType(FIX::ExecType_TRADE));
+        message.setField(FIX::OrdStatus(FIX::OrdStatus_FILLED));
+        message.setField(FIX::Symbol("AAPL"));
+        message.setField(FIX::Side('1'));
+        message.setField(FIX::OrdType('2'));
+        message.setField(FIX::Price(150.02));
+        message.setField(FIX::EffectiveTime(s_timestamp, 6));
+        message.setField(FIX::LastMkt("SHIFT"));
+        message.setField(FIX::LeavesQty(0));
+        message.setField(FIX::CumQty(10));
+        message.setField(FIX::TransactTime(s_timestamp, 6));
+        shift::fix::addFIXGroup<FIX50SP2::ExecutionReport::NoPartyIDs>(message, FIX::PartyRole(FIX::PartyRole_CLIENT_ID), FIX::PartyID("0c8a4f6e-2d71-4b3a-9e15-7f2b6c4d8a90"));
+        shift::fix::addFIXGroup<FIX50SP2::ExecutionReport::NoPartyIDs>(message, FIX::PartyRole(FIX::PartyRole_CLIENT_ID), FIX::PartyID("e41b9a37-6c08-4f2d-b5e3-1d7a0c9f6b82"));
+        shift::fix::addFIXGroup<FIX50SP2::ExecutionReport::NoTrdRegTimestamps>(message, FIX::TrdRegTimestamp(s_timestamp, 6));
+        shift::fix::addFIXGroup<FIX50SP2::ExecutionReport::NoTrdRegTimestamps>(message, FIX::TrdRegTimestamp(s_timestamp, 6));
+        return message;
+    }
+
+    static auto decode(const Message& message, FIX::OrderID& orderID1, FIX::SecondaryOrderID& orderID2, FIX::OrdStatus& status, FIX::Symbol& symbol, FIX::Side& orderType1, FIX::OrdType& orderType2, FIX::Price& price, FIX::EffectiveTime& execTime, FIX::LastMkt& destination, FIX::CumQty& executedSize, FIX::TransactTime& serverTime, FIX50SP2::ExecutionReport::NoPartyIDs& idGroup, FIX::PartyID& userID1, FIX::PartyID& userID2, FIX50SP2::ExecutionReport::NoTrdRegTimestamps& timeGroup, FIX::TrdRegTimestamp& utcTime1, FIX::TrdRegTimestamp& utcTime2) -> double
+    {
+        message.getField(orderID1);
+        message.getField(orderID2);
+        message.getField(status);
+        message.getField(symbol);
+        message.getField(orderType1);
+        message.getField(orderType2);
+        message.getField(price);
+        message.getField(execTime);
+        message.getField(destination);
+        message.getField(executedSize);
+        message.getField(serverTime);
+
+        message.getGroup(1, idGroup);
+        idGroup.getField(userID1);
+        message.getGroup(2, idGroup);
+        idGroup.getField(userID2);
+
+        message.getGroup(1, timeGroup);
+        timeGroup.getField(utcTime1);
+        message.getGroup(2, timeGroup);
+        timeGroup.getField(utcTime2);
+
+        return orderID1.getString().size() + orderID2.getString().size() + status.getValue() + symbol.getString().size() + orderType1.getValue() + orderType2.getValue()
+            + price.getValue() + execTime.getValue().getFraction(6) + destination.getString().size() + executedSize.getValue() + serverTime.getValue().getFraction(6)
+            + userID1.getString().size() + userID2.getString().size() + utcTime1.getValue().getFraction(6) + utcTime2.getValue().getFraction(6);
+    }
+};
+
+struct MarketDataIncrementalRefreshDecoder { // Brokerage Center and LibCoreClient: order book updates
+    using Message = FIX50SP2::MarketDataIncrementalRefresh;
+    using Fields = std::tuple<FIX50SP2::MarketDataIncrementalRefresh::NoMDEntries, FIX::MDEntryType, FIX::Symbol, FIX::MDEntryPx, FIX::MDEntrySize, FIX::MDEntryDate, FIX::MDEntryTime, FIX::MDMkt>;
+
+    static auto create() -> Message
+    {
+        Message message;
+        shift::fix::addFIXGroup<FIX50SP2::MarketDataIncrementalRefresh::NoMDEntries>(message,
+            FIX::MDUpdateAction(FIX::MDUpdateAction_CHANGE),
+            FIX::MDEntryType('B'),
+            FIX::Symbol("AAPL"),
+            FIX::MDEntryPx(150.01),
+            FIX::MDEntrySize(3),
+            FIX::MDEntryDate(FIX::UtcDateOnly(s_timestamp.getDate(), s_timestamp.getMonth(), s_timestamp.getYear())),
+            FIX::MDEntryTime(FIX::UtcTimeOnly(s_timestamp.getTimeT(), s_timestamp.getFraction(6), 6)),
+            FIX::MDMkt("NAS"));
+        return message;
+    }
+
+    static auto decode(const Message& message, FIX50SP2::MarketDataIncrementalRefresh::NoMDEntries& entryGroup, FIX::MDEntryType& bookType, FIX::Symbol& symbol, FIX::MDEntryPx& price, FIX::MDEntrySize& size, FIX::MDEntryDate& simulationDate, FIX::MDEntryTime& simulationTime, FIX::MDMkt& destination) -> double
+    {
+        message.getGroup(1, entryGroup);
+        entryGroup.getField(bookType);
+        entryGroup.getField(symbol);
+        entryGroup.getField(price);
+        entryGroup.getField(size);
+        entryGroup.getField(simulationDate);
+        entryGroup.getField(simulationTime);
+        entryGroup.getField(destination);
+
+        return bookType.getValue() + symbol.getString().size() + price.getValue() + size.getValue()
+            + simulationDate.getValue().getDate() + simulationTime.getValue().getFraction(6) + destination.getString().size();
+    }
+};
+
+template <typename _Decoder, typename _Fields = typename _Decoder::Fields>
+struct Strategies;
+
+template <typename _Decoder, typename... _FieldTypes>
+struct Strategies<_Decoder, std::tuple<_FieldTypes...>> {
+    // previous behavior: shared static fields while a single thread is decoding, fields on the heap otherwise
+    static auto legacy(const typename _Decoder::Message& message) -> double
+    {
+        static std::tuple<_FieldTypes...> s_fields;
+
+        static std::atomic<unsigned int> s_cntAtom { 0 };
+        unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
+
+        while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
+        }
+
+        double result = 0.0;
+        if (0 == prevCnt) { // sequential case
+            result = std::apply([&message](auto&... fields) { return _Decoder::decode(message, fields...); }, s_fields);
+        } else { // > 1 threads
+            auto fields = std::make_tuple(std::make_unique<_FieldTypes>()...);
+            result = std::apply([&message](auto&... pFields) { return _Decoder::decode(message, *pFields...); }, fields);
+        }
+
+        s_cntAtom--;
+        return result;
+    }
+
+    static auto threadLocal(const typename _Decoder::Message& message) -> double
+    {
+        return std::apply([&message](auto&... fields) { return _Decoder::decode(message, fields...); }, shift::fix::getThreadLocalFields<typename _Decoder::Message, _FieldTypes...>());
+    }
+};
+
+template <typename _Decoder, typename _DecodeFunc>
+static void run(const char* name, int numThreads, std::size_t numMessages, _DecodeFunc decode)
+{
+    std::vector<std::thread> threads;
+    std::atomic<int> numReady { 0 };
+    std::atomic<bool> go { false };
+    std::vector<double> checksums(numThreads);
+
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&, t] {
+            const auto message = _Decoder::create();
+            decode(message); // warm up: grows the field buffers reused by the thread-local set
+
+            ++numReady;
+            while (!go) {
+                std::this_thread::yield();
+            }
+
+            double checksum = 0.0;
+            for (std::size_t i = 0; i < numMessages; ++i) {
+                checksum += decode(message);
+            }
+            checksums[t] = checksum;
+        });
+    }
+
+    while (numReady != numThreads) {
+        std::this_thread::yield();
+    }
+
+    const auto startAllocations = s_numAllocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    const auto numAllocations = s_numAllocations.load() - startAllocations;
+
+    const double totalMessages = static_cast<double>(numMessages) * numThreads;
+
+    std::cout << "  " << std::left << std::setw(12) << name
+              << " threads: " << std::setw(3) << numThreads
+              << " | per message: " << std::setw(10) << (static_cast<double>(elapsed) * numThreads / totalMessages) << " ns"
+              << " | throughput: " << std::setw(10) << (totalMessages / elapsed * 1000.0) << " M msg/s"
+              << " | allocations per message: " << (numAllocations / totalMessages)
+              << std::endl;
+}
+
+template <typename _Decoder>
+static void runAll(const char* messageType, std::size_t numMessages, int maxNumThreads)
+{
+    std::cout << messageType << std::endl;
+    for (int numThreads = 1; numThreads <= maxNumThreads; numThreads *= 2) {
+        run<_Decoder>("legacy", numThreads, numMessages, Strategies<_Decoder>::legacy);
+        run<_Decoder>("thread-local", numThreads, numMessages, Strategies<_Decoder>::threadLocal);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t numMessages = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    const int maxNumThreads = std::max((argc > 2) ? std::atoi(argv[2]) : 4, 1);
+
+    std::cout << "Messages per thread: " << numMessages
+              << " | max threads: " << maxNumThreads << std::endl;
+
+    runAll<QuoteDecoder>("Quote", numMessages, maxNumThreads);
+    runAll<NewOrderSingleDecoder>("NewOrderSingle", numMessages, maxNumThreads);
+    runAll<ExecutionReportDecoder>("ExecutionReport", numMessages, maxNumThreads);
+    runAll<MarketDataIncrementalRefreshDecoder>("MarketDataIncrementalRefresh", numMessages, maxNumThreads);
+
+    return 0;
+}
@@ -0,0 +1,384 @@
+/*
+** Deterministic replay of a recorded order/quote stream through one market (the "me_bench" harness).
+**
+** The stream is fed through Market::bufNewLocalOrder/bufNewGlobalOrder, and the market is driven
+** from this thread against a virtual clock (see TimeSetting::setVirtualClock), so that no DE, BC,
+** or FIX session is needed, and every run of the same stream produces the same execution reports.
+** Reported: throughput, per-record latency percentiles (submission until the market is idle again),
+** heap allocations while replaying, and a hash of all execution reports to check for determinism.
+**
+** Usage: ReplayBenchmark generate <file> [numRecords = 1000000] [seed = 42]
+**        ReplayBenchmark run <file> [batchFrequencyS = 0 (continuous market)]
+**
+** File format (native byte order): a ReplayFileHeader followed by numRecords ReplayRecords,
+** sorted by time. Global orders (TRTH_*) come from the DE, all others from clients.
+*/
+
+#include "markets/ContinuousStockMarket.h"
+#include "markets/FBAStockMarket.h"
+
+#include "TimeSetting.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <shift/miscutils/terminal/Options.h>
+
+/* ALLOCATION COUNTING */
+
+static std::atomic<bool> s_isCountingAllocations { false };
+static std::atomic<std::size_t> s_numAllocations { 0 };
+static std::atomic<std::size_t> s_numAllocatedBytes { 0 };
+
+auto operator new(std::size_t size) -> void*
+{
+    if (s_isCountingAllocations.load(std::memory_order_relaxed)) {
+        s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+        s_numAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    if (auto* ptr = std::malloc(size > 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc {};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+/* FILE FORMAT */
+
+static constexpr char REPLAY_FILE_MAGIC[8] = { 'S', 'H', 'I', 'F', 'T', 'M', 'E', '1' };
+
+struct ReplayFileHeader {
+    char magic[8];
+    char symbol[16];
+    std::uint64_t numRecords;
+};
+
+struct ReplayRecord {
+    std::int64_t nanos; // time since the start of the stream
+    double price;
+    std::int32_t size;
+    char type; // Order::Type
+    char reserved[3];
+    char traderID[12]; // or the destination, for global orders
+    char orderID[20];
+};
+
+static_assert(std::is_trivially_copyable_v<ReplayFileHeader> && sizeof(ReplayFileHeader) == 32);
+static_assert(std::is_trivially_copyable_v<ReplayRecord> && sizeof(ReplayRecord) == 56);
+
+template <std::size_t N>
+static void copyField(char (&field)[N], std::string_view value)
+{
+    std::memset(field, 0, N);
+    std::memcpy(field, value.data(), std::min(value.size(), N));
+}
+
+template <std::size_t N>
+static auto viewField(const char (&field)[N]) -> std::string_view
+{
+    return { field, ::strnlen(field, N) };
+}
+
+static auto isGlobal(const ReplayRecord& record) -> bool
+{
+    return record.type == Order::Type::TRTH_TRADE || record.type == Order::Type::TRTH_BID || record.type == Order::Type::TRTH_ASK;
+}
+
+/* GENERATE */
+
+// synthetic stream: DE quotes and trades around a drifting mid price, mixed with
+// client limit, market, and cancel orders (mostly limit orders near the inside)
+static auto generate(const std::string& fileName, std::size_t numRecords, std::uint64_t seed) -> int
+{
+    std::mt19937_64 rng { seed };
+    std::uniform_real_distribution<double> unitDist { 0.0, 1.0 };
+    std::exponential_distribution<double> gapDist { 1.0 / 20'000.0 }; // mean of 20us between records
+    std::uniform_int_distribution<int> tickDist { -20, 20 };
+    std::uniform_int_distribution<int> sizeDist { 1, 10 };
+    std::uniform_int_distribution<int> traderDist { 0, 99 };
+
+    static const char* const s_destinations[] = { "NYS", "NAS", "ARC", "BAT" };
+
+    std::vector<ReplayRecord> records(numRecords);
+    std::vector<std::pair<std::size_t, char>> live; // resting client orders: record index and cancel type
+
+    double nanos = 0.0;
+    int midTicks = 10'000;
+
+    for (std::size_t i = 0; i < numRecords; ++i) {
+        auto& record = records[i];
+        std::memset(&record, 0, sizeof(record));
+
+        nanos += gapDist(rng);
+        record.nanos = static_cast<std::int64_t>(nanos);
+        record.size = sizeDist(rng);
+
+        if (auto r = unitDist(rng); r < 0.2) { // global quote or trade
+            midTicks += tickDist(rng) / 10;
+            int side = std::uniform_int_distribution<int> { 0, 2 }(rng);
+            record.type = (side == 0) ? Order::Type::TRTH_BID : (side == 1) ? Order::Type::TRTH_ASK : Order::Type::TRTH_TRADE;
+            record.price = (midTicks + ((side == 0) ? -1 : (side == 1) ? 1 : 0)) / 100.0;
+            record.size *= 100;
+            copyField(record.traderID, s_destinations[rng() % 4]);
+        } else if (r < 0.35 && !live.empty()) { // cancel a resting order
+            auto j = std::uniform_int_distribution<std::size_t> { 0, live.size() - 1 }(rng);
+            const auto& target = records[live[j].first];
+            record.type = live[j].second;
+            record.price = target.price;
+            record.size = target.size;
+            std::memcpy(record.traderID, target.traderID, sizeof(record.traderID));
+            std::memcpy(record.orderID, target.orderID, sizeof(record.orderID));
+            live[j] = live.back();
+            live.pop_back();
+        } else { // new client order
+            bool isBuy = (rng() % 2) == 0;
+            bool isMarket = unitDist(rng) < 0.05;
+            record.type = isMarket ? (isBuy ? Order::Type::MARKET_BUY : Order::Type::MARKET_SELL)
+                                   : (isBuy ? Order::Type::LIMIT_BUY : Order::Type::LIMIT_SELL);
+            record.price = isMarket ? 0.0 : (midTicks + tickDist(rng)) / 100.0;
+            copyField(record.traderID, "T" + std::to_string(traderDist(rng)));
+            copyField(record.orderID, "O" + std::to_string(i));
+            if (!isMarket) {
+                live.emplace_back(i, isBuy ? Order::Type::CANCEL_BID : Order::Type::CANCEL_ASK);
+            }
+        }
+    }
+
+    ReplayFileHeader header {};
+    std::memcpy(header.magic, REPLAY_FILE_MAGIC, sizeof(header.magic));
+    copyField(header.symbol, "BENCH");
+    header.numRecords = numRecords;
+
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> file { std::fopen(fileName.c_str(), "wb"), &std::fclose };
+    if (!file
+        || std::fwrite(&header, sizeof(header), 1, file.get()) != 1
+        || std::fwrite(records.data(), sizeof(ReplayRecord), records.size(), file.get()) != records.size()) {
+        std::cerr << "Cannot write " << fileName << std::endl;
+        return 1;
+    }
+
+    std::cout << "Generated " << numRecords << " records into " << fileName << std::endl;
+    return 0;
+}
+
+/* RUN */
+
+// FNV-1a, over the fields of every execution report (simulation times excluded)
+class ReportHasher {
+public:
+    void add(const void* data, std::size_t size)
+    {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            m_hash = (m_hash ^ bytes[i]) * 0x100000001b3ULL;
+        }
+    }
+
+    void add(const std::string& value)
+    {
+        add(value.data(), value.size() + 1); // including the terminating null character, as a separator
+    }
+
+    void add(const ExecutionReport& report)
+    {
+        add(report.symbol);
+        add(&report.price, sizeof(report.price));
+        add(&report.size, sizeof(report.size));
+        add(report.traderID1);
+        add(report.traderID2);
+        add(&report.orderType1, sizeof(report.orderType1));
+        add(&report.orderType2, sizeof(report.orderType2));
+        add(report.orderID1);
+        add(report.orderID2);
+        add(&report.decision, sizeof(report.decision));
+        add(report.destination);
+    }
+
+    auto get() const -> std::uint64_t
+    {
+        return m_hash;
+    }
+
+private:
+    std::uint64_t m_hash = 0xcbf29ce484222325ULL;
+};
+
+template <typename MarketType>
+class ReplayMarket : public MarketType {
+public:
+    using MarketType::MarketType;
+
+    auto getHash() const -> std::uint64_t { return m_hasher.get(); }
+    auto getNumExecutionReports() const -> std::size_t { return m_numExecutionReports; }
+    auto getNumOrderBookUpdates() const -> std::size_t { return m_numOrderBookUpdates; }
+
+protected:
+    /* virtual */ void publishMessages(const std::vector<ExecutionReport>& executionReports, const std::vector<OrderBookEntry>& orderBookUpdates) override
+    {
+        for (const auto& report : executionReports) {
+            m_hasher.add(report);
+        }
+        m_numExecutionReports += executionReports.size();
+        m_numOrderBookUpdates += orderBookUpdates.size();
+    }
+
+private:
+    ReportHasher m_hasher;
+    std::size_t m_numExecutionReports = 0;
+    std::size_t m_numOrderBookUpdates = 0;
+};
+
+template <typename MarketType>
+static void replay(MarketType& market, const std::vector<ReplayRecord>& records)
+{
+    auto& timeSetting = TimeSetting::getInstance();
+    auto startNanos = timeSetting.nowNanos(); // virtual clock: the simulation start
+
+    std::vector<std::int64_t> latenciesNS;
+    latenciesNS.reserve(records.size());
+
+    std::size_t numGlobal = 0;
+
+    shift::terminal::VerboseOptHelper voh { std::cout, false }; // mute market output while running
+
+    s_numAllocations = 0;
+    s_numAllocatedBytes = 0;
+    s_isCountingAllocations = true;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (const auto& record : records) {
+        timeSetting.setVirtualNanos(record.nanos + 1); // the record is due right away
+
+        auto submitted = std::chrono::steady_clock::now();
+
+        if (isGlobal(record)) {
+            Order order { market.getSymbol(), record.price, record.size, static_cast<Order::Type>(record.type), viewField(record.traderID), TimeSetting::s_toUtcTimestamp(startNanos + record.nanos) };
+            order.setNanos(record.nanos);
+            market.bufNewGlobalOrder(std::move(order));
+            ++numGlobal;
+        } else {
+            Order order { market.getSymbol(), viewField(record.traderID), viewField(record.orderID), record.price, record.size, static_cast<Order::Type>(record.type), TimeSetting::s_toUtcTimestamp(startNanos + record.nanos) };
+            order.setNanos(record.nanos);
+            market.bufNewLocalOrder(std::move(order));
+        }
+
+        while (market.processNextOrder()) {
+        }
+
+        latenciesNS.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - submitted).count());
+    }
+
+    market.flushPendingMessages();
+
+    auto elapsedS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    s_isCountingAllocations = false;
+    std::cout.clear(); // unmute
+
+    std::sort(latenciesNS.begin(), latenciesNS.end());
+    auto percentile = [&latenciesNS](double p) {
+        return latenciesNS[std::min(latenciesNS.size() - 1, static_cast<std::size_t>(p * latenciesNS.size()))];
+    };
+
+    std::cout << "Records: " << records.size() << " (" << (records.size() - numGlobal) << " local, " << numGlobal << " global)" << '\n'
+              << std::fixed << std::setprecision(0)
+              << "Throughput: " << (records.size() / elapsedS) << " records/s"
+              << std::setprecision(3) << " (" << elapsedS << " s)" << '\n'
+              << "Latency (ns) p50: " << percentile(0.50)
+              << " p90: " << percentile(0.90)
+              << " p99: " << percentile(0.99)
+              << " p99.9: " << percentile(0.999)
+              << " max: " << latenciesNS.back() << '\n'
+              << std::setprecision(2)
+              << "Allocations: " << s_numAllocations << " (" << (static_cast<double>(s_numAllocations) / records.size()) << " per record), "
+              << s_numAllocatedBytes << " bytes" << '\n'
+              << "Execution reports: " << market.getNumExecutionReports()
+              << " | order book updates: " << market.getNumOrderBookUpdates()
+              << " | hash: 0x" << std::hex << std::setw(16) << std::setfill('0') << market.getHash() << std::dec << std::setfill(' ')
+              << std::endl;
+}
+
+static auto run(const std::string& fileName, double batchFrequencyS) -> int
+{
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> file { std::fopen(fileName.c_str(), "rb"), &std::fclose };
+    ReplayFileHeader header {};
+    if (!file || std::fread(&header, sizeof(header), 1, file.get()) != 1 || std::memcmp(header.magic, REPLAY_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        std::cerr << "Cannot read " << fileName << std::endl;
+        return 1;
+    }
+
+    std::vector<ReplayRecord> records(header.numRecords);
+    if (std::fread(records.data(), sizeof(ReplayRecord), records.size(), file.get()) != records.size()) {
+        std::cerr << "Truncated file: " << fileName << std::endl;
+        return 1;
+    }
+
+    if (!std::is_sorted(records.begin(), records.end(), [](const ReplayRecord& a, const ReplayRecord& b) { return a.nanos < b.nanos; })) {
+        std::cerr << "Records are not sorted by time: " << fileName << std::endl;
+        return 1;
+    }
+
+    std::string symbol { viewField(header.symbol) };
+
+    TimeSetting::getInstance().initiate(boost::posix_time::time_from_string("2018-12-17 09:30:00"), 1);
+    TimeSetting::getInstance().setVirtualClock(true);
+    TimeSetting::getInstance().setVirtualNanos(0);
+    TimeSetting::getInstance().setStartTime();
+
+    if (batchFrequencyS > 0.0) {
+        std::cout << "Market: FBAStockMarket (" << batchFrequencyS << " s batches)" << std::endl;
+        ReplayMarket<markets::FBAStockMarket> market { symbol, batchFrequencyS };
+        replay(market, records);
+    } else {
+        std::cout << "Market: ContinuousStockMarket" << std::endl;
+        ReplayMarket<markets::ContinuousStockMarket> market { symbol };
+        replay(market, records);
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    std::string command = (argc > 1) ? argv[1] : "";
+
+    if (command == "generate" && argc > 2) {
+        const std::size_t numRecords = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 1'000'000;
+        const std::uint64_t seed = (argc > 4) ? std::strtoull(argv[4], nullptr, 10) : 42;
+        return generate(argv[2], numRecords, seed);
+    }
+
+    if (command == "run" && argc > 2) {
+        const double batchFrequencyS = (argc > 3) ? std::atof(argv[3]) : 0.0;
+        return run(argv[2], batchFrequencyS);
+    }
+
+    std::cerr << "Usage: " << argv[0] << " generate <file> [numRecords = 1000000] [seed = 42]" << '\n'
+              << "       " << argv[0] << " run <file> [batchFrequencyS = 0 (continuous market)]" << std::endl;
+    return 1;
+}
@@ -0,0 +1,123 @@
+/*
+** Measures order-to-execution-report latency of an idle ContinuousStockMarket thread
+** under each market wait strategy (blocking, hybrid, spinning).
+**
+** Each round rests a limit buy, lets the market go idle for a random gap, and then sends
+** a crossing limit sell: latency is measured from submission until the trade is visible
+** in the book, which happens in the same critical section that generates the execution report.
+** CPU time used by the whole process is reported as well, since idle spinning is not free.
+**
+** Usage: WakeUpLatencyBenchmark [numRounds = 2000] [maxIdleGapUS = 2000]
+*/
+
+#include "markets/ContinuousStockMarket.h"
+
+#include "TimeSetting.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <shift/miscutils/terminal/Options.h>
+
+using namespace std::chrono_literals;
+using shift::concurrency::WaitStrategy;
+
+class BenchmarkMarket : public markets::ContinuousStockMarket {
+public:
+    BenchmarkMarket()
+        : ContinuousStockMarket { std::string { "BENCH" } }
+    {
+    }
+
+    auto getNumRestingOrders() -> std::size_t
+    {
+        std::lock_guard<shift::concurrency::Spinlock> guard(m_spinlock);
+        return m_localBids.getOrderPool().size() + m_localAsks.getOrderPool().size();
+    }
+};
+
+static void waitForRestingOrders(BenchmarkMarket& market, std::size_t numRestingOrders)
+{
+    while (market.getNumRestingOrders() != numRestingOrders) {
+        std::this_thread::yield();
+    }
+}
+
+static void run(const char* name, WaitStrategy::Type type, int numRounds, int maxIdleGapUS)
+{
+    std::mt19937 rng { 42 };
+    std::uniform_int_distribution<int> gapDist { maxIdleGapUS / 10, maxIdleGapUS };
+
+    shift::terminal::VerboseOptHelper voh { std::cout, false }; // mute market output while running
+
+    BenchmarkMarket market;
+    market.setWaitStrategy(type);
+    std::thread marketThread { std::ref(market) };
+
+    std::vector<double> latenciesUS;
+    latenciesUS.reserve(numRounds);
+
+    auto startCPU = std::clock();
+    auto startWall = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < numRounds; ++i) {
+        market.bufNewLocalOrder({ "BENCH", "buyer", "B" + std::to_string(i), 10.0, 100, Order::Type::LIMIT_BUY, {} });
+        waitForRestingOrders(market, 1);
+
+        std::this_thread::sleep_for(std::chrono::microseconds(gapDist(rng))); // let the market go idle
+
+        auto sent = std::chrono::steady_clock::now();
+        market.bufNewLocalOrder({ "BENCH", "seller", "S" + std::to_string(i), 10.0, 100, Order::Type::LIMIT_SELL, {} });
+        waitForRestingOrders(market, 0);
+        latenciesUS.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sent).count());
+    }
+
+    auto elapsedWall = std::chrono::duration<double>(std::chrono::steady_clock::now() - startWall).count();
+    auto elapsedCPU = static_cast<double>(std::clock() - startCPU) / CLOCKS_PER_SEC;
+
+    markets::MarketList::s_isTimeout = true;
+    marketThread.join();
+    markets::MarketList::s_isTimeout = false;
+
+    std::cout.clear(); // unmute
+
+    std::sort(latenciesUS.begin(), latenciesUS.end());
+    auto percentile = [&latenciesUS](double p) {
+        return latenciesUS[std::min(latenciesUS.size() - 1, static_cast<std::size_t>(p * latenciesUS.size()))];
+    };
+
+    std::cout << std::fixed << std::setprecision(1) << std::left << std::setw(9) << name
+              << " latency (us) p50: " << std::setw(8) << percentile(0.50)
+              << " p90: " << std::setw(8) << percentile(0.90)
+              << " p99: " << std::setw(8) << percentile(0.99)
+              << " max: " << std::setw(8) << latenciesUS.back()
+              << " | CPU time / wall time: " << std::setprecision(2) << (elapsedCPU / elapsedWall)
+              << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    const int numRounds = (argc > 1) ? std::atoi(argv[1]) : 2000;
+    const int maxIdleGapUS = (argc > 2) ? std::atoi(argv[2]) : 2000;
+
+    TimeSetting::getInstance().initiate(boost::posix_time::second_clock::local_time(), 1);
+    TimeSetting::getInstance().setStartTime();
+    std::this_thread::sleep_for(2ms); // orders are only due once the simulation clock is past them
+
+    std::cout << "Rounds: " << numRounds << " | idle gap: " << (maxIdleGapUS / 10) << "-" << maxIdleGapUS << " us" << std::endl;
+
+    run("blocking", WaitStrategy::Type::BLOCKING, numRounds, maxIdleGapUS);
+    run("hybrid", WaitStrategy::Type::HYBRID, numRounds, maxIdleGapUS);
+    run("spinning", WaitStrategy::Type::SPINNING, numRounds, maxIdleGapUS);
+
+    return 0;
+}
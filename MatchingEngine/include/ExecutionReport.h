@@ -3,6 +3,7 @@
 #include "Order.h"
 
 #include <string>
+#include <string_view>
 
 #include <quickfix/FieldTypes.h>
 
@@ -28,8 +29,8 @@ struct ExecutionReport {
         std::string traderID2,
         Order::Type orderType1,
         Order::Type orderType2,
-        std::string orderID1,
-        std::string orderID2,
+        std::string_view orderID1,
+        std::string_view orderID2,
         char decision,
         std::string destination,
         FIX::UtcTimeStamp simulationTime1,
@@ -41,8 +42,8 @@ struct ExecutionReport {
         , traderID2 { std::move(traderID2) }
         , orderType1 { orderType1 }
         , orderType2 { orderType2 }
-        , orderID1 { std::move(orderID1) }
-        , orderID2 { std::move(orderID2) }
+        , orderID1 { orderID1 }
+        , orderID2 { orderID2 }
         , decision { decision }
         , destination { std::move(destination) }
         , simulationTime1 { std::move(simulationTime1) }
@@ -4,10 +4,12 @@
 #include "OrderBookEntry.h"
 #include "OrderConfirmation.h"
 
+#include <atomic>
 #include <mutex>
 #include <set>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 // acceptor
 #include <quickfix/Application.h>
@@ -43,6 +45,11 @@ public:
     auto connectBrokerageCenter(const std::string& configFile, bool verbose = false, const std::string& cryptoKey = "", const std::string& dbConfigFile = "") -> bool;
     void disconnectBrokerageCenter();
 
+    // batching mode: order book updates are packed into multi-entry MarketDataIncrementalRefresh messages,
+    // and markets coalesce their outgoing messages per ::FIX_BATCH_FLUSH_INTERVAL (see Market::sendPendingMessages())
+    auto isBatchingMode() const -> bool;
+    void setBatchingMode(bool isBatchingMode);
+
     void sendOrderBook(const std::vector<OrderBookEntry>& orderBook, const std::string& targetID = "");
     void sendOrderBookUpdates(const std::vector<OrderBookEntry>& orderBookUpdates);
     void sendExecutionReports(const std::vector<ExecutionReport>& executionReports);
@@ -52,8 +59,13 @@ private:
     FIXAcceptor(const FIXAcceptor&) = delete; // forbid copying
     auto operator=(const FIXAcceptor&) -> FIXAcceptor& = delete; // forbid assigning
 
+    auto getTargetList() const -> std::vector<std::string>;
+
+    static auto s_newExecID() -> std::string;
+
     static void s_sendSecurityList(const std::string& targetID);
     static void s_sendOrderConfirmation(const OrderConfirmation& confirmation, const std::string& targetID);
+    static void s_sendOrderRejection(const OrderConfirmation& confirmation, const std::string& targetID, const std::string& reason);
 
     // QuickFIX methods
     void onCreate(const FIX::SessionID&) override;
@@ -65,6 +77,8 @@ private:
     void fromApp(const FIX::Message&, const FIX::SessionID&) noexcept(false) override;
     void onMessage(const FIX50SP2::NewOrderSingle&, const FIX::SessionID&) override;
 
+    std::atomic<bool> m_isBatchingMode { false };
+
     mutable std::mutex m_mtxTargetSet;
     std::unordered_set<std::string> m_targetSet;
 
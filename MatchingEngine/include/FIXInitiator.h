@@ -3,9 +3,11 @@
 #include "ExecutionReport.h"
 #include "Order.h"
 
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
@@ -51,11 +53,17 @@ public:
 
     static void s_sendNextDataRequest();
 
+    // data chunks are counted by the Datafeed Engine's notices sent after each of them
+    auto getNumDataChunksReceived() const -> int;
+    auto waitForDataChunks(int numDataChunks, std::chrono::milliseconds timeout) -> int;
+
 private:
     FIXInitiator() = default; // singleton pattern
     FIXInitiator(const FIXInitiator&) = delete; // forbid copying
     auto operator=(const FIXInitiator&) -> FIXInitiator& = delete; // forbid assigning
 
+    static void s_receiveTickBatch(std::string_view payload);
+
     // QuickFIX methods
     void onCreate(const FIX::SessionID&) override;
     void onLogon(const FIX::SessionID&) override;
@@ -75,4 +83,8 @@ private:
     std::condition_variable m_cvMarketDataReady;
     mutable std::mutex m_mtxMarketDataReady;
     std::string m_lastMarketDataRequestID;
+
+    std::condition_variable m_cvDataChunkReceived;
+    mutable std::mutex m_mtxDataChunks;
+    int m_numDataChunksReceived = 0;
 };
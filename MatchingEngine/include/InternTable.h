@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// process-wide table of interned strings (symbols, trader IDs, destinations):
+// each distinct string is stored once, and referred to by a small integer ID.
+// looking an ID up does not take a lock: strings are stored in fixed-size chunks
+// which are never moved, so references to them stay valid forever; interning only
+// takes the lock the first time a thread interns a given string (see intern())
+class InternTable {
+public:
+    using id_t = std::uint32_t;
+
+    static constexpr id_t EMPTY_ID = 0; // ID of the empty string
+
+    ~InternTable() = default;
+
+    static auto getInstance() -> InternTable&;
+
+    auto intern(std::string_view str) -> id_t;
+
+    // id must have been returned by intern()
+    inline auto lookup(id_t id) const -> const std::string&
+    {
+        return m_chunks[id / CHUNK_SIZE].load(std::memory_order_acquire)[id % CHUNK_SIZE];
+    }
+
+    auto size() const -> std::size_t;
+
+private:
+    InternTable(); // singleton pattern
+    InternTable(const InternTable&) = delete; // forbid copying
+    auto operator=(const InternTable&) -> InternTable& = delete; // forbid assigning
+
+    auto findOrInsert(std::string_view str) -> id_t;
+
+    static constexpr std::size_t CHUNK_SIZE = 1024;
+    static constexpr std::size_t MAX_NUM_CHUNKS = 4096;
+
+    mutable std::mutex m_mtxTable;
+    std::unordered_map<std::string_view, id_t> m_ids; // keys refer to the stored strings
+    std::array<std::unique_ptr<std::string[]>, MAX_NUM_CHUNKS> m_storage;
+    std::array<std::atomic<const std::string*>, MAX_NUM_CHUNKS> m_chunks;
+    std::size_t m_size;
+};
@@ -1,8 +1,45 @@
 #pragma once
 
-#include <quickfix/FieldTypes.h>
+#include "InternTable.h"
 
+#include <array>
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <quickfix/FieldTypes.h>
+
+// order IDs are kept inline (no heap allocation), up to MAX_LENGTH characters
+class OrderID {
+public:
+    static constexpr std::size_t MAX_LENGTH = 63;
+
+    OrderID() = default;
+    OrderID(std::string_view orderID); // longer IDs are truncated
+
+    inline auto view() const -> std::string_view
+    {
+        return { m_data.data(), m_length };
+    }
+
+    inline auto operator==(const OrderID& other) const -> bool
+    {
+        return view() == other.view();
+    }
+
+    struct Hash {
+        inline auto operator()(const OrderID& orderID) const -> std::size_t
+        {
+            return std::hash<std::string_view> {}(orderID.view());
+        }
+    };
+
+private:
+    std::array<char, MAX_LENGTH> m_data;
+    std::uint8_t m_length = 0;
+};
 
 class Order {
 public:
@@ -19,43 +56,49 @@ public:
     };
 
     Order() = default;
-    Order(std::string symbol, double price, int size, Order::Type type, std::string destination, FIX::UtcTimeStamp simulationTime);
-    Order(std::string symbol, std::string traderID, std::string orderID, double price, int size, Order::Type type, FIX::UtcTimeStamp simulationTime);
+    Order(std::string_view symbol, double price, int size, Order::Type type, std::string_view destination, const FIX::UtcTimeStamp& simulationTime);
+    Order(std::string_view symbol, std::string_view traderID, std::string_view orderID, double price, int size, Order::Type type, const FIX::UtcTimeStamp& simulationTime);
 
-    auto operator==(const Order& other) -> bool;
+    auto operator==(const Order& other) const -> bool;
 
     // getters
     auto getSymbol() const -> const std::string&;
     auto getTraderID() const -> const std::string&;
-    auto getOrderID() const -> const std::string&;
-    auto getMilli() const -> long;
+    auto getOrderID() const -> std::string_view;
+    auto getNanos() const -> std::int64_t; // time at which the order is due, in nanoseconds since the simulation start
     auto getPrice() const -> double;
     auto getSize() const -> int;
     auto getType() const -> Type;
     auto getTypeString() const -> std::string;
     auto getDestination() const -> const std::string&;
-    auto getTime() const -> const FIX::UtcTimeStamp&;
+    auto getTime() const -> FIX::UtcTimeStamp;
+    auto getTimeNS() const -> std::int64_t; // simulation time, in nanoseconds since epoch
     auto getAuctionCounter() const -> int;
 
     // setters
-    void setSymbol(const std::string& symbol);
-    void setMilli(long milli);
+    void setSymbol(std::string_view symbol);
+    void setNanos(std::int64_t nanos);
     void setPrice(double price);
     void setSize(int size);
     void setType(Type type);
-    void setDestination(const std::string& destination);
+    void setDestination(std::string_view destination);
 
     void incrementAuctionCounter();
 
 private:
-    std::string m_symbol;
-    std::string m_traderID;
-    std::string m_orderID;
-    long m_milli;
-    double m_price;
-    int m_size;
-    Type m_type;
-    std::string m_destination;
-    FIX::UtcTimeStamp m_simulationTime;
-    int m_auctionCounter;
+    // strings are either interned or stored inline, so that orders do not own any heap memory
+    // (members are sorted by size to avoid padding)
+    OrderID m_orderID;
+    double m_price = 0.0;
+    std::int64_t m_simulationTimeNS = 0;
+    std::int64_t m_nanos = 0;
+    int m_size = 0;
+    int m_auctionCounter = 0;
+    InternTable::id_t m_symbol = InternTable::EMPTY_ID;
+    InternTable::id_t m_traderID = InternTable::EMPTY_ID;
+    InternTable::id_t m_destination = InternTable::EMPTY_ID;
+    Type m_type = LIMIT_BUY;
 };
+
+// copying or moving an order is a plain memory copy: it never allocates
+static_assert(std::is_trivially_copyable_v<Order>);
@@ -6,6 +6,40 @@ using namespace std::chrono_literals;
 
 static constexpr auto DURATION_PER_DATA_CHUNK = 300s;
 
+// prefetching of data chunks: more chunks are requested while less than DATA_PREFETCH_HORIZON of data (simulation time)
+// is requested ahead of the simulation, with at most DATA_CHUNKS_MAX_IN_FLIGHT chunks requested but not received yet
+static constexpr auto DATA_PREFETCH_HORIZON = 2 * DURATION_PER_DATA_CHUNK;
+static constexpr auto DATA_CHUNKS_MAX_IN_FLIGHT = 3;
+// upper bound for the data requester to wait before re-checking its state (e.g. termination)
+static constexpr auto DATA_REQUEST_MAX_WAIT_DURATION = 1s;
+
 static constexpr auto FIX_SESSION_DURATION = 12 * 60 * 60; // 12 hours
 
 static constexpr auto FBA_ORDER_BOOK_MAX_LEVEL = 5;
+
+// capacities of the per-market ingress queues (rounded up to a power of two):
+// producers back off while a queue is full, so these only bound burst sizes
+// (global orders are then staged by the market thread until they are due, in a buffer initially reserved for as many)
+static constexpr auto GLOBAL_ORDER_QUEUE_CAPACITY = 4096;
+static constexpr auto LOCAL_ORDER_QUEUE_CAPACITY = 1024;
+
+// upper bound for an idle market thread to wait before re-checking its state (e.g. timeout)
+static constexpr auto MARKET_MAX_WAIT_DURATION = 100ms;
+
+// maximum number of events a market worker processes for one market before moving on to the next one
+static constexpr auto MARKET_WORKER_BATCH_SIZE = 64;
+
+// batching mode of the FIXAcceptor (see --batch option):
+// maximum number of order book updates packed into one MarketDataIncrementalRefresh message
+static constexpr auto FIX_MAX_MD_ENTRIES_PER_MESSAGE = 64;
+// how long a busy market may hold back its execution reports and order book updates (idle markets flush immediately)
+static constexpr auto FIX_BATCH_FLUSH_INTERVAL = 1ms;
+// a market flushes earlier if it holds back more messages than this
+static constexpr auto FIX_BATCH_MAX_PENDING_MESSAGES = 1024;
+
+// capacity of the per-market queue of outgoing messages for publisher threads (see --publishers option):
+// markets never block on it, extra messages are kept in an overflow queue
+static constexpr auto OUTGOING_MESSAGE_QUEUE_CAPACITY = 1024;
+
+// maximum number of messages a publisher sends for one market before moving on to the next one
+static constexpr auto MARKET_PUBLISHER_BATCH_SIZE = 256;
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <string>
 
 #include <quickfix/FieldTypes.h>
@@ -14,11 +16,24 @@ public:
     static auto getInstance() -> TimeSetting&;
     static auto getUTCPTime(const boost::posix_time::ptime& localPtime) -> boost::posix_time::ptime;
 
+    // conversions between FIX::UtcTimeStamp and nanoseconds since epoch:
+    // s_toUtcTimestamp() keeps a per-thread cache of the current second, so that only the fraction needs to be updated
+    static auto s_toNanos(const FIX::UtcTimeStamp& utc) -> std::int64_t;
+    static auto s_toUtcTimestamp(std::int64_t nanos) -> FIX::UtcTimeStamp;
+
     void initiate(const boost::posix_time::ptime& localPtime, int speed = false);
     void setStartTime();
+    auto getSpeed() const -> int;
+
+    // replay mode: the clock only moves when told to (through setVirtualNanos()), instead of following real time
+    void setVirtualClock(bool isVirtualClock);
+    void setVirtualNanos(std::int64_t nanos); // real (not simulation) time since the start
+
     auto pastMilli(bool simTime = false) const -> long;
-    auto pastMilli(const FIX::UtcTimeStamp& utc, bool simTime = false) const -> long;
-    auto simulationTimestamp() -> FIX::UtcTimeStamp;
+    auto pastNanos(bool simTime = false) const -> std::int64_t;
+    auto pastNanos(const FIX::UtcTimeStamp& utc, bool simTime = false) const -> std::int64_t;
+    auto nowNanos() const -> std::int64_t; // simulation time, in nanoseconds since epoch
+    auto simulationTimestamp() const -> FIX::UtcTimeStamp;
 
 private:
     TimeSetting() = default; // singleton pattern
@@ -26,7 +41,10 @@ private:
     auto operator=(const TimeSetting&) -> TimeSetting& = delete; // forbid assigning
 
     boost::posix_time::ptime m_utcDateTime;
+    std::int64_t m_utcDateTimeNanos; // m_utcDateTime, in nanoseconds since epoch
     std::time_t m_hhmmss;
     int m_speed;
-    std::chrono::high_resolution_clock::time_point m_startTimePoint; // real time (not simulation time)
+    std::chrono::steady_clock::time_point m_startTimePoint; // real time (not simulation time)
+    std::atomic<bool> m_isVirtualClock { false };
+    std::atomic<std::int64_t> m_virtualNanos { 0 };
 };
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <map>
 #include <string>
 #include <vector>
 
-auto fileConfigMode(std::string filePath, std::string& date, std::string& startTime, std::string& endTime, int& experimentSpeed, std::vector<std::string>& symbols) -> bool;
+// numWorkers: number of market worker threads the worker assignments refer to (0 if markets run in their own threads)
+auto fileConfigMode(std::string filePath, std::string& date, std::string& startTime, std::string& endTime, int& experimentSpeed, std::vector<std::string>& symbols, std::map<std::string, int>& workerAssignments, int numWorkers) -> bool;
 
 void inputConfigMode(std::string& date, std::string& startTime, std::string& endTime, int& experimentSpeed, std::vector<std::string>& symbols);
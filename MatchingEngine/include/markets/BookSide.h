@@ -0,0 +1,69 @@
+#pragma once
+
+#include "OrderPool.h"
+#include "PriceLevel.h"
+
+#include <string_view>
+#include <vector>
+
+namespace markets {
+
+// one side (bid or ask) of the local order book:
+// price levels are kept in a flat vector sorted from worst to best price,
+// so that the best level (which is where almost all activity happens)
+// is at the back, and inserting/removing it does not move any other level.
+// iteration is exposed from best to worst price, as it used to be with std::list
+class BookSide {
+public:
+    enum class Type : char {
+        BID,
+        ASK,
+    };
+
+    using iterator = std::vector<PriceLevel>::reverse_iterator; // best -> worst price
+    using const_iterator = std::vector<PriceLevel>::const_reverse_iterator;
+    using reverse_iterator = std::vector<PriceLevel>::iterator; // worst -> best price
+    using const_reverse_iterator = std::vector<PriceLevel>::const_iterator;
+
+    BookSide(Type type);
+
+    BookSide(const BookSide&) = delete; // forbid copying
+    auto operator=(const BookSide&) -> BookSide& = delete; // forbid assigning
+
+    auto getType() const -> Type;
+
+    auto empty() const -> bool;
+    auto size() const -> std::size_t;
+
+    auto begin() -> iterator;
+    auto begin() const -> const_iterator;
+    auto end() -> iterator;
+    auto end() const -> const_iterator;
+
+    auto rbegin() -> reverse_iterator;
+    auto rbegin() const -> const_reverse_iterator;
+    auto rend() -> reverse_iterator;
+    auto rend() const -> const_reverse_iterator;
+
+    // first price level (from best to worst) whose price is not better than the given price:
+    // that is either the level with the same price, or the position to insert a new one
+    auto lower_bound(double price) -> iterator;
+
+    // insert a new empty price level before pos (in best to worst order)
+    auto insert(iterator pos, double price) -> iterator;
+    auto erase(iterator pos) -> iterator;
+
+    // O(1) lookup of a resting order by its order ID and price (returns an end() iterator if not found)
+    auto findOrder(std::string_view orderID, double price) -> PriceLevel::iterator;
+
+    auto getOrderPool() -> OrderPool&;
+
+private:
+    auto isBetter(double price, double other) const -> bool;
+
+    Type m_type;
+    OrderPool m_orderPool; // must be declared before m_levels
+    std::vector<PriceLevel> m_levels;
+};
+
+} // markets
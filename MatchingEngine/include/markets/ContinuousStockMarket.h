@@ -14,8 +14,7 @@ public:
     ContinuousStockMarket(const market_creator_parameters_t& parameters);
     virtual ~ContinuousStockMarket() = default;
 
-    // function to start one matching engine, for market thread
-    virtual void operator()() override;
+    virtual auto processNextOrder() -> bool override;
 
     void doGlobalLimitBuy(Order& orderRef);
     void doGlobalLimitSell(Order& orderRef);
@@ -32,6 +31,9 @@ public:
 
     void insertLocalBid(Order newBid);
     void insertLocalAsk(Order newAsk);
+
+protected:
+    Order m_prevGlobalOrder; // used to skip repeated quotes
 };
 
 } // markets
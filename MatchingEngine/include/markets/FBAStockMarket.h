@@ -5,8 +5,10 @@
 #include "Order.h"
 #include "PriceLevel.h"
 
+#include <cstdint>
 #include <deque>
 #include <string>
+#include <vector>
 
 namespace markets {
 
@@ -21,18 +23,22 @@ public:
 
     auto getNextBatchAuction() const -> double;
 
-    // function to start one matching engine, for market thread
-    virtual void operator()() override;
+    virtual auto processNextOrder() -> bool override;
+    virtual auto getNextWakeUpNS() const -> std::int64_t override;
 
-    static inline void s_sortPriceLevel(PriceLevel& currentLevel)
+    // FBA: orders in a price level are sorted by auction counter (older orders first) and size (larger orders first)
+    static inline auto s_hasPriority(const Order& a, const Order& b) -> bool
     {
-        currentLevel.sort([](const Order& a, const Order& b) {
-            if (a.getAuctionCounter() == b.getAuctionCounter()) {
-                return a.getSize() > b.getSize();
-            }
+        if (a.getAuctionCounter() == b.getAuctionCounter()) {
+            return a.getSize() > b.getSize();
+        }
+
+        return a.getAuctionCounter() > b.getAuctionCounter();
+    }
 
-            return a.getAuctionCounter() > b.getAuctionCounter();
-        });
+    static inline void s_sortPriceLevel(PriceLevel& currentLevel)
+    {
+        currentLevel.sort(s_hasPriority);
     };
 
     static auto s_determineExecutionSizes(int totalExecutionSize, const PriceLevel& currentLevel) -> std::deque<int>;
@@ -47,11 +53,18 @@ public:
     void insertLocalAsk(Order newAsk);
 
 protected:
+    // one row of the demand/supply curve used to select the execution price of a batch auction
+    struct DemandSupply {
+        double price;
+        int demand; // total size of all bids at this price or higher
+        int supply; // total size of all asks at this price or lower
+    };
+
     double m_lastExecutionPrice;
+    std::vector<DemandSupply> m_demandSupplyCurve; // ordered by increasing price, reused in every batch auction
 
-    // FIXME: these variables should be in microseconds (TimeSetting update required)
-    long m_batchFrequencyMS; // frequenty batch auctions batch frequency in milliseconds
-    long m_nextBatchAuctionMS;
+    std::int64_t m_batchFrequencyNS; // frequenty batch auctions batch frequency in nanoseconds (simulation time)
+    std::int64_t m_nextBatchAuctionNS;
 };
 
 } // markets
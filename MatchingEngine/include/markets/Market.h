@@ -1,5 +1,6 @@
 #pragma once
 
+#include "BookSide.h"
 #include "ExecutionReport.h"
 #include "FIXAcceptor.h"
 #include "Order.h"
@@ -7,19 +8,35 @@
 #include "PriceLevel.h"
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <list>
 #include <map>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <string>
+#include <variant>
 #include <vector>
 
 #include <quickfix/FieldTypes.h>
 
+#include <shift/miscutils/concurrency/MPSCQueue.h>
+#include <shift/miscutils/concurrency/SPSCQueue.h>
 #include <shift/miscutils/concurrency/Spinlock.h>
+#include <shift/miscutils/concurrency/WaitStrategy.h>
 
 namespace markets {
 
+// a complete order book, to be sent to one target (or to all targets if targetID is empty)
+struct OrderBookSnapshot {
+    std::vector<OrderBookEntry> entries;
+    std::string targetID;
+};
+
+// an outgoing message, as handed from a market to its publisher thread
+using outgoing_message_t = std::variant<ExecutionReport, OrderBookEntry, OrderBookSnapshot>;
+
 class Market {
 public:
     Market(std::string symbol);
@@ -36,34 +53,74 @@ public:
     void bufNewGlobalOrder(Order&& newOrder);
     void bufNewLocalOrder(Order&& newOrder);
 
+    auto getWaitStrategy() const -> shift::concurrency::WaitStrategy::Type;
+    void setWaitStrategy(shift::concurrency::WaitStrategy::Type type);
+
+    // make the ingress queues signal an external wait strategy (e.g. the one of a worker thread serving several markets):
+    // must be called before orders start arriving
+    void shareWaitStrategy(shift::concurrency::WaitStrategy& waitStrategy);
+
+    // send all held back execution reports and order book updates (see sendPendingMessages()), e.g. when going idle
+    void flushPendingMessages();
+
+    // hand all outgoing messages to a publisher thread (signaled through waitStrategy) instead of sending them from the market thread:
+    // must be called before orders start arriving
+    void setPublisher(shift::concurrency::WaitStrategy& waitStrategy);
+
+    // publisher side: send (at most maxCount) queued outgoing messages, returns the number of messages sent
+    auto publishOutgoingMessages(std::size_t maxCount) -> std::size_t;
+
+    // number of outgoing messages waiting for the publisher thread (backpressure metric)
+    auto getOutgoingQueueDepth() const -> std::size_t;
+
     // function to start one matching engine, for market thread
-    virtual void operator()() = 0;
+    void operator()();
+
+    // process the next due event (order or auction), if any: returns false if there was nothing to do
+    virtual auto processNextOrder() -> bool = 0;
+
+    // simulation time (in nanoseconds since the simulation start) at which the next event is due if no new orders are received
+    virtual auto getNextWakeUpNS() const -> std::int64_t;
+
+    static void s_waitUntil(shift::concurrency::WaitStrategy& waitStrategy, std::int64_t wakeUpNS);
 
 protected:
     std::string m_symbol;
     shift::concurrency::Spinlock m_spinlock;
 
-    // buffer new quotes & trades received from DE
-    mutable std::mutex m_mtxNewGlobalOrders;
-    std::queue<Order> m_newGlobalOrders;
+    // buffer new quotes & trades received from DE (single producer: the FIXInitiator thread):
+    // the market thread moves them to m_stagedGlobalOrders whenever it runs, due or not,
+    // so that a full queue only holds back the producer until the market thread is scheduled (never for simulation time)
+    shift::concurrency::SPSCQueue<Order> m_newGlobalOrders;
+    // global orders waiting until they are due (only accessed by the market thread):
+    // consumed from m_nextStagedGlobalOrder on, and the buffer keeps its capacity once all of them were consumed
+    std::vector<Order> m_stagedGlobalOrders;
+    std::size_t m_nextStagedGlobalOrder;
 
     std::list<Order> m_globalBids;
     std::list<Order> m_globalAsks;
 
     std::list<Order>::iterator m_thisGlobalOrder;
 
-    // buffer new orders received from clients
-    mutable std::mutex m_mtxNewLocalOrders;
-    std::queue<Order> m_newLocalOrders;
+    // buffer new orders received from clients (multiple producers: the FIXAcceptor threads):
+    // orders wait in the queue until they are due, so that a full queue holds back the producers
+    shift::concurrency::MPSCQueue<Order> m_newLocalOrders;
+
+    // signaled by the producers of both ingress queues
+    shift::concurrency::WaitStrategy m_ownWaitStrategy;
+    shift::concurrency::WaitStrategy* m_waitStrategy;
 
-    std::list<PriceLevel> m_localBids;
-    std::list<PriceLevel> m_localAsks;
+    BookSide m_localBids;
+    BookSide m_localAsks;
 
-    std::list<PriceLevel>::iterator m_thisPriceLevel;
-    std::list<Order>::iterator m_thisLocalOrder;
+    BookSide::iterator m_thisPriceLevel;
+    PriceLevel::iterator m_thisLocalOrder;
 
+    void stageGlobalOrders();
     auto getNextOrder(Order& orderRef) -> bool;
 
+    auto findLocalOrder(BookSide& bookSide, const Order& orderRef) -> bool;
+
     void executeGlobalOrder(Order& orderRef, int size, double price, char decision);
     void executeLocalOrder(Order& orderRef, int size, double price, char decision);
 
@@ -72,27 +129,40 @@ protected:
         m_executionReports.push_back(std::move(newExecutionReport));
     }
 
-    inline void sendExecutionReports()
-    {
-        FIXAcceptor::getInstance().sendExecutionReports(m_executionReports);
-        m_executionReports.clear();
-    }
-
     inline void addOrderBookUpdate(OrderBookEntry&& newOrderBookUpdate)
     {
         m_orderBookUpdates.push_back(std::move(newOrderBookUpdate));
     }
 
-    inline void sendOrderBookUpdates()
-    {
-        FIXAcceptor::getInstance().sendOrderBookUpdates(m_orderBookUpdates);
-        m_orderBookUpdates.clear();
-    };
+    // send the execution reports and order book updates of the current matching step, in this order:
+    // in batching mode, they are held back for up to ::FIX_BATCH_FLUSH_INTERVAL, unless force is set
+    // (must be called with m_spinlock held)
+    void sendPendingMessages(bool force = false);
+
+    // where all execution reports and order book updates end up (from the market or the publisher thread):
+    // sends them to brokers through the FIXAcceptor
+    virtual void publishMessages(const std::vector<ExecutionReport>& executionReports, const std::vector<OrderBookEntry>& orderBookUpdates);
 
 private:
     // vectors to hold temporary information
     std::vector<ExecutionReport> m_executionReports;
     std::vector<OrderBookEntry> m_orderBookUpdates;
+    std::chrono::steady_clock::time_point m_pendingSince; // when the oldest held back message was generated
+
+    // outgoing messages waiting for the publisher thread (if any):
+    // pushed while holding m_spinlock, and kept in the overflow queue instead of blocking when the queue is full
+    std::unique_ptr<shift::concurrency::SPSCQueue<outgoing_message_t>> m_outgoingMessages;
+    std::deque<outgoing_message_t> m_overflowMessages;
+    std::atomic<std::size_t> m_numOverflowMessages;
+    shift::concurrency::WaitStrategy* m_publisherWaitStrategy;
+
+    // only accessed by the publisher thread
+    std::vector<ExecutionReport> m_executionReportsToPublish;
+    std::vector<OrderBookEntry> m_orderBookUpdatesToPublish;
+
+    void enqueueOutgoingMessage(outgoing_message_t&& message);
+    void moveOverflowMessages();
+    void publishBufferedMessages();
 };
 
 class MarketList {
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Market.h"
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <shift/miscutils/concurrency/WaitStrategy.h>
+
+namespace markets {
+
+// a sender thread serving a fixed set of markets:
+// markets queue their outgoing messages (see Market::setPublisher()), and the publisher serializes and sends them,
+// so that market threads never wait for FIX message construction or network I/O
+class MarketPublisher {
+public:
+    MarketPublisher(int id, shift::concurrency::WaitStrategy::Type waitStrategy);
+
+    MarketPublisher(const MarketPublisher&) = delete; // forbid copying
+    auto operator=(const MarketPublisher&) -> MarketPublisher& = delete; // forbid assigning
+
+    auto getID() const -> int;
+    auto getNumMarkets() const -> int;
+    auto getNumPublishedMessages() const -> long;
+    auto getQueueDepth() const -> std::size_t; // number of messages waiting to be sent, over all markets
+
+    // must be called before the publisher thread starts and before orders start arriving
+    void addMarket(Market& market);
+
+    // let the publisher thread send all remaining messages and return: to be called once all markets of this publisher have stopped
+    void stop();
+
+    // function to start the publisher, for publisher thread
+    void operator()();
+
+private:
+    int m_id;
+    std::vector<Market*> m_markets;
+    shift::concurrency::WaitStrategy m_waitStrategy; // signaled by all markets of this publisher
+    std::atomic<bool> m_isStopped;
+
+    std::atomic<long> m_numPublishedMessages;
+};
+
+} // markets
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Market.h"
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include <shift/miscutils/concurrency/WaitStrategy.h>
+
+namespace markets {
+
+// a worker thread multiplexing a fixed set of markets:
+// markets are served round-robin, and the worker only waits when none of them has anything to do
+class MarketWorker {
+public:
+    MarketWorker(int id, shift::concurrency::WaitStrategy::Type waitStrategy);
+
+    MarketWorker(const MarketWorker&) = delete; // forbid copying
+    auto operator=(const MarketWorker&) -> MarketWorker& = delete; // forbid assigning
+
+    auto getID() const -> int;
+    auto getNumMarkets() const -> int;
+    auto getNumProcessedOrders() const -> long;
+    auto getUtilization() const -> double; // fraction of time spent processing, since the worker started
+
+    // must be called before the worker thread starts and before orders start arriving
+    void addMarket(Market& market);
+
+    // function to start the worker, for worker thread
+    void operator()();
+
+private:
+    int m_id;
+    std::vector<Market*> m_markets;
+    shift::concurrency::WaitStrategy m_waitStrategy; // shared by all markets of this worker
+
+    std::chrono::steady_clock::time_point m_startTime;
+    std::atomic<bool> m_isStarted;
+    std::atomic<long> m_numProcessedOrders;
+    std::atomic<long> m_busyTimeNS;
+};
+
+} // markets
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Order.h"
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+namespace markets {
+
+// contiguous storage for resting local orders:
+// price levels link their orders through node indices (intrusive FIFO queues),
+// and released nodes are recycled through a free list, so that
+// inserting and removing orders does not hit the allocator in steady state;
+// the pool also indexes its orders by order ID, so that cancellations
+// do not have to scan the order book: the index is an open-addressing
+// table of node indices (linear probing), which only allocates when it grows;
+// every order in the pool has its own entry, including orders sharing an ID
+class OrderPool {
+public:
+    using index_t = std::uint32_t;
+
+    static constexpr index_t NIL = std::numeric_limits<index_t>::max();
+
+    struct Node {
+        Order order;
+        index_t prev;
+        index_t next;
+    };
+
+    OrderPool(std::size_t initialCapacity = 0);
+
+    OrderPool(const OrderPool&) = delete; // forbid copying
+    auto operator=(const OrderPool&) -> OrderPool& = delete; // forbid assigning
+
+    auto acquire(Order order) -> index_t;
+    void release(index_t index);
+
+    // node references are invalidated by acquire(), indices are not
+    inline auto operator[](index_t index) -> Node&
+    {
+        return m_nodes[index];
+    }
+
+    inline auto operator[](index_t index) const -> const Node&
+    {
+        return m_nodes[index];
+    }
+
+    auto find(std::string_view orderID, double price) const -> index_t;
+
+    auto size() const -> std::size_t;
+    auto capacity() const -> std::size_t;
+
+private:
+    auto getHomeSlot(std::string_view orderID) const -> std::size_t;
+    void insertIntoIndex(index_t index);
+    void eraseFromIndex(index_t index);
+    void growIndex();
+
+    std::vector<Node> m_nodes;
+    std::vector<index_t> m_orderIDIndex; // NIL marks an empty slot, size is a power of two
+    index_t m_freeHead;
+    std::size_t m_numInUse;
+};
+
+} // markets
@@ -1,14 +1,87 @@
 #pragma once
 
 #include "Order.h"
+#include "OrderPool.h"
 
-#include <list>
+#include <algorithm>
+#include <iterator>
+#include <vector>
 
 namespace markets {
 
 class PriceLevel {
 public:
-    PriceLevel() = default;
+    // forward iterator over the intrusive FIFO queue of a price level
+    template <typename OrderType, typename PoolType>
+    class OrderIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Order;
+        using difference_type = std::ptrdiff_t;
+        using pointer = OrderType*;
+        using reference = OrderType&;
+
+        OrderIterator() = default;
+
+        OrderIterator(PoolType* pool, OrderPool::index_t index)
+            : m_pool { pool }
+            , m_index { index }
+        {
+        }
+
+        // iterator -> const_iterator
+        operator OrderIterator<const Order, const OrderPool>() const
+        {
+            return { m_pool, m_index };
+        }
+
+        auto operator*() const -> reference
+        {
+            return (*m_pool)[m_index].order;
+        }
+
+        auto operator->() const -> pointer
+        {
+            return &(*m_pool)[m_index].order;
+        }
+
+        auto operator++() -> OrderIterator&
+        {
+            m_index = (*m_pool)[m_index].next;
+            return *this;
+        }
+
+        auto operator++(int) -> OrderIterator
+        {
+            OrderIterator prev = *this;
+            ++(*this);
+            return prev;
+        }
+
+        auto operator==(const OrderIterator& other) const -> bool
+        {
+            return m_index == other.m_index;
+        }
+
+        auto operator!=(const OrderIterator& other) const -> bool
+        {
+            return m_index != other.m_index;
+        }
+
+        auto getIndex() const -> OrderPool::index_t
+        {
+            return m_index;
+        }
+
+    private:
+        PoolType* m_pool = nullptr;
+        OrderPool::index_t m_index = OrderPool::NIL;
+    };
+
+    using iterator = OrderIterator<Order, OrderPool>;
+    using const_iterator = OrderIterator<const Order, const OrderPool>;
+
+    PriceLevel(OrderPool& pool, double price);
 
     // getters
     auto getPrice() const -> double;
@@ -19,28 +92,85 @@ public:
     void setPrice(double price);
     void setSize(int size);
 
-    auto empty() -> bool;
-    void push_back(const Order& order);
-    void push_front(const Order& order);
+    auto empty() const -> bool;
+    void push_back(Order order);
+    void push_front(Order order);
+    auto insert(iterator pos, Order order) -> iterator;
 
-    auto begin() -> std::list<Order>::iterator;
-    auto begin() const -> std::list<Order>::const_iterator;
+    auto begin() -> iterator;
+    auto begin() const -> const_iterator;
 
-    auto end() -> std::list<Order>::iterator;
-    auto end() const -> std::list<Order>::const_iterator;
+    auto end() -> iterator;
+    auto end() const -> const_iterator;
 
-    auto erase(std::list<Order>::iterator iter) -> std::list<Order>::iterator;
+    auto erase(iterator iter) -> iterator;
 
     template <class Compare>
     void sort(Compare comp)
     {
-        m_orders.sort(comp);
+        if (m_numOrders < 2 || isSorted(comp)) {
+            return;
+        }
+
+        // stable sort of the node indices, then relink the queue in the new order
+        static thread_local std::vector<OrderPool::index_t> s_indices;
+        s_indices.clear();
+        for (auto index = m_head; index != OrderPool::NIL; index = (*m_pool)[index].next) {
+            s_indices.push_back(index);
+        }
+
+        std::stable_sort(s_indices.begin(), s_indices.end(), [this, &comp](OrderPool::index_t a, OrderPool::index_t b) {
+            return comp((*m_pool)[a].order, (*m_pool)[b].order);
+        });
+
+        auto prev = OrderPool::NIL;
+        for (auto index : s_indices) {
+            (*m_pool)[index].prev = prev;
+            if (prev != OrderPool::NIL) {
+                (*m_pool)[prev].next = index;
+            }
+            prev = index;
+        }
+        (*m_pool)[prev].next = OrderPool::NIL;
+
+        m_head = s_indices.front();
+        m_tail = s_indices.back();
+    }
+
+    template <class Compare>
+    auto isSorted(Compare comp) const -> bool
+    {
+        return std::is_sorted(begin(), end(), comp);
+    }
+
+    // same result as push_back followed by sort, but a single pass when the level is already sorted:
+    // the new order goes after every order that it does not compare less than
+    template <class Compare>
+    void insertSorted(Order order, Compare comp)
+    {
+        auto pos = end();
+        auto prev = end();
+        for (auto iter = begin(); iter != end(); prev = iter++) {
+            if ((prev != end()) && comp(*iter, *prev)) {
+                push_back(std::move(order));
+                sort(comp);
+                return;
+            }
+            if ((pos == end()) && comp(order, *iter)) {
+                pos = iter;
+            }
+        }
+
+        insert(pos, std::move(order));
     }
 
 private:
+    OrderPool* m_pool;
     double m_price;
     int m_size;
-    std::list<Order> m_orders;
+    int m_numOrders;
+    OrderPool::index_t m_head;
+    OrderPool::index_t m_tail;
 };
 
-} // markets
\ No newline at end of file
+} // markets
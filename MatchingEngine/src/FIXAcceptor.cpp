@@ -6,7 +6,7 @@
 #include "markets/Market.h"
 
 #include <atomic>
-#include <cassert>
+#include <chrono>
 #include <map>
 
 #include <quickfix/FieldConvertors.h>
@@ -15,6 +15,7 @@
 #include <shift/miscutils/crossguid/Guid.h>
 #include <shift/miscutils/crypto/Decryptor.h>
 #include <shift/miscutils/fix/HelperFunctions.h>
+#include <shift/miscutils/fix/ThreadLocalFields.h>
 #include <shift/miscutils/terminal/Common.h>
 
 /* static */ std::string FIXAcceptor::s_senderID;
@@ -28,6 +29,8 @@ static const auto& FIXFIELD_PARTYROLE_CLIENTID = FIX::PartyRole(FIX::PartyRole_C
 static const auto& FIXFIELD_EXECTYPE_ORDER_STATUS = FIX::ExecType(FIX::ExecType_ORDER_STATUS);
 static const auto& FIXFIELD_ORDSTATUS_NEW = FIX::OrdStatus(FIX::OrdStatus_NEW);
 static const auto& FIXFIELD_ORDSTATUS_PENDING_CANCEL = FIX::OrdStatus(FIX::OrdStatus_PENDING_CANCEL);
+static const auto& FIXFIELD_EXECTYPE_REJECTED = FIX::ExecType(FIX::ExecType_REJECTED);
+static const auto& FIXFIELD_ORDSTATUS_REJECTED = FIX::OrdStatus(FIX::OrdStatus_REJECTED);
 static const auto& FIXFIELD_CUMQTY_0 = FIX::CumQty(0);
 
 FIXAcceptor::~FIXAcceptor() // override
@@ -133,6 +136,22 @@ void FIXAcceptor::disconnectBrokerageCenter()
     }
 }
 
+auto FIXAcceptor::getTargetList() const -> std::vector<std::string>
+{
+    std::lock_guard<std::mutex> lock(m_mtxTargetSet);
+    return { m_targetSet.begin(), m_targetSet.end() };
+}
+
+auto FIXAcceptor::isBatchingMode() const -> bool
+{
+    return m_isBatchingMode.load(std::memory_order_relaxed);
+}
+
+void FIXAcceptor::setBatchingMode(bool isBatchingMode)
+{
+    m_isBatchingMode.store(isBatchingMode, std::memory_order_relaxed);
+}
+
 /*
  * @brief Send complete order book to brokers.
  */
@@ -160,9 +179,7 @@ void FIXAcceptor::sendOrderBook(const std::vector<OrderBookEntry>& orderBook, co
     }
 
     if (targetID.empty()) {
-        std::lock_guard<std::mutex> lock(m_mtxTargetSet);
-
-        for (const auto& tID : m_targetSet) {
+        for (const auto& tID : getTargetList()) {
             header.setField(FIX::TargetCompID(tID));
             FIX::Session::sendToTarget(message);
         }
@@ -174,10 +191,16 @@ void FIXAcceptor::sendOrderBook(const std::vector<OrderBookEntry>& orderBook, co
 
 /*
  * @brief Send all order book updates to brokers.
+ *        In batching mode, consecutive updates share one MarketDataIncrementalRefresh message.
  */
 void FIXAcceptor::sendOrderBookUpdates(const std::vector<OrderBookEntry>& orderBookUpdates)
 {
-    for (const auto& update : orderBookUpdates) {
+    const std::size_t maxEntriesPerMessage = isBatchingMode() ? ::FIX_MAX_MD_ENTRIES_PER_MESSAGE : 1;
+
+    // do not hold the lock while sending: new targets would wait for the whole batch
+    const auto targetList = getTargetList();
+
+    for (auto it = orderBookUpdates.begin(); it != orderBookUpdates.end();) {
         FIX::Message message;
 
         FIX::Header& header = message.getHeader();
@@ -185,25 +208,24 @@ void FIXAcceptor::sendOrderBookUpdates(const std::vector<OrderBookEntry>& orderB
         header.setField(FIX::SenderCompID(s_senderID));
         header.setField(FIX::MsgType(FIX::MsgType_MarketDataIncrementalRefresh));
 
-        auto utc = update.getUTCTime();
-
-        shift::fix::addFIXGroup<FIX50SP2::MarketDataIncrementalRefresh::NoMDEntries>(message,
-            ::FIXFIELD_MDUPDATEACTION_CHANGE,
-            FIX::MDEntryType(update.getType()),
-            FIX::Symbol(update.getSymbol()),
-            FIX::MDEntryPx(update.getPrice()),
-            FIX::MDEntrySize(update.getSize()),
-            FIX::MDEntryDate(FIX::UtcDateOnly(utc.getDate(), utc.getMonth(), utc.getYear())),
-            FIX::MDEntryTime(FIX::UtcTimeOnly(utc.getTimeT(), utc.getFraction(6), 6)),
-            FIX::MDMkt(update.getDestination()));
-
-        {
-            std::lock_guard<std::mutex> lock(m_mtxTargetSet);
+        for (std::size_t numEntries = 0; (numEntries < maxEntriesPerMessage) && (it != orderBookUpdates.end()); ++numEntries, ++it) {
+            const auto& update = *it;
+            auto utc = update.getUTCTime();
+
+            shift::fix::addFIXGroup<FIX50SP2::MarketDataIncrementalRefresh::NoMDEntries>(message,
+                ::FIXFIELD_MDUPDATEACTION_CHANGE,
+                FIX::MDEntryType(update.getType()),
+                FIX::Symbol(update.getSymbol()),
+                FIX::MDEntryPx(update.getPrice()),
+                FIX::MDEntrySize(update.getSize()),
+                FIX::MDEntryDate(FIX::UtcDateOnly(utc.getDate(), utc.getMonth(), utc.getYear())),
+                FIX::MDEntryTime(FIX::UtcTimeOnly(utc.getTimeT(), utc.getFraction(6), 6)),
+                FIX::MDMkt(update.getDestination()));
+        }
 
-            for (const auto& tID : m_targetSet) {
-                header.setField(FIX::TargetCompID(tID));
-                FIX::Session::sendToTarget(message);
-            }
+        for (const auto& tID : targetList) {
+            header.setField(FIX::TargetCompID(tID));
+            FIX::Session::sendToTarget(message);
         }
     }
 }
@@ -213,6 +235,17 @@ void FIXAcceptor::sendOrderBookUpdates(const std::vector<OrderBookEntry>& orderB
  */
 void FIXAcceptor::sendExecutionReports(const std::vector<ExecutionReport>& executionReports)
 {
+    if (executionReports.empty()) {
+        return;
+    }
+
+    // all reports of one batch share the same effective and transaction times
+    const FIX::EffectiveTime effectiveTime(TimeSetting::getInstance().simulationTimestamp(), 6);
+    const FIX::TransactTime transactTime(6);
+
+    // do not hold the lock while sending: new targets would wait for the whole batch
+    const auto targetList = getTargetList();
+
     for (const auto& report : executionReports) {
         FIX::Message message;
 
@@ -223,18 +256,18 @@ void FIXAcceptor::sendExecutionReports(const std::vector<ExecutionReport>& execu
 
         message.setField(FIX::OrderID(report.orderID1));
         message.setField(FIX::SecondaryOrderID(report.orderID2));
-        message.setField(FIX::ExecID(shift::crossguid::newGuid().str()));
+        message.setField(FIX::ExecID(s_newExecID()));
         message.setField(::FIXFIELD_EXECTYPE_TRADE); // required by FIX
         message.setField(FIX::OrdStatus(report.decision));
         message.setField(FIX::Symbol(report.symbol));
         message.setField(FIX::Side(report.orderType1));
         message.setField(FIX::OrdType(report.orderType2));
         message.setField(FIX::Price(report.price));
-        message.setField(FIX::EffectiveTime(TimeSetting::getInstance().simulationTimestamp(), 6));
+        message.setField(effectiveTime);
         message.setField(FIX::LastMkt(report.destination));
         message.setField(::FIXFIELD_LEAVQTY_0); // required by FIX
         message.setField(FIX::CumQty(report.size));
-        message.setField(FIX::TransactTime(6));
+        message.setField(transactTime);
 
         shift::fix::addFIXGroup<FIX50SP2::ExecutionReport::NoPartyIDs>(message,
             ::FIXFIELD_PARTYROLE_CLIENTID,
@@ -250,17 +283,25 @@ void FIXAcceptor::sendExecutionReports(const std::vector<ExecutionReport>& execu
         shift::fix::addFIXGroup<FIX50SP2::ExecutionReport::NoTrdRegTimestamps>(message,
             FIX::TrdRegTimestamp(report.simulationTime2, 6));
 
-        {
-            std::lock_guard<std::mutex> lock(m_mtxTargetSet);
-
-            for (const auto& tID : m_targetSet) {
-                header.setField(FIX::TargetCompID(tID));
-                FIX::Session::sendToTarget(message);
-            }
+        for (const auto& tID : targetList) {
+            header.setField(FIX::TargetCompID(tID));
+            FIX::Session::sendToTarget(message);
         }
     }
 }
 
+/**
+ * @brief Generate a new execution ID.
+ *        Much cheaper than a GUID: a counter that is unique within a run, prefixed by the run's start time (in microseconds).
+ */
+/* static */ auto FIXAcceptor::s_newExecID() -> std::string
+{
+    static const auto s_prefix = std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count()) + '-';
+    static std::atomic<unsigned long long> s_nextExecID { 0 };
+
+    return s_prefix + std::to_string(s_nextExecID.fetch_add(1, std::memory_order_relaxed));
+}
+
 /*
  * @brief Send security list to broker.
  */
@@ -298,7 +339,7 @@ void FIXAcceptor::sendExecutionReports(const std::vector<ExecutionReport>& execu
     header.setField(FIX::MsgType(FIX::MsgType_ExecutionReport));
 
     message.setField(FIX::OrderID(confirmation.orderID));
-    message.setField(FIX::ExecID(shift::crossguid::newGuid().str()));
+    message.setField(FIX::ExecID(s_newExecID()));
     message.setField(::FIXFIELD_EXECTYPE_ORDER_STATUS); // required by FIX
     if (confirmation.orderType != Order::Type::CANCEL_BID && confirmation.orderType != Order::Type::CANCEL_ASK) { // not a cancellation
         message.setField(::FIXFIELD_ORDSTATUS_NEW);
@@ -321,6 +362,40 @@ void FIXAcceptor::sendExecutionReports(const std::vector<ExecutionReport>& execu
     FIX::Session::sendToTarget(message);
 }
 
+/**
+ * @brief Tell the client that its order was discarded instead of being sent to its market.
+ */
+/* static */ void FIXAcceptor::s_sendOrderRejection(const OrderConfirmation& confirmation, const std::string& targetID, const std::string& reason)
+{
+    FIX::Message message;
+
+    FIX::Header& header = message.getHeader();
+    header.setField(::FIXFIELD_BEGINSTRING_FIXT11);
+    header.setField(FIX::SenderCompID(s_senderID));
+    header.setField(FIX::TargetCompID(targetID));
+    header.setField(FIX::MsgType(FIX::MsgType_ExecutionReport));
+
+    message.setField(FIX::OrderID(confirmation.orderID));
+    message.setField(FIX::ExecID(s_newExecID()));
+    message.setField(::FIXFIELD_EXECTYPE_REJECTED);
+    message.setField(::FIXFIELD_ORDSTATUS_REJECTED);
+    message.setField(FIX::Symbol(confirmation.symbol));
+    message.setField(FIX::Side(confirmation.orderType));
+    message.setField(FIX::Price(confirmation.price));
+    message.setField(FIX::EffectiveTime(TimeSetting::getInstance().simulationTimestamp(), 6));
+    message.setField(FIX::LastMkt("SHIFT"));
+    message.setField(FIX::LeavesQty(confirmation.size));
+    message.setField(::FIXFIELD_CUMQTY_0); // required by FIX
+    message.setField(FIX::TransactTime(6));
+    message.setField(FIX::Text(reason));
+
+    shift::fix::addFIXGroup<FIX50SP2::ExecutionReport::NoPartyIDs>(message,
+        ::FIXFIELD_PARTYROLE_CLIENTID,
+        FIX::PartyID(confirmation.traderID));
+
+    FIX::Session::sendToTarget(message);
+}
+
 void FIXAcceptor::onCreate(const FIX::SessionID& sessionID) // override
 {
     s_senderID = sessionID.getSenderCompID().getValue();
@@ -375,69 +450,31 @@ void FIXAcceptor::onMessage(const FIX50SP2::NewOrderSingle& message, const FIX::
         return;
     }
 
-    static FIX::ClOrdID orderID;
-    static FIX::Symbol symbol;
-    static FIX::OrderQty size;
-    static FIX::OrdType orderType;
-    static FIX::Price price;
-
-    static FIX50SP2::NewOrderSingle::NoPartyIDs idGroup;
-    static FIX::PartyID traderID;
+    auto& [orderID, symbol, size, orderType, price, idGroup, traderID] = shift::fix::getThreadLocalFields<FIX50SP2::NewOrderSingle, FIX::ClOrdID, FIX::Symbol, FIX::OrderQty, FIX::OrdType, FIX::Price, FIX50SP2::NewOrderSingle::NoPartyIDs, FIX::PartyID>();
 
-    // #pragma GCC diagnostic ignored ....
+    message.getField(orderID);
+    message.getField(symbol);
+    message.getField(size);
+    message.getField(orderType);
+    message.getField(price);
 
-    FIX::ClOrdID* pOrderID = nullptr;
-    FIX::Symbol* pSymbol = nullptr;
-    FIX::OrderQty* pSize = nullptr;
-    FIX::OrdType* pOrderType = nullptr;
-    FIX::Price* pPrice = nullptr;
+    message.getGroup(1, idGroup);
+    idGroup.getField(traderID);
 
-    FIX50SP2::NewOrderSingle::NoPartyIDs* pIDGroup = nullptr;
-    FIX::PartyID* pTraderID = nullptr;
-
-    static std::atomic<unsigned int> s_cntAtom { 0 };
-    unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-    while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-    }
-
-    assert(s_cntAtom > 0);
-
-    if (0 == prevCnt) { // sequential case; optimized:
-        pOrderID = &orderID;
-        pSymbol = &symbol;
-        pSize = &size;
-        pOrderType = &orderType;
-        pPrice = &price;
-        pIDGroup = &idGroup;
-        pTraderID = &traderID;
-    } else { // > 1 threads; always safe way:
-        pOrderID = new decltype(orderID);
-        pSymbol = new decltype(symbol);
-        pSize = new decltype(size);
-        pOrderType = new decltype(orderType);
-        pPrice = new decltype(price);
-        pIDGroup = new decltype(idGroup);
-        pTraderID = new decltype(traderID);
+    if (orderID.getValue().size() > OrderID::MAX_LENGTH) { // order IDs are stored inline
+        cout << "Rejecting order, order ID too long: " << orderID.getValue() << endl;
+        s_sendOrderRejection({ symbol.getValue(), traderID.getValue(), orderID.getValue(), price.getValue(), static_cast<int>(size.getValue()), orderType.getValue() }, sessionID.getTargetCompID().getValue(), "Order ID longer than " + std::to_string(OrderID::MAX_LENGTH) + " characters");
+        return;
     }
 
-    message.getField(*pOrderID);
-    message.getField(*pSymbol);
-    message.getField(*pSize);
-    message.getField(*pOrderType);
-    message.getField(*pPrice);
-
-    message.getGroup(1, *pIDGroup);
-    pIDGroup->getField(*pTraderID);
-
-    auto milli = TimeSetting::getInstance().pastMilli();
+    auto nanos = TimeSetting::getInstance().pastNanos();
     auto now = TimeSetting::getInstance().simulationTimestamp();
 
-    Order order { pSymbol->getValue(), pTraderID->getValue(), pOrderID->getValue(), pPrice->getValue(), static_cast<int>(pSize->getValue()), static_cast<Order::Type>(pOrderType->getValue()), now };
-    order.setMilli(milli);
+    Order order { symbol.getValue(), traderID.getValue(), orderID.getValue(), price.getValue(), static_cast<int>(size.getValue()), static_cast<Order::Type>(orderType.getValue()), now };
+    order.setNanos(nanos);
 
     // add new quote to buffer
-    auto marketIt = markets::MarketList::getInstance().find(pSymbol->getValue());
+    auto marketIt = markets::MarketList::getInstance().find(symbol.getValue());
     if (marketIt != markets::MarketList::getInstance().end()) {
         marketIt->second->bufNewLocalOrder(std::move(order));
     } else {
@@ -445,19 +482,6 @@ void FIXAcceptor::onMessage(const FIX50SP2::NewOrderSingle& message, const FIX::
     }
 
     // send confirmation to client
-    cout << "Sending confirmation: " << pOrderID->getValue() << endl;
-    s_sendOrderConfirmation({ pSymbol->getValue(), pTraderID->getValue(), pOrderID->getValue(), pPrice->getValue(), static_cast<int>(pSize->getValue()), pOrderType->getValue() }, sessionID.getTargetCompID().getValue());
-
-    if (0 != prevCnt) { // > 1 threads
-        delete pOrderID;
-        delete pSymbol;
-        delete pSize;
-        delete pOrderType;
-        delete pPrice;
-        delete pIDGroup;
-        delete pTraderID;
-    }
-
-    s_cntAtom--;
-    assert(s_cntAtom >= 0);
+    cout << "Sending confirmation: " << orderID.getValue() << endl;
+    s_sendOrderConfirmation({ symbol.getValue(), traderID.getValue(), orderID.getValue(), price.getValue(), static_cast<int>(size.getValue()), orderType.getValue() }, sessionID.getTargetCompID().getValue());
 }
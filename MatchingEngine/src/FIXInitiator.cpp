@@ -4,8 +4,6 @@
 #include "TimeSetting.h"
 #include "markets/Market.h"
 
-#include <atomic>
-#include <cassert>
 #include <map>
 
 #include <quickfix/FieldConvertors.h>
@@ -14,6 +12,8 @@
 #include <shift/miscutils/crossguid/Guid.h>
 #include <shift/miscutils/crypto/Decryptor.h>
 #include <shift/miscutils/fix/HelperFunctions.h>
+#include <shift/miscutils/fix/ThreadLocalFields.h>
+#include <shift/miscutils/fix/TickBatch.h>
 #include <shift/miscutils/terminal/Common.h>
 
 /* static */ std::string FIXInitiator::s_senderID;
@@ -199,6 +199,23 @@ auto FIXInitiator::sendSecurityListRequestAwait(const std::string& requestID, co
     FIX::Session::sendToTarget(message);
 }
 
+auto FIXInitiator::getNumDataChunksReceived() const -> int
+{
+    std::lock_guard<std::mutex> guard(m_mtxDataChunks);
+    return m_numDataChunksReceived;
+}
+
+/**
+ * @brief Wait until at least numDataChunks data chunks were received, or the timeout expires.
+ * @return The number of data chunks received so far.
+ */
+auto FIXInitiator::waitForDataChunks(int numDataChunks, std::chrono::milliseconds timeout) -> int
+{
+    std::unique_lock<std::mutex> lock(m_mtxDataChunks);
+    m_cvDataChunkReceived.wait_for(lock, timeout, [this, numDataChunks] { return m_numDataChunksReceived >= numDataChunks; });
+    return m_numDataChunksReceived;
+}
+
 void FIXInitiator::onCreate(const FIX::SessionID& sessionID) // override
 {
     s_senderID = sessionID.getSenderCompID().getValue();
@@ -227,6 +244,13 @@ void FIXInitiator::fromApp(const FIX::Message& message, const FIX::SessionID& se
  */
 void FIXInitiator::onMessage(const FIX50SP2::News& message, const FIX::SessionID& sessionID) // override
 {
+    if (message.isSetField(FIX::FIELD::RawData)) { // batched raw data
+        FIX::RawData payload;
+        message.getField(payload);
+        s_receiveTickBatch(payload.getValue());
+        return;
+    }
+
     FIX::NoLinesOfText numOfGroups;
     message.getField(numOfGroups);
     if (numOfGroups.getValue() < 1) {
@@ -234,64 +258,77 @@ void FIXInitiator::onMessage(const FIX50SP2::News& message, const FIX::SessionID
         return;
     }
 
-    static FIX::Headline requestID;
-
-    static FIX50SP2::News::NoLinesOfText textGroup;
-    static FIX::Text text;
-
-    // #pragma GCC diagnostic ignored ....
+    auto& [requestID, textGroup, text] = shift::fix::getThreadLocalFields<FIX50SP2::News, FIX::Headline, FIX50SP2::News::NoLinesOfText, FIX::Text>();
 
-    FIX::Headline* pRequestID = nullptr;
+    message.getField(requestID);
 
-    FIX50SP2::News::NoLinesOfText* pTextGroup = nullptr;
-    FIX::Text* pText = nullptr;
+    message.getGroup(1, textGroup);
+    textGroup.getField(text);
 
-    static std::atomic<unsigned int> s_cntAtom { 0 };
-    unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-    while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-    }
-
-    assert(s_cntAtom > 0);
-
-    if (0 == prevCnt) { // sequential case; optimized:
-        pRequestID = &requestID;
-        pTextGroup = &textGroup;
-        pText = &text;
-    } else { // > 1 threads; always safe way:
-        pRequestID = new decltype(requestID);
-        pTextGroup = new decltype(textGroup);
-        pText = new decltype(text);
+    if (text.getValue() == "SENDFINISH") { // all raw data of the last requested chunk were received (it is sent after them)
+        {
+            std::lock_guard<std::mutex> guard(m_mtxDataChunks);
+            ++m_numDataChunksReceived;
+        }
+        m_cvDataChunkReceived.notify_all();
     }
 
-    message.getField(*pRequestID);
-
-    message.getGroup(1, *pTextGroup);
-    pTextGroup->getField(*pText);
-
     cout << endl;
     cout << "----- Receive NOTICE -----" << endl;
-    cout << "request id: " << pRequestID->getValue() << endl;
-    cout << "text: " << pText->getValue() << endl;
+    cout << "request id: " << requestID.getValue() << endl;
+    cout << "text: " << text.getValue() << endl;
 
-    bool isReadyNews = pText->getValue() == "READY";
-    bool isEmptyNews = !isReadyNews && (pText->getValue() == "EMPTY");
+    bool isReadyNews = text.getValue() == "READY";
+    bool isEmptyNews = !isReadyNews && (text.getValue() == "EMPTY");
     if (isReadyNews || isEmptyNews) {
         {
             std::lock_guard<std::mutex> guard(m_mtxMarketDataReady);
-            m_lastMarketDataRequestID = pRequestID->getValue() + (isEmptyNews ? "[EMPTY]" : "");
+            m_lastMarketDataRequestID = requestID.getValue() + (isEmptyNews ? "[EMPTY]" : "");
         }
         m_cvMarketDataReady.notify_all();
     }
+}
 
-    if (0 != prevCnt) { // > 1 threads
-        delete pRequestID;
-        delete pTextGroup;
-        delete pText;
+/**
+ * @brief Receive a batch of raw data from Datafeed Engine (encoded by shift::fix::TickBatchWriter).
+ */
+/* static */ void FIXInitiator::s_receiveTickBatch(std::string_view payload)
+{
+    shift::fix::TickBatchReader reader { payload };
+    if (!reader.isValid()) {
+        cout << "Cannot decode tick batch!" << endl;
+        return;
     }
 
-    s_cntAtom--;
-    assert(s_cntAtom >= 0);
+    const std::string symbol { reader.getSymbol() };
+    auto marketIt = markets::MarketList::getInstance().find(symbol);
+    if (marketIt == markets::MarketList::getInstance().end()) {
+        cout << "Receive error in Global!" << endl;
+        return;
+    }
+
+    shift::fix::TickBatchEntry entry;
+    while (reader.next(&entry)) {
+        const auto transactTime = TimeSetting::s_toUtcTimestamp(entry.utcMicrosecs * 1'000);
+        auto nanos = TimeSetting::getInstance().pastNanos(transactTime);
+
+        Order order { symbol, entry.bidPrice, entry.bidSize, Order::Type::TRTH_TRADE, entry.buyerID, transactTime };
+        order.setNanos(nanos);
+
+        if ('Q' == entry.toq) { // quote
+            order.setType(Order::Type::TRTH_BID); // update as "bid" from Global
+
+            Order order2 { symbol, entry.askPrice, entry.askSize, Order::Type::TRTH_ASK, entry.sellerID, transactTime };
+            order2.setNanos(nanos);
+
+            marketIt->second->bufNewGlobalOrder(std::move(order2));
+        }
+        marketIt->second->bufNewGlobalOrder(std::move(order));
+    }
+
+    if (!reader.isValid()) {
+        cout << "Tick batch of " << symbol << " is truncated!" << endl;
+    }
 }
 
 /**
@@ -310,107 +347,40 @@ void FIXInitiator::onMessage(const FIX50SP2::Quote& message, const FIX::SessionI
         return;
     }
 
-    static FIX::Symbol symbol;
-    static FIX::BidPx bidPrice;
-    static FIX::OfferPx askPrice;
-    static FIX::BidSize bidSize;
-    static FIX::OfferSize askSize;
-    static FIX::TransactTime transactTime;
+    auto& [symbol, bidPrice, askPrice, bidSize, askSize, transactTime, idGroup, buyerID, sellerID] = shift::fix::getThreadLocalFields<FIX50SP2::Quote, FIX::Symbol, FIX::BidPx, FIX::OfferPx, FIX::BidSize, FIX::OfferSize, FIX::TransactTime, FIX50SP2::Quote::NoPartyIDs, FIX::PartyID, FIX::PartyID>();
 
-    static FIX50SP2::Quote::NoPartyIDs idGroup;
-    static FIX::PartyID buyerID;
-    static FIX::PartyID sellerID;
+    message.getField(symbol);
+    message.getField(bidPrice);
+    message.getField(bidSize);
+    message.getField(transactTime);
 
-    // #pragma GCC diagnostic ignored ....
+    message.getGroup(1, idGroup);
+    idGroup.getField(buyerID);
 
-    FIX::Symbol* pSymbol = nullptr;
-    FIX::BidPx* pBidPrice = nullptr;
-    FIX::OfferPx* pAskPrice = nullptr;
-    FIX::BidSize* pBidSize = nullptr;
-    FIX::OfferSize* pAskSize = nullptr;
-    FIX::TransactTime* pTransactTime = nullptr;
-
-    FIX50SP2::Quote::NoPartyIDs* pIDGroup = nullptr;
-    FIX::PartyID* pBuyerID = nullptr;
-    FIX::PartyID* pSellerID = nullptr;
-
-    static std::atomic<unsigned int> s_cntAtom { 0 };
-    unsigned int prevCnt = s_cntAtom.load(std::memory_order_relaxed);
-
-    while (!s_cntAtom.compare_exchange_strong(prevCnt, prevCnt + 1)) {
-    }
-
-    assert(s_cntAtom > 0);
-
-    if (0 == prevCnt) { // sequential case; optimized:
-        pSymbol = &symbol;
-        pBidPrice = &bidPrice;
-        pAskPrice = &askPrice;
-        pBidSize = &bidSize;
-        pAskSize = &askSize;
-        pTransactTime = &transactTime;
-        pIDGroup = &idGroup;
-        pBuyerID = &buyerID;
-        pSellerID = &sellerID;
-    } else { // > 1 threads; always safe way:
-        pSymbol = new decltype(symbol);
-        pBidPrice = new decltype(bidPrice);
-        pAskPrice = new decltype(askPrice);
-        pBidSize = new decltype(bidSize);
-        pAskSize = new decltype(askSize);
-        pTransactTime = new decltype(transactTime);
-        pIDGroup = new decltype(idGroup);
-        pBuyerID = new decltype(buyerID);
-        pSellerID = new decltype(sellerID);
-    }
-
-    message.getField(*pSymbol);
-    message.getField(*pBidPrice);
-    message.getField(*pBidSize);
-    message.getField(*pTransactTime);
-
-    message.getGroup(1, *pIDGroup);
-    pIDGroup->getField(*pBuyerID);
-
-    auto marketIt = markets::MarketList::getInstance().find(pSymbol->getValue());
+    auto marketIt = markets::MarketList::getInstance().find(symbol.getValue());
     if (marketIt == markets::MarketList::getInstance().end()) {
         cout << "Receive error in Global!" << endl;
         return;
     }
 
-    auto milli = TimeSetting::getInstance().pastMilli(pTransactTime->getValue());
+    auto nanos = TimeSetting::getInstance().pastNanos(transactTime.getValue());
 
-    Order order { pSymbol->getValue(), pBidPrice->getValue(), static_cast<int>(pBidSize->getValue()), Order::Type::TRTH_TRADE, pBuyerID->getValue(), pTransactTime->getValue() };
-    order.setMilli(milli);
+    Order order { symbol.getValue(), bidPrice.getValue(), static_cast<int>(bidSize.getValue()), Order::Type::TRTH_TRADE, buyerID.getValue(), transactTime.getValue() };
+    order.setNanos(nanos);
 
     if (ordType == 0) { // quote
         order.setType(Order::Type::TRTH_BID); // update as "bid" from Global
 
-        message.getField(*pAskPrice);
-        message.getField(*pAskSize);
+        message.getField(askPrice);
+        message.getField(askSize);
 
-        message.getGroup(2, *pIDGroup);
-        pIDGroup->getField(*pSellerID);
+        message.getGroup(2, idGroup);
+        idGroup.getField(sellerID);
 
-        Order order2 { pSymbol->getValue(), pAskPrice->getValue(), static_cast<int>(pAskSize->getValue()), Order::Type::TRTH_ASK, pSellerID->getValue(), pTransactTime->getValue() };
-        order2.setMilli(milli);
+        Order order2 { symbol.getValue(), askPrice.getValue(), static_cast<int>(askSize.getValue()), Order::Type::TRTH_ASK, sellerID.getValue(), transactTime.getValue() };
+        order2.setNanos(nanos);
 
         marketIt->second->bufNewGlobalOrder(std::move(order2));
     }
     marketIt->second->bufNewGlobalOrder(std::move(order));
-
-    if (0 != prevCnt) { // > 1 threads
-        delete pSymbol;
-        delete pBidPrice;
-        delete pAskPrice;
-        delete pBidSize;
-        delete pAskSize;
-        delete pTransactTime;
-        delete pIDGroup;
-        delete pBuyerID;
-        delete pSellerID;
-    }
-
-    s_cntAtom--;
-    assert(s_cntAtom >= 0);
 }
@@ -0,0 +1,71 @@
+#include "InternTable.h"
+
+#include <stdexcept>
+
+/* static */ auto InternTable::getInstance() -> InternTable&
+{
+    static InternTable s_internTableInst;
+    return s_internTableInst;
+}
+
+InternTable::InternTable()
+    : m_size { 0 }
+{
+    for (auto& chunk : m_chunks) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+
+    intern(""); // EMPTY_ID
+}
+
+/**
+ * @brief Get the ID of a string, adding it to the table if needed.
+ */
+auto InternTable::intern(std::string_view str) -> InternTable::id_t
+{
+    // the interned strings (symbols, trader IDs, destinations) are few and each thread meets the same ones again and again:
+    // a thread remembers the IDs it got, so that only strings new to it go through the shared table and its lock
+    thread_local std::unordered_map<std::string_view, id_t> s_knownIDs; // keys refer to the stored strings
+
+    if (auto it = s_knownIDs.find(str); it != s_knownIDs.end()) {
+        return it->second;
+    }
+
+    auto id = findOrInsert(str);
+    s_knownIDs.emplace(lookup(id), id);
+
+    return id;
+}
+
+auto InternTable::findOrInsert(std::string_view str) -> InternTable::id_t
+{
+    std::lock_guard<std::mutex> guard(m_mtxTable);
+
+    if (auto it = m_ids.find(str); it != m_ids.end()) {
+        return it->second;
+    }
+
+    auto chunkIndex = m_size / CHUNK_SIZE;
+    if (chunkIndex >= MAX_NUM_CHUNKS) {
+        throw std::length_error("InternTable is full");
+    }
+
+    if (!m_storage[chunkIndex]) {
+        m_storage[chunkIndex] = std::make_unique<std::string[]>(CHUNK_SIZE);
+        m_chunks[chunkIndex].store(m_storage[chunkIndex].get(), std::memory_order_release);
+    }
+
+    auto& stored = m_storage[chunkIndex][m_size % CHUNK_SIZE];
+    stored = str;
+
+    auto id = static_cast<id_t>(m_size++);
+    m_ids.emplace(stored, id);
+
+    return id;
+}
+
+auto InternTable::size() const -> std::size_t
+{
+    std::lock_guard<std::mutex> guard(m_mtxTable);
+    return m_size;
+}
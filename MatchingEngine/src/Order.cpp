@@ -1,34 +1,57 @@
 #include "Order.h"
 
-Order::Order(std::string symbol, double price, int size, Order::Type type, std::string destination, FIX::UtcTimeStamp simulationTime)
-    : m_symbol { std::move(symbol) }
-    , m_traderID { "TRTH" }
-    , m_orderID { "TRTH" }
-    , m_milli { 0 }
+#include "TimeSetting.h"
+
+#include <algorithm>
+#include <cstring>
+
+static auto s_trthID() -> InternTable::id_t
+{
+    static const auto id = InternTable::getInstance().intern("TRTH");
+    return id;
+}
+
+static auto s_shiftID() -> InternTable::id_t
+{
+    static const auto id = InternTable::getInstance().intern("SHIFT");
+    return id;
+}
+
+OrderID::OrderID(std::string_view orderID)
+    : m_length { static_cast<std::uint8_t>(std::min(orderID.size(), MAX_LENGTH)) }
+{
+    std::memcpy(m_data.data(), orderID.data(), m_length);
+}
+
+Order::Order(std::string_view symbol, double price, int size, Order::Type type, std::string_view destination, const FIX::UtcTimeStamp& simulationTime)
+    : m_orderID { "TRTH" }
     , m_price { price }
+    , m_simulationTimeNS { TimeSetting::s_toNanos(simulationTime) }
+    , m_nanos { 0 }
     , m_size { size }
-    , m_type { type }
-    , m_destination { std::move(destination) }
-    , m_simulationTime { std::move(simulationTime) }
     , m_auctionCounter { 0 }
+    , m_symbol { InternTable::getInstance().intern(symbol) }
+    , m_traderID { s_trthID() }
+    , m_destination { InternTable::getInstance().intern(destination) }
+    , m_type { type }
 {
 }
 
-Order::Order(std::string symbol, std::string traderID, std::string orderID, double price, int size, Order::Type type, FIX::UtcTimeStamp simulationTime)
-    : m_symbol { std::move(symbol) }
-    , m_traderID { std::move(traderID) }
-    , m_orderID { std::move(orderID) }
-    , m_milli { 0 }
-    , m_price(price)
-    , m_size(size)
-    , m_type(type)
-    , m_destination("SHIFT")
-    , m_simulationTime { std::move(simulationTime) }
+Order::Order(std::string_view symbol, std::string_view traderID, std::string_view orderID, double price, int size, Order::Type type, const FIX::UtcTimeStamp& simulationTime)
+    : m_orderID { orderID }
+    , m_price { price }
+    , m_simulationTimeNS { TimeSetting::s_toNanos(simulationTime) }
+    , m_nanos { 0 }
+    , m_size { size }
     , m_auctionCounter { 0 }
+    , m_symbol { InternTable::getInstance().intern(symbol) }
+    , m_traderID { InternTable::getInstance().intern(traderID) }
+    , m_destination { s_shiftID() }
+    , m_type { type }
 {
 }
 
-auto Order::operator==(const Order& other) -> bool
+auto Order::operator==(const Order& other) const -> bool
 {
     return m_symbol == other.m_symbol
         && m_traderID == other.m_traderID
@@ -41,22 +64,22 @@ auto Order::operator==(const Order& other) -> bool
 
 auto Order::getSymbol() const -> const std::string&
 {
-    return m_symbol;
+    return InternTable::getInstance().lookup(m_symbol);
 }
 
 auto Order::getTraderID() const -> const std::string&
 {
-    return m_traderID;
+    return InternTable::getInstance().lookup(m_traderID);
 }
 
-auto Order::getOrderID() const -> const std::string&
+auto Order::getOrderID() const -> std::string_view
 {
-    return m_orderID;
+    return m_orderID.view();
 }
 
-auto Order::getMilli() const -> long
+auto Order::getNanos() const -> std::int64_t
 {
-    return m_milli;
+    return m_nanos;
 }
 
 auto Order::getPrice() const -> double
@@ -110,12 +133,17 @@ auto Order::getTypeString() const -> std::string
 
 auto Order::getDestination() const -> const std::string&
 {
-    return m_destination;
+    return InternTable::getInstance().lookup(m_destination);
+}
+
+auto Order::getTime() const -> FIX::UtcTimeStamp
+{
+    return TimeSetting::s_toUtcTimestamp(m_simulationTimeNS);
 }
 
-auto Order::getTime() const -> const FIX::UtcTimeStamp&
+auto Order::getTimeNS() const -> std::int64_t
 {
-    return m_simulationTime;
+    return m_simulationTimeNS;
 }
 
 auto Order::getAuctionCounter() const -> int
@@ -123,14 +151,14 @@ auto Order::getAuctionCounter() const -> int
     return m_auctionCounter;
 }
 
-void Order::setSymbol(const std::string& symbol)
+void Order::setSymbol(std::string_view symbol)
 {
-    m_symbol = symbol;
+    m_symbol = InternTable::getInstance().intern(symbol);
 }
 
-void Order::setMilli(long milli)
+void Order::setNanos(std::int64_t nanos)
 {
-    m_milli = milli;
+    m_nanos = nanos;
 }
 
 void Order::setPrice(double price)
@@ -148,9 +176,9 @@ void Order::setType(Order::Type type)
     m_type = type;
 }
 
-void Order::setDestination(const std::string& destination)
+void Order::setDestination(std::string_view destination)
 {
-    m_destination = destination;
+    m_destination = InternTable::getInstance().intern(destination);
 }
 
 void Order::incrementAuctionCounter()
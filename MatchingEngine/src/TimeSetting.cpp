@@ -2,6 +2,9 @@
 
 #include <shift/miscutils/terminal/Common.h>
 
+static constexpr std::int64_t NANOSECONDS_PER_SECOND = 1'000'000'000;
+static constexpr std::int64_t NANOSECONDS_PER_MILLISECOND = 1'000'000;
+
 /* static */ auto TimeSetting::getInstance() -> TimeSetting&
 {
     static TimeSetting s_timeSettingInst;
@@ -28,12 +31,41 @@
     return boost::posix_time::ptime_from_tm(*tmUtc);
 }
 
+/**
+ * @brief Convert FIX::UtcTimeStamp to nanoseconds since epoch.
+ */
+/* static */ auto TimeSetting::s_toNanos(const FIX::UtcTimeStamp& utc) -> std::int64_t
+{
+    return static_cast<std::int64_t>(utc.getTimeT()) * NANOSECONDS_PER_SECOND + utc.getFraction(9);
+}
+
+/**
+ * @brief Convert nanoseconds since epoch to FIX::UtcTimeStamp.
+ */
+/* static */ auto TimeSetting::s_toUtcTimestamp(std::int64_t nanos) -> FIX::UtcTimeStamp
+{
+    // building a timestamp from scratch requires a calendar conversion:
+    // only do it once per second and per thread
+    thread_local std::int64_t s_cachedSecond = -1;
+    thread_local FIX::UtcTimeStamp s_cachedTimestamp(static_cast<std::time_t>(0), 0, 9);
+
+    auto second = nanos / NANOSECONDS_PER_SECOND;
+    if (second != s_cachedSecond) {
+        s_cachedTimestamp = FIX::UtcTimeStamp(static_cast<std::time_t>(second), 0, 9);
+        s_cachedSecond = second;
+    }
+
+    s_cachedTimestamp.setNanosecond(static_cast<int>(nanos % NANOSECONDS_PER_SECOND));
+    return s_cachedTimestamp;
+}
+
 /**
  * @brief Initiate member variables.
  */
 void TimeSetting::initiate(const boost::posix_time::ptime& localPtime, int speed)
 {
     m_utcDateTime = getUTCPTime(localPtime);
+    m_utcDateTimeNanos = static_cast<std::int64_t>(boost::posix_time::to_time_t(m_utcDateTime)) * NANOSECONDS_PER_SECOND;
     m_hhmmss = m_utcDateTime.time_of_day().total_seconds();
     m_speed = speed;
 
@@ -47,39 +79,75 @@ void TimeSetting::initiate(const boost::posix_time::ptime& localPtime, int speed
  */
 void TimeSetting::setStartTime()
 {
-    m_startTimePoint = std::chrono::high_resolution_clock::now();
+    m_startTimePoint = std::chrono::steady_clock::now();
+}
+
+/**
+ * @brief Get simulation speed (simulation time per unit of real time).
+ */
+auto TimeSetting::getSpeed() const -> int
+{
+    return m_speed;
+}
+
+/**
+ * @brief Switch between the real clock and a virtual clock driven through setVirtualNanos().
+ */
+void TimeSetting::setVirtualClock(bool isVirtualClock)
+{
+    m_isVirtualClock.store(isVirtualClock, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Set the time elapsed since the start, in virtual clock mode.
+ */
+void TimeSetting::setVirtualNanos(std::int64_t nanos)
+{
+    m_virtualNanos.store(nanos, std::memory_order_relaxed);
 }
 
 /**
  * @brief Get total millisecond from now.
  */
-auto TimeSetting::pastMilli(bool simTime) const -> long // FIXME: can be replaced with microsecond version
+auto TimeSetting::pastMilli(bool simTime) const -> long
 {
-    std::chrono::high_resolution_clock::time_point localNow = std::chrono::high_resolution_clock::now();
-    long milli = std::chrono::duration_cast<std::chrono::milliseconds>(localNow - m_startTimePoint).count();
+    return pastNanos(simTime) / NANOSECONDS_PER_MILLISECOND;
+}
 
-    return simTime ? (m_speed * milli) : milli;
+/**
+ * @brief Get total nanoseconds from now.
+ */
+auto TimeSetting::pastNanos(bool simTime) const -> std::int64_t
+{
+    std::int64_t nanos = m_isVirtualClock.load(std::memory_order_relaxed)
+        ? m_virtualNanos.load(std::memory_order_relaxed)
+        : std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTimePoint).count();
+
+    return simTime ? (m_speed * nanos) : nanos;
 }
 
 /**
- * @ brief Get total millisecond from FIX::UtcTimeStamp.
+ * @brief Get total nanoseconds from FIX::UtcTimeStamp.
  */
-auto TimeSetting::pastMilli(const FIX::UtcTimeStamp& utc, bool simTime) const -> long // FIXME: can be replaced with microsecond version
+auto TimeSetting::pastNanos(const FIX::UtcTimeStamp& utc, bool simTime) const -> std::int64_t
 {
-    long milli = (utc.getHour() * 3600 + utc.getMinute() * 60 + utc.getSecond() - m_hhmmss) * 1000 + utc.getMillisecond();
+    std::int64_t nanos = (utc.getHour() * 3600 + utc.getMinute() * 60 + utc.getSecond() - m_hhmmss) * NANOSECONDS_PER_SECOND + utc.getFraction(9);
 
-    return simTime ? (m_speed * milli) : milli;
+    return simTime ? (m_speed * nanos) : nanos;
 }
 
 /**
- * @brief Get FIX::UtcTimeStamp from now.
+ * @brief Get simulation time from now, in nanoseconds since epoch.
  */
-auto TimeSetting::simulationTimestamp() -> FIX::UtcTimeStamp
+auto TimeSetting::nowNanos() const -> std::int64_t
 {
-    std::chrono::high_resolution_clock::time_point timeNow = std::chrono::high_resolution_clock::now();
-    boost::posix_time::microseconds micro(std::chrono::duration_cast<std::chrono::microseconds>(timeNow - m_startTimePoint).count() * m_speed);
-    auto tmUtcSec = boost::posix_time::to_tm(m_utcDateTime + micro);
-    auto timestampUtc = FIX::UtcTimeStamp(&tmUtcSec, (int)micro.fractional_seconds(), 6);
+    return m_utcDateTimeNanos + pastNanos(true);
+}
 
-    return timestampUtc;
+/**
+ * @brief Get FIX::UtcTimeStamp from now.
+ */
+auto TimeSetting::simulationTimestamp() const -> FIX::UtcTimeStamp
+{
+    return s_toUtcTimestamp(nowNanos());
 }
@@ -1,11 +1,12 @@
 #include "ConfigFunctions.h"
 
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 
 #include <shift/miscutils/terminal/Common.h>
 
-auto fileConfigMode(std::string filePath, std::string& date, std::string& startTime, std::string& endTime, int& experimentSpeed, std::vector<std::string>& symbols) -> bool
+auto fileConfigMode(std::string filePath, std::string& date, std::string& startTime, std::string& endTime, int& experimentSpeed, std::vector<std::string>& symbols, std::map<std::string, int>& workerAssignments, int numWorkers) -> bool
 {
     std::string line;
     std::string key;
@@ -32,6 +33,11 @@ auto fileConfigMode(std::string filePath, std::string& date, std::string& startT
                         endTime = value;
                     } else if (key == "speed") {
                         experimentSpeed = stoi(value);
+                    } else if (key == "worker") { // e.g. "worker=SPY:0"
+                        auto pos = value.find(':');
+                        if (pos != std::string::npos) {
+                            workerAssignments[value.substr(0, pos)] = stoi(value.substr(pos + 1));
+                        }
                     }
                     cout << value << endl;
                 }
@@ -42,6 +48,17 @@ auto fileConfigMode(std::string filePath, std::string& date, std::string& startT
         return false;
     }
 
+    // there are never more worker threads than markets
+    numWorkers = std::min(numWorkers, static_cast<int>(symbols.size()));
+    if (numWorkers > 0) {
+        for (const auto& [symbol, worker] : workerAssignments) {
+            if (worker >= numWorkers) {
+                cout << "Invalid worker assignment " << symbol << ':' << worker << ": there are only " << numWorkers << " worker threads (0 to " << numWorkers - 1 << ")." << endl;
+                return false;
+            }
+        }
+    }
+
     return true;
 }
 
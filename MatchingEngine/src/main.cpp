@@ -5,7 +5,10 @@
 #include "TimeSetting.h"
 #include "markets/Market.h"
 #include "markets/MarketFactory.h"
+#include "markets/MarketPublisher.h"
+#include "markets/MarketWorker.h"
 
+#include <algorithm>
 #include <atomic>
 #if __has_include(<filesystem>)
 #include <filesystem>
@@ -13,6 +16,8 @@
 #include <experimental/filesystem>
 #endif
 #include <future>
+#include <iomanip>
+#include <map>
 
 #include <pwd.h>
 
@@ -46,6 +51,14 @@ using namespace std::chrono_literals;
     "verbose"
 #define CSTR_MANUAL \
     "manual"
+#define CSTR_WAIT \
+    "wait"
+#define CSTR_WORKERS \
+    "workers"
+#define CSTR_BATCH \
+    "batch"
+#define CSTR_PUBLISHERS \
+    "publishers"
 
 /* Abbreviation of NAMESPACE */
 namespace po = boost::program_options;
@@ -54,6 +67,32 @@ using voh_t = shift::terminal::VerboseOptHelper;
 
 static std::atomic<bool> s_isRequestingData { true };
 
+/*
+ * @brief Function to print the load of each market worker thread.
+ */
+static void s_printMarketWorkerStatistics(const std::vector<std::unique_ptr<markets::MarketWorker>>& marketWorkerList)
+{
+    for (const auto& worker : marketWorkerList) {
+        cout << "Market worker " << worker->getID() << ": "
+             << worker->getNumMarkets() << " markets, "
+             << worker->getNumProcessedOrders() << " events processed, "
+             << std::fixed << std::setprecision(2) << (100.0 * worker->getUtilization()) << "% utilization" << endl;
+    }
+}
+
+/*
+ * @brief Function to print the backlog of each market publisher thread.
+ */
+static void s_printMarketPublisherStatistics(const std::vector<std::unique_ptr<markets::MarketPublisher>>& marketPublisherList)
+{
+    for (const auto& publisher : marketPublisherList) {
+        cout << "Market publisher " << publisher->getID() << ": "
+             << publisher->getNumMarkets() << " markets, "
+             << publisher->getNumPublishedMessages() << " messages published, "
+             << publisher->getQueueDepth() << " messages queued" << endl;
+    }
+}
+
 /*
  * @brief Function to request data chunks in the background.
  */
@@ -66,30 +105,52 @@ static void s_requestDatafeedEngineData(std::string configFile, bool verbose, st
 
     // send request to Datafeed Engine for TRTH data and *wait* until data is ready
     if (FIXInitiator::getInstance().sendSecurityListRequestAwait(requestID, startTime, endTime, symbols, numSecondsPerDataChunk)) {
-        auto requestOnce = [](auto* pStartTime) {
-            FIXInitiator::s_sendNextDataRequest();
-            *pStartTime += boost::posix_time::seconds(::DURATION_PER_DATA_CHUNK.count());
-        };
-
-        // since real time (i.e. absolute time) may have been elapsed considerably because of the system waiting for download to finish,
-        // we shall compensate data consumer for that elapsed real time with tantamount simulation time of data:
-        auto elapsedSimlTime = std::chrono::milliseconds(TimeSetting::getInstance().pastMilli(true)); // take simulation speed (experimentSpeed) into account
-        auto adjustedDPDC = std::chrono::duration_cast<decltype(elapsedSimlTime)>(::DURATION_PER_DATA_CHUNK); // unify the time units
-        if (elapsedSimlTime.count() > (adjustedDPDC.count() / 2)) { // it's called "considerably" lagged iff. lag at least half of the duration per chunk
-            auto numChunksToCoverElapsedTime = static_cast<long>(elapsedSimlTime.count() / adjustedDPDC.count()) + 1;
-            while (numChunksToCoverElapsedTime-- > 0) {
-                requestOnce(&startTime);
+        auto& initiator = FIXInitiator::getInstance();
+        const auto chunkDuration = std::chrono::duration_cast<std::chrono::milliseconds>(::DURATION_PER_DATA_CHUNK);
+        const auto prefetchHorizon = std::chrono::duration_cast<std::chrono::milliseconds>(::DATA_PREFETCH_HORIZON);
+        int numChunksRequested = 0;
+        int numChunksReceived = 0;
+
+        // credit-based prefetching: instead of requesting chunks on a fixed schedule, keep requesting them while
+        // less than the prefetch horizon of data is requested ahead of the simulation, with a bounded number of chunks in flight.
+        // The same rule catches up with the real time elapsed (e.g. waiting for downloads to finish) and with slow data reads.
+        while (s_isRequestingData) {
+            auto simulationTime = std::chrono::milliseconds(TimeSetting::getInstance().pastMilli(true)); // take simulation speed (experimentSpeed) into account
+
+            while (startTime < endTime
+                && numChunksRequested - numChunksReceived < ::DATA_CHUNKS_MAX_IN_FLIGHT
+                && numChunksRequested * chunkDuration < simulationTime + prefetchHorizon) {
+                FIXInitiator::s_sendNextDataRequest();
+                startTime += boost::posix_time::seconds(::DURATION_PER_DATA_CHUNK.count());
+                ++numChunksRequested;
             }
-        }
 
-        // to guarentee a smooth data streaming: supplier shall always keep some safe amount of data ahead of consumer in buffer
-        requestOnce(&startTime);
+            if (startTime >= endTime && numChunksReceived == numChunksRequested) {
+                break; // everything was received
+            }
 
-        // begin periodic streaming:
-        do {
-            requestOnce(&startTime);
-            std::this_thread::sleep_for(::DURATION_PER_DATA_CHUNK / experimentSpeed);
-        } while (s_isRequestingData && startTime < endTime);
+            // wait for the next chunk, or until the simulation reaches the point where the next one shall be requested
+            auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(::DATA_REQUEST_MAX_WAIT_DURATION);
+            if (startTime < endTime && numChunksRequested - numChunksReceived < ::DATA_CHUNKS_MAX_IN_FLIGHT) {
+                auto untilNextRequest = (numChunksRequested * chunkDuration - prefetchHorizon - simulationTime) / experimentSpeed;
+                timeout = std::max(std::min(timeout, untilNextRequest), std::chrono::milliseconds(1));
+            }
+
+            int received = initiator.waitForDataChunks(numChunksReceived + 1, timeout);
+            while (numChunksReceived < received) {
+                ++numChunksReceived;
+                simulationTime = std::chrono::milliseconds(TimeSetting::getInstance().pastMilli(true));
+
+                // lag: how far the simulation already is into the chunk just received, i.e. how late its first data are
+                auto lag = simulationTime - (numChunksReceived - 1) * chunkDuration;
+                auto buffered = numChunksReceived * chunkDuration - simulationTime;
+                if (lag.count() > 0) {
+                    cout << COLOR_WARNING "Data chunk " << numChunksReceived << " arrived " << lag.count() / 1000.0 << " s (simulation time) behind the simulation." NO_COLOR << endl;
+                } else if (verbose) {
+                    cout << "Data chunk " << numChunksReceived << " received, data buffered " << buffered.count() / 1000.0 << " s (simulation time) ahead of the simulation." << endl;
+                }
+            }
+        }
     }
 
     FIXInitiator::getInstance().disconnectDatafeedEngine();
@@ -118,6 +179,16 @@ auto main(int argc, char** argv) -> int
         } timer;
         bool isVerbose;
         bool isManualInput;
+        shift::concurrency::WaitStrategy::Type waitStrategy;
+        struct { // market worker threads settings
+            bool isSet;
+            int num;
+        } workers;
+        bool isBatchingMode;
+        struct { // market publisher threads settings
+            bool isSet;
+            int num;
+        } publishers;
     } params = {
         "/usr/local/share/shift/MatchingEngine/", // default installation folder for configuration
         "SHIFT123", // built-in initial crypto key used for encrypting dbLogin.txt
@@ -131,6 +202,16 @@ auto main(int argc, char** argv) -> int
         },
         false,
         false,
+        shift::concurrency::WaitStrategy::Type::HYBRID,
+        {
+            false,
+            0,
+        },
+        false,
+        {
+            false,
+            0,
+        },
     };
 
     po::options_description desc("\nUSAGE: ./MatchingEngine [options] <args>\n\n\tThis is the MatchingEngine.\n\tThe server connects with DatafeedEngine and BrokerageCenter instances and runs in background.\n\nOPTIONS");
@@ -145,6 +226,10 @@ auto main(int argc, char** argv) -> int
         (CSTR_TIMEOUT ",t", po::value<decltype(params.timer)::min_t>(), "timeout duration counted in minutes. If not provided, user should terminate server with the terminal.") //
         (CSTR_VERBOSE ",v", "verbose mode that dumps detailed server information") //
         (CSTR_MANUAL ",m", "set manual input of all parameters") //
+        (CSTR_WAIT ",w", po::value<std::string>(), "how idle markets wait for new orders: blocking, spinning, or hybrid (default: hybrid)") //
+        (CSTR_WORKERS ",n", po::value<int>(), "serve all markets with the given number of worker threads (0: one per CPU core). If not provided, each market runs in its own thread.") //
+        (CSTR_BATCH ",a", "batch outgoing FIX messages: pack order book updates into multi-entry messages, and let busy markets coalesce their messages for up to 1 ms") //
+        (CSTR_PUBLISHERS ",p", po::value<int>(), "send outgoing FIX messages from the given number of publisher threads (0: one per CPU core). If not provided, markets send their own messages.") //
         ; // add_options
 
     po::variables_map vm;
@@ -217,15 +302,50 @@ auto main(int argc, char** argv) -> int
         params.isManualInput = true;
     }
 
+    if (vm.count(CSTR_WAIT) > 0) {
+        auto waitStrategy = vm[CSTR_WAIT].as<std::string>();
+        if (waitStrategy == "blocking") {
+            params.waitStrategy = shift::concurrency::WaitStrategy::Type::BLOCKING;
+        } else if (waitStrategy == "spinning") {
+            params.waitStrategy = shift::concurrency::WaitStrategy::Type::SPINNING;
+        } else if (waitStrategy == "hybrid") {
+            params.waitStrategy = shift::concurrency::WaitStrategy::Type::HYBRID;
+        } else {
+            cerr << COLOR_ERROR "ERROR: Unknown wait strategy: " << waitStrategy << NO_COLOR << endl;
+            return 1;
+        }
+    }
+
+    if (vm.count(CSTR_WORKERS) > 0) {
+        params.workers.isSet = true;
+        params.workers.num = vm[CSTR_WORKERS].as<int>();
+        if (params.workers.num <= 0) {
+            params.workers.num = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    if (vm.count(CSTR_BATCH) > 0) {
+        params.isBatchingMode = true;
+    }
+
+    if (vm.count(CSTR_PUBLISHERS) > 0) {
+        params.publishers.isSet = true;
+        params.publishers.num = vm[CSTR_PUBLISHERS].as<int>();
+        if (params.publishers.num <= 0) {
+            params.publishers.num = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
     std::string configFile = params.configDir + "config.txt";
     std::string dateString = "2018-12-17";
     std::string startTimeString = "09:30:00";
     std::string endTimeString = "16:00:00";
     int experimentSpeed = 1;
     std::vector<std::string> symbols;
+    std::map<std::string, int> workerAssignments;
 
     if (!params.isManualInput) {
-        if (!fileConfigMode(configFile, dateString, startTimeString, endTimeString, experimentSpeed, symbols)) {
+        if (!fileConfigMode(configFile, dateString, startTimeString, endTimeString, experimentSpeed, symbols, workerAssignments, params.workers.isSet ? params.workers.num : 0)) {
             return 3;
         }
     } else {
@@ -264,19 +384,64 @@ auto main(int argc, char** argv) -> int
         return 4;
     }
 
-    // begin Market threads
+    for (auto& kv : markets::MarketList::getInstance()) {
+        kv.second->setWaitStrategy(params.waitStrategy);
+    }
+
     int numOfMarkets = markets::MarketList::getInstance().size();
-    std::vector<std::thread> marketThreadList(numOfMarkets);
-    {
-        int i = 0;
+    std::vector<std::unique_ptr<markets::MarketWorker>> marketWorkerList;
+    std::vector<std::thread> marketThreadList;
+    std::vector<std::unique_ptr<markets::MarketPublisher>> marketPublisherList;
+    std::vector<std::thread> publisherThreadList;
+
+    if (params.publishers.isSet) { // begin Market publisher threads
+        int numOfPublishers = std::min(params.publishers.num, numOfMarkets);
+        for (int i = 0; i < numOfPublishers; ++i) {
+            marketPublisherList.push_back(std::make_unique<markets::MarketPublisher>(i, params.waitStrategy));
+        }
 
+        int nextPublisher = 0;
         for (auto& kv : markets::MarketList::getInstance()) {
-            marketThreadList[i] = std::thread(std::ref(*kv.second));
-            ++i;
+            marketPublisherList[nextPublisher++ % numOfPublishers]->addMarket(*kv.second);
+        }
+
+        for (auto& publisher : marketPublisherList) {
+            publisherThreadList.emplace_back(std::ref(*publisher));
+        }
+    }
+
+    if (params.workers.isSet) { // begin Market worker threads
+        int numOfWorkers = std::min(params.workers.num, numOfMarkets);
+        for (int i = 0; i < numOfWorkers; ++i) {
+            marketWorkerList.push_back(std::make_unique<markets::MarketWorker>(i, params.waitStrategy));
+        }
+
+        // markets without an assigned worker are distributed round-robin
+        // (assigned workers have been validated against numOfWorkers by fileConfigMode())
+        int nextWorker = 0;
+        for (auto& kv : markets::MarketList::getInstance()) {
+            auto it = workerAssignments.find(kv.first);
+            int worker = (it != workerAssignments.end() && it->second >= 0) ? it->second : nextWorker++ % numOfWorkers;
+            marketWorkerList[worker]->addMarket(*kv.second);
+        }
+
+        for (auto& worker : marketWorkerList) {
+            marketThreadList.emplace_back(std::ref(*worker));
+        }
+    } else { // begin Market threads
+        for (auto& kv : markets::MarketList::getInstance()) {
+            marketThreadList.emplace_back(std::ref(*kv.second));
         }
     }
     cout << endl
-         << "A total of " << numOfMarkets << " Stock Markets are ready in the Matching Engine." << endl
+         << "A total of " << numOfMarkets << " Stock Markets are ready in the Matching Engine";
+    if (params.workers.isSet) {
+        cout << " (served by " << marketWorkerList.size() << " worker threads)";
+    }
+    if (params.publishers.isSet) {
+        cout << " (published by " << marketPublisherList.size() << " publisher threads)";
+    }
+    cout << "." << endl
          << "Waiting for orders..." << endl
          << endl;
 
@@ -288,6 +453,7 @@ auto main(int argc, char** argv) -> int
     std::thread dataRequester(&::s_requestDatafeedEngineData, params.configDir + "initiator.cfg", params.isVerbose, params.cryptoKey, params.configDir + CSTR_DBLOGIN_TXT, std::move(requestID), std::move(startTime), std::move(endTime), std::move(symbols), ::DURATION_PER_DATA_CHUNK.count(), experimentSpeed);
 
     // initiate Brokerage Center connection
+    FIXAcceptor::getInstance().setBatchingMode(params.isBatchingMode);
     FIXAcceptor::getInstance().connectBrokerageCenter(params.configDir + "acceptor.cfg", params.isVerbose, params.cryptoKey, params.configDir + CSTR_DBLOGIN_TXT);
 
     // create 'done' file in ~/.shift/MatchingEngine to signalize shell that service is done loading
@@ -318,11 +484,14 @@ auto main(int argc, char** argv) -> int
     } else {
         std::async(std::launch::async // no delay
             ,
-            [&params] {
+            [&params, &marketWorkerList, &marketPublisherList] {
                 while (true) {
                     cout.clear();
                     cout << '\n'
-                         << COLOR_PROMPT "The MatchingEngine is running. (Enter 'T' to stop)" NO_COLOR << '\n'
+                         << COLOR_PROMPT "The MatchingEngine is running. (Enter 'T' to stop"
+                         << (params.workers.isSet ? ", 'W' for market worker statistics" : "")
+                         << (params.publishers.isSet ? ", 'P' for market publisher statistics" : "")
+                         << ")" NO_COLOR << '\n'
                          << endl;
                     voh_t { cout, params.isVerbose, true };
 
@@ -331,22 +500,48 @@ auto main(int argc, char** argv) -> int
                     if ('T' == cmd || 't' == cmd) {
                         return;
                     }
+                    if (('W' == cmd || 'w' == cmd) && params.workers.isSet) {
+                        cout.clear();
+                        ::s_printMarketWorkerStatistics(marketWorkerList);
+                    }
+                    if (('P' == cmd || 'p' == cmd) && params.publishers.isSet) {
+                        cout.clear();
+                        ::s_printMarketPublisherStatistics(marketPublisherList);
+                    }
                 }
             })
             .get(); // this_thread will wait for user terminating acceptor.
     }
 
     // close program
-    FIXAcceptor::getInstance().disconnectBrokerageCenter();
-
     ::s_isRequestingData = false; // to terminate data requester
     if (dataRequester.joinable()) {
         dataRequester.join(); // wait for termination
     }
 
     markets::MarketList::s_isTimeout = true;
-    for (int i = 0; i < numOfMarkets; ++i) {
-        marketThreadList[i].join();
+    for (auto& marketThread : marketThreadList) {
+        marketThread.join();
+    }
+
+    // publishers send what the stopped markets left behind, therefore the Brokerage Center must still be connected
+    for (auto& publisher : marketPublisherList) {
+        publisher->stop();
+    }
+    for (auto& publisherThread : publisherThreadList) {
+        publisherThread.join();
+    }
+
+    FIXAcceptor::getInstance().disconnectBrokerageCenter();
+
+    if (params.workers.isSet) {
+        cout.clear();
+        ::s_printMarketWorkerStatistics(marketWorkerList);
+    }
+
+    if (params.publishers.isSet) {
+        cout.clear();
+        ::s_printMarketPublisherStatistics(marketPublisherList);
     }
 
     if (params.isVerbose) {
@@ -0,0 +1,105 @@
+#include "markets/BookSide.h"
+
+#include <algorithm>
+
+namespace markets {
+
+BookSide::BookSide(BookSide::Type type)
+    : m_type { type }
+{
+}
+
+auto BookSide::getType() const -> BookSide::Type
+{
+    return m_type;
+}
+
+auto BookSide::empty() const -> bool
+{
+    return m_levels.empty();
+}
+
+auto BookSide::size() const -> std::size_t
+{
+    return m_levels.size();
+}
+
+auto BookSide::begin() -> BookSide::iterator
+{
+    return m_levels.rbegin();
+}
+
+auto BookSide::begin() const -> BookSide::const_iterator
+{
+    return m_levels.rbegin();
+}
+
+auto BookSide::end() -> BookSide::iterator
+{
+    return m_levels.rend();
+}
+
+auto BookSide::end() const -> BookSide::const_iterator
+{
+    return m_levels.rend();
+}
+
+auto BookSide::rbegin() -> BookSide::reverse_iterator
+{
+    return m_levels.begin();
+}
+
+auto BookSide::rbegin() const -> BookSide::const_reverse_iterator
+{
+    return m_levels.begin();
+}
+
+auto BookSide::rend() -> BookSide::reverse_iterator
+{
+    return m_levels.end();
+}
+
+auto BookSide::rend() const -> BookSide::const_reverse_iterator
+{
+    return m_levels.end();
+}
+
+auto BookSide::lower_bound(double price) -> BookSide::iterator
+{
+    // m_levels is sorted from worst to best price, therefore all levels not better than price
+    // form a prefix of it, and the last element of that prefix is the one we are looking for
+    auto it = std::upper_bound(m_levels.begin(), m_levels.end(), price, [this](double p, const PriceLevel& level) {
+        return isBetter(level.getPrice(), p);
+    });
+
+    return iterator { it };
+}
+
+auto BookSide::insert(BookSide::iterator pos, double price) -> BookSide::iterator
+{
+    auto it = m_levels.insert(pos.base(), PriceLevel { m_orderPool, price });
+    return iterator { ++it };
+}
+
+auto BookSide::erase(BookSide::iterator pos) -> BookSide::iterator
+{
+    auto it = m_levels.erase(std::next(pos).base());
+    return iterator { it };
+}
+
+auto BookSide::findOrder(std::string_view orderID, double price) -> PriceLevel::iterator
+{
+    return { &m_orderPool, m_orderPool.find(orderID, price) };
+}
+
+auto BookSide::getOrderPool() -> OrderPool&
+{
+    return m_orderPool;
+}
+
+auto BookSide::isBetter(double price, double other) const -> bool
+{
+    return (m_type == Type::BID) ? (price > other) : (price < other);
+}
+
+} // markets
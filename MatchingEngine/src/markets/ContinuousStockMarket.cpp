@@ -4,19 +4,15 @@
 
 #include "TimeSetting.h"
 
-#include <chrono>
-#include <thread>
-
 #include <shift/miscutils/terminal/Common.h>
 
-using namespace std::chrono_literals;
-
 namespace markets {
 
 static MarketCreator<ContinuousStockMarket> creator("ContinuousStockMarket");
 
 ContinuousStockMarket::ContinuousStockMarket(std::string symbol)
     : Market { std::move(symbol) }
+    , m_prevGlobalOrder {}
 {
 }
 
@@ -26,132 +22,127 @@ ContinuousStockMarket::ContinuousStockMarket(const market_creator_parameters_t&
 }
 
 /**
- * @brief Function to start one ContinuousStockMarket matching engine, for exchange thread.
+ * @brief Process the next due order (if any) of this ContinuousStockMarket.
  */
-/* virtual */ void ContinuousStockMarket::operator()() // override
+/* virtual */ auto ContinuousStockMarket::processNextOrder() -> bool // override
 {
     Order nextOrder {};
-    Order prevGlobalOrder {};
 
-    while (!MarketList::s_isTimeout) { // process orders
-
-        if (!getNextOrder(nextOrder)) {
-            std::this_thread::sleep_for(1ms);
-            continue;
-        }
+    if (!getNextOrder(nextOrder)) {
+        return false;
+    }
 
-        // spinlock implementation:
-        // it is better than a standard lock in this scenario, since,
-        // most of the time, only this thread needs access to order book data
-        std::lock_guard<shift::concurrency::Spinlock> guard(m_spinlock);
+    // spinlock implementation:
+    // it is better than a standard lock in this scenario, since,
+    // most of the time, only this thread needs access to order book data
+    std::lock_guard<shift::concurrency::Spinlock> guard(m_spinlock);
 
-        switch (nextOrder.getType()) {
+    switch (nextOrder.getType()) {
 
-        case Order::Type::LIMIT_BUY: {
-            doLocalLimitBuy(nextOrder);
-            if (nextOrder.getSize() > 0) {
-                insertLocalBid(nextOrder);
-                cout << "Insert Bid" << endl;
-            }
-            break;
+    case Order::Type::LIMIT_BUY: {
+        doLocalLimitBuy(nextOrder);
+        if (nextOrder.getSize() > 0) {
+            insertLocalBid(std::move(nextOrder));
+            cout << "Insert Bid" << endl;
         }
+        break;
+    }
 
-        case Order::Type::LIMIT_SELL: {
-            doLocalLimitSell(nextOrder);
-            if (nextOrder.getSize() > 0) {
-                insertLocalAsk(nextOrder);
-                cout << "Insert Ask" << endl;
-            }
-            break;
+    case Order::Type::LIMIT_SELL: {
+        doLocalLimitSell(nextOrder);
+        if (nextOrder.getSize() > 0) {
+            insertLocalAsk(std::move(nextOrder));
+            cout << "Insert Ask" << endl;
         }
+        break;
+    }
 
-        case Order::Type::MARKET_BUY: {
-            doLocalMarketBuy(nextOrder);
-            if (nextOrder.getSize() > 0) {
-                insertLocalBid(nextOrder);
-                cout << "Insert Bid" << endl;
-            }
-            break;
+    case Order::Type::MARKET_BUY: {
+        doLocalMarketBuy(nextOrder);
+        if (nextOrder.getSize() > 0) {
+            insertLocalBid(std::move(nextOrder));
+            cout << "Insert Bid" << endl;
         }
+        break;
+    }
 
-        case Order::Type::MARKET_SELL: {
-            doLocalMarketSell(nextOrder);
-            if (nextOrder.getSize() > 0) {
-                insertLocalAsk(nextOrder);
-                cout << "Insert Ask" << endl;
-            }
-            break;
+    case Order::Type::MARKET_SELL: {
+        doLocalMarketSell(nextOrder);
+        if (nextOrder.getSize() > 0) {
+            insertLocalAsk(std::move(nextOrder));
+            cout << "Insert Ask" << endl;
         }
+        break;
+    }
 
-        case Order::Type::CANCEL_BID: {
-            doLocalCancelBid(nextOrder);
-            std::cout << "Cancel Bid Done" << endl;
-            break;
-        }
+    case Order::Type::CANCEL_BID: {
+        doLocalCancelBid(nextOrder);
+        std::cout << "Cancel Bid Done" << endl;
+        break;
+    }
 
-        case Order::Type::CANCEL_ASK: {
-            doLocalCancelAsk(nextOrder);
-            std::cout << "Cancel Ask Done" << endl;
-            break;
-        }
+    case Order::Type::CANCEL_ASK: {
+        doLocalCancelAsk(nextOrder);
+        std::cout << "Cancel Ask Done" << endl;
+        break;
+    }
 
-        case Order::Type::TRTH_TRADE: {
-            doGlobalLimitBuy(nextOrder);
-            doGlobalLimitSell(nextOrder);
-            if (nextOrder.getSize() > 0) {
-                auto now = TimeSetting::getInstance().simulationTimestamp();
-                addExecutionReport({ m_symbol,
-                    nextOrder.getPrice(),
-                    nextOrder.getSize(),
-                    "T1",
-                    "T2",
-                    Order::Type::LIMIT_BUY,
-                    Order::Type::LIMIT_SELL,
-                    "O1",
-                    "O2",
-                    '5', // decision '5' here means this is a trade update from TRTH
-                    "TRTH",
-                    now,
-                    now });
-            }
-            break;
-        }
+    case Order::Type::TRTH_TRADE: {
+        doGlobalLimitBuy(nextOrder);
+        doGlobalLimitSell(nextOrder);
+        if (nextOrder.getSize() > 0) {
+            auto now = TimeSetting::getInstance().simulationTimestamp();
+            addExecutionReport({ m_symbol,
+                nextOrder.getPrice(),
+                nextOrder.getSize(),
+                "T1",
+                "T2",
+                Order::Type::LIMIT_BUY,
+                Order::Type::LIMIT_SELL,
+                "O1",
+                "O2",
+                '5', // decision '5' here means this is a trade update from TRTH
+                "TRTH",
+                now,
+                now });
+        }
+        break;
+    }
 
-        case Order::Type::TRTH_BID: {
-            // if same price, size, and destination, skip
-            if (nextOrder == prevGlobalOrder) {
-                break;
-            }
-            prevGlobalOrder = nextOrder;
-            doGlobalLimitBuy(nextOrder);
-            if (nextOrder.getSize() > 0) {
-                updateGlobalBids(nextOrder);
-            }
+    case Order::Type::TRTH_BID: {
+        // if same price, size, and destination, skip
+        if (nextOrder == m_prevGlobalOrder) {
             break;
         }
+        m_prevGlobalOrder = nextOrder;
+        doGlobalLimitBuy(nextOrder);
+        if (nextOrder.getSize() > 0) {
+            updateGlobalBids(std::move(nextOrder));
+        }
+        break;
+    }
 
-        case Order::Type::TRTH_ASK: {
-            // if same price, size, and destination, skip
-            if (nextOrder == prevGlobalOrder) {
-                break;
-            }
-            prevGlobalOrder = nextOrder;
-            doGlobalLimitSell(nextOrder);
-            if (nextOrder.getSize() > 0) {
-                updateGlobalAsks(nextOrder);
-            }
+    case Order::Type::TRTH_ASK: {
+        // if same price, size, and destination, skip
+        if (nextOrder == m_prevGlobalOrder) {
             break;
         }
+        m_prevGlobalOrder = nextOrder;
+        doGlobalLimitSell(nextOrder);
+        if (nextOrder.getSize() > 0) {
+            updateGlobalAsks(std::move(nextOrder));
         }
+        break;
+    }
+    }
 
-        // for debugging:
-        // displayGlobalOrderBooks();
-        // displayLocalOrderBooks();
+    // for debugging:
+    // displayGlobalOrderBooks();
+    // displayLocalOrderBooks();
 
-        sendExecutionReports();
+    sendPendingMessages();
 
-        sendOrderBookUpdates();
-    }
+    return true;
 }
 
 void ContinuousStockMarket::doGlobalLimitBuy(Order& orderRef)
@@ -356,7 +347,9 @@ void ContinuousStockMarket::doLocalLimitBuy(Order& orderRef)
             if (m_thisLocalOrder == m_thisPriceLevel->end()) {
                 // if m_thisLocalOrder reaches end(), go to next m_thisPriceLevel
                 ++m_thisPriceLevel;
-                m_thisLocalOrder = m_thisPriceLevel->begin();
+                if (m_thisPriceLevel != m_localAsks.end()) {
+                    m_thisLocalOrder = m_thisPriceLevel->begin();
+                }
                 continue;
             }
 
@@ -472,7 +465,9 @@ void ContinuousStockMarket::doLocalLimitSell(Order& orderRef)
             if (m_thisLocalOrder == m_thisPriceLevel->end()) {
                 // if m_thisLocalOrder reaches end(), go to next m_thisPriceLevel
                 ++m_thisPriceLevel;
-                m_thisLocalOrder = m_thisPriceLevel->begin();
+                if (m_thisPriceLevel != m_localBids.end()) {
+                    m_thisLocalOrder = m_thisPriceLevel->begin();
+                }
                 continue;
             }
 
@@ -585,7 +580,9 @@ void ContinuousStockMarket::doLocalMarketBuy(Order& orderRef)
             if (m_thisLocalOrder == m_thisPriceLevel->end()) {
                 // if m_thisLocalOrder reaches end(), go to next m_thisPriceLevel
                 ++m_thisPriceLevel;
-                m_thisLocalOrder = m_thisPriceLevel->begin();
+                if (m_thisPriceLevel != m_localAsks.end()) {
+                    m_thisLocalOrder = m_thisPriceLevel->begin();
+                }
                 continue;
             }
 
@@ -690,7 +687,9 @@ void ContinuousStockMarket::doLocalMarketSell(Order& orderRef)
             if (m_thisLocalOrder == m_thisPriceLevel->end()) {
                 // if m_thisLocalOrder reaches end(), go to next m_thisPriceLevel
                 ++m_thisPriceLevel;
-                m_thisLocalOrder = m_thisPriceLevel->begin();
+                if (m_thisPriceLevel != m_localBids.end()) {
+                    m_thisLocalOrder = m_thisPriceLevel->begin();
+                }
                 continue;
             }
 
@@ -773,103 +772,55 @@ void ContinuousStockMarket::doLocalMarketSell(Order& orderRef)
 
 void ContinuousStockMarket::doLocalCancelBid(Order& orderRef)
 {
-    m_thisPriceLevel = m_localBids.begin();
-
-    if (orderRef.getPrice() > 0.0) { // not a market order
-        // find right price level for new order
-        while ((m_thisPriceLevel != m_localBids.end()) && (orderRef.getPrice() < m_thisPriceLevel->getPrice())) {
-            ++m_thisPriceLevel;
-        }
-    }
-
-    if (m_thisPriceLevel == m_localBids.end()) { // did not find any orders
-        cout << "No such order to be canceled." << endl;
-
-    } else if ((orderRef.getPrice() > 0.0) && (orderRef.getPrice() != m_thisPriceLevel->getPrice())) { // did not find the right price for non-market orders
+    if (!findLocalOrder(m_localBids, orderRef)) { // did not find any order which matched the right order id (and price)
         cout << "No such order to be canceled." << endl;
+        return;
+    }
 
-    } else {
-        m_thisLocalOrder = m_thisPriceLevel->begin();
-
-        // find right order id to cancel
-        while ((m_thisLocalOrder != m_thisPriceLevel->end()) && (orderRef.getOrderID() != m_thisLocalOrder->getOrderID())) {
-            ++m_thisLocalOrder;
-        }
-
-        if (m_thisLocalOrder != m_thisPriceLevel->end()) {
-            int size = m_thisLocalOrder->getSize() - orderRef.getSize();
-            executeLocalOrder(orderRef, size, 0.0, '4'); // cancellation orders have executed price = 0.0
-
-            if (m_thisLocalOrder->getType() != Order::Type::MARKET_BUY) { // see ContinuousStockMarket::insertLocalBid for more info
-                // broadcast local order book update
-                addOrderBookUpdate({ OrderBookEntry::Type::LOC_BID, m_symbol, m_thisPriceLevel->getPrice(), m_thisPriceLevel->getSize(),
-                    TimeSetting::getInstance().simulationTimestamp() });
-            }
+    int size = m_thisLocalOrder->getSize() - orderRef.getSize();
+    executeLocalOrder(orderRef, size, 0.0, '4'); // cancellation orders have executed price = 0.0
 
-            // remove completely canceled order from local order book
-            if (size <= 0) {
-                m_thisLocalOrder = m_thisPriceLevel->erase(m_thisLocalOrder);
-            }
+    if (m_thisLocalOrder->getType() != Order::Type::MARKET_BUY) { // see ContinuousStockMarket::insertLocalBid for more info
+        // broadcast local order book update
+        addOrderBookUpdate({ OrderBookEntry::Type::LOC_BID, m_symbol, m_thisPriceLevel->getPrice(), m_thisPriceLevel->getSize(),
+            TimeSetting::getInstance().simulationTimestamp() });
+    }
 
-            // remove empty price level from local order book
-            if (m_thisPriceLevel->empty()) {
-                m_localBids.erase(m_thisPriceLevel);
-            }
+    // remove completely canceled order from local order book
+    if (size <= 0) {
+        m_thisLocalOrder = m_thisPriceLevel->erase(m_thisLocalOrder);
+    }
 
-        } else { // did not find any order which matched the right order id
-            cout << "No such order to be canceled." << endl;
-        }
+    // remove empty price level from local order book
+    if (m_thisPriceLevel->empty()) {
+        m_localBids.erase(m_thisPriceLevel);
     }
 }
 
 void ContinuousStockMarket::doLocalCancelAsk(Order& orderRef)
 {
-    m_thisPriceLevel = m_localAsks.begin();
-
-    if (orderRef.getPrice() > 0.0) { // not a market order
-        // find right price level for new order
-        while ((m_thisPriceLevel != m_localAsks.end()) && (orderRef.getPrice() > m_thisPriceLevel->getPrice())) {
-            ++m_thisPriceLevel;
-        }
-    }
-
-    if (m_thisPriceLevel == m_localAsks.end()) { // did not find any orders
-        cout << "No such order to be canceled." << endl;
-
-    } else if ((orderRef.getPrice() > 0.0) && (orderRef.getPrice() != m_thisPriceLevel->getPrice())) { // did not find the right price for non-market orders
+    if (!findLocalOrder(m_localAsks, orderRef)) { // did not find any order which matched the right order id (and price)
         cout << "No such order to be canceled." << endl;
+        return;
+    }
 
-    } else {
-        m_thisLocalOrder = m_thisPriceLevel->begin();
-
-        // find right order id to cancel
-        while ((m_thisLocalOrder != m_thisPriceLevel->end()) && (orderRef.getOrderID() != m_thisLocalOrder->getOrderID())) {
-            ++m_thisLocalOrder;
-        }
-
-        if (m_thisLocalOrder != m_thisPriceLevel->end()) {
-            int size = m_thisLocalOrder->getSize() - orderRef.getSize();
-            executeLocalOrder(orderRef, size, 0.0, '4'); // cancellation orders have executed price = 0.0
-
-            if (m_thisLocalOrder->getType() != Order::Type::MARKET_SELL) { // see ContinuousStockMarket::insertLocalAsk for more info
-                // broadcast local order book update
-                addOrderBookUpdate({ OrderBookEntry::Type::LOC_ASK, m_symbol, m_thisPriceLevel->getPrice(), m_thisPriceLevel->getSize(),
-                    TimeSetting::getInstance().simulationTimestamp() });
-            }
+    int size = m_thisLocalOrder->getSize() - orderRef.getSize();
+    executeLocalOrder(orderRef, size, 0.0, '4'); // cancellation orders have executed price = 0.0
 
-            // remove completely canceled order from local order book
-            if (size <= 0) {
-                m_thisLocalOrder = m_thisPriceLevel->erase(m_thisLocalOrder);
-            }
+    if (m_thisLocalOrder->getType() != Order::Type::MARKET_SELL) { // see ContinuousStockMarket::insertLocalAsk for more info
+        // broadcast local order book update
+        addOrderBookUpdate({ OrderBookEntry::Type::LOC_ASK, m_symbol, m_thisPriceLevel->getPrice(), m_thisPriceLevel->getSize(),
+            TimeSetting::getInstance().simulationTimestamp() });
+    }
 
-            // remove empty price level from local order book
-            if (m_thisPriceLevel->empty()) {
-                m_localAsks.erase(m_thisPriceLevel);
-            }
+    // remove completely canceled order from local order book
+    if (size <= 0) {
+        m_thisLocalOrder = m_thisPriceLevel->erase(m_thisLocalOrder);
+    }
 
-        } else { // did not find any order which matched the right order id
-            cout << "No such order to be canceled." << endl;
-        }
+    // remove empty price level from local order book
+    if (m_thisPriceLevel->empty()) {
+        m_localAsks.erase(m_thisPriceLevel);
     }
 }
 
@@ -881,52 +832,23 @@ void ContinuousStockMarket::insertLocalBid(Order newBid)
     // - they must have a price such that they are always guaranteed first place in the order book
     // - when matching other orders, they should assume the price of the second price level (current best price)
     // - otherwise, they should assume the price of the matching limit order (and do not match with market orders)
-    if (newBid.getType() == Order::Type::MARKET_BUY) {
+    bool isMarketOrder = (newBid.getType() == Order::Type::MARKET_BUY);
+    if (isMarketOrder) {
         newBid.setPrice(std::numeric_limits<double>::max());
     }
 
-    if (!m_localBids.empty()) {
-        m_thisPriceLevel = m_localBids.begin();
-
-        // find right price level for new order
-        while ((m_thisPriceLevel != m_localBids.end()) && (newBid.getPrice() < m_thisPriceLevel->getPrice())) {
-            ++m_thisPriceLevel;
-        }
-
-        if (newBid.getPrice() == m_thisPriceLevel->getPrice()) { // add to existing price level
-            m_thisPriceLevel->setSize(m_thisPriceLevel->getSize() + newBid.getSize());
-            m_thisPriceLevel->push_back(std::move(newBid));
-
-        } else if (newBid.getPrice() > m_thisPriceLevel->getPrice()) { // new order is new best bid or in between price levels
-            PriceLevel newPriceLevel;
-            newPriceLevel.setPrice(newBid.getPrice());
-            newPriceLevel.setSize(newBid.getSize());
-            newPriceLevel.push_back(std::move(newBid));
+    // find right price level for new order
+    m_thisPriceLevel = m_localBids.lower_bound(newBid.getPrice());
 
-            m_thisPriceLevel = m_localBids.insert(m_thisPriceLevel, std::move(newPriceLevel));
-
-        } else { // m_thisPriceLevel == m_localBids.end()
-            PriceLevel newPriceLevel;
-            newPriceLevel.setPrice(newBid.getPrice());
-            newPriceLevel.setSize(newBid.getSize());
-            newPriceLevel.push_back(std::move(newBid));
-
-            m_localBids.push_back(std::move(newPriceLevel));
-            m_thisPriceLevel = m_localBids.end();
-            --m_thisPriceLevel;
-        }
-
-    } else { // m_localBids.empty()
-        PriceLevel newPriceLevel;
-        newPriceLevel.setPrice(newBid.getPrice());
-        newPriceLevel.setSize(newBid.getSize());
-        newPriceLevel.push_back(std::move(newBid));
-
-        m_localBids.push_back(std::move(newPriceLevel));
-        m_thisPriceLevel = m_localBids.begin();
+    if ((m_thisPriceLevel == m_localBids.end()) || (newBid.getPrice() != m_thisPriceLevel->getPrice())) {
+        // new order is new best bid, in between price levels, or worst bid
+        m_thisPriceLevel = m_localBids.insert(m_thisPriceLevel, newBid.getPrice());
     }
 
-    if (newBid.getType() != Order::Type::MARKET_BUY) {
+    m_thisPriceLevel->setSize(m_thisPriceLevel->getSize() + newBid.getSize());
+    m_thisPriceLevel->push_back(std::move(newBid));
+
+    if (!isMarketOrder) {
         // broadcast local order book update
         addOrderBookUpdate({ OrderBookEntry::Type::LOC_BID, m_symbol, m_thisPriceLevel->getPrice(), m_thisPriceLevel->getSize(),
             TimeSetting::getInstance().simulationTimestamp() });
@@ -941,52 +863,23 @@ void ContinuousStockMarket::insertLocalAsk(Order newAsk)
     // - they must have a price such that they are always guaranteed first place in the order book
     // - when matching other orders, they should assume the price of the second price level (current best price)
     // - otherwise, they should assume the price of the matching limit order (and do not match with market orders)
-    if (newAsk.getType() == Order::Type::MARKET_SELL) {
+    bool isMarketOrder = (newAsk.getType() == Order::Type::MARKET_SELL);
+    if (isMarketOrder) {
         newAsk.setPrice(std::numeric_limits<double>::min());
     }
 
-    if (!m_localAsks.empty()) {
-        m_thisPriceLevel = m_localAsks.begin();
-
-        // find right price level for new order
-        while ((m_thisPriceLevel != m_localAsks.end()) && (newAsk.getPrice() > m_thisPriceLevel->getPrice())) {
-            ++m_thisPriceLevel;
-        }
-
-        if (newAsk.getPrice() == m_thisPriceLevel->getPrice()) { // add to existing price level
-            m_thisPriceLevel->setSize(m_thisPriceLevel->getSize() + newAsk.getSize());
-            m_thisPriceLevel->push_back(std::move(newAsk));
-
-        } else if (newAsk.getPrice() < m_thisPriceLevel->getPrice()) { // new order is new best ask or in between price levels
-            PriceLevel newPriceLevel;
-            newPriceLevel.setPrice(newAsk.getPrice());
-            newPriceLevel.setSize(newAsk.getSize());
-            newPriceLevel.push_back(std::move(newAsk));
-
-            m_thisPriceLevel = m_localAsks.insert(m_thisPriceLevel, std::move(newPriceLevel));
-
-        } else { // m_thisPriceLevel == m_localAsks.end()
-            PriceLevel newPriceLevel;
-            newPriceLevel.setPrice(newAsk.getPrice());
-            newPriceLevel.setSize(newAsk.getSize());
-            newPriceLevel.push_back(std::move(newAsk));
+    // find right price level for new order
+    m_thisPriceLevel = m_localAsks.lower_bound(newAsk.getPrice());
 
-            m_localAsks.push_back(std::move(newPriceLevel));
-            m_thisPriceLevel = m_localAsks.end();
-            --m_thisPriceLevel;
-        }
-
-    } else { // m_localAsks.empty()
-        PriceLevel newPriceLevel;
-        newPriceLevel.setPrice(newAsk.getPrice());
-        newPriceLevel.setSize(newAsk.getSize());
-        newPriceLevel.push_back(std::move(newAsk));
-
-        m_localAsks.push_back(std::move(newPriceLevel));
-        m_thisPriceLevel = m_localAsks.begin();
+    if ((m_thisPriceLevel == m_localAsks.end()) || (newAsk.getPrice() != m_thisPriceLevel->getPrice())) {
+        // new order is new best ask, in between price levels, or worst ask
+        m_thisPriceLevel = m_localAsks.insert(m_thisPriceLevel, newAsk.getPrice());
     }
 
-    if (newAsk.getType() != Order::Type::MARKET_SELL) {
+    m_thisPriceLevel->setSize(m_thisPriceLevel->getSize() + newAsk.getSize());
+    m_thisPriceLevel->push_back(std::move(newAsk));
+
+    if (!isMarketOrder) {
         // broadcast local order book update
         addOrderBookUpdate({ OrderBookEntry::Type::LOC_ASK, m_symbol, m_thisPriceLevel->getPrice(), m_thisPriceLevel->getSize(),
             TimeSetting::getInstance().simulationTimestamp() });
@@ -5,13 +5,13 @@
 #include "Parameters.h"
 #include "TimeSetting.h"
 
-#include <chrono>
-#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
 
 #include <shift/miscutils/terminal/Common.h>
 
-using namespace std::chrono_literals;
-
 namespace markets {
 
 static MarketCreator<FBAStockMarket> creator("FBAStockMarket");
@@ -20,8 +20,8 @@ FBAStockMarket::FBAStockMarket(std::string symbol, double batchFrequencyS)
     : Market { std::move(symbol) }
     , m_lastExecutionPrice { 0.0 }
 {
-    m_batchFrequencyMS = static_cast<long>(batchFrequencyS * 1'000.0); // seconds to milliseconds
-    m_nextBatchAuctionMS = m_batchFrequencyMS;
+    m_batchFrequencyNS = std::llround(batchFrequencyS * 1'000'000'000.0); // seconds to nanoseconds
+    m_nextBatchAuctionNS = m_batchFrequencyNS;
 }
 
 FBAStockMarket::FBAStockMarket(const market_creator_parameters_t& parameters)
@@ -31,130 +31,131 @@ FBAStockMarket::FBAStockMarket(const market_creator_parameters_t& parameters)
 
 auto FBAStockMarket::getBatchFrequency() const -> double
 {
-    return static_cast<double>(m_batchFrequencyMS) / 1'000.0; // milliseconds to seconds
+    return static_cast<double>(m_batchFrequencyNS) / 1'000'000'000.0; // nanoseconds to seconds
 }
 
 void FBAStockMarket::setBatchFrequency(double batchFrequencyS)
 {
-    m_batchFrequencyMS = static_cast<long>(batchFrequencyS * 1'000.0); // seconds to milliseconds
+    m_batchFrequencyNS = std::llround(batchFrequencyS * 1'000'000'000.0); // seconds to nanoseconds
 }
 
 auto FBAStockMarket::getNextBatchAuction() const -> double
 {
-    return static_cast<double>(m_nextBatchAuctionMS) / 1'000.0; // milliseconds to seconds
+    return static_cast<double>(m_nextBatchAuctionNS) / 1'000'000'000.0; // nanoseconds to seconds
 }
 
 /**
- * @brief Function to start one FBAStockMarket matching engine, for exchange thread.
+ * @brief Run the batch auction if it is due, or else process the next due order (if any) of this FBAStockMarket.
  */
-/* virtual */ void FBAStockMarket::operator()() // override
+/* virtual */ auto FBAStockMarket::processNextOrder() -> bool // override
 {
-    Order nextOrder {};
+    // FBA: Batch Auction Stage
+    if (auto simulationNS = TimeSetting::getInstance().pastNanos(true); simulationNS >= m_nextBatchAuctionNS) {
+        m_nextBatchAuctionNS += m_batchFrequencyNS;
+        cout << "FBA: " << (static_cast<double>(simulationNS) / 1'000'000.0) << "ms" << endl;
 
-    while (!MarketList::s_isTimeout) { // process orders
+        {
+            // spinlock implementation:
+            // it is better than a standard lock in this scenario, since,
+            // most of the time, only this thread needs access to order book data
+            std::lock_guard<shift::concurrency::Spinlock> guard(m_spinlock);
 
-        // FBA: Batch Auction Stage
-        if (auto simulationMS = TimeSetting::getInstance().pastMilli(true); simulationMS >= m_nextBatchAuctionMS) {
-            m_nextBatchAuctionMS += m_batchFrequencyMS;
-            cout << "FBA: " << simulationMS << "ms" << endl;
+            // for debugging:
+            // displayGlobalOrderBooks();
+            // displayLocalOrderBooks();
 
-            {
-                // spinlock implementation:
-                // it is better than a standard lock in this scenario, since,
-                // most of the time, only this thread needs access to order book data
-                std::lock_guard<shift::concurrency::Spinlock> guard(m_spinlock);
+            doBatchAuction();
+            doIncrementAuctionCounters();
 
-                // for debugging:
-                // displayGlobalOrderBooks();
-                // displayLocalOrderBooks();
+            // for debugging:
+            // displayGlobalOrderBooks();
+            // displayLocalOrderBooks();
 
-                doBatchAuction();
-                doIncrementAuctionCounters();
+            sendPendingMessages();
+        }
 
-                // for debugging:
-                // displayGlobalOrderBooks();
-                // displayLocalOrderBooks();
+        sendOrderBookData("", false, ::FBA_ORDER_BOOK_MAX_LEVEL); // uses m_spinlock
 
-                sendExecutionReports();
-            }
+        return true;
+    }
 
-            sendOrderBookData("", false, ::FBA_ORDER_BOOK_MAX_LEVEL); // uses m_spinlock
+    // FBA: Order Submission Stage
+    Order nextOrder {};
 
-            continue;
-        }
+    if (!getNextOrder(nextOrder)) {
+        return false;
+    }
 
-        // FBA: Order Submission Stage
-        if (!getNextOrder(nextOrder)) {
-            std::this_thread::sleep_for(1ms);
-            continue;
-        }
+    // spinlock implementation:
+    // it is better than a standard lock in this scenario, since,
+    // most of the time, only this thread needs access to order book data
+    std::lock_guard<shift::concurrency::Spinlock> guard(m_spinlock);
 
-        // spinlock implementation:
-        // it is better than a standard lock in this scenario, since,
-        // most of the time, only this thread needs access to order book data
-        std::lock_guard<shift::concurrency::Spinlock> guard(m_spinlock);
+    switch (nextOrder.getType()) {
 
-        switch (nextOrder.getType()) {
+    case Order::Type::LIMIT_BUY: {
+        insertLocalBid(std::move(nextOrder));
+        // cout << "Insert Bid" << endl;
+        break;
+    }
 
-        case Order::Type::LIMIT_BUY: {
-            insertLocalBid(nextOrder);
-            // cout << "Insert Bid" << endl;
-            break;
-        }
+    case Order::Type::LIMIT_SELL: {
+        insertLocalAsk(std::move(nextOrder));
+        // cout << "Insert Ask" << endl;
+        break;
+    }
 
-        case Order::Type::LIMIT_SELL: {
-            insertLocalAsk(nextOrder);
-            // cout << "Insert Ask" << endl;
-            break;
-        }
+    case Order::Type::MARKET_BUY: {
+        insertLocalBid(std::move(nextOrder));
+        // cout << "Insert Bid" << endl;
+        break;
+    }
 
-        case Order::Type::MARKET_BUY: {
-            insertLocalBid(nextOrder);
-            // cout << "Insert Bid" << endl;
-            break;
-        }
+    case Order::Type::MARKET_SELL: {
+        insertLocalAsk(std::move(nextOrder));
+        // cout << "Insert Ask" << endl;
+        break;
+    }
 
-        case Order::Type::MARKET_SELL: {
-            insertLocalAsk(nextOrder);
-            // cout << "Insert Ask" << endl;
-            break;
-        }
+    case Order::Type::CANCEL_BID: {
+        doLocalCancelBid(nextOrder);
+        // std::cout << "Cancel Bid Done" << endl;
+        break;
+    }
 
-        case Order::Type::CANCEL_BID: {
-            doLocalCancelBid(nextOrder);
-            // std::cout << "Cancel Bid Done" << endl;
-            break;
-        }
+    case Order::Type::CANCEL_ASK: {
+        doLocalCancelAsk(nextOrder);
+        // std::cout << "Cancel Ask Done" << endl;
+        break;
+    }
 
-        case Order::Type::CANCEL_ASK: {
-            doLocalCancelAsk(nextOrder);
-            // std::cout << "Cancel Ask Done" << endl;
-            break;
-        }
+    case Order::Type::TRTH_TRADE: {
+        break;
+    }
 
-        case Order::Type::TRTH_TRADE: {
-            break;
-        }
+    case Order::Type::TRTH_BID: {
+        break;
+    }
 
-        case Order::Type::TRTH_BID: {
-            break;
-        }
+    case Order::Type::TRTH_ASK: {
+        break;
+    }
+    }
 
-        case Order::Type::TRTH_ASK: {
-            break;
-        }
-        }
+    // for debugging:
+    // displayGlobalOrderBooks();
+    // displayLocalOrderBooks();
 
-        // for debugging:
-        // displayGlobalOrderBooks();
-        // displayLocalOrderBooks();
+    // FBA: required for cancellation orders
+    // (changes to the order book during the order submission stage are never added, so they are not broadcasted)
+    sendPendingMessages();
 
-        // FBA: required for cancellation orders
-        sendExecutionReports();
+    return true;
+}
 
-        // FBA: changes to the order book during the order submission stage should not be broadcasted
-        // sendOrderBookUpdates();
-    }
+/* virtual */ auto FBAStockMarket::getNextWakeUpNS() const -> std::int64_t // override
+{
+    return std::min(Market::getNextWakeUpNS(), m_nextBatchAuctionNS);
 }
 
 /* static */ auto FBAStockMarket::s_determineExecutionSizes(int totalExecutionSize, const PriceLevel& currentLevel) -> std::deque<int>
@@ -173,36 +174,87 @@ auto FBAStockMarket::getNextBatchAuction() const -> double
         // --
         // there is a catch: orders that remainined in the book from previous
         // auctions (indicated by their auction counter) should have priority
-        int auctionCounter = currentLevel.begin()->getAuctionCounter();
-        bool changeCounter = true;
-
-        sizes.assign(sizes.size(), 0);
-        int j = totalExecutionSize;
-        while (j > 0) {
-            int i = 0;
-            for (const auto& order : currentLevel) {
-                if (order.getAuctionCounter() == auctionCounter) {
-                    if (order.getSize() > sizes[i]) {
-                        sizes[i] += 1;
-                        changeCounter = false;
-                        if (--j == 0) {
-                            break;
-                        }
-                    } else {
-                        // orders with the same auction counter are ordered by size
-                        break;
-                    }
-                } else if (order.getAuctionCounter() < auctionCounter) {
-                    // orders are ordered by their auction counter
-                    break;
+        // --
+        // shares used to be handed out one at a time, in rounds over the level:
+        // each round gives one share to every order of the current auction counter
+        // tier, in level order, until it reaches an order that is already full
+        // (or an order with a lower auction counter); a round that gives nothing
+        // moves on to the next (lower) auction counter tier. The same allocation
+        // is computed here in closed form, in a single pass over the level:
+        // - only orders whose auction counter is not higher than any order before them
+        //   are ever reached by a round, and they form the tiers, in level order;
+        // - in a tier, an order stops receiving shares as soon as itself or any order
+        //   before it is full, so it receives at most the smallest size up to it (its cap);
+        // - caps do not increase along a tier, so the tier is water-filled: every order
+        //   receives min(cap, k) shares for some k, and the remaining shares of the last
+        //   (incomplete) round go to the first orders whose cap is above k.
+        // In a level sorted by s_hasPriority, every order is part of a tier and its cap
+        // is its own size.
+        static thread_local std::vector<int> s_orderSizes;
+        static thread_local std::vector<int> s_tierOrders; // level positions, tier after tier
+        static thread_local std::vector<int> s_tierCounters;
+        static thread_local std::vector<int> s_caps;
+
+        s_orderSizes.clear();
+        s_tierOrders.clear();
+        s_tierCounters.clear();
+
+        int lowestCounter = std::numeric_limits<int>::max();
+        for (const auto& order : currentLevel) {
+            if (order.getAuctionCounter() <= lowestCounter) {
+                lowestCounter = order.getAuctionCounter();
+                s_tierOrders.push_back(static_cast<int>(s_orderSizes.size()));
+                s_tierCounters.push_back(lowestCounter);
+            }
+            s_orderSizes.push_back(order.getSize());
+        }
+
+        int remaining = totalExecutionSize;
+        std::size_t first = 0;
+        while (remaining > 0 && first < s_tierOrders.size()) {
+            std::size_t last = first + 1;
+            while (last < s_tierOrders.size() && s_tierCounters[last] == s_tierCounters[first]) {
+                ++last;
+            }
+
+            s_caps.clear();
+            int cap = std::numeric_limits<int>::max();
+            for (std::size_t t = first; t < last; ++t) {
+                cap = std::min(cap, s_orderSizes[s_tierOrders[t]]);
+                s_caps.push_back(cap);
+            }
+
+            // raise the orders still receiving shares (always the first numReceiving ones)
+            // to the next cap, as long as there are enough shares for that
+            int level = 0;
+            int extra = 0;
+            auto numReceiving = static_cast<int>(s_caps.size());
+            while (numReceiving > 0 && remaining > 0) {
+                auto cost = static_cast<std::int64_t>(s_caps[numReceiving - 1] - level) * numReceiving;
+                if (cost <= remaining) {
+                    remaining -= static_cast<int>(cost);
+                    level = s_caps[numReceiving - 1];
+                    --numReceiving;
+                } else {
+                    level += remaining / numReceiving;
+                    extra = remaining % numReceiving;
+                    remaining = 0;
                 }
-                ++i;
             }
-            if (changeCounter) {
-                --auctionCounter;
-            } else {
-                changeCounter = true;
+
+            for (std::size_t t = first; t < last; ++t) {
+                sizes[s_tierOrders[t]] = std::min(s_caps[t - first], level) + ((static_cast<int>(t - first) < extra) ? 1 : 0);
             }
+
+            first = last;
+        }
+
+        // only possible in an unsorted level, where the rounds above would never end:
+        // hand out what is left in level order, so that the whole execution size is still allocated
+        for (std::size_t i = 0; remaining > 0 && i < s_orderSizes.size(); ++i) {
+            int share = std::min(s_orderSizes[i] - sizes[i], remaining);
+            sizes[i] += share;
+            remaining -= share;
         }
 
         // for debugging:
@@ -322,8 +374,6 @@ void FBAStockMarket::doBatchAuction()
 
             int totalDemand = 0;
             int totalSupply = 0;
-            std::map<double, std::pair<int, int>> demandSuppyTable;
-            int prevValue = 0;
             int minValue = 0;
             int absExcess = 0;
             int minExcess = 0;
@@ -331,70 +381,63 @@ void FBAStockMarket::doBatchAuction()
             int totalExecutionSize = -1;
             double executionPrice = 0.0;
 
-            // calculate total "general" demand/supply and total demand/supply at individual price levels.
-            // the total demand/supply at an individual price level is that price level's demand/supply
-            // + the total "general" demand/supply up until that individual price level
+            // the total demand at a given price is the size of all bids at that price or better (higher),
+            // and the total supply at a given price is the size of all asks at that price or better (lower)
             // --
-            // both m_localBids and m_localAsk are already ordered by best prices for that
-            // particular order book type (bid or ask), so we can simply iterate in order:
+            // both m_localBids and m_localAsks are flat vectors of price levels already ordered by price,
+            // so the demand/supply curve (one row for every price present in either order book,
+            // from the lowest price to the highest) is a single merge of the two:
+            // - bids are visited from worst to best (rbegin() -> rend()), i.e. by increasing price;
+            // - asks are visited from best to worst (begin() -> end()), i.e. by increasing price as well.
             for (const auto& localBid : m_localBids) {
                 totalDemand += localBid.getSize();
-                demandSuppyTable[localBid.getPrice()].first = totalDemand;
-            }
-            for (const auto& localAsk : m_localAsks) {
-                totalSupply += localAsk.getSize();
-                demandSuppyTable[localAsk.getPrice()].second = totalSupply;
             }
 
-            // for debugging:
-            // cout << endl;
-            // cout << "Price\tDemand\tSupply" << endl;
-            // for (const auto& [price, ds] : demandSuppyTable) {
-            //     cout << price << '\t' << ds.first << '\t' << ds.second << endl;
-            // }
-            // cout << endl;
+            m_demandSupplyCurve.clear();
+            {
+                auto bidLevel = m_localBids.rbegin();
+                auto askLevel = m_localAsks.begin();
+                int remainingDemand = totalDemand; // demand from bids at the current price or higher
+
+                while ((bidLevel != m_localBids.rend()) || (askLevel != m_localAsks.end())) {
+                    double price = 0.0;
+                    int bidSize = 0;
+
+                    if ((askLevel == m_localAsks.end()) || ((bidLevel != m_localBids.rend()) && (bidLevel->getPrice() <= askLevel->getPrice()))) {
+                        price = bidLevel->getPrice();
+                        bidSize = bidLevel->getSize();
+                        ++bidLevel;
+                    } else {
+                        price = askLevel->getPrice();
+                    }
+                    if ((askLevel != m_localAsks.end()) && (askLevel->getPrice() == price)) {
+                        totalSupply += askLevel->getSize();
+                        ++askLevel;
+                    }
 
-            // now we need to "fill the gaps" of the total demand/supply at individual price levels:
-            // some prices may be available in the bid order book, but not in the ask order book
-            // (and vice versa)
-            // --
-            // std::map is ordered, so in the case of the demand (bids),
-            // we need to move backwards in the demand/supply table:
-            prevValue = 0;
-            for (auto rit = demandSuppyTable.rbegin(); rit != demandSuppyTable.rend(); ++rit) {
-                if (rit->second.first == 0) {
-                    rit->second.first = prevValue;
-                } else {
-                    prevValue = rit->second.first;
-                }
-            }
-            prevValue = 0;
-            for (auto& kv : demandSuppyTable) {
-                if (kv.second.second == 0) {
-                    kv.second.second = prevValue;
-                } else {
-                    prevValue = kv.second.second;
+                    m_demandSupplyCurve.push_back({ price, remainingDemand, totalSupply });
+                    remainingDemand -= bidSize;
                 }
             }
 
             // for debugging:
             // cout << endl;
             // cout << "Price\tDemand\tSupply" << endl;
-            // for (const auto& [price, ds] : demandSuppyTable) {
-            //     cout << price << '\t' << ds.first << '\t' << ds.second << endl;
+            // for (const auto& row : m_demandSupplyCurve) {
+            //     cout << row.price << '\t' << row.demand << '\t' << row.supply << endl;
             // }
             // cout << endl;
 
             // apply execution price selection rules
-            for (const auto& [price, ds] : demandSuppyTable) {
-                minValue = std::min(ds.first, ds.second);
+            for (const auto& [price, demand, supply] : m_demandSupplyCurve) {
+                minValue = std::min(demand, supply);
                 if (minValue > totalExecutionSize) {
                     // 1st rule: maximum aggregated size of matched orders
-                    minExcess = std::abs(ds.first - ds.second);
+                    minExcess = std::abs(demand - supply);
                     totalExecutionSize = minValue;
                     executionPrice = price;
                 } else if (minValue == totalExecutionSize) {
-                    absExcess = std::abs(ds.first - ds.second);
+                    absExcess = std::abs(demand - supply);
                     if (absExcess < minExcess) {
                         // 2nd rule: minimum number of unmatched orders
                         minExcess = absExcess;
@@ -511,13 +554,17 @@ void FBAStockMarket::doBatchAuction()
                 // remove empty price level from local bid order book
                 if (thisBidLevel->empty()) {
                     thisBidLevel = m_localBids.erase(thisBidLevel);
-                    thisBidOrder = thisBidLevel->begin();
+                    if (thisBidLevel != m_localBids.end()) {
+                        thisBidOrder = thisBidLevel->begin();
+                    }
                 }
 
                 // remove empty price level from local ask order book
                 if (thisAskLevel->empty()) {
                     thisAskLevel = m_localAsks.erase(thisAskLevel);
-                    thisAskOrder = thisAskLevel->begin();
+                    if (thisAskLevel != m_localAsks.end()) {
+                        thisAskOrder = thisAskLevel->begin();
+                    }
                 }
             }
         }
@@ -541,115 +588,67 @@ void FBAStockMarket::doIncrementAuctionCounters()
 
 void FBAStockMarket::doLocalCancelBid(Order& orderRef)
 {
-    m_thisPriceLevel = m_localBids.begin();
-
-    if (orderRef.getPrice() > 0.0) { // not a market order
-        // find right price level for new order
-        while ((m_thisPriceLevel != m_localBids.end()) && (orderRef.getPrice() < m_thisPriceLevel->getPrice())) {
-            ++m_thisPriceLevel;
-        }
-    }
-
-    if (m_thisPriceLevel == m_localBids.end()) { // did not find any orders
-        cout << "No such order to be canceled." << endl;
-
-    } else if ((orderRef.getPrice() > 0.0) && (orderRef.getPrice() != m_thisPriceLevel->getPrice())) { // did not find the right price for non-market orders
+    if (!findLocalOrder(m_localBids, orderRef)) { // did not find any order which matched the right order id (and price)
         cout << "No such order to be canceled." << endl;
+        return;
+    }
 
-    } else {
-        m_thisLocalOrder = m_thisPriceLevel->begin();
-
-        // find right order id to cancel
-        while ((m_thisLocalOrder != m_thisPriceLevel->end()) && (orderRef.getOrderID() != m_thisLocalOrder->getOrderID())) {
-            ++m_thisLocalOrder;
-        }
-
-        if (m_thisLocalOrder != m_thisPriceLevel->end()) {
-            int size = m_thisLocalOrder->getSize() - orderRef.getSize();
-            executeLocalOrder(orderRef, size, 0.0, '4'); // cancellation orders have executed price = 0.0
-
-            // FBA: changes to the order book during the order submission stage should not be broadcasted
-            // if (m_thisLocalOrder->getType() != Order::Type::MARKET_BUY) { // see FBAStockMarket::insertLocalBid for more info
-            //     // broadcast local order book update
-            //     addOrderBookUpdate({ OrderBookEntry::Type::LOC_BID, m_symbol, m_thisPriceLevel->getPrice(), m_thisPriceLevel->getSize(),
-            //         TimeSetting::getInstance().simulationTimestamp() });
-            // }
+    int size = m_thisLocalOrder->getSize() - orderRef.getSize();
+    executeLocalOrder(orderRef, size, 0.0, '4'); // cancellation orders have executed price = 0.0
 
-            // remove completely canceled order from local order book
-            if (size <= 0) {
-                m_thisLocalOrder = m_thisPriceLevel->erase(m_thisLocalOrder);
-            }
+    // FBA: changes to the order book during the order submission stage should not be broadcasted
+    // if (m_thisLocalOrder->getType() != Order::Type::MARKET_BUY) { // see FBAStockMarket::insertLocalBid for more info
+    //     // broadcast local order book update
+    //     addOrderBookUpdate({ OrderBookEntry::Type::LOC_BID, m_symbol, m_thisPriceLevel->getPrice(), m_thisPriceLevel->getSize(),
+    //         TimeSetting::getInstance().simulationTimestamp() });
+    // }
 
-            // remove empty price level from local order book
-            if (m_thisPriceLevel->empty()) {
-                m_localBids.erase(m_thisPriceLevel);
-            } else {
-                // FBA: sort by auction counter and size:
-                // this is required when pro-rating an execution in a given price level
-                // (needed here in case of partial cancellation)
-                s_sortPriceLevel(*m_thisPriceLevel);
-            }
+    // remove completely canceled order from local order book
+    if (size <= 0) {
+        m_thisLocalOrder = m_thisPriceLevel->erase(m_thisLocalOrder);
+    }
 
-        } else { // did not find any order which matched the right order id
-            cout << "No such order to be canceled." << endl;
-        }
+    // remove empty price level from local order book
+    if (m_thisPriceLevel->empty()) {
+        m_localBids.erase(m_thisPriceLevel);
+    } else {
+        // FBA: sort by auction counter and size:
+        // this is required when pro-rating an execution in a given price level
+        // (needed here in case of partial cancellation)
+        s_sortPriceLevel(*m_thisPriceLevel);
     }
 }
 
 void FBAStockMarket::doLocalCancelAsk(Order& orderRef)
 {
-    m_thisPriceLevel = m_localAsks.begin();
-
-    if (orderRef.getPrice() > 0.0) { // not a market order
-        // find right price level for new order
-        while ((m_thisPriceLevel != m_localAsks.end()) && (orderRef.getPrice() > m_thisPriceLevel->getPrice())) {
-            ++m_thisPriceLevel;
-        }
-    }
-
-    if (m_thisPriceLevel == m_localAsks.end()) { // did not find any orders
-        cout << "No such order to be canceled." << endl;
-
-    } else if ((orderRef.getPrice() > 0.0) && (orderRef.getPrice() != m_thisPriceLevel->getPrice())) { // did not find the right price for non-market orders
+    if (!findLocalOrder(m_localAsks, orderRef)) { // did not find any order which matched the right order id (and price)
         cout << "No such order to be canceled." << endl;
+        return;
+    }
 
-    } else {
-        m_thisLocalOrder = m_thisPriceLevel->begin();
-
-        // find right order id to cancel
-        while ((m_thisLocalOrder != m_thisPriceLevel->end()) && (orderRef.getOrderID() != m_thisLocalOrder->getOrderID())) {
-            ++m_thisLocalOrder;
-        }
-
-        if (m_thisLocalOrder != m_thisPriceLevel->end()) {
-            int size = m_thisLocalOrder->getSize() - orderRef.getSize();
-            executeLocalOrder(orderRef, size, 0.0, '4'); // cancellation orders have executed price = 0.0
+    int size = m_thisLocalOrder->getSize() - orderRef.getSize();
+    executeLocalOrder(orderRef, size, 0.0, '4'); // cancellation orders have executed price = 0.0
 
-            // FBA: changes to the order book during the order submission stage should not be broadcasted
-            // if (m_thisLocalOrder->getType() != Order::Type::MARKET_SELL) { // see FBAStockMarket::insertLocalAsk for more info
-            //     // broadcast local order book update
-            //     addOrderBookUpdate({ OrderBookEntry::Type::LOC_ASK, m_symbol, m_thisPriceLevel->getPrice(), m_thisPriceLevel->getSize(),
-            //         TimeSetting::getInstance().simulationTimestamp() });
-            // }
-
-            // remove completely canceled order from local order book
-            if (size <= 0) {
-                m_thisLocalOrder = m_thisPriceLevel->erase(m_thisLocalOrder);
-            }
+    // FBA: changes to the order book during the order submission stage should not be broadcasted
+    // if (m_thisLocalOrder->getType() != Order::Type::MARKET_SELL) { // see FBAStockMarket::insertLocalAsk for more info
+    //     // broadcast local order book update
+    //     addOrderBookUpdate({ OrderBookEntry::Type::LOC_ASK, m_symbol, m_thisPriceLevel->getPrice(), m_thisPriceLevel->getSize(),
+    //         TimeSetting::getInstance().simulationTimestamp() });
+    // }
 
-            // remove empty price level from local order book
-            if (m_thisPriceLevel->empty()) {
-                m_localAsks.erase(m_thisPriceLevel);
-            } else {
-                // FBA: sort by auction counter and size:
-                // this is required when pro-rating an execution in a given price level
-                // (needed here in case of partial cancellation)
-                s_sortPriceLevel(*m_thisPriceLevel);
-            }
+    // remove completely canceled order from local order book
+    if (size <= 0) {
+        m_thisLocalOrder = m_thisPriceLevel->erase(m_thisLocalOrder);
+    }
 
-        } else { // did not find any order which matched the right order id
-            cout << "No such order to be canceled." << endl;
-        }
+    // remove empty price level from local order book
+    if (m_thisPriceLevel->empty()) {
+        m_localAsks.erase(m_thisPriceLevel);
+    } else {
+        // FBA: sort by auction counter and size:
+        // this is required when pro-rating an execution in a given price level
+        // (needed here in case of partial cancellation)
+        s_sortPriceLevel(*m_thisPriceLevel);
     }
 }
 
@@ -662,50 +661,19 @@ void FBAStockMarket::insertLocalBid(Order newBid)
         newBid.setPrice(std::numeric_limits<double>::max());
     }
 
-    if (!m_localBids.empty()) {
-        m_thisPriceLevel = m_localBids.begin();
-
-        // find right price level for new order
-        while ((m_thisPriceLevel != m_localBids.end()) && (newBid.getPrice() < m_thisPriceLevel->getPrice())) {
-            ++m_thisPriceLevel;
-        }
-
-        if (newBid.getPrice() == m_thisPriceLevel->getPrice()) { // add to existing price level
-            m_thisPriceLevel->setSize(m_thisPriceLevel->getSize() + newBid.getSize());
-            m_thisPriceLevel->push_back(std::move(newBid));
+    // find right price level for new order
+    m_thisPriceLevel = m_localBids.lower_bound(newBid.getPrice());
 
-        } else if (newBid.getPrice() > m_thisPriceLevel->getPrice()) { // new order is new best bid or in between price levels
-            PriceLevel newPriceLevel;
-            newPriceLevel.setPrice(newBid.getPrice());
-            newPriceLevel.setSize(newBid.getSize());
-            newPriceLevel.push_back(std::move(newBid));
-
-            m_thisPriceLevel = m_localBids.insert(m_thisPriceLevel, std::move(newPriceLevel));
-
-        } else { // m_thisPriceLevel == m_localBids.end()
-            PriceLevel newPriceLevel;
-            newPriceLevel.setPrice(newBid.getPrice());
-            newPriceLevel.setSize(newBid.getSize());
-            newPriceLevel.push_back(std::move(newBid));
-
-            m_localBids.push_back(std::move(newPriceLevel));
-            m_thisPriceLevel = m_localBids.end();
-            --m_thisPriceLevel;
-        }
-
-    } else { // m_localBids.empty()
-        PriceLevel newPriceLevel;
-        newPriceLevel.setPrice(newBid.getPrice());
-        newPriceLevel.setSize(newBid.getSize());
-        newPriceLevel.push_back(std::move(newBid));
-
-        m_localBids.push_back(std::move(newPriceLevel));
-        m_thisPriceLevel = m_localBids.begin();
+    if ((m_thisPriceLevel == m_localBids.end()) || (newBid.getPrice() != m_thisPriceLevel->getPrice())) {
+        // new order is new best bid, in between price levels, or worst bid
+        m_thisPriceLevel = m_localBids.insert(m_thisPriceLevel, newBid.getPrice());
     }
 
+    m_thisPriceLevel->setSize(m_thisPriceLevel->getSize() + newBid.getSize());
+
     // FBA: sort by auction counter and size:
     // this is required when pro-rating an execution in a given price level
-    s_sortPriceLevel(*m_thisPriceLevel);
+    m_thisPriceLevel->insertSorted(std::move(newBid), s_hasPriority);
 
     // FBA: changes to the order book during the order submission stage should not be broadcasted
     // if (newBid.getType() != Order::Type::MARKET_BUY) {
@@ -724,50 +692,19 @@ void FBAStockMarket::insertLocalAsk(Order newAsk)
         newAsk.setPrice(std::numeric_limits<double>::min());
     }
 
-    if (!m_localAsks.empty()) {
-        m_thisPriceLevel = m_localAsks.begin();
-
-        // find right price level for new order
-        while ((m_thisPriceLevel != m_localAsks.end()) && (newAsk.getPrice() > m_thisPriceLevel->getPrice())) {
-            ++m_thisPriceLevel;
-        }
+    // find right price level for new order
+    m_thisPriceLevel = m_localAsks.lower_bound(newAsk.getPrice());
 
-        if (newAsk.getPrice() == m_thisPriceLevel->getPrice()) { // add to existing price level
-            m_thisPriceLevel->setSize(m_thisPriceLevel->getSize() + newAsk.getSize());
-            m_thisPriceLevel->push_back(std::move(newAsk));
-
-        } else if (newAsk.getPrice() < m_thisPriceLevel->getPrice()) { // new order is new best ask or in between price levels
-            PriceLevel newPriceLevel;
-            newPriceLevel.setPrice(newAsk.getPrice());
-            newPriceLevel.setSize(newAsk.getSize());
-            newPriceLevel.push_back(std::move(newAsk));
-
-            m_thisPriceLevel = m_localAsks.insert(m_thisPriceLevel, std::move(newPriceLevel));
-
-        } else { // m_thisPriceLevel == m_localAsks.end()
-            PriceLevel newPriceLevel;
-            newPriceLevel.setPrice(newAsk.getPrice());
-            newPriceLevel.setSize(newAsk.getSize());
-            newPriceLevel.push_back(std::move(newAsk));
-
-            m_localAsks.push_back(std::move(newPriceLevel));
-            m_thisPriceLevel = m_localAsks.end();
-            --m_thisPriceLevel;
-        }
-
-    } else { // m_localAsks.empty()
-        PriceLevel newPriceLevel;
-        newPriceLevel.setPrice(newAsk.getPrice());
-        newPriceLevel.setSize(newAsk.getSize());
-        newPriceLevel.push_back(std::move(newAsk));
-
-        m_localAsks.push_back(std::move(newPriceLevel));
-        m_thisPriceLevel = m_localAsks.begin();
+    if ((m_thisPriceLevel == m_localAsks.end()) || (newAsk.getPrice() != m_thisPriceLevel->getPrice())) {
+        // new order is new best ask, in between price levels, or worst ask
+        m_thisPriceLevel = m_localAsks.insert(m_thisPriceLevel, newAsk.getPrice());
     }
 
+    m_thisPriceLevel->setSize(m_thisPriceLevel->getSize() + newAsk.getSize());
+
     // FBA: sort by auction counter and size:
     // this is required when pro-rating an execution in a given price level
-    s_sortPriceLevel(*m_thisPriceLevel);
+    m_thisPriceLevel->insertSorted(std::move(newAsk), s_hasPriority);
 
     // FBA: changes to the order book during the order submission stage should not be broadcasted
     // if (newAsk.getType() != Order::Type::MARKET_SELL) {
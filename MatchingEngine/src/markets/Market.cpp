@@ -1,14 +1,27 @@
 #include "markets/Market.h"
 
+#include "Parameters.h"
 #include "TimeSetting.h"
 
+#include <algorithm>
+#include <thread>
+
 #include <shift/miscutils/terminal/Common.h>
 
 namespace markets {
 
 Market::Market(std::string symbol)
     : m_symbol { std::move(symbol) }
+    , m_newGlobalOrders { ::GLOBAL_ORDER_QUEUE_CAPACITY }
+    , m_nextStagedGlobalOrder { 0 }
+    , m_newLocalOrders { ::LOCAL_ORDER_QUEUE_CAPACITY }
+    , m_waitStrategy { &m_ownWaitStrategy }
+    , m_localBids { BookSide::Type::BID }
+    , m_localAsks { BookSide::Type::ASK }
+    , m_numOverflowMessages { 0 }
+    , m_publisherWaitStrategy { nullptr }
 {
+    m_stagedGlobalOrders.reserve(::GLOBAL_ORDER_QUEUE_CAPACITY);
 }
 
 auto Market::getSymbol() const -> const std::string&
@@ -21,6 +34,19 @@ void Market::setSymbol(const std::string& symbol)
     m_symbol = symbol;
 }
 
+/**
+ * @brief Function to start one matching engine, for market thread.
+ */
+void Market::operator()()
+{
+    while (!MarketList::s_isTimeout) { // process orders
+        if (!processNextOrder()) {
+            flushPendingMessages();
+            s_waitUntil(*m_waitStrategy, getNextWakeUpNS());
+        }
+    }
+}
+
 void Market::displayGlobalOrderBooks()
 {
     auto simulationMS = TimeSetting::getInstance().pastMilli(true);
@@ -84,6 +110,9 @@ void Market::sendOrderBookData(const std::string& targetID /* = "" */, bool incl
     // this function will only be executed a couple of times during a simulation
     std::lock_guard<shift::concurrency::Spinlock> guard(m_spinlock);
 
+    // held back order book updates predate this snapshot, so they must not be received after it
+    sendPendingMessages(true);
+
     // requirements:
     // - the first order book entry must have a price <= 0.0. This will signal the BC it
     // needs to clear its current version of the order book before accepting new entries
@@ -131,6 +160,18 @@ void Market::sendOrderBookData(const std::string& targetID /* = "" */, bool incl
         }
     }
 
+    if (m_outgoingMessages) { // the publisher thread sends them after any message queued earlier
+        if (includeGlobal) {
+            enqueueOutgoingMessage(OrderBookSnapshot { std::move(globalBids), targetID });
+            enqueueOutgoingMessage(OrderBookSnapshot { std::move(globalAsks), targetID });
+        }
+
+        enqueueOutgoingMessage(OrderBookSnapshot { std::move(localBids), targetID });
+        enqueueOutgoingMessage(OrderBookSnapshot { std::move(localAsks), targetID });
+        m_publisherWaitStrategy->notify();
+        return;
+    }
+
     if (includeGlobal) {
         FIXAcceptor::getInstance().sendOrderBook(globalBids, targetID);
         FIXAcceptor::getInstance().sendOrderBook(globalAsks, targetID);
@@ -142,56 +183,219 @@ void Market::sendOrderBookData(const std::string& targetID /* = "" */, bool incl
 
 void Market::bufNewGlobalOrder(Order&& newOrder)
 {
-    try {
-        std::lock_guard<std::mutex> ngGuard(m_mtxNewGlobalOrders);
-        m_newGlobalOrders.push(std::move(newOrder));
-    } catch (std::exception& e) {
-        cout << e.what() << endl;
+    // the queue is bounded: if the market thread has not run for a while, back off until it moves the queued orders out
+    while (!m_newGlobalOrders.try_push(std::move(newOrder))) {
+        if (MarketList::s_isTimeout) { // the market thread has stopped: nobody will make room
+            return;
+        }
+        std::this_thread::yield();
     }
+
+    m_waitStrategy->notify();
 }
 
 void Market::bufNewLocalOrder(Order&& newOrder)
 {
-    try {
-        std::lock_guard<std::mutex> nlGuard(m_mtxNewLocalOrders);
-        m_newLocalOrders.push(std::move(newOrder));
-    } catch (std::exception& e) {
-        cout << e.what() << endl;
+    // the queue is bounded: if the market thread falls behind, back off until it catches up
+    while (!m_newLocalOrders.try_push(std::move(newOrder))) {
+        if (MarketList::s_isTimeout) { // the market thread has stopped: nobody will make room
+            return;
+        }
+        std::this_thread::yield();
     }
+
+    m_waitStrategy->notify();
 }
 
-auto Market::getNextOrder(Order& orderRef) -> bool
+auto Market::getWaitStrategy() const -> shift::concurrency::WaitStrategy::Type
 {
-    bool good = false;
-    auto simulationMS = TimeSetting::getInstance().pastMilli(true);
+    return m_waitStrategy->getType();
+}
 
-    std::lock_guard<std::mutex> ngGuard(m_mtxNewGlobalOrders);
-    if (!m_newGlobalOrders.empty()) {
-        orderRef = m_newGlobalOrders.front();
-        if (orderRef.getMilli() < simulationMS) {
-            good = true;
-        }
+void Market::setWaitStrategy(shift::concurrency::WaitStrategy::Type type)
+{
+    m_waitStrategy->setType(type);
+}
+
+void Market::shareWaitStrategy(shift::concurrency::WaitStrategy& waitStrategy)
+{
+    m_waitStrategy = &waitStrategy;
+}
+
+void Market::setPublisher(shift::concurrency::WaitStrategy& waitStrategy)
+{
+    m_outgoingMessages = std::make_unique<shift::concurrency::SPSCQueue<outgoing_message_t>>(::OUTGOING_MESSAGE_QUEUE_CAPACITY);
+    m_publisherWaitStrategy = &waitStrategy;
+}
+
+/**
+ * @brief Send queued outgoing messages, for publisher thread.
+ *        Consecutive execution reports, or consecutive order book updates, are sent together (see FIXAcceptor batching mode).
+ */
+auto Market::publishOutgoingMessages(std::size_t maxCount) -> std::size_t
+{
+    if (!m_outgoingMessages) {
+        return 0;
     }
-    std::lock_guard<std::mutex> nlGuard(m_mtxNewLocalOrders);
-    if (!m_newLocalOrders.empty()) {
-        Order* nextLocalOrder = &m_newLocalOrders.front();
-        if (good) {
-            if (orderRef.getMilli() >= nextLocalOrder->getMilli()) {
-                orderRef = *nextLocalOrder;
-                m_newLocalOrders.pop();
-            } else {
-                m_newGlobalOrders.pop();
+
+    auto publish = [this](outgoing_message_t&& message) {
+        if (auto* report = std::get_if<ExecutionReport>(&message)) {
+            if (!m_orderBookUpdatesToPublish.empty()) {
+                publishBufferedMessages();
+            }
+            m_executionReportsToPublish.push_back(std::move(*report));
+        } else if (auto* update = std::get_if<OrderBookEntry>(&message)) {
+            if (!m_executionReportsToPublish.empty()) {
+                publishBufferedMessages();
             }
-        } else if (nextLocalOrder->getMilli() < simulationMS) {
-            good = true;
-            orderRef = *nextLocalOrder;
-            m_newLocalOrders.pop();
+            m_orderBookUpdatesToPublish.push_back(std::move(*update));
+        } else {
+            publishBufferedMessages();
+            auto& snapshot = std::get<OrderBookSnapshot>(message);
+            FIXAcceptor::getInstance().sendOrderBook(snapshot.entries, snapshot.targetID);
         }
-    } else if (good) {
-        m_newGlobalOrders.pop();
+    };
+
+    auto count = m_outgoingMessages->consume_all(publish, maxCount);
+
+    // the market thread only retries its overflow queue when it has new messages: do not wait for that,
+    // and send what was moved right away (reporting no messages would put the publisher thread to sleep)
+    if (count < maxCount && m_numOverflowMessages.load(std::memory_order_relaxed) > 0) {
+        {
+            std::lock_guard<shift::concurrency::Spinlock> guard(m_spinlock);
+            moveOverflowMessages();
+        }
+
+        count += m_outgoingMessages->consume_all(publish, maxCount - count);
+    }
+
+    publishBufferedMessages();
+
+    return count;
+}
+
+auto Market::getOutgoingQueueDepth() const -> std::size_t
+{
+    if (!m_outgoingMessages) {
+        return 0;
+    }
+
+    return m_outgoingMessages->size() + m_numOverflowMessages.load(std::memory_order_relaxed);
+}
+
+void Market::flushPendingMessages()
+{
+    std::lock_guard<shift::concurrency::Spinlock> guard(m_spinlock);
+    sendPendingMessages(true);
+}
+
+/**
+ * @brief Move all queued global orders to the staging buffer, where they wait until they are due.
+ */
+void Market::stageGlobalOrders()
+{
+    if (m_nextStagedGlobalOrder == m_stagedGlobalOrders.size()) {
+        m_stagedGlobalOrders.clear();
+        m_nextStagedGlobalOrder = 0;
+    } else if (m_nextStagedGlobalOrder > m_stagedGlobalOrders.size() / 2) { // drop the consumed orders (amortized over them)
+        m_stagedGlobalOrders.erase(m_stagedGlobalOrders.begin(), m_stagedGlobalOrders.begin() + m_nextStagedGlobalOrder);
+        m_nextStagedGlobalOrder = 0;
     }
 
-    return good;
+    m_newGlobalOrders.consume_all([this](Order&& order) { m_stagedGlobalOrders.push_back(std::move(order)); });
+}
+
+auto Market::getNextOrder(Order& orderRef) -> bool
+{
+    auto simulationNS = TimeSetting::getInstance().pastNanos(true);
+
+    stageGlobalOrders();
+
+    // orders are received in due time order: only the oldest order of each queue can be due
+    Order* nextGlobalOrder = (m_nextStagedGlobalOrder < m_stagedGlobalOrders.size()) ? &m_stagedGlobalOrders[m_nextStagedGlobalOrder] : nullptr;
+    const Order* nextLocalOrder = m_newLocalOrders.front();
+
+    bool globalIsDue = (nextGlobalOrder != nullptr) && (nextGlobalOrder->getNanos() < simulationNS);
+    bool localIsDue = (nextLocalOrder != nullptr) && (nextLocalOrder->getNanos() < simulationNS);
+
+    // local orders go first when both are due at the same time
+    if (localIsDue && (!globalIsDue || (nextGlobalOrder->getNanos() >= nextLocalOrder->getNanos()))) {
+        return m_newLocalOrders.try_pop(orderRef);
+    }
+
+    if (globalIsDue) {
+        orderRef = std::move(*nextGlobalOrder);
+        ++m_nextStagedGlobalOrder;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Simulation time (in nanoseconds) at which the earliest queued order is due.
+ */
+/* virtual */ auto Market::getNextWakeUpNS() const -> std::int64_t
+{
+    std::int64_t wakeUpNS = std::numeric_limits<std::int64_t>::max();
+
+    // queued orders are due as soon as the simulation time is past their own
+    // (global orders still in the queue were received after the staged ones)
+    if (m_nextStagedGlobalOrder < m_stagedGlobalOrders.size()) {
+        wakeUpNS = m_stagedGlobalOrders[m_nextStagedGlobalOrder].getNanos() + 1;
+    } else if (const Order* nextGlobalOrder = m_newGlobalOrders.front()) {
+        wakeUpNS = std::min(wakeUpNS, nextGlobalOrder->getNanos() + 1);
+    }
+    if (const Order* nextLocalOrder = m_newLocalOrders.front()) {
+        wakeUpNS = std::min(wakeUpNS, nextLocalOrder->getNanos() + 1);
+    }
+
+    return wakeUpNS;
+}
+
+/**
+ * @brief Wait (according to the given wait strategy) until it is signaled,
+ * or wakeUpNS (in simulation time) is reached.
+ */
+/* static */ void Market::s_waitUntil(shift::concurrency::WaitStrategy& waitStrategy, std::int64_t wakeUpNS)
+{
+    auto simulationNS = TimeSetting::getInstance().pastNanos(true);
+    if (wakeUpNS <= simulationNS) {
+        return;
+    }
+
+    std::int64_t timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(::MARKET_MAX_WAIT_DURATION).count();
+    if (int speed = TimeSetting::getInstance().getSpeed(); speed > 0) {
+        // convert simulation time to real time, rounding up
+        timeout = std::min(timeout, (wakeUpNS - simulationNS - 1) / speed + 1);
+    }
+
+    waitStrategy.waitUntil(std::chrono::steady_clock::now() + std::chrono::nanoseconds(timeout));
+}
+
+/**
+ * @brief Find the resting order targeted by a cancellation order,
+ * and point m_thisPriceLevel and m_thisLocalOrder to it.
+ */
+auto Market::findLocalOrder(BookSide& bookSide, const Order& orderRef) -> bool
+{
+    if (bookSide.empty()) {
+        return false;
+    }
+
+    // cancellation orders must target the right price, and market orders can only be found in the first price level
+    // (several resting orders may share the order ID, at other prices)
+    double price = (orderRef.getPrice() > 0.0) ? orderRef.getPrice() : bookSide.begin()->getPrice();
+
+    auto orderIt = bookSide.findOrder(orderRef.getOrderID(), price);
+    if (orderIt.getIndex() == OrderPool::NIL) {
+        return false;
+    }
+
+    m_thisPriceLevel = bookSide.lower_bound(price);
+    m_thisLocalOrder = orderIt;
+
+    return true;
 }
 
 // decision '2' means this is a trade record, '4' means cancel record; record trade or cancel with object actions
@@ -251,6 +455,96 @@ void Market::executeLocalOrder(Order& orderRef, int size, double price, char dec
         orderRef.getTime() });
 }
 
+void Market::sendPendingMessages(bool force /* = false */)
+{
+    if (m_executionReports.empty() && m_orderBookUpdates.empty()) {
+        return;
+    }
+
+    if (!force && FIXAcceptor::getInstance().isBatchingMode()) {
+        auto now = std::chrono::steady_clock::now();
+        if (m_pendingSince == std::chrono::steady_clock::time_point {}) {
+            m_pendingSince = now;
+        }
+
+        if ((now - m_pendingSince < ::FIX_BATCH_FLUSH_INTERVAL)
+            && (m_executionReports.size() + m_orderBookUpdates.size() < ::FIX_BATCH_MAX_PENDING_MESSAGES)) {
+            return;
+        }
+    }
+
+    if (m_outgoingMessages) { // the publisher thread sends them
+        for (auto& report : m_executionReports) {
+            enqueueOutgoingMessage(std::move(report));
+        }
+        for (auto& update : m_orderBookUpdates) {
+            enqueueOutgoingMessage(std::move(update));
+        }
+        m_publisherWaitStrategy->notify();
+    } else {
+        publishMessages(m_executionReports, m_orderBookUpdates);
+    }
+
+    m_executionReports.clear();
+    m_orderBookUpdates.clear();
+
+    m_pendingSince = {};
+}
+
+/**
+ * @brief Queue an outgoing message for the publisher thread, without ever blocking (must be called with m_spinlock held).
+ */
+void Market::enqueueOutgoingMessage(outgoing_message_t&& message)
+{
+    moveOverflowMessages(); // older messages go first
+
+    if (!m_overflowMessages.empty() || !m_outgoingMessages->try_push(std::move(message))) {
+        m_overflowMessages.push_back(std::move(message));
+        m_numOverflowMessages.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Move as many overflown messages as possible into the queue of the publisher thread (must be called with m_spinlock held).
+ */
+void Market::moveOverflowMessages()
+{
+    while (!m_overflowMessages.empty() && m_outgoingMessages->try_push(std::move(m_overflowMessages.front()))) {
+        m_overflowMessages.pop_front();
+        m_numOverflowMessages.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Send the execution reports and order book updates collected by the publisher thread.
+ */
+void Market::publishBufferedMessages()
+{
+    if (m_executionReportsToPublish.empty() && m_orderBookUpdatesToPublish.empty()) {
+        return;
+    }
+
+    publishMessages(m_executionReportsToPublish, m_orderBookUpdatesToPublish);
+    m_executionReportsToPublish.clear();
+    m_orderBookUpdatesToPublish.clear();
+}
+
+/**
+ * @brief Send execution reports and order book updates (in this order) to brokers.
+ */
+/* virtual */ void Market::publishMessages(const std::vector<ExecutionReport>& executionReports, const std::vector<OrderBookEntry>& orderBookUpdates)
+{
+    auto& fixAcceptor = FIXAcceptor::getInstance();
+
+    if (!executionReports.empty()) {
+        fixAcceptor.sendExecutionReports(executionReports);
+    }
+
+    if (!orderBookUpdates.empty()) {
+        fixAcceptor.sendOrderBookUpdates(orderBookUpdates);
+    }
+}
+
 /* static */ std::atomic<bool> MarketList::s_isTimeout { false };
 
 /* static */ auto MarketList::getInstance() -> MarketList::market_list_t&
@@ -0,0 +1,87 @@
+#include "markets/MarketPublisher.h"
+
+#include "Parameters.h"
+
+#include <chrono>
+
+namespace markets {
+
+MarketPublisher::MarketPublisher(int id, shift::concurrency::WaitStrategy::Type waitStrategy)
+    : m_id { id }
+    , m_waitStrategy { waitStrategy }
+    , m_isStopped { false }
+    , m_numPublishedMessages { 0 }
+{
+}
+
+auto MarketPublisher::getID() const -> int
+{
+    return m_id;
+}
+
+auto MarketPublisher::getNumMarkets() const -> int
+{
+    return m_markets.size();
+}
+
+auto MarketPublisher::getNumPublishedMessages() const -> long
+{
+    return m_numPublishedMessages.load(std::memory_order_relaxed);
+}
+
+auto MarketPublisher::getQueueDepth() const -> std::size_t
+{
+    std::size_t queueDepth = 0;
+    for (const auto* market : m_markets) {
+        queueDepth += market->getOutgoingQueueDepth();
+    }
+    return queueDepth;
+}
+
+void MarketPublisher::addMarket(Market& market)
+{
+    market.setPublisher(m_waitStrategy);
+    m_markets.push_back(&market);
+}
+
+void MarketPublisher::stop()
+{
+    m_isStopped.store(true, std::memory_order_release);
+    m_waitStrategy.notify();
+}
+
+/**
+ * @brief Function to start one MarketPublisher, for publisher thread.
+ */
+void MarketPublisher::operator()()
+{
+    while (!m_isStopped.load(std::memory_order_acquire)) {
+        long numPublishedMessages = 0;
+
+        // a bounded number of messages per market and per round, so that a busy market cannot starve the others
+        for (auto* market : m_markets) {
+            numPublishedMessages += market->publishOutgoingMessages(::MARKET_PUBLISHER_BATCH_SIZE);
+        }
+
+        if (numPublishedMessages > 0) {
+            m_numPublishedMessages.fetch_add(numPublishedMessages, std::memory_order_relaxed);
+            continue;
+        }
+
+        m_waitStrategy.waitUntil(std::chrono::steady_clock::now() + ::MARKET_MAX_WAIT_DURATION);
+    }
+
+    // the markets have stopped (see stop()): send everything they left behind, including held back messages
+    long numPublishedMessages = 0;
+    for (auto* market : m_markets) {
+        market->flushPendingMessages();
+
+        std::size_t numMessages = 0;
+        while ((numMessages = market->publishOutgoingMessages(::MARKET_PUBLISHER_BATCH_SIZE)) > 0) {
+            numPublishedMessages += numMessages;
+        }
+    }
+    m_numPublishedMessages.fetch_add(numPublishedMessages, std::memory_order_relaxed);
+}
+
+} // markets
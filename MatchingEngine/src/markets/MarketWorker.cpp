@@ -0,0 +1,90 @@
+#include "markets/MarketWorker.h"
+
+#include "Parameters.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace markets {
+
+MarketWorker::MarketWorker(int id, shift::concurrency::WaitStrategy::Type waitStrategy)
+    : m_id { id }
+    , m_waitStrategy { waitStrategy }
+    , m_isStarted { false }
+    , m_numProcessedOrders { 0 }
+    , m_busyTimeNS { 0 }
+{
+}
+
+auto MarketWorker::getID() const -> int
+{
+    return m_id;
+}
+
+auto MarketWorker::getNumMarkets() const -> int
+{
+    return m_markets.size();
+}
+
+auto MarketWorker::getNumProcessedOrders() const -> long
+{
+    return m_numProcessedOrders.load(std::memory_order_relaxed);
+}
+
+auto MarketWorker::getUtilization() const -> double
+{
+    if (!m_isStarted.load(std::memory_order_acquire)) {
+        return 0.0;
+    }
+
+    auto elapsedNS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime).count();
+    return (elapsedNS > 0) ? static_cast<double>(m_busyTimeNS.load(std::memory_order_relaxed)) / elapsedNS : 0.0;
+}
+
+void MarketWorker::addMarket(Market& market)
+{
+    market.shareWaitStrategy(m_waitStrategy);
+    m_markets.push_back(&market);
+}
+
+/**
+ * @brief Function to start one MarketWorker, for worker thread.
+ */
+void MarketWorker::operator()()
+{
+    m_startTime = std::chrono::steady_clock::now();
+    m_isStarted.store(true, std::memory_order_release);
+
+    while (!MarketList::s_isTimeout) {
+        auto roundStartTime = std::chrono::steady_clock::now();
+        long numProcessedOrders = 0;
+
+        // a bounded number of events per market and per round, so that a busy market cannot starve the others
+        for (auto* market : m_markets) {
+            int i = 0;
+            while ((i < ::MARKET_WORKER_BATCH_SIZE) && market->processNextOrder()) {
+                ++i;
+            }
+            numProcessedOrders += i;
+
+            if (i < ::MARKET_WORKER_BATCH_SIZE) { // this market is idle: do not hold back its outgoing messages any longer
+                market->flushPendingMessages();
+            }
+        }
+
+        if (numProcessedOrders > 0) {
+            m_numProcessedOrders.fetch_add(numProcessedOrders, std::memory_order_relaxed);
+            m_busyTimeNS.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - roundStartTime).count(), std::memory_order_relaxed);
+            continue;
+        }
+
+        std::int64_t wakeUpNS = std::numeric_limits<std::int64_t>::max();
+        for (const auto* market : m_markets) {
+            wakeUpNS = std::min(wakeUpNS, market->getNextWakeUpNS());
+        }
+
+        Market::s_waitUntil(m_waitStrategy, wakeUpNS);
+    }
+}
+
+} // markets
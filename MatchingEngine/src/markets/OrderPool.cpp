@@ -0,0 +1,143 @@
+#include "markets/OrderPool.h"
+
+#include <functional>
+
+namespace markets {
+
+static constexpr std::size_t MIN_INDEX_SIZE = 16;
+
+OrderPool::OrderPool(std::size_t initialCapacity /* = 0 */)
+    : m_freeHead { NIL }
+    , m_numInUse { 0 }
+{
+    m_nodes.reserve(initialCapacity);
+
+    // keep the index at most half full
+    std::size_t indexSize = MIN_INDEX_SIZE;
+    while (indexSize < 2 * initialCapacity) {
+        indexSize *= 2;
+    }
+    m_orderIDIndex.assign(indexSize, NIL);
+}
+
+auto OrderPool::acquire(Order order) -> OrderPool::index_t
+{
+    index_t index = m_freeHead;
+
+    if (index != NIL) { // recycle a released node
+        m_freeHead = m_nodes[index].next;
+        m_nodes[index].order = std::move(order);
+    } else { // grow the pool
+        index = static_cast<index_t>(m_nodes.size());
+        m_nodes.push_back({ std::move(order), NIL, NIL });
+    }
+
+    m_nodes[index].prev = NIL;
+    m_nodes[index].next = NIL;
+    ++m_numInUse;
+
+    if (2 * m_numInUse > m_orderIDIndex.size()) {
+        growIndex();
+    }
+    insertIntoIndex(index);
+
+    return index;
+}
+
+void OrderPool::release(OrderPool::index_t index)
+{
+    eraseFromIndex(index);
+
+    m_nodes[index].prev = NIL;
+    m_nodes[index].next = m_freeHead;
+    m_freeHead = index;
+    --m_numInUse;
+}
+
+/**
+ * @brief Find an order in the pool by its order ID and price.
+ *        Order IDs are chosen by clients and may be shared by several orders: probing goes on until one of them also has the given price
+ *        (if several orders share both, any of them may be returned).
+ */
+auto OrderPool::find(std::string_view orderID, double price) const -> OrderPool::index_t
+{
+    const auto mask = m_orderIDIndex.size() - 1;
+
+    for (auto slot = getHomeSlot(orderID); m_orderIDIndex[slot] != NIL; slot = (slot + 1) & mask) {
+        const auto& order = m_nodes[m_orderIDIndex[slot]].order;
+        if (order.getOrderID() == orderID && order.getPrice() == price) {
+            return m_orderIDIndex[slot];
+        }
+    }
+
+    return NIL;
+}
+
+auto OrderPool::size() const -> std::size_t
+{
+    return m_numInUse;
+}
+
+auto OrderPool::capacity() const -> std::size_t
+{
+    return m_nodes.size();
+}
+
+auto OrderPool::getHomeSlot(std::string_view orderID) const -> std::size_t
+{
+    return std::hash<std::string_view> {}(orderID) & (m_orderIDIndex.size() - 1);
+}
+
+void OrderPool::insertIntoIndex(OrderPool::index_t index)
+{
+    const auto mask = m_orderIDIndex.size() - 1;
+
+    auto slot = getHomeSlot(m_nodes[index].order.getOrderID());
+    while (m_orderIDIndex[slot] != NIL) {
+        slot = (slot + 1) & mask;
+    }
+
+    m_orderIDIndex[slot] = index;
+}
+
+void OrderPool::eraseFromIndex(OrderPool::index_t index)
+{
+    const auto mask = m_orderIDIndex.size() - 1;
+
+    // look for the entry of this node, not for any entry with the same order ID
+    auto hole = getHomeSlot(m_nodes[index].order.getOrderID());
+    while (m_orderIDIndex[hole] != index) {
+        if (m_orderIDIndex[hole] == NIL) { // not indexed
+            return;
+        }
+        hole = (hole + 1) & mask;
+    }
+
+    // backward shift deletion: move back the following entries of the cluster
+    // that would otherwise no longer be reachable from their home slot
+    for (auto slot = (hole + 1) & mask; m_orderIDIndex[slot] != NIL; slot = (slot + 1) & mask) {
+        const auto home = getHomeSlot(m_nodes[m_orderIDIndex[slot]].order.getOrderID());
+
+        // is the home slot cyclically outside (hole, slot]?
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            m_orderIDIndex[hole] = m_orderIDIndex[slot];
+            hole = slot;
+        }
+    }
+
+    m_orderIDIndex[hole] = NIL;
+}
+
+void OrderPool::growIndex()
+{
+    std::vector<index_t> oldIndex(2 * m_orderIDIndex.size(), NIL);
+    oldIndex.swap(m_orderIDIndex);
+
+    for (auto index : oldIndex) {
+        if (index != NIL) {
+            insertIntoIndex(index);
+        }
+    }
+}
+
+} // markets
@@ -2,6 +2,16 @@
 
 namespace markets {
 
+PriceLevel::PriceLevel(OrderPool& pool, double price)
+    : m_pool { &pool }
+    , m_price { price }
+    , m_size { 0 }
+    , m_numOrders { 0 }
+    , m_head { OrderPool::NIL }
+    , m_tail { OrderPool::NIL }
+{
+}
+
 auto PriceLevel::getPrice() const -> double
 {
     return m_price;
@@ -14,7 +24,7 @@ auto PriceLevel::getSize() const -> int
 
 auto PriceLevel::getNumOrders() const -> int
 {
-    return m_orders.size();
+    return m_numOrders;
 }
 
 void PriceLevel::setPrice(double price)
@@ -27,44 +37,108 @@ void PriceLevel::setSize(int size)
     m_size = size;
 }
 
-auto PriceLevel::empty() -> bool
+auto PriceLevel::empty() const -> bool
 {
-    return m_orders.empty();
+    return m_numOrders == 0;
 }
 
-void PriceLevel::push_back(const Order& order)
+void PriceLevel::push_back(Order order)
 {
-    m_orders.push_back(order);
+    auto index = m_pool->acquire(std::move(order));
+
+    (*m_pool)[index].prev = m_tail;
+    if (m_tail != OrderPool::NIL) {
+        (*m_pool)[m_tail].next = index;
+    } else {
+        m_head = index;
+    }
+    m_tail = index;
+
+    ++m_numOrders;
+}
+
+void PriceLevel::push_front(Order order)
+{
+    auto index = m_pool->acquire(std::move(order));
+
+    (*m_pool)[index].next = m_head;
+    if (m_head != OrderPool::NIL) {
+        (*m_pool)[m_head].prev = index;
+    } else {
+        m_tail = index;
+    }
+    m_head = index;
+
+    ++m_numOrders;
 }
 
-void PriceLevel::push_front(const Order& order)
+auto PriceLevel::insert(PriceLevel::iterator pos, Order order) -> PriceLevel::iterator
 {
-    m_orders.push_front(order);
+    if (pos == end()) {
+        push_back(std::move(order));
+        return { m_pool, m_tail };
+    }
+
+    auto index = m_pool->acquire(std::move(order));
+    auto next = pos.getIndex();
+    auto prev = (*m_pool)[next].prev;
+
+    (*m_pool)[index].prev = prev;
+    (*m_pool)[index].next = next;
+    (*m_pool)[next].prev = index;
+    if (prev != OrderPool::NIL) {
+        (*m_pool)[prev].next = index;
+    } else {
+        m_head = index;
+    }
+
+    ++m_numOrders;
+
+    return { m_pool, index };
 }
 
-auto PriceLevel::begin() -> std::list<Order>::iterator
+auto PriceLevel::begin() -> PriceLevel::iterator
 {
-    return m_orders.begin();
+    return { m_pool, m_head };
 }
 
-auto PriceLevel::begin() const -> std::list<Order>::const_iterator
+auto PriceLevel::begin() const -> PriceLevel::const_iterator
 {
-    return m_orders.begin();
+    return { m_pool, m_head };
 }
 
-auto PriceLevel::end() -> std::list<Order>::iterator
+auto PriceLevel::end() -> PriceLevel::iterator
 {
-    return m_orders.end();
+    return { m_pool, OrderPool::NIL };
 }
 
-auto PriceLevel::end() const -> std::list<Order>::const_iterator
+auto PriceLevel::end() const -> PriceLevel::const_iterator
 {
-    return m_orders.end();
+    return { m_pool, OrderPool::NIL };
 }
 
-auto PriceLevel::erase(std::list<Order>::iterator iter) -> std::list<Order>::iterator
+auto PriceLevel::erase(PriceLevel::iterator iter) -> PriceLevel::iterator
 {
-    return m_orders.erase(iter);
+    auto index = iter.getIndex();
+    auto prev = (*m_pool)[index].prev;
+    auto next = (*m_pool)[index].next;
+
+    if (prev != OrderPool::NIL) {
+        (*m_pool)[prev].next = next;
+    } else {
+        m_head = next;
+    }
+
+    if (next != OrderPool::NIL) {
+        (*m_pool)[next].prev = prev;
+    } else {
+        m_tail = prev;
+    }
+
+    m_pool->release(index);
+    --m_numOrders;
+
+    return { m_pool, next };
 }
 
 } // markets
@@ -0,0 +1,109 @@
+#define BOOST_TEST_MODULE test_CancelDuplicateOrderIDs
+#define BOOST_TEST_DYN_LINK
+
+#include "markets/ContinuousStockMarket.h"
+
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace markets;
+
+// order IDs are chosen by clients, so that several resting orders may share one:
+// a cancellation must still find the order at its own price (or in the best price level, for market cancellations)
+class TestMarket : public ContinuousStockMarket {
+public:
+    TestMarket()
+        : ContinuousStockMarket { "TEST" }
+    {
+    }
+
+    void restBid(const std::string& orderID, double price)
+    {
+        auto level = m_localBids.lower_bound(price);
+        if (level == m_localBids.end() || level->getPrice() != price) {
+            level = m_localBids.insert(level, price);
+        }
+        level->setSize(level->getSize() + 100);
+        level->push_back(Order { "TEST", "trader", orderID, price, 100, Order::Type::LIMIT_BUY, {} });
+    }
+
+    // finds the bid targeted by a cancellation (price 0.0: market cancellation), returns its price (or -1.0 if not found)
+    auto findBid(const std::string& orderID, double price) -> double
+    {
+        Order cancel { "TEST", "trader", orderID, price, 100, Order::Type::CANCEL_BID, {} };
+        if (!findLocalOrder(m_localBids, cancel)) {
+            return -1.0;
+        }
+
+        BOOST_TEST(m_thisPriceLevel->getPrice() == m_thisLocalOrder->getPrice());
+        return m_thisLocalOrder->getPrice();
+    }
+
+    // removes the bid targeted by a cancellation, as a full cancellation does
+    void cancelBid(const std::string& orderID, double price)
+    {
+        BOOST_REQUIRE(findBid(orderID, price) >= 0.0);
+
+        m_thisPriceLevel->setSize(m_thisPriceLevel->getSize() - m_thisLocalOrder->getSize());
+        m_thisPriceLevel->erase(m_thisLocalOrder);
+        if (m_thisPriceLevel->empty()) {
+            m_localBids.erase(m_thisPriceLevel);
+        }
+    }
+};
+
+BOOST_AUTO_TEST_CASE(CancelsEachPriceOfADuplicatedID)
+{
+    TestMarket market;
+    market.restBid("DUP", 100.01);
+    market.restBid("DUP", 100.02);
+
+    BOOST_TEST(market.findBid("DUP", 100.01) == 100.01);
+    BOOST_TEST(market.findBid("DUP", 100.02) == 100.02);
+    BOOST_TEST(market.findBid("DUP", 100.03) == -1.0);
+
+    market.cancelBid("DUP", 100.01);
+    BOOST_TEST(market.findBid("DUP", 100.01) == -1.0);
+    BOOST_TEST(market.findBid("DUP", 100.02) == 100.02);
+
+    market.cancelBid("DUP", 100.02);
+    BOOST_TEST(market.findBid("DUP", 100.02) == -1.0);
+}
+
+BOOST_AUTO_TEST_CASE(MarketCancelOnlyTargetsTheBestLevel)
+{
+    TestMarket market;
+    market.restBid("OTHER", 100.05);
+    market.restBid("DUP", 100.01);
+
+    BOOST_TEST(market.findBid("DUP", 0.0) == -1.0);
+
+    market.restBid("DUP", 100.05);
+    BOOST_TEST(market.findBid("DUP", 0.0) == 100.05);
+
+    market.cancelBid("DUP", 0.0);
+    market.cancelBid("OTHER", 0.0);
+    BOOST_TEST(market.findBid("DUP", 0.0) == 100.01);
+}
+
+BOOST_AUTO_TEST_CASE(FindsEveryDuplicateWhileTheIndexGrows)
+{
+    TestMarket market;
+    const int numOrders = 1000; // long probe sequences, and several index resizes
+
+    for (int i = 0; i < numOrders; ++i) {
+        market.restBid("DUP", 100.0 - i * 0.01);
+        market.restBid("ID" + std::to_string(i), 100.0 - i * 0.01);
+    }
+
+    // cancel every other duplicate, then check that all remaining ones are still found
+    for (int i = 0; i < numOrders; i += 2) {
+        market.cancelBid("DUP", 100.0 - i * 0.01);
+    }
+    for (int i = 0; i < numOrders; ++i) {
+        const double price = 100.0 - i * 0.01;
+        BOOST_TEST(market.findBid("DUP", price) == ((i % 2 == 0) ? -1.0 : price));
+        BOOST_TEST(market.findBid("ID" + std::to_string(i), price) == price);
+    }
+}
@@ -0,0 +1,156 @@
+#define BOOST_TEST_MODULE test_FBAExecutionSizes
+#define BOOST_TEST_DYN_LINK
+
+#include "markets/FBAStockMarket.h"
+
+#include <algorithm>
+#include <deque>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace markets;
+
+// the original allocator, which hands out shares one at a time
+// (returns nothing where it would never finish, which is only possible in unsorted levels)
+static auto referenceExecutionSizes(int totalExecutionSize, const PriceLevel& currentLevel) -> std::optional<std::deque<int>>
+{
+    std::deque<int> sizes(currentLevel.getNumOrders());
+
+    if (totalExecutionSize >= currentLevel.getSize()) {
+        int i = 0;
+        for (const auto& order : currentLevel) {
+            sizes[i] = order.getSize();
+            ++i;
+        }
+        return sizes;
+    }
+
+    int lowestCounter = currentLevel.begin()->getAuctionCounter();
+    for (const auto& order : currentLevel) {
+        lowestCounter = std::min(lowestCounter, order.getAuctionCounter());
+    }
+
+    int auctionCounter = currentLevel.begin()->getAuctionCounter();
+    bool changeCounter = true;
+
+    int j = totalExecutionSize;
+    while (j > 0) {
+        if (auctionCounter < lowestCounter) {
+            return std::nullopt;
+        }
+
+        int i = 0;
+        for (const auto& order : currentLevel) {
+            if (order.getAuctionCounter() == auctionCounter) {
+                if (order.getSize() > sizes[i]) {
+                    sizes[i] += 1;
+                    changeCounter = false;
+                    if (--j == 0) {
+                        break;
+                    }
+                } else {
+                    break;
+                }
+            } else if (order.getAuctionCounter() < auctionCounter) {
+                break;
+            }
+            ++i;
+        }
+        if (changeCounter) {
+            --auctionCounter;
+        } else {
+            changeCounter = true;
+        }
+    }
+
+    return sizes;
+}
+
+static void fillRandomLevel(std::mt19937& rng, PriceLevel& level, bool isSorted)
+{
+    std::uniform_int_distribution<int> numOrdersDist { 1, 40 };
+    std::uniform_int_distribution<int> counterDist { 0, 4 };
+    std::uniform_int_distribution<int> sizeDist { 1, (rng() % 2) ? 10 : 1000 };
+
+    int numOrders = numOrdersDist(rng);
+    for (int i = 0; i < numOrders; ++i) {
+        Order order { "TEST", "T" + std::to_string(i), "O" + std::to_string(i), level.getPrice(), sizeDist(rng), Order::Type::LIMIT_BUY, FIX::UtcTimeStamp {} };
+        for (int c = counterDist(rng); c > 0; --c) {
+            order.incrementAuctionCounter();
+        }
+
+        level.setSize(level.getSize() + order.getSize());
+        if (isSorted) {
+            level.insertSorted(std::move(order), FBAStockMarket::s_hasPriority);
+        } else {
+            level.push_back(std::move(order));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SORTED_LEVELS_MATCH_REFERENCE)
+{
+    std::mt19937 rng { 42 };
+
+    for (int n = 0; n < 20000; ++n) {
+        OrderPool pool;
+        PriceLevel level { pool, 10.0 };
+        fillRandomLevel(rng, level, true);
+
+        BOOST_REQUIRE(level.isSorted(FBAStockMarket::s_hasPriority));
+
+        int totalExecutionSize = std::uniform_int_distribution<int> { 0, level.getSize() + 5 }(rng);
+        auto expected = referenceExecutionSizes(totalExecutionSize, level);
+        auto actual = FBAStockMarket::s_determineExecutionSizes(totalExecutionSize, level);
+
+        BOOST_REQUIRE(expected);
+        BOOST_REQUIRE(*expected == actual);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(UNSORTED_LEVELS_MATCH_REFERENCE)
+{
+    std::mt19937 rng { 4242 };
+
+    for (int n = 0; n < 20000; ++n) {
+        OrderPool pool;
+        PriceLevel level { pool, 10.0 };
+        fillRandomLevel(rng, level, false);
+
+        int totalExecutionSize = std::uniform_int_distribution<int> { 0, level.getSize() + 5 }(rng);
+        auto expected = referenceExecutionSizes(totalExecutionSize, level);
+        auto actual = FBAStockMarket::s_determineExecutionSizes(totalExecutionSize, level);
+
+        BOOST_REQUIRE_EQUAL(std::count_if(actual.begin(), actual.end(), [](int size) { return size < 0; }), 0);
+        BOOST_REQUIRE_EQUAL(std::accumulate(actual.begin(), actual.end(), 0), std::min(totalExecutionSize, level.getSize()));
+        if (expected) {
+            BOOST_REQUIRE(*expected == actual);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SORTED_INSERTION_MATCHES_SORT)
+{
+    std::mt19937 rng { 7 };
+
+    for (int n = 0; n < 2000; ++n) {
+        OrderPool sortedPool;
+        OrderPool resortedPool;
+        PriceLevel sortedLevel { sortedPool, 10.0 };
+        PriceLevel resortedLevel { resortedPool, 10.0 };
+
+        std::mt19937 sortedRng = rng;
+        fillRandomLevel(sortedRng, sortedLevel, true);
+        fillRandomLevel(rng, resortedLevel, false);
+        FBAStockMarket::s_sortPriceLevel(resortedLevel);
+
+        BOOST_REQUIRE(std::equal(sortedLevel.begin(), sortedLevel.end(), resortedLevel.begin(), resortedLevel.end(), [](const Order& a, const Order& b) {
+            return a.getTraderID() == b.getTraderID();
+        }));
+    }
+}
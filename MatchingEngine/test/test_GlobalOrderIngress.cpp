@@ -0,0 +1,61 @@
+#define BOOST_TEST_MODULE test_GlobalOrderIngress
+#define BOOST_TEST_DYN_LINK
+
+#include "Parameters.h"
+#include "TimeSetting.h"
+#include "markets/ContinuousStockMarket.h"
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace markets;
+
+class TestMarket : public ContinuousStockMarket {
+public:
+    TestMarket()
+        : ContinuousStockMarket { "TEST" }
+    {
+    }
+
+    using Market::getNextOrder;
+};
+
+// the FIXInitiator thread receives a chunk of ticks long before they are due (see ::DATA_PREFETCH_HORIZON):
+// it must be able to hand over many more of them than the ingress queue can hold, without waiting for the simulation time
+BOOST_AUTO_TEST_CASE(ProducerIsNotHeldBackByFutureOrders)
+{
+    TimeSetting::getInstance().initiate(boost::posix_time::time_from_string("2018-12-17 09:30:00"), 1);
+    TimeSetting::getInstance().setStartTime();
+
+    TestMarket market;
+    std::thread marketThread { std::ref(market) };
+
+    const int numOrders = 4 * ::GLOBAL_ORDER_QUEUE_CAPACITY;
+    const std::int64_t firstDueNS = std::chrono::duration_cast<std::chrono::nanoseconds>(1h).count();
+
+    auto producer = std::async(std::launch::async, [&market, numOrders, firstDueNS] {
+        for (int i = 0; i < numOrders; ++i) {
+            Order order { "TEST", 100.0, 1, (i % 2 == 0) ? Order::Type::TRTH_BID : Order::Type::TRTH_ASK, "NSDQ", {} };
+            order.setNanos(firstDueNS + i);
+            market.bufNewGlobalOrder(std::move(order));
+        }
+    });
+
+    const bool isProducerDone = (producer.wait_for(10s) == std::future_status::ready);
+
+    MarketList::s_isTimeout = true; // stops the market thread (and a held back producer)
+    marketThread.join();
+    producer.wait();
+
+    BOOST_TEST(isProducerDone);
+
+    // nothing is due yet, and the market waits for the oldest order
+    Order order;
+    BOOST_TEST(!market.getNextOrder(order));
+    BOOST_TEST(market.getNextWakeUpNS() == firstDueNS + 1);
+}